@@ -34,6 +34,7 @@ void LoadMemory(U32 *DestAddr, U32 *BasebandAddr, int Size);
 void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size);
 // input file for PC simulation
 void SetInputFile(char *FileName);
+void SetInputFile2(char *FileName);	// second RF input of L5 band
 // RF control
 void EnableRF();
 
@@ -78,6 +78,12 @@ void SaveMemory(U32 *BasebandAddr, U32 *SrcAddr, int Size)
 //   FileName: file name
 void SetInputFile(char *FileName) {}
 
+//*************** Set input file of second RF input (L5 band) ****************
+//* in real system, this function has no effect
+// Parameters:
+//   FileName: file name
+void SetInputFile2(char *FileName) {}
+
 //*************** enable RF clock ****************
 //* in PC platform, this will run baseband process until end of scenario
 //* in real system, this will enable RF and its ADC clock
@@ -103,6 +103,15 @@ void SetInputFile(char *FileName)
 	InitPosition.hae = Baseband.StartPos.alt;
 }
 
+//*************** Set input file of second RF input (L5 band) ****************
+//* in C model, this is a RF file sampled at SAMPLE_FREQ_L5 covering same time span as first input
+// Parameters:
+//   FileName: file name
+void SetInputFile2(char *FileName)
+{
+	Baseband.SetInputFile2(FileName, SAMPLES_1MS_L5);
+}
+
 //*************** enable RF clock ****************
 //* in PC platform, this will run baseband process until end of scenario
 //* in real system, this will enable RF and its ADC clock
@@ -26,12 +26,14 @@ typedef struct
 	int NoncohNumber;
 	int StrideNumber;
 	int StrideInterval;
+	int DftNumber;	// number of DFT bins within one stride, 8/16/32
 	ACQ_SAT_CONFIG SatConfig[TOTAL_CHANNEL_NUMBER];
 } ACQ_CONFIG, *PACQ_CONFIG;
 
 void AEInitialize(void);
 PACQ_CONFIG GetFreeAcqTask(void);
 int AddAcqTask(PACQ_CONFIG pAcqConfig);
+int AddAidedAcqTask(PSAT_PREDICT_PARAM SatList, int SatNumber);
 void AeInterruptProc();
 void StartAcquisition(void);
 int AcqBufferReachTh(void);
@@ -49,6 +49,7 @@ typedef struct
 // configuration for individual field
 #define STATE_BUF_SET_PRE_SHIFT(pStateBuffer, PreShift)         SET_FIELD((pStateBuffer)->CorrConfig, 0, 2, PreShift)
 #define STATE_BUF_SET_POST_SHIFT(pStateBuffer, PostShift)       SET_FIELD((pStateBuffer)->CorrConfig, 2, 2, PostShift)
+#define STATE_BUF_SELECT_INPUT2(pStateBuffer)                   SET_BIT32((pStateBuffer)->CorrConfig, 4)
 #define STATE_BUF_DATA_IN_I(pStateBuffer)                       CLEAR_BIT32((pStateBuffer)->CorrConfig, 5)
 #define STATE_BUF_DATA_IN_Q(pStateBuffer)                       SET_BIT32((pStateBuffer)->CorrConfig, 5)
 #define STATE_BUF_ENABLE_PRN2(pStateBuffer)                     SET_BIT32((pStateBuffer)->CorrConfig, 6)
@@ -96,10 +97,11 @@ typedef struct
 #define STATE_BUF_SET_PRN_COUNT(pStateBuffer, Count) ((pStateBuffer)->PrnCount = Count)
 
 // PRN configuration and count for different signal
-#define PRN_CONFIG_L1CA(Svid) (CAPrnInit[Svid-1])
+#define PRN_CONFIG_L1CA(Svid) (((Svid) < MIN_SBAS_SVID) ? CAPrnInit[Svid-1] : WaasPrnInit[(Svid)-MIN_SBAS_SVID])
 #define PRN_CONFIG_E1(Svid)   (0xc0000004 + ((49 + Svid) << 6))
 #define PRN_CONFIG_B1C(Svid)  (B1CPilotInit[Svid-1])
 #define PRN_CONFIG_L1C(Svid)  (L1CPilotInit[Svid-1])
+#define PRN_CONFIG_L5(Svid)   (L5QInit[Svid-1] | 0x40000000)	// general PRN 1 using polynomial set 1
 #define PRN_CONFIG2_E1(Svid)  (0xc0000004 + ((Svid-1) << 6))
 #define PRN_CONFIG2_B1C(Svid) (B1CDataInit[Svid-1])
 #define PRN_CONFIG2_L1C(Svid) (L1CDataInit[Svid-1])
@@ -107,9 +109,15 @@ typedef struct
 #define PRN_COUNT_E1(StartPhase)   (((StartPhase / 1023) << 10) + (StartPhase % 1023))
 #define PRN_COUNT_B1C(StartPhase)  (StartPhase)
 #define PRN_COUNT_L1C(StartPhase)  (StartPhase)
-#define GET_PRN_COUNT(FreqID, PrnCount) (FREQ_ID_IS_L1CA(FreqID) ? ((PrnCount >> 14)) : (FREQ_ID_IS_E1(FreqID) ? ((PrnCount) - ((PrnCount) >> 10)) : (PrnCount)))
+#define PRN_COUNT_L5(StartPhase)   ((StartPhase) << 14)
+#define GET_PRN_COUNT(FreqID, PrnCount) ((FREQ_ID_IS_L1CA(FreqID) || FREQ_ID_IS_L5(FreqID)) ? ((PrnCount >> 14)) : (FREQ_ID_IS_E1(FreqID) ? ((PrnCount) - ((PrnCount) >> 10)) : (PrnCount)))
 
 // constant settings in baseband
 #define PRE_SHIFT_BITS 1
 
+// Neuman-Hofman code of GPS L5 and secondary code of Galileo E1C, first chip at LSB
+#define NH10_CODE 0x000002b0	// I5
+#define NH20_CODE 0x00072b20	// Q5
+#define CS25_CODE 0x009b501c	// E1C secondary code
+
 #endif	// __BB_DEFINES_H__
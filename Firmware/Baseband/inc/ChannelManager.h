@@ -32,8 +32,34 @@ typedef struct
 	U32 CorData[20];	// 20 correlation result of peak correlator (or pilot data symbols for pilot data sync)
 } BIT_SYNC_DATA, *PBIT_SYNC_DATA;
 
+typedef struct
+{
+	volatile int Update;	// set by task after Pending filled (in critical section), cleared by interrupt after copy to Current
+	NAV_BIT_PREDICT Pending;	// latest prediction from PVT
+	NAV_BIT_PREDICT Current;	// prediction used for data wipe-off
+	U32 PrevPrompt;		// wiped off prompt correlator result of previous bit, 0 if not available
+	int MismatchCount;	// leaky count of sign flip between wiped off prompt results
+	U32 HoldOffBit;		// prediction not used before BitCount reaches this value after mismatch detected
+} BIT_WIPEOFF, *PBIT_WIPEOFF;
+
+// each wiped off bit with prompt sign flip adds WIPEOFF_MISMATCH_STEP, each bit without flip subtracts 1
+// correct prediction keeps count near 0 unless flip probability by noise exceeds 1/(STEP+1)
+#define WIPEOFF_MISMATCH_STEP 3
+#define WIPEOFF_MISMATCH_TH 32
+#define WIPEOFF_HOLDOFF_BITS 300	// one subframe for PVT to decode new data before prediction used again
+
+// alignment of per channel hot state to cache line
+#define CACHE_LINE_SIZE 32
+#if defined(_MSC_VER)
+#define CACHE_LINE_ALIGN __declspec(align(CACHE_LINE_SIZE))
+#else
+#define CACHE_LINE_ALIGN __attribute__((aligned(CACHE_LINE_SIZE)))
+#endif
+
 // channel related functions and variables
-typedef struct tag_CHANNEL_STATE
+// only fields accessed on each coherent interrupt are placed here, large buffers are placed in
+// per channel pools indexed by LogicChannel and accessed through CHANNEL_XXX() macros below
+typedef struct CACHE_LINE_ALIGN tag_CHANNEL_STATE
 {
 	U8 UserChannel;		// user channel number (reserved for future use)
 	U8 LogicChannel;	// physical channel number (map to hardware logic channel)
@@ -43,9 +69,6 @@ typedef struct tag_CHANNEL_STATE
 	// following variable for tracking stage
 	int TrackingTime;		// millisecond at current stage (reset at stage swith or at phase loss lock at final stage)
 	int TrackingTimeout;	// millisecond for current stage timeout (-1 for final stage)
-	// state buffer cache and pointer to hardware buffer
-	STATE_BUFFER StateBufferCache;	// local image of state buffer
-	volatile PSTATE_BUFFER StateBufferHW;	// pointer to hardware state buffer
 	// accumulation number and counter
 	int CoherentNumber;		// same as coherent number settings in CohConfig field of state buffer
 	int FftNumber;			// 1 for PLL only (no FLL), 2 for cross-dot (FLL), 3~8 for FFT
@@ -67,16 +90,6 @@ typedef struct tag_CHANNEL_STATE
 	U32 CarrierFreqSave;	// carrier frequency control word when PLL/FLL lock
 	U32 CodeFreqSave;		// code frequency control word when DLL lock
 	int CodeSearchCount;	// counter on search range on correlator acquisition or tracking hold
-	// buffer for coherent and non-coherent sum
-	U32 CohBuffer[COH_BUF_LEN];	// buffer to hold coherent sums
-	int NoncohBuffer[NONCOH_BUF_LEN];	// buffer to hold noncoherent sums
-	// data for bit sync
-	BIT_SYNC_DATA BitSyncData;
-	int ToggleCount[20];	// toggle count for each position (only BitSyncTask will access this array)
-	int BitSyncResult;		// set by BitSyncTask, -1 for bit sync fail, 0 for bit sync in process, 1~20 as bit sync position, 21 as switch to tracking from bit sync
-	// data for data stream decode
-	DATA_STREAM DataStream;
-	int FrameCounter;		// current data/secondary code position in frame
 	// tracking loop coefficients
 	int pll_k1, pll_k2, pll_k3;	// maximum 3rd order
 	int fll_k1, fll_k2;			// maximum 2nd order
@@ -89,6 +102,18 @@ typedef struct tag_CHANNEL_STATE
 	// lock detector
 	int PLD, FLD, DLD;	// 0 to 100 as indicator of lock quality
 	int LoseLockCounter;
+	// vector tracking aiding
+	int AidDoppler;		// Doppler predicted by PVT Kalman filter in unit of 1/256Hz
+	int AidUpdate;		// set by PVT task as VECTOR_AIDING_VALID or VECTOR_AIDING_DROP, cleared on coherent interrupt
+	int VectorFreqAcc;	// accumulated frequency discriminator output since last measurement
+	int VectorDelayAcc;	// accumulated delay discriminator output since last measurement
+	int VectorDiscCount;	// number of discriminator outputs accumulated
+	// bit sync and data stream state
+	int BitSyncResult;		// set by BitSyncTask, -1 for bit sync fail, 0 for bit sync in process, 1~20 as bit sync position, 21 as switch to tracking from bit sync
+	int FrameCounter;		// current data/secondary code position in frame
+	// state buffer cache and pointer to hardware buffer
+	volatile PSTATE_BUFFER StateBufferHW;	// pointer to hardware state buffer
+	STATE_BUFFER StateBufferCache;	// local image of state buffer
 } CHANNEL_STATE, *PCHANNEL_STATE;
 
 typedef struct
@@ -118,10 +143,38 @@ typedef struct
 #pragma pack(pop)	//restore original alignment
 
 extern CHANNEL_STATE ChannelStateArray[TOTAL_CHANNEL_NUMBER];
+// pools of large per channel buffers, only accessed on FFT/non-coherent, bit sync and data decode
+extern U32 ChannelCohBuffer[TOTAL_CHANNEL_NUMBER][COH_BUF_LEN];		// buffer to hold coherent sums
+extern int ChannelNoncohBuffer[TOTAL_CHANNEL_NUMBER][NONCOH_BUF_LEN];	// buffer to hold noncoherent sums
+extern BIT_SYNC_DATA ChannelBitSyncData[TOTAL_CHANNEL_NUMBER];		// data for bit sync
+extern int ChannelToggleCount[TOTAL_CHANNEL_NUMBER][20];			// toggle count for each position (only BitSyncTask will access this array)
+extern DATA_STREAM ChannelDataStream[TOTAL_CHANNEL_NUMBER];			// data for data stream decode
+extern BIT_WIPEOFF ChannelBitWipeoff[TOTAL_CHANNEL_NUMBER];			// predicted navigation bits for data wipe-off
+
+#define CHANNEL_COH_BUFFER(pChannel)    (ChannelCohBuffer[(pChannel)->LogicChannel])
+#define CHANNEL_NONCOH_BUFFER(pChannel) (ChannelNoncohBuffer[(pChannel)->LogicChannel])
+#define CHANNEL_BIT_SYNC_DATA(pChannel) (ChannelBitSyncData[(pChannel)->LogicChannel])
+#define CHANNEL_TOGGLE_COUNT(pChannel)  (ChannelToggleCount[(pChannel)->LogicChannel])
+#define CHANNEL_DATA_STREAM(pChannel)   (ChannelDataStream[(pChannel)->LogicChannel])
+#define CHANNEL_BIT_WIPEOFF(pChannel)   (ChannelBitWipeoff[(pChannel)->LogicChannel])
+
+// values for AidUpdate field
+#define VECTOR_AIDING_NONE  0	// no new aiding from PVT
+#define VECTOR_AIDING_VALID 1	// new predicted Doppler in AidDoppler
+#define VECTOR_AIDING_DROP  2	// PVT degraded, hand over to scalar tracking loops
+// vector aiding only applies on weak signal (track 2/3) and signal lost (hold 3) stages
+#define STAGE_VECTOR_AIDING(stage) ((stage) == STAGE_HOLD3 || (stage) == (STAGE_TRACK + 2) || (stage) == (STAGE_TRACK + 3))
+// SBAS channel has 2ms symbol, so it uses its own column of TrackingConfig after frequency ID columns
+#define CHANNEL_IS_SBAS(pChannel) SVID_IS_SBAS((pChannel)->FreqID, (pChannel)->Svid)
+#define SIGNAL_CONFIG_INDEX(pChannel) (CHANNEL_IS_SBAS(pChannel) ? 5 : (pChannel)->FreqID)
+
 void InitChannel(PCHANNEL_STATE pChannel);
 void ConfigChannel(PCHANNEL_STATE pChannel, int Doppler, int CodePhase16x);
+void ConfigL5Channel(PCHANNEL_STATE pChannel, PBB_MEASUREMENT L1Msr);
 void SyncCacheWrite(PCHANNEL_STATE ChannelState);
 void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect);
 int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement, U32 *DataBuffer);
+void ApplyVectorAiding(PSAT_PREDICT_PARAM AidingList, U32 AidingMask, U32 ChannelMask);
+void ApplyNavBitPrediction(PNAV_BIT_PREDICT PredictList, U32 PredictMask, U32 ChannelMask);
 
 #endif // __CHANNEL_MANAGER_H__
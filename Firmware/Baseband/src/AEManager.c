@@ -54,6 +54,42 @@ int AddAcqTask(PACQ_CONFIG pAcqConfig)
 	return 0;
 }
 
+//*************** Add acquisition task of satellites with predicted Doppler ****************
+//* only L1C/A satellites are searched with narrow frequency range around predicted Doppler
+// Parameters:
+//   SatList: satellites to be acquired with predicted Doppler
+//   SatNumber: number of satellites in list
+// Return value:
+//   number of satellites put into acquisition task
+int AddAidedAcqTask(PSAT_PREDICT_PARAM SatList, int SatNumber)
+{
+	int i, AcqNumber = 0;
+	PACQ_CONFIG pAcqConfig;
+
+	if ((pAcqConfig = GetFreeAcqTask()) == NULL)
+		return 0;
+	for (i = 0; i < SatNumber && AcqNumber < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if (SatList[i].FreqID != FREQ_L1CA)
+			continue;
+		pAcqConfig->SatConfig[AcqNumber].FreqSvid = (U8)FREQ_SVID(SatList[i].FreqID, SatList[i].Svid);
+		pAcqConfig->SatConfig[AcqNumber].CodeSpan = 3;
+		pAcqConfig->SatConfig[AcqNumber].CenterFreq = (S16)SatList[i].Doppler;
+		AcqNumber ++;
+	}
+	pAcqConfig->SignalType = 0;	// for BPSK acquisition
+	pAcqConfig->AcqChNumber = AcqNumber;
+	pAcqConfig->CohNumber = 4;
+	pAcqConfig->NoncohNumber = 1;
+	pAcqConfig->StrideNumber = 1;
+	pAcqConfig->StrideInterval = 500;
+	pAcqConfig->DftNumber = 8;
+	if (AcqNumber > 0)
+		AddAcqTask(pAcqConfig);
+
+	return AcqNumber;
+}
+
 void DoAcqTask()
 {
 	int i;
@@ -113,10 +149,14 @@ void AeInterruptProc()
 void StartAcquisition(void)
 {
 	int i;
-	int DftFreq = (CurAcqTask->StrideInterval << 10) / 1000;
+	int DftSize = (CurAcqTask->DftNumber >= 32) ? 2 : (CurAcqTask->DftNumber >= 16) ? 1 : 0;
+	int DftFreq = (CurAcqTask->StrideInterval << (10 - DftSize)) / 1000;	// DFT bin interval is StrideInterval/DftNumber
 	unsigned int ConfigData[4];
 
-	ConfigData[0] = 0x04000000 | (CurAcqTask->NoncohNumber << 16) | (CurAcqTask->CohNumber << 8) | CurAcqTask->StrideNumber;	// threshold: 3'b100
+	// peak frequency index in AE result is 9bit signed, so total bins of all strides should be within -256~255
+	if (CurAcqTask->StrideNumber > (512 >> (3 + DftSize)) - 1)
+		CurAcqTask->StrideNumber = (512 >> (3 + DftSize)) - 1;
+	ConfigData[0] = 0x04000000 | (DftSize << 28) | (CurAcqTask->NoncohNumber << 16) | (CurAcqTask->CohNumber << 8) | CurAcqTask->StrideNumber;	// threshold: 3'b100
 	ConfigData[3]= AE_STRIDE_INTERVAL(CurAcqTask->StrideInterval);
 	for (i = 0; i < CurAcqTask->AcqChNumber; i ++)
 	{
@@ -199,7 +239,7 @@ int ProcessAcqResult(void *Param)
 	{
 		LoadMemory(AcqResult, (U32 *)(ADDR_BASE_AE_BUFFER + i * 32 + 16), 16);
 		Doppler = ((int)(AcqResult[1] << 8)) >> 23;
-		Doppler = pAcqConfig->SatConfig[i].CenterFreq + (Doppler * 2 - 7) * pAcqConfig->StrideInterval / 16;
+		Doppler = pAcqConfig->SatConfig[i].CenterFreq + (Doppler * 2 - (pAcqConfig->DftNumber - 1)) * pAcqConfig->StrideInterval / (pAcqConfig->DftNumber * 2);
 		CodePhase = AcqResult[1] & 0x7fff;	// acquired code position, 2x chip scale
 		DEBUG_OUTPUT(OUTPUT_CONTROL(ACQUISITION, INFO), "Ch%02d %08x %08x %08x %08x ", i, AcqResult[0], AcqResult[1], AcqResult[2], AcqResult[3]);
 		DEBUG_OUTPUT(OUTPUT_CONTROL(ACQUISITION, INFO), "Svid%2d Amp=%3d Cor=%5d Freq=%d\n",  GET_SVID(pAcqConfig->SatConfig[i].FreqSvid), AcqResult[1] >> 24, CodePhase, Doppler);
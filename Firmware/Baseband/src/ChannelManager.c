@@ -21,12 +21,20 @@
 #include "PvtEntry.h"
 
 CHANNEL_STATE ChannelStateArray[TOTAL_CHANNEL_NUMBER];
-extern PTRACKING_CONFIG TrackingConfig[][4];
+U32 ChannelCohBuffer[TOTAL_CHANNEL_NUMBER][COH_BUF_LEN];
+int ChannelNoncohBuffer[TOTAL_CHANNEL_NUMBER][NONCOH_BUF_LEN];
+BIT_SYNC_DATA ChannelBitSyncData[TOTAL_CHANNEL_NUMBER];
+int ChannelToggleCount[TOTAL_CHANNEL_NUMBER][20];
+DATA_STREAM ChannelDataStream[TOTAL_CHANNEL_NUMBER];
+BIT_WIPEOFF ChannelBitWipeoff[TOTAL_CHANNEL_NUMBER];
+extern PTRACKING_CONFIG TrackingConfig[][6];
 
 void CalcDiscriminator(PCHANNEL_STATE ChannelState, unsigned int Method);
 void CohBufferFft(PCHANNEL_STATE ChannelState);
 void CohBufferAcc(PCHANNEL_STATE ChannelState);
 void DoTrackingLoop(PCHANNEL_STATE ChannelState);
+void VectorAidingUpdate(PCHANNEL_STATE ChannelState);
+int CohBufferWipeOff(PCHANNEL_STATE ChannelState);
 void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage);
 int StageDetermination(PCHANNEL_STATE ChannelState);
 
@@ -37,6 +45,7 @@ static void CalcCN0(PCHANNEL_STATE ChannelState);
 static int BitSyncTask(void *Param);
 static int DataSyncTask(void *Param);
 static int SyncPilotData(unsigned int DataWord, const unsigned int SecondCode[57], int StartOffset);
+static int SyncE1PilotData(unsigned int DataWord, int StartOffset);
 
 void SetNHConfig(PCHANNEL_STATE ChannelState, int NHPos, const unsigned int *NHCode);
 
@@ -48,9 +57,12 @@ void SetNHConfig(PCHANNEL_STATE ChannelState, int NHPos, const unsigned int *NHC
 void InitChannel(PCHANNEL_STATE pChannel)
 {
 	PSTATE_BUFFER pStateBuffer = &(pChannel->StateBufferCache);
-	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[0][pChannel->FreqID];
+	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[0][SIGNAL_CONFIG_INDEX(pChannel)];
 
 	memset(pStateBuffer, 0, sizeof(STATE_BUFFER));
+	CHANNEL_DATA_STREAM(pChannel).BitCount = 0;
+	CHANNEL_BIT_WIPEOFF(pChannel).Current.BitNumber = 0;
+	CHANNEL_BIT_WIPEOFF(pChannel).HoldOffBit = 0;
 
 	STATE_BUF_SET_CORR_CONFIG(pStateBuffer, CurTrackingConfig->CoherentNumber, 0, CurTrackingConfig->NarrowFactor, 0, 0, 0, 0, CurTrackingConfig->PostShift, PRE_SHIFT_BITS);
 	STATE_BUF_SET_NH_CONFIG(pStateBuffer, 0, 0);
@@ -59,27 +71,44 @@ void InitChannel(PCHANNEL_STATE pChannel)
 	if (FREQ_ID_IS_L1CA(pChannel->FreqID))
 	{
 		STATE_BUF_SET_PRN_CONFIG(pStateBuffer, PRN_CONFIG_L1CA(pChannel->Svid));
-		pChannel->DataStream.TotalAccTime = 20;	// 20ms for GPS L1CA
-		pChannel->State |= DATA_STREAM_1BIT;
+		if (CHANNEL_IS_SBAS(pChannel))
+		{
+			CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 2;	// 2ms symbol for SBAS
+			pChannel->State |= DATA_STREAM_8BIT;	// soft symbol for Viterbi decode
+		}
+		else
+		{
+			CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 20;	// 20ms for GPS L1CA
+			pChannel->State |= DATA_STREAM_1BIT;
+		}
 	}
 	else if (FREQ_ID_IS_E1(pChannel->FreqID))
 	{
 		STATE_BUF_SET_PRN_CONFIG(pStateBuffer, PRN_CONFIG_E1(pChannel->Svid));
-		pChannel->DataStream.TotalAccTime = 4;	// 4ms for Galileo E1
+		CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 4;	// 4ms for Galileo E1
 		pChannel->State |= DATA_STREAM_4BIT;
 	}
 	else if (FREQ_ID_IS_B1C(pChannel->FreqID))
 	{
 		STATE_BUF_SET_PRN_CONFIG(pStateBuffer, PRN_CONFIG_B1C(pChannel->Svid));
-		pChannel->DataStream.TotalAccTime = 10;	// 10ms for BDS B1C
+		CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 10;	// 10ms for BDS B1C
 		pChannel->State |= DATA_STREAM_8BIT;
 	}
 	else if (FREQ_ID_IS_L1C(pChannel->FreqID))
 	{
 		STATE_BUF_SET_PRN_CONFIG(pStateBuffer, PRN_CONFIG_L1C(pChannel->Svid));
-		pChannel->DataStream.TotalAccTime = 10;	// 10ms for GPS L1C
+		CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 10;	// 10ms for GPS L1C
 		pChannel->State |= DATA_STREAM_8BIT;
 	}
+	else if (FREQ_ID_IS_L5(pChannel->FreqID))
+	{
+		STATE_BUF_SET_PRN_CONFIG(pStateBuffer, PRN_CONFIG_L5(pChannel->Svid));
+		STATE_BUF_SET_NH_CONFIG(pStateBuffer, 20, NH20_CODE);	// NH20 on Q5 removed by HW
+		STATE_BUF_SET_DUMP_LENGTH(pStateBuffer, 10230);
+		STATE_BUF_SELECT_INPUT2(pStateBuffer);	// L5 band from second TE FIFO
+		CHANNEL_DATA_STREAM(pChannel).TotalAccTime = 20;	// 20ms NH period for GPS L5 pilot
+		pChannel->State |= DATA_STREAM_NONE;	// pilot channel has no data to decode
+	}
 	pChannel->State |= STATE_CACHE_DIRTY;	// set cache dirty
 
 	SwitchTrackingStage(pChannel, STAGE_PULL_IN);	// switch to pull-in stage
@@ -100,9 +129,11 @@ void ConfigChannel(PCHANNEL_STATE pChannel, int Doppler, int CodePhase16x)
 	// config DWORDs
 	if (FREQ_ID_IS_L1CA(pChannel->FreqID))
 		pChannel->CarrierFreqBase = CARRIER_FREQ(Doppler);
+	else if (FREQ_ID_IS_L5(pChannel->FreqID))
+		pChannel->CarrierFreqBase = CARRIER_FREQ_L5(Doppler);
 	else
 		pChannel->CarrierFreqBase = CARRIER_FREQ_BOC(Doppler);
-	pChannel->CodeFreqBase = CODE_FREQ(Doppler);
+	pChannel->CodeFreqBase = FREQ_ID_IS_L5(pChannel->FreqID) ? CODE_FREQ_L5(Doppler) : CODE_FREQ(Doppler);
 	STATE_BUF_SET_CARRIER_FREQ(pStateBuffer, pChannel->CarrierFreqBase);
 	STATE_BUF_SET_CODE_FREQ(pStateBuffer, pChannel->CodeFreqBase);
 	// PRN config
@@ -133,14 +164,58 @@ void ConfigChannel(PCHANNEL_STATE pChannel, int Doppler, int CodePhase16x)
 		pChannel->SkipCount = 10 - StartPhase / 1023;	// align to bit edge
 		pChannel->TrackingTime = StartPhase / 1023;
 	}
+	else if (FREQ_ID_IS_L5(pChannel->FreqID))
+	{
+		StartPhase %= 10230;	// remnant of code cycle
+		STATE_BUF_SET_PRN_COUNT(pStateBuffer, PRN_COUNT_L5(StartPhase));
+		pChannel->SkipCount = 1;	// skip the first coherent sum result (PRN not ready until code edge for L5)
+	}
 	// status fields
 	STATE_BUF_SET_CODE_PHASE(pStateBuffer, (CodePhase16x << 29));
-	STATE_BUF_SET_DUMP_COUNT(pStateBuffer, (StartPhase % 1023));
-	STATE_BUF_SET_NH_COUNT(pStateBuffer, (StartPhase / 1023));
+	if (FREQ_ID_IS_L5(pChannel->FreqID))	// one dump per 1ms code period, NH position set by caller
+	{
+		STATE_BUF_SET_DUMP_COUNT(pStateBuffer, StartPhase);
+		STATE_BUF_SET_NH_COUNT(pStateBuffer, 0);
+	}
+	else
+	{
+		STATE_BUF_SET_DUMP_COUNT(pStateBuffer, (StartPhase % 1023));
+		STATE_BUF_SET_NH_COUNT(pStateBuffer, (StartPhase / 1023));
+	}
 	STATE_BUF_SET_CODE_SUB_PHASE(pStateBuffer, (CodePhase16x >> 3));
 	pChannel->State |= (STATE_CACHE_FREQ_DIRTY | STATE_CACHE_CODE_DIRTY);	// set cache dirty
 }
 
+//*************** Configure L5 channel handed over from L1C/A channel ****************
+//* Doppler is scaled by carrier frequency ratio, code phase within 20ms data bit of L1C/A
+//* is scaled by code rate ratio, so NH code position of L5 is also determined
+// Parameters:
+//   pChannel: pointer to channel state of L5 channel
+//   L1Msr: baseband measurement of L1C/A channel tracking the same satellite
+// Return value:
+//   none
+void ConfigL5Channel(PCHANNEL_STATE pChannel, PBB_MEASUREMENT L1Msr)
+{
+	PSTATE_BUFFER pStateBuffer = &(pChannel->StateBufferCache);
+	int Doppler, HalfChip;
+	S64 CodePhase;
+
+	// L5 Doppler is 115/154 of L1 Doppler
+	Doppler = (int)(((S64)L1Msr->CarrierFreq * SAMPLE_FREQ) >> 32) - IF_FREQ;
+	Doppler = Doppler * 115 / 154;
+	// L1C/A code count within 20ms in unit of 1/2 chip, L5 has 10 times of 1/2 chips within same period
+	// add back 4 correlator interval compensated in ComposeMeasurement() to get local code position of HW
+	CodePhase = (((S64)L1Msr->CodeCount << 32) + L1Msr->CodeNCO) * 10 + (4LL << 32);
+	CodePhase %= ((S64)(20 * 20460) << 32);
+	if (CodePhase < 0)
+		CodePhase += ((S64)(20 * 20460) << 32);
+	HalfChip = (int)(CodePhase >> 32);
+	ConfigChannel(pChannel, Doppler, HalfChip * 8);
+	// set fractional code phase in full precision and NH position within 20ms
+	STATE_BUF_SET_CODE_PHASE(pStateBuffer, (U32)CodePhase);
+	STATE_BUF_SET_NH_COUNT(pStateBuffer, HalfChip / 20460);
+}
+
 //*************** Synchronize state buffer cache value to HW ****************
 //* according to different cache dirty field, different value will be written
 // Parameters:
@@ -215,7 +290,7 @@ void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect)
 	CompleteData = (ChannelState->PendingCount == 0 && CurrentCor != 0) ? (CohCount == 0 && CurrentCor == 1) : 1;
 
 	SyncCacheRead(ChannelState, SYNC_CACHE_READ_DATA);	// copy coherent result to cache
-	CohBuffer = ChannelState->CohBuffer + ChannelState->FftCount * CORRELATOR_NUM;
+	CohBuffer = CHANNEL_COH_BUFFER(ChannelState) + ChannelState->FftCount * CORRELATOR_NUM;
 	if (CompleteData)
 	{
 		memcpy(ChannelState->PendingCoh + ChannelState->PendingCount, ChannelState->StateBufferCache.CoherentSum + ChannelState->PendingCount, sizeof(U32) * (8 - ChannelState->PendingCount));	// concatinate data
@@ -247,6 +322,8 @@ void ProcessCohSum(int ChannelID, unsigned int OverwriteProtect)
 //   none
 void ProcessCohData(PCHANNEL_STATE ChannelState)
 {
+	int WipeOffFail = 0;
+
 	ChannelState->TrackingTime += ChannelState->CoherentNumber;	// accumulate tracking time
 	DEBUG_OUTPUT(OUTPUT_CONTROL(COH_PROC, NONE), "track time %d\n", ChannelState->TrackingTime);
 	if (ChannelState->SkipCount > 0)	// skip coherent result for following process
@@ -265,8 +342,12 @@ void ProcessCohData(PCHANNEL_STATE ChannelState)
 	if (((ChannelState->State & STAGE_MASK) >= STAGE_TRACK) && (ChannelState->pll_k1 > 0))	// tracking stage uses PLL (change to more flexible condition in the future)
 		CalcDiscriminator(ChannelState, TRACKING_UPDATE_PLL);
 
+	// remove data modulation with predicted navigation bits, skip FFT if prediction not available
+	if ((ChannelState->State & STAGE_MASK) == (STAGE_TRACK + 3))
+		WipeOffFail = !CohBufferWipeOff(ChannelState);
+
 	// do FFT and non-coherent accumulation
-	if (++ChannelState->FftCount == ChannelState->FftNumber)
+	if (!WipeOffFail && ++ChannelState->FftCount == ChannelState->FftNumber)
 	{
 		ChannelState->FftCount = 0;
 		if (ChannelState->FftNumber > 1)
@@ -277,6 +358,10 @@ void ProcessCohData(PCHANNEL_STATE ChannelState)
 			CalcCN0(ChannelState);
 	}
 
+	// apply carrier and code frequency predicted by PVT (or hand over to scalar loops)
+	if (ChannelState->AidUpdate != VECTOR_AIDING_NONE)
+		VectorAidingUpdate(ChannelState);
+
 	// do tracking loop
 	if ((ChannelState->State & STAGE_MASK) >= STAGE_PULL_IN)
 		DoTrackingLoop(ChannelState);
@@ -287,9 +372,12 @@ void ProcessCohData(PCHANNEL_STATE ChannelState)
 	// keep bit edge at tracking hold
 	else if ((ChannelState->State & STAGE_MASK) == STAGE_HOLD3)
 	{
-		ChannelState->DataStream.CurrentAccTime += ChannelState->CoherentNumber;
-		if (ChannelState->DataStream.CurrentAccTime >= ChannelState->DataStream.TotalAccTime)
-			ChannelState->DataStream.CurrentAccTime = 0;
+		CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime += ChannelState->CoherentNumber;
+		if (CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime >= CHANNEL_DATA_STREAM(ChannelState).TotalAccTime)
+		{
+			CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime = 0;
+			CHANNEL_DATA_STREAM(ChannelState).BitCount ++;	// keep symbol index for navigation bit prediction
+		}
 	}
 	// do data decode at tracking stage
 	else if (((ChannelState->State & STAGE_MASK) >= STAGE_TRACK) && ((ChannelState->State & DATA_STREAM_MASK) != 0))
@@ -310,8 +398,9 @@ int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement, U32 *DataBuff
 {
 	PCHANNEL_STATE ChannelState = &ChannelStateArray[ChannelID];
 	PSTATE_BUFFER StateBuffer = &(ChannelState->StateBufferCache);
-	int WordNumber;
+	int WordNumber = 0;
 	int CohCount, CurrentCor;
+	S64 CodeCount;
 
 	SyncCacheRead(ChannelState, SYNC_CACHE_READ_STATUS);
 	memcpy((void *)Measurement, (void *)ChannelState, sizeof(U32) * 3);	// copy first elements of structure
@@ -326,42 +415,64 @@ int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement, U32 *DataBuff
 	if (CurrentCor)
 		CohCount ++;
 	if (FREQ_ID_IS_L1CA(ChannelState->FreqID))	// L1C/A need to add millisecond count within 20ms
-		Measurement->CodeCount += (ChannelState->DataStream.CurrentAccTime + CohCount) * 2046;
+		Measurement->CodeCount += (CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime + CohCount) * 2046;
+	else if (FREQ_ID_IS_L5(ChannelState->FreqID))	// L5 add millisecond count within 20ms NH period
+		Measurement->CodeCount += STATE_BUF_GET_NH_COUNT(StateBuffer) * 20460;
 
 	Measurement->CarrierFreq = STATE_BUF_GET_CARRIER_FREQ(StateBuffer);
 	Measurement->CarrierNCO = STATE_BUF_GET_CARRIER_PHASE(StateBuffer);
 	Measurement->CarrierCount = STATE_BUF_GET_CARRIER_COUNT(StateBuffer);
+	// for vector tracking, add average discriminator output to NCO values so that residual goes into KF
+	if ((ChannelState->State & STATE_VECTOR_AIDED) && ChannelState->VectorDiscCount > 0)
+	{
+		// frequency discriminator has 8192 per FFT bin of 1000/(8*Tc)Hz, convert to carrier frequency control word
+		Measurement->CarrierFreq += (S32)((((S64)ChannelState->VectorFreqAcc << 16) * 1000) / ((S64)ChannelState->VectorDiscCount * ChannelState->CoherentNumber * SAMPLE_FREQ));
+		// delay discriminator has 16384 per correlator interval, local code ahead of signal on positive value
+		CodeCount = ((S64)Measurement->CodeCount << 32) + Measurement->CodeNCO;
+		CodeCount -= ((S64)ChannelState->VectorDelayAcc << (18 - EXTRACT_UINT(StateBuffer->CorrConfig, 10, 2))) / ChannelState->VectorDiscCount;
+		Measurement->CodeCount = (S32)(CodeCount >> 32);
+		Measurement->CodeNCO = (U32)CodeCount;
+	}
+	ChannelState->VectorFreqAcc = ChannelState->VectorDelayAcc = ChannelState->VectorDiscCount = 0;
 	// fill data stream here
-	Measurement->DataNumber = ChannelState->DataStream.DataCount;
-	if ((ChannelState->State & DATA_STREAM_PRN2) && FREQ_ID_IS_B1C_L1C(ChannelState->FreqID))	// B1C/L1C using decoding data channel
-		Measurement->FrameIndex = ChannelState->DataStream.StartIndex;
+	Measurement->DataNumber = CHANNEL_DATA_STREAM(ChannelState).DataCount;
+	Measurement->BitCount = CHANNEL_DATA_STREAM(ChannelState).BitCount;
+	if (ChannelState->State & DATA_STREAM_PRN2)	// B1C/L1C/E1 using decoding data channel
+		Measurement->FrameIndex = CHANNEL_DATA_STREAM(ChannelState).StartIndex;
 	else
 		Measurement->FrameIndex = -1;
 	Measurement->DataStreamAddr = DataBuffer;
 	if ((ChannelState->State & DATA_STREAM_MASK) == DATA_STREAM_1BIT)
 	{
 		WordNumber = (Measurement->DataNumber + 31) / 32;
-		ChannelState->DataStream.DataBuffer[WordNumber-1] <<= ((~Measurement->DataNumber + 1) & 0x1f);	// last word shift to MSB
-		memcpy(Measurement->DataStreamAddr, ChannelState->DataStream.DataBuffer, sizeof(U32) * WordNumber);
+		CHANNEL_DATA_STREAM(ChannelState).DataBuffer[WordNumber-1] <<= ((~Measurement->DataNumber + 1) & 0x1f);	// last word shift to MSB
+		memcpy(Measurement->DataStreamAddr, CHANNEL_DATA_STREAM(ChannelState).DataBuffer, sizeof(U32) * WordNumber);
 	}
 	else if ((ChannelState->State & DATA_STREAM_MASK) == DATA_STREAM_4BIT)
 	{
 		WordNumber = (Measurement->DataNumber + 7) / 8;
-		ChannelState->DataStream.DataBuffer[WordNumber-1] <<= (((~Measurement->DataNumber + 1) & 0x7) * 4);	// last word shift to MSB
-		memcpy(Measurement->DataStreamAddr, ChannelState->DataStream.DataBuffer, sizeof(U32) * WordNumber);
+		CHANNEL_DATA_STREAM(ChannelState).DataBuffer[WordNumber-1] <<= (((~Measurement->DataNumber + 1) & 0x7) * 4);	// last word shift to MSB
+		memcpy(Measurement->DataStreamAddr, CHANNEL_DATA_STREAM(ChannelState).DataBuffer, sizeof(U32) * WordNumber);
+		CHANNEL_DATA_STREAM(ChannelState).ChannelState = ChannelState;
+		if ((ChannelState->State & DATA_STREAM_PRN2) && FREQ_ID_IS_E1(ChannelState->FreqID) && CHANNEL_DATA_STREAM(ChannelState).DataCount > 0)
+			AddToTask(TASK_POSTMEAS, GalDecodeTask, &CHANNEL_DATA_STREAM(ChannelState), sizeof(DATA_STREAM) - 32 + WordNumber);
 	}
 	else if ((ChannelState->State & DATA_STREAM_MASK) == DATA_STREAM_8BIT)
 	{
 		WordNumber = (Measurement->DataNumber + 3) / 4;
-		ChannelState->DataStream.DataBuffer[WordNumber-1] <<= (((~Measurement->DataNumber + 1) & 0x3) * 8);	// last word shift to MSB
-		memcpy(Measurement->DataStreamAddr, ChannelState->DataStream.DataBuffer, sizeof(U32) * WordNumber);
-		ChannelState->DataStream.ChannelState = ChannelState;
-		if ((ChannelState->State & DATA_STREAM_PRN2) && ChannelState->DataStream.DataCount > 0)
-			AddToTask(TASK_POSTMEAS, BdsDecodeTask, &(ChannelState->DataStream), sizeof(DATA_STREAM) - 32 + WordNumber);
+		CHANNEL_DATA_STREAM(ChannelState).DataBuffer[WordNumber-1] <<= (((~Measurement->DataNumber + 1) & 0x3) * 8);	// last word shift to MSB
+		memcpy(Measurement->DataStreamAddr, CHANNEL_DATA_STREAM(ChannelState).DataBuffer, sizeof(U32) * WordNumber);
+		CHANNEL_DATA_STREAM(ChannelState).ChannelState = ChannelState;
+		if ((ChannelState->State & DATA_STREAM_PRN2) && FREQ_ID_IS_L1C(ChannelState->FreqID) && CHANNEL_DATA_STREAM(ChannelState).DataCount > 0)
+			AddToTask(TASK_POSTMEAS, L1cDecodeTask, &CHANNEL_DATA_STREAM(ChannelState), sizeof(DATA_STREAM) - 32 + WordNumber);
+		else if ((ChannelState->State & DATA_STREAM_PRN2) && CHANNEL_DATA_STREAM(ChannelState).DataCount > 0)
+			AddToTask(TASK_POSTMEAS, BdsDecodeTask, &CHANNEL_DATA_STREAM(ChannelState), sizeof(DATA_STREAM) - 32 + WordNumber);
+		else if (CHANNEL_IS_SBAS(ChannelState) && CHANNEL_DATA_STREAM(ChannelState).DataCount > 0)
+			AddToTask(TASK_POSTMEAS, SbasDecodeTask, &CHANNEL_DATA_STREAM(ChannelState), sizeof(DATA_STREAM) - 32 + WordNumber);
 	}
 	if (FREQ_ID_IS_L1CA(ChannelState->FreqID) || (ChannelState->State & DATA_STREAM_PRN2))	// clear DataCount if decoding data channel
-		ChannelState->DataStream.DataCount= 0;
-	ChannelState->DataStream.StartIndex = ChannelState->FrameCounter;
+		CHANNEL_DATA_STREAM(ChannelState).DataCount= 0;
+	CHANNEL_DATA_STREAM(ChannelState).StartIndex = ChannelState->FrameCounter;
 
 	Measurement->CN0 = ChannelState->CN0;
 	Measurement->LockIndicator = 100;
@@ -369,6 +480,64 @@ int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement, U32 *DataBuff
 	return WordNumber;
 }
 
+//*************** Pass carrier and code frequency prediction from PVT to tracking channels ****************
+//* called in task context after PVT process, values will be applied on next coherent interrupt
+// Parameters:
+//   AidingList: predicted Doppler of each logic channel
+//   AidingMask: bit mask of channels with valid prediction
+//   ChannelMask: bit mask of active channels
+// Return value:
+//   none
+void ApplyVectorAiding(PSAT_PREDICT_PARAM AidingList, U32 AidingMask, U32 ChannelMask)
+{
+	int i;
+	PCHANNEL_STATE ChannelState;
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if ((ChannelMask & (1 << i)) == 0)
+			continue;
+		ChannelState = &ChannelStateArray[i];
+		if ((AidingMask & (1 << i)) && AidingList[i].FreqID == ChannelState->FreqID && AidingList[i].Svid == ChannelState->Svid)
+		{
+			ChannelState->AidDoppler = (int)(AidingList[i].Doppler * 256);
+			ChannelState->AidUpdate = VECTOR_AIDING_VALID;
+		}
+		else if (ChannelState->State & STATE_VECTOR_AIDED)
+			ChannelState->AidUpdate = VECTOR_AIDING_DROP;
+	}
+}
+
+//*************** Pass navigation bit prediction from PVT to tracking channels ****************
+//* called in task context after PVT process, prediction will be used on next coherent interrupt
+// Parameters:
+//   PredictList: predicted navigation bits of each logic channel
+//   PredictMask: bit mask of channels with valid prediction
+//   ChannelMask: bit mask of active channels
+// Return value:
+//   none
+void ApplyNavBitPrediction(PNAV_BIT_PREDICT PredictList, U32 PredictMask, U32 ChannelMask)
+{
+	int i;
+	PCHANNEL_STATE ChannelState;
+	PBIT_WIPEOFF BitWipeoff;
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if ((ChannelMask & PredictMask & (1 << i)) == 0)
+			continue;
+		ChannelState = &ChannelStateArray[i];
+		if (PredictList[i].FreqID != ChannelState->FreqID || PredictList[i].Svid != ChannelState->Svid)
+			continue;
+		BitWipeoff = &CHANNEL_BIT_WIPEOFF(ChannelState);
+		// interrupt copies Pending to Current when Update set, so update both with interrupt disabled
+		ENTER_CRITICAL();
+		BitWipeoff->Pending = PredictList[i];
+		BitWipeoff->Update = 1;
+		EXIT_CRITICAL();
+	}
+}
+
 //*************** Put 1ms correlation result in buffer and send 20 results to bit sync task ****************
 //* update carrier frequency and code frequency acccording to dicriminator output
 // Parameters:
@@ -377,7 +546,7 @@ int ComposeMeasurement(int ChannelID, PBB_MEASUREMENT Measurement, U32 *DataBuff
 //   none
 void CollectBitSyncData(PCHANNEL_STATE ChannelState)
 {
-	PBIT_SYNC_DATA BitSyncData = &(ChannelState->BitSyncData);
+	PBIT_SYNC_DATA BitSyncData = &CHANNEL_BIT_SYNC_DATA(ChannelState);
 
 	BitSyncData->CorData[BitSyncData->CorDataCount] = ChannelState->PendingCoh[4];	// copy peak correlator result
 	if (++BitSyncData->CorDataCount == 20)	// 20 correlation result, send to bit sync task
@@ -397,11 +566,12 @@ void CollectBitSyncData(PCHANNEL_STATE ChannelState)
 //   none
 void DecodeDataStream(PCHANNEL_STATE ChannelState)
 {
-	PDATA_STREAM DataStream = &(ChannelState->DataStream);
-	PBIT_SYNC_DATA BitSyncData = &(ChannelState->BitSyncData);
+	PDATA_STREAM DataStream = &CHANNEL_DATA_STREAM(ChannelState);
+	PBIT_SYNC_DATA BitSyncData = &CHANNEL_BIT_SYNC_DATA(ChannelState);
 	int DataSymbol;
 	int CurIndex;
 	int i, SymbolCount;
+	int Amp, SoftSymbol;
 	unsigned int Data;
 
 	ChannelState->FrameCounter ++;
@@ -450,6 +620,7 @@ void DecodeDataStream(PCHANNEL_STATE ChannelState)
 			}
 			DataStream->DataBuffer[CurIndex] |= DataSymbol;
 			DataStream->DataCount ++;
+			DataStream->BitCount ++;
 		}
 	}
 	else	// decode L1C/A or decode pilot channel NH code
@@ -476,11 +647,39 @@ void DecodeDataStream(PCHANNEL_STATE ChannelState)
 			DataStream->PrevImag = DataStream->CurImag;
 		}
 		// put into data stream buffer
-		CurIndex = DataStream->DataCount / 32;
-		DataStream->DataBuffer[CurIndex] <<= 1;
-		DataStream->DataBuffer[CurIndex] |= DataSymbol;
+		if ((ChannelState->State & DATA_STREAM_MASK) == DATA_STREAM_8BIT)	// SBAS soft symbol scaled by smoothed amplitude
+		{
+			if (DataStream->DataCount >= 128)	// buffer full, drop symbol
+			{
+				DataStream->CurrentAccTime = 0;
+				DataStream->CurReal = DataStream->CurImag = 0;
+				return;
+			}
+			Amp = ((DataStream->CurReal < 0) ? -DataStream->CurReal : DataStream->CurReal) + ((DataStream->CurImag < 0) ? -DataStream->CurImag : DataStream->CurImag);
+			if (DataStream->SymbolAmp == 0)
+				DataStream->SymbolAmp = Amp;
+			else
+				DataStream->SymbolAmp += (Amp - DataStream->SymbolAmp) >> 4;
+			if (DataStream->SymbolAmp == 0)
+				DataStream->SymbolAmp = 1;
+			if ((ChannelState->State & STAGE_MASK) == (STAGE_TRACK + 1))	// PLL lock, use in-phase value as soft symbol
+				SoftSymbol = DataStream->CurReal * 32 / DataStream->SymbolAmp;
+			else	// use amplitude with sign of toggle determined symbol
+				SoftSymbol = (DataSymbol ? -Amp : Amp) * 32 / DataStream->SymbolAmp;
+			SoftSymbol = (SoftSymbol > 127) ? 127 : (SoftSymbol < -127) ? -127 : SoftSymbol;	// negative soft symbol for bit 1
+			CurIndex = DataStream->DataCount / 4;
+			DataStream->DataBuffer[CurIndex] <<= 8;
+			DataStream->DataBuffer[CurIndex] |= (SoftSymbol & 0xff);
+		}
+		else
+		{
+			CurIndex = DataStream->DataCount / 32;
+			DataStream->DataBuffer[CurIndex] <<= 1;
+			DataStream->DataBuffer[CurIndex] |= DataSymbol;
+		}
 
 		DataStream->DataCount ++;
+		DataStream->BitCount ++;
 		DataStream->CurrentAccTime = 0;
 		DataStream->CurReal = DataStream->CurImag = 0;
 
@@ -505,7 +704,7 @@ void DecodeDataStream(PCHANNEL_STATE ChannelState)
 //   none
 void CalcCN0(PCHANNEL_STATE ChannelState)
 {
-	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[STAGE_CONFIG_INDEX(ChannelState->State & STAGE_MASK)][ChannelState->FreqID];
+	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[STAGE_CONFIG_INDEX(ChannelState->State & STAGE_MASK)][SIGNAL_CONFIG_INDEX(ChannelState)];
 	int CohRatio = CurTrackingConfig->CoherentNumber * CurTrackingConfig->FftNumber;
 	int NoncohRatio = CurTrackingConfig->NonCohNumber;
 	int NoiseFloor = GetRegValue(ADDR_TE_NOISE_FLOOR);	// NF get from hardware
@@ -516,6 +715,9 @@ void CalcCN0(PCHANNEL_STATE ChannelState)
 
 	// calculate noise power 2(sigma^2) = 4 * (NF^2) / pi
 	NoiseFloor = (NoiseFloor * NoiseFloor * 163) >> 8;
+	// noise floor is measured on L1 input, scale noise power by sample number within 1ms for L5 input
+	if (FREQ_ID_IS_L5(ChannelState->FreqID))
+		NoiseFloor = (int)((S64)NoiseFloor * SAMPLE_FREQ_L5 / SAMPLE_FREQ);
 	// calculate adjusted noise power (2 * sigma^2 * Nc * Nn / 2^Shift)
 	NoiseFloor = (NoiseFloor * CohRatio * NoncohRatio) >> Shift;
 	// remove adjusted noise power from total power
@@ -613,6 +815,8 @@ int BitSyncTask(void *Param)
 	int DotProduct;
 	int ToggleCount, MaxCount = 0, TotalCount = 0;
 	int MaxTogglePos = 0;
+	int IsSbas = CHANNEL_IS_SBAS(BitSyncData->ChannelState);
+	int Period = IsSbas ? 2 : 20;	// SBAS symbol is 2ms, count toggle at each 1ms of 2ms period
 
 	// accumulate toggle at corresponding position
 	for (i = 0; i < 20; i ++)
@@ -621,11 +825,13 @@ int BitSyncTask(void *Param)
 		CurrentImag = (S16)(BitSyncData->CorData[i] & 0xffff);
 		DotProduct = (int)PrevReal * CurrentReal + (int)PrevImag * CurrentImag;	// calculate I1*I2+Q1*Q2
 		if (DotProduct < 0)
-			BitSyncData->ChannelState->ToggleCount[i] ++;
+			CHANNEL_TOGGLE_COUNT(BitSyncData->ChannelState)[i % Period] ++;
 		PrevReal = CurrentReal; PrevImag = CurrentImag;
-
-		// find max toggle count and calculate total count
-		ToggleCount = BitSyncData->ChannelState->ToggleCount[i];
+	}
+	// find max toggle count and calculate total count
+	for (i = 0; i < Period; i ++)
+	{
+		ToggleCount = CHANNEL_TOGGLE_COUNT(BitSyncData->ChannelState)[i];
 		if (MaxCount < ToggleCount)
 		{
 			MaxCount = ToggleCount;
@@ -635,14 +841,14 @@ int BitSyncTask(void *Param)
 	}
 
 	// determine whether bit sync success
-	if (MaxCount >= 5 && MaxCount >= TotalCount / 2)	// at least 5 toggles and max position toggle occupies at least 50%, SUCCESS
+	if (IsSbas ? (MaxCount >= 20 && MaxCount >= TotalCount * 3 / 4) : (MaxCount >= 5 && MaxCount >= TotalCount / 2))	// SBAS: 20 toggles and 75% at one position, GPS: 5 toggles and 50%, SUCCESS
 	{
 		DEBUG_OUTPUT(OUTPUT_CONTROL(COH_PROC, NONE), "Bitsync found at %d with %d/%d\n", MaxTogglePos, MaxCount, TotalCount);
 		MaxTogglePos += BitSyncData->TimeTag;	// toggle position align to time tag
-		MaxTogglePos %= 20;		// remnant of 20ms
-		BitSyncData->ChannelState->BitSyncResult = MaxTogglePos ? MaxTogglePos : 20;	// set result, which means bit toggle when (TrackTime % 20 == BitSyncResult)
+		MaxTogglePos %= Period;		// remnant of symbol period
+		BitSyncData->ChannelState->BitSyncResult = MaxTogglePos ? MaxTogglePos : Period;	// set result, which means bit toggle when (TrackTime % Period == BitSyncResult)
 	}
-	else if (TotalCount > 100)	// 100 toggles and still not success FAIL
+	else if (TotalCount > (IsSbas ? 400 : 100))	// too many toggles and still not success FAIL
 		BitSyncData->ChannelState->BitSyncResult = -1;
 	return 0;
 }
@@ -667,22 +873,24 @@ int DataSyncTask(void *Param)
 	int FreqID = (int)(BitSyncData->ChannelState->FreqID);
 	int Svid = (int)(BitSyncData->ChannelState->Svid);
 
+	// revert data order to LSB first
+	for (i = 0; i < 24; i ++)
+	{
+		DataWord <<= 1;
+		DataWord |= (BitSyncData->CorData[0] & 1) ? 1 : 0;
+		BitSyncData->CorData[0] >>= 1;
+	}
 	if (FREQ_ID_IS_E1(FreqID))
-		;
+	{
+		BitSyncData->ChannelState->BitSyncResult = SyncE1PilotData(DataWord, BitSyncData->TimeTag / 4 - 24);
+		return 0;
+	}
 	else if (FREQ_ID_IS_B1C(FreqID))
 	{
-		// revert data order to LSB first
-		for (i = 0; i < 24; i ++)
-		{
-			DataWord <<= 1;
-			DataWord |= (BitSyncData->CorData[0] & 1) ? 1 : 0;
-			BitSyncData->CorData[0] >>= 1;
-		}
 		BitSyncData->ChannelState->BitSyncResult = SyncPilotData(DataWord, B1CSecondCode[Svid-1], BitSyncData->TimeTag / 10 - 24);
 		return 0;
 	}
-	else if (FREQ_ID_IS_L1C(FreqID))
-		;
+	// L1C pilot overlay code (L1CO) table is not in ConstTable, BitSyncResult kept 0 so L1C stays on pilot channel
 	return 0;
 }
 
@@ -720,3 +928,32 @@ int SyncPilotData(unsigned int DataWord, const unsigned int SecondCode[57], int
 		i += 1800;
 	return Match ? (0x1000 + i) : (0x800 + i);
 }
+
+//*************** find E1 pilot data sync match position ****************
+// Parameters:
+//   DataWord: 24 pilot symbols with first symbol at LSB
+//   StartOffset: first bit from TrackingTime==0
+// Return value:
+//   0 for match position not found
+//   0x800~0x800+24 for match positive
+//   0x1000~0x1000+24 for match negative
+int SyncE1PilotData(unsigned int DataWord, int StartOffset)
+{
+	int i;
+	unsigned int Match;
+
+	for (i = 0; i < 25; i ++)
+	{
+		Match = DataWord ^ (((CS25_CODE >> i) | (CS25_CODE << (25 - i))) & 0xffffff);
+		if (Match == 0 || Match == 0xffffff)
+			break;
+	}
+
+	if (i == 25)
+		return 0;
+	i -= StartOffset;
+	i %= 25;
+	if (i < 0)
+		i += 25;
+	return Match ? (0x1000 + i) : (0x800 + i);
+}
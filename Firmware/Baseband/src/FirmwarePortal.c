@@ -27,6 +27,7 @@
 #define PARAM_OFFSET_GPSALM		1024*4
 #define PARAM_OFFSET_BDSALM		1024*8
 #define PARAM_OFFSET_GALALM		1024*16
+#define PARAM_OFFSET_EPHLAYOUT	1024*23
 #define PARAM_OFFSET_GPSEPH		1024*24
 #define PARAM_OFFSET_BDSEPH		1024*32
 #define PARAM_OFFSET_GALEPH		1024*48
@@ -81,6 +82,7 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 		FREQ_SVID(FREQ_L1CA, 16),
 		FREQ_SVID(FREQ_L1CA, 27),
 		FREQ_SVID(FREQ_L1CA, 30),
+//		FREQ_SVID(FREQ_L1CA, 44),	// SBAS PRN131
 		FREQ_SVID(FREQ_B1C, 8),
 		FREQ_SVID(FREQ_B1C, 19),
 		FREQ_SVID(FREQ_B1C, 21),
@@ -117,12 +119,23 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 	SetRegValue(ADDR_TE_CODE_LENGTH, 0x00ffc000);	// set L1CA code length
 	SetRegValue(ADDR_TE_NOISE_CONFIG, 1);			// set noise smooth factor
 	SetRegValue(ADDR_TE_NOISE_FLOOR, 784 >> PRE_SHIFT_BITS);	// set initial noise floor
+#if defined DUAL_FREQ_L5
+	SetRegValue(ADDR_BB_ENABLE, 0x00000300);		// enable TE with second FIFO
+	SetRegValue(ADDR_FIFO_CLEAR, 0x00000200);		// clear second FIFO
+	SetRegValue(ADDR_TE_FIFO2_CONFIG, 1);			// second FIFO config, enable dummy write
+	SetRegValue(ADDR_TE_FIFO2_BLOCK_SIZE, SAMPLES_1MS_L5);	// second FIFO block size
+	SetRegValue(ADDR_TE_POLYNOMIAL2, 0x063b5b00);	// set L5 polynomial
+	SetRegValue(ADDR_TE_CODE_LENGTH2, 0x09fd9ffe);	// set L5 code length
+#endif
 
 	// initialize firmware modules
 	TaskInitialize();
 	TEInitialize();
 	AEInitialize();
 	BdsDecodeInit();
+	SbasDecodeInit();
+	GalDecodeInit();
+	L1cDecodeInit();
 	MsrProcInit();
 	PvtProcInit((PRECEIVER_INFO)0);
 	if (Start != ColdStart)
@@ -143,6 +156,15 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 		sv_list[i] = 0;
 	}
 	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_USE_KF;
+//	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_VECTOR_TRACKING;	// uncomment to enable KF aided tracking on weak channels
+	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_XCORR_CHECK;
+	g_PvtConfig.XcorrDopplerTh = 10;
+	g_PvtConfig.XcorrCN0Gap = 1000;
+	g_PvtConfig.XcorrConfirmCount = 3;
+	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_COARSE_TIME;
+	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_RAIM;
+	g_PvtConfig.RaimSigma = 5.0;
+	g_PvtConfig.RaimMaxExclude = 2;
 
 	// start acquisition
 	// first task search L1C/A signal
@@ -172,6 +194,7 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 		pAcqConfig->NoncohNumber = 1;
 		pAcqConfig->StrideNumber = (Start == ColdStart) ? 19 : (Start == WarmStart) ? 3 : 1;
 		pAcqConfig->StrideInterval = 500;
+		pAcqConfig->DftNumber = 8;	// 16 bins on 1000Hz stride has larger scalloping loss at bin edge, keep 8 bins
 		if (pAcqConfig->AcqChNumber > 0)
 			AddAcqTask(pAcqConfig);
 	}
@@ -202,6 +225,7 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 		pAcqConfig->NoncohNumber = 2;
 		pAcqConfig->StrideNumber = (Start == ColdStart) ? 19 : (Start == WarmStart) ? 3 : 1;
 		pAcqConfig->StrideInterval = 500;
+		pAcqConfig->DftNumber = 8;	// 16 bins on 1000Hz stride has larger scalloping loss at bin edge, keep 8 bins
 		if (pAcqConfig->AcqChNumber > 0)
 			AddAcqTask(pAcqConfig);
 	}
@@ -209,6 +233,8 @@ void FirmwareInitialize(StartType Start, PSYSTEM_TIME CurTime, LLH *CurPosition)
 
 void LoadAllParameters()
 {
+	unsigned int EphLayout;
+
 	LoadParameters(PARAM_OFFSET_CONFIG, &g_PvtConfig, sizeof(g_PvtConfig));
 	LoadParameters(PARAM_OFFSET_RCVRINFO, &g_ReceiverInfo, sizeof(g_ReceiverInfo));
 	LoadParameters(PARAM_OFFSET_IONOUTC, &g_GpsIonoParam, sizeof(g_GpsIonoParam));
@@ -218,6 +244,9 @@ void LoadAllParameters()
 	LoadParameters(PARAM_OFFSET_GPSALM, &g_GpsAlmanac, sizeof(g_GpsAlmanac));
 	LoadParameters(PARAM_OFFSET_BDSALM, &g_BdsAlmanac, sizeof(g_BdsAlmanac));
 	LoadParameters(PARAM_OFFSET_GALALM, &g_GalileoAlmanac, sizeof(g_GalileoAlmanac));
+	LoadParameters(PARAM_OFFSET_EPHLAYOUT, &EphLayout, sizeof(EphLayout));
+	if (EphLayout != EPH_LAYOUT_TAG)	// ephemeris saved with different structure layout, discard
+		return;
 	LoadParameters(PARAM_OFFSET_GPSEPH, &g_GpsEphemeris, sizeof(g_GpsEphemeris));
 	LoadParameters(PARAM_OFFSET_BDSEPH, &g_BdsEphemeris, sizeof(g_BdsEphemeris));
 	LoadParameters(PARAM_OFFSET_GALEPH, &g_GalileoEphemeris, sizeof(g_GalileoEphemeris));
@@ -225,6 +254,8 @@ void LoadAllParameters()
 
 void SaveAllParameters()
 {
+	unsigned int EphLayout = EPH_LAYOUT_TAG;
+
 	SaveParameters(PARAM_OFFSET_CONFIG, &g_PvtConfig, sizeof(g_PvtConfig));
 	SaveParameters(PARAM_OFFSET_RCVRINFO, &g_ReceiverInfo, sizeof(g_ReceiverInfo));
 	SaveParameters(PARAM_OFFSET_IONOUTC, &g_GpsIonoParam, sizeof(g_GpsIonoParam));
@@ -234,6 +265,7 @@ void SaveAllParameters()
 	SaveParameters(PARAM_OFFSET_GPSALM, &g_GpsAlmanac, sizeof(g_GpsAlmanac));
 	SaveParameters(PARAM_OFFSET_BDSALM, &g_BdsAlmanac, sizeof(g_BdsAlmanac));
 	SaveParameters(PARAM_OFFSET_GALALM, &g_GalileoAlmanac, sizeof(g_GalileoAlmanac));
+	SaveParameters(PARAM_OFFSET_EPHLAYOUT, &EphLayout, sizeof(EphLayout));
 	SaveParameters(PARAM_OFFSET_GPSEPH, &g_GpsEphemeris, sizeof(g_GpsEphemeris));
 	SaveParameters(PARAM_OFFSET_BDSEPH, &g_BdsEphemeris, sizeof(g_BdsEphemeris));
 	SaveParameters(PARAM_OFFSET_GALEPH, &g_GalileoEphemeris, sizeof(g_GalileoEphemeris));
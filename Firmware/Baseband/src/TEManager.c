@@ -10,10 +10,12 @@
 #include "RegAddress.h"
 #include "BBDefines.h"
 #include "HWCtrl.h"
+#include "PlatformCtrl.h"
 #include "FirmwarePortal.h"
 #include "TaskManager.h"
 #include "ChannelManager.h"
 #include "TEManager.h"
+#include "AEManager.h"
 #include "PvtEntry.h"
 #include "ComposeOutput.h"
 
@@ -21,11 +23,18 @@ int MeasurementInterval;
 unsigned int MeasIntCounter;
 unsigned int BasebandTickCount;
 U32 ChannelOccupation;
+U32 ChannelReleaseRequest;	// channels requested to release by PVT, served on coherent interrupt
 BB_MEASUREMENT BasebandMeasurement[TOTAL_CHANNEL_NUMBER];
 U32 DataStreamBuffer[100/4*TOTAL_CHANNEL_NUMBER];		// 100 8bit symbols x 32 channels
 BB_MEAS_PARAM MeasurementParam;
+SAT_PREDICT_PARAM VectorAiding[TOTAL_CHANNEL_NUMBER];	// KF predicted Doppler for vector tracking
+NAV_BIT_PREDICT NavBitPrediction[TOTAL_CHANNEL_NUMBER];	// predicted navigation bits for data wipe-off
+SAT_PREDICT_PARAM AcqAiding[32];	// satellites in view predicted after Doppler positioning
 
 int MeasProcTask(void *Param);
+#if defined DUAL_FREQ_L5
+static void HandOverL5(PBB_MEASUREMENT Measurements, U32 ChannelMask);
+#endif
 
 //*************** Initialize TE manager ****************
 //* this function is called at initialization stage
@@ -39,8 +48,15 @@ void TEInitialize()
 
 	MeasIntCounter = BasebandTickCount = 0;
 	ChannelOccupation = 0;
+	ChannelReleaseRequest = 0;
 	MeasurementParam.RunTimeAcc = 0;
 	memset(ChannelStateArray, 0, sizeof(ChannelStateArray));
+	memset(ChannelCohBuffer, 0, sizeof(ChannelCohBuffer));
+	memset(ChannelNoncohBuffer, 0, sizeof(ChannelNoncohBuffer));
+	memset(ChannelBitSyncData, 0, sizeof(ChannelBitSyncData));
+	memset(ChannelToggleCount, 0, sizeof(ChannelToggleCount));
+	memset(ChannelDataStream, 0, sizeof(ChannelDataStream));
+	memset(ChannelBitWipeoff, 0, sizeof(ChannelBitWipeoff));
 	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
 	{
 		ChannelStateArray[i].LogicChannel = i;
@@ -74,6 +90,11 @@ void UpdateChannels()
 		{
 			if ((ChannelStateArray[i].State & STAGE_MASK) == STAGE_RELEASE)
 				ReleaseChannel(i);
+			else if (ChannelReleaseRequest & ChannelMask)
+			{
+				ChannelReleaseRequest &= ~ChannelMask;
+				ReleaseChannel(i);
+			}
 			else
 				SyncCacheWrite(ChannelStateArray + i);
 		}
@@ -158,9 +179,55 @@ void MeasurementProc()
 	MeasurementParam.MeasInterval = MeasurementInterval;
 	MeasurementParam.Measurements = BasebandMeasurement;
 	AddToTask(TASK_POSTMEAS, MeasProcTask, &MeasurementParam, sizeof(BB_MEAS_PARAM));
+#if defined DUAL_FREQ_L5
+	// start L5 channels using code phase and Doppler of L1C/A channels just latched
+	HandOverL5(BasebandMeasurement, MeasurementParam.MeasMask);
+#endif
 //	printf("MSR %d\n", MeasurementParam.RunTimeAcc);
 }
 
+#if defined DUAL_FREQ_L5
+//*************** Start L5 channel for satellites tracked on L1C/A ****************
+//* L1C/A channel in tracking stage with bit sync has code phase within 20ms,
+//* so L5 channel can start with both code phase and NH position determined
+// Parameters:
+//   Measurements: baseband measurement array arranged by channel
+//   ChannelMask: channels having valid measurement
+// Return value:
+//   none
+void HandOverL5(PBB_MEASUREMENT Measurements, U32 ChannelMask)
+{
+	int i;
+	U32 L5Mask = 0, NewMask = 0;
+	PCHANNEL_STATE NewChannel;
+
+	// satellites already having L5 channel
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+		if ((ChannelOccupation & (1 << i)) && FREQ_ID_IS_L5(ChannelStateArray[i].FreqID))
+			L5Mask |= (1 << (ChannelStateArray[i].Svid - 1));
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if ((ChannelMask & (1 << i)) == 0 || !FREQ_ID_IS_L1CA(Measurements[i].FreqID) || Measurements[i].Svid > 32)
+			continue;
+		if ((Measurements[i].State & STAGE_MASK) < STAGE_TRACK || Measurements[i].CN0 < 3000 || (L5Mask & (1 << (Measurements[i].Svid - 1))))
+			continue;
+		if ((NewChannel = GetAvailableChannel()) == NULL)
+			break;
+		NewChannel->FreqID = FREQ_L5;
+		NewChannel->Svid = Measurements[i].Svid;
+		InitChannel(NewChannel);
+		ConfigL5Channel(NewChannel, &Measurements[i]);
+		SyncCacheWrite(NewChannel);
+		L5Mask |= (1 << (NewChannel->Svid - 1));
+		NewMask |= (1 << NewChannel->LogicChannel);
+		DEBUG_OUTPUT(OUTPUT_CONTROL(TRACKING_SWITCH, INFO), "SV%02d hand over to L5 on channel %d\n", NewChannel->Svid, NewChannel->LogicChannel);
+	}
+	if (NewMask)
+		SetRegValue(ADDR_TE_CHANNEL_ENABLE, GetChannelEnable());
+}
+#endif
+
 //*************** Task to process baseband measurements ****************
 //* This task is added to and called within PostMeasTask queue
 // Parameters:
@@ -172,12 +239,35 @@ int MeasProcTask(void *Param)
 	int OutputBasebandMeas = 0;
 	PBB_MEAS_PARAM MeasParam = (PBB_MEAS_PARAM)Param;
 	PBB_MEASUREMENT Msr = MeasParam->Measurements;
+	U32 AidingMask, PredictMask;
+	int i, ch_num, SatNumber, AcqNumber;
 
 	if (OutputBasebandMeas)
 		AddToTask(TASK_INOUT, MeasPrintTask, Param, sizeof(BB_MEAS_PARAM));
 
 	MsrProc(Msr, MeasParam->MeasMask, MeasParam->MeasInterval, MeasurementInterval);
+	// release channels found tracking cross correlation peak (single write, cleared bit by bit in interrupt)
+	ChannelReleaseRequest = GetXcorrChannelMask();
 	PvtProc(MeasParam->MeasInterval);
+	// acquire satellites in view not yet tracked once coarse position available from Doppler positioning
+	if ((SatNumber = GetAcqAiding(AcqAiding)) > 0)
+	{
+		for (i = 0, AcqNumber = 0; i < SatNumber; i ++)
+		{
+			for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+				if ((MeasParam->MeasMask & (1 << ch_num)) && Msr[ch_num].FreqID == AcqAiding[i].FreqID && Msr[ch_num].Svid == AcqAiding[i].Svid)
+					break;
+			if (ch_num == TOTAL_CHANNEL_NUMBER)
+				AcqAiding[AcqNumber++] = AcqAiding[i];
+		}
+		AddAidedAcqTask(AcqAiding, AcqNumber);
+	}
+	// feed KF prediction back to tracking channels (or hand over to scalar loops if not available)
+	AidingMask = GetVectorAiding(VectorAiding);
+	ApplyVectorAiding(VectorAiding, AidingMask, MeasParam->MeasMask);
+	// predict following navigation bits for data wipe-off
+	PredictMask = GetNavBitPrediction(Msr, MeasParam->MeasMask, NavBitPrediction);
+	ApplyNavBitPrediction(NavBitPrediction, PredictMask, MeasParam->MeasMask);
 
 	return 0;
 }
@@ -7,6 +7,7 @@
 //----------------------------------------------------------------------
 #include <stdio.h>
 #include <string.h>
+#include "HWCtrl.h"
 #include "ChannelManager.h"
 #include "BBCommonFunc.h"
 
@@ -16,6 +17,7 @@ static int Rotate(int x, int y);
 static void SearchPeakCoh(int NoncohBuffer[], PSEARCH_PEAK_RESULT SearchResult);
 static void SearchPeakFft(int NoncohBuffer[], PSEARCH_PEAK_RESULT SearchResult);
 static void GetCoefficients(int BnT16x, int Order, int Coef[3]);
+static void ScaleCoefficients(int Coef[3], PCHANNEL_STATE ChannelState);
 static void AdjustLockIndicator(int *LockIndicator, int Adjustment);
 
 // the table is calculated as Kn*2^33/fs, fs = 4113
@@ -42,6 +44,14 @@ static int FilterCoef31[6][3] = {	// third order coefficients for 0.1 < BnT < 0.
 { 753107, 155634, 13748, }, { 825160, 192934, 19738, }, { 885726, 228271, 26294, },
 };
 
+// search cells of tracking hold, code offset in correlator interval and frequency offset in unit of MAX_BIN_NUM FFT bins
+// cells nearer to the position before lose lock are searched first
+static const int ReacqSearchCell[][2] = {
+	{  0,  0, }, {  7,  0, }, { -7,  0, }, {  0,  1, }, {  0, -1, }, {  7,  1, },
+	{ -7,  1, }, {  7, -1, }, { -7, -1, }, { 14,  0, }, {-14,  0, },
+};
+#define REACQ_CELL_NUMBER (sizeof(ReacqSearchCell) / sizeof(ReacqSearchCell[0]))
+
 //#define POWER(x, y) AmplitudeJPL(x,y)
 #define POWER(x, y) ((x)*(x) + (y)*(y))
 
@@ -64,9 +74,9 @@ void CalcDiscriminator(PCHANNEL_STATE ChannelState, unsigned int Method)
 	if (Method & (TRACKING_UPDATE_FLL | TRACKING_UPDATE_DLL))
 	{
 		if (ChannelState->FftNumber == 1)
-			SearchPeakCoh(ChannelState->NoncohBuffer, &SearchResult);
+			SearchPeakCoh(CHANNEL_NONCOH_BUFFER(ChannelState), &SearchResult);
 		else
-			SearchPeakFft(ChannelState->NoncohBuffer, &SearchResult);
+			SearchPeakFft(CHANNEL_NONCOH_BUFFER(ChannelState), &SearchResult);
 		ChannelState->PeakPower = SearchResult.PeakPower * SearchResult.PeakPower;
 	}
 	if ((Method & TRACKING_UPDATE_FLL) && ChannelState->fll_k1 > 0)
@@ -118,6 +128,13 @@ void CalcDiscriminator(PCHANNEL_STATE ChannelState, unsigned int Method)
 	}
 	if (ChannelState->LoseLockCounter < 0)
 		ChannelState->LoseLockCounter = 0;
+	// accumulate FLL/DLL discriminator output as residual to KF prediction for vector tracking
+	if ((ChannelState->State & STATE_VECTOR_AIDED) && (Method & TRACKING_UPDATE_DLL))
+	{
+		ChannelState->VectorFreqAcc += (Method & TRACKING_UPDATE_FLL) ? ChannelState->FrequencyDiff : 0;
+		ChannelState->VectorDelayAcc += ChannelState->DelayDiff;
+		ChannelState->VectorDiscCount ++;
+	}
 //	if (ChannelState->Svid == 4)
 //		printf("LostCounter=%d\n", ChannelState->LoseLockCounter);
 }
@@ -139,13 +156,13 @@ void CohBufferFft(PCHANNEL_STATE ChannelState)
 		CohReal[i] = CohImag[i] = 0;	// fill rest of FFT input sample with 0
 	// clear noncoherent acc result on first accumulation
 	if (ChannelState->NonCohCount == 0)
-		memset(ChannelState->NoncohBuffer, 0, sizeof(ChannelState->NoncohBuffer));
+		memset(CHANNEL_NONCOH_BUFFER(ChannelState), 0, sizeof(CHANNEL_NONCOH_BUFFER(ChannelState)));
 	// do FFT for all correlators
 	for (i = 0; i < CORRELATOR_NUM; i ++)
 	{
 		for (j = 0; j < ChannelState->FftNumber; j ++)
 		{
-			CohResult = (S32)ChannelState->CohBuffer[j * CORRELATOR_NUM + i];
+			CohResult = (S32)CHANNEL_COH_BUFFER(ChannelState)[j * CORRELATOR_NUM + i];
 			CohReal[j] = (int)(CohResult >> 16);
 			CohImag[j] = (int)((S16)CohResult);
 		}
@@ -167,9 +184,9 @@ void CohBufferFft(PCHANNEL_STATE ChannelState)
 		}*/
 		// accumulate power, move 0 frequency bin in middle
 		for (j = 0; j < MAX_BIN_NUM/2; j ++)
-			ChannelState->NoncohBuffer[i * MAX_BIN_NUM + j] += POWER(FftResultReal[j + MAX_BIN_NUM/2], FftResultImag[j + MAX_BIN_NUM/2]);
+			CHANNEL_NONCOH_BUFFER(ChannelState)[i * MAX_BIN_NUM + j] += POWER(FftResultReal[j + MAX_BIN_NUM/2], FftResultImag[j + MAX_BIN_NUM/2]);
 		for (; j < MAX_BIN_NUM; j ++)
-			ChannelState->NoncohBuffer[i * MAX_BIN_NUM + j] += POWER(FftResultReal[j - MAX_BIN_NUM/2], FftResultImag[j - MAX_BIN_NUM/2]);
+			CHANNEL_NONCOH_BUFFER(ChannelState)[i * MAX_BIN_NUM + j] += POWER(FftResultReal[j - MAX_BIN_NUM/2], FftResultImag[j - MAX_BIN_NUM/2]);
 	}
 	if (++ChannelState->NonCohCount == ChannelState->NonCohNumber)
 	{
@@ -192,13 +209,13 @@ void CohBufferAcc(PCHANNEL_STATE ChannelState)
 	int CohReal, CohImag;
 
 	if (ChannelState->NonCohCount == 0)
-		memset(ChannelState->NoncohBuffer, 0, sizeof(int) * 7);	// clear first 7 value for 7 correlators
+		memset(CHANNEL_NONCOH_BUFFER(ChannelState), 0, sizeof(int) * 7);	// clear first 7 value for 7 correlators
 	for (i = 0; i < CORRELATOR_NUM; i ++)
 	{
-		CohResult = (S32)ChannelState->CohBuffer[i];
+		CohResult = (S32)CHANNEL_COH_BUFFER(ChannelState)[i];
 		CohReal = (int)(CohResult >> 16);
 		CohImag = (int)((S16)CohResult);
-		ChannelState->NoncohBuffer[i] += POWER(CohReal, CohImag);
+		CHANNEL_NONCOH_BUFFER(ChannelState)[i] += POWER(CohReal, CohImag);
 	}
 	if (++ChannelState->NonCohCount == ChannelState->NonCohNumber)
 	{
@@ -207,6 +224,82 @@ void CohBufferAcc(PCHANNEL_STATE ChannelState)
 	}
 }
 
+//*************** Get number of predicted navigation bits from current bit ****************
+//* latest prediction from PVT is taken on call
+// Parameters:
+//   ChannelState: Pointer to channel state structure
+// Return value:
+//   number of predicted bits starting from the bit currently accumulating, 0 if not available
+int GetPredictBitNumber(PCHANNEL_STATE ChannelState)
+{
+	PBIT_WIPEOFF BitWipeoff = &CHANNEL_BIT_WIPEOFF(ChannelState);
+	int BitIndex;
+
+	if (BitWipeoff->Update)
+	{
+		BitWipeoff->Current = BitWipeoff->Pending;
+		BitWipeoff->Update = 0;
+	}
+	if (BitWipeoff->Current.BitNumber == 0 || BitWipeoff->Current.Svid != ChannelState->Svid)
+		return 0;
+	if ((int)(CHANNEL_DATA_STREAM(ChannelState).BitCount - BitWipeoff->HoldOffBit) < 0)	// prediction mismatch detected recently
+		return 0;
+	BitIndex = (int)(CHANNEL_DATA_STREAM(ChannelState).BitCount - BitWipeoff->Current.StartBit);
+	if (BitIndex < 0 || BitIndex >= BitWipeoff->Current.BitNumber)
+		return 0;
+	return BitWipeoff->Current.BitNumber - BitIndex;
+}
+
+//*************** Remove data modulation of latest coherent result ****************
+//* coherent result should cover exactly one data bit, negate I/Q of all correlators
+//* if predicted bit is 1, PendingCoh is not changed for data decode
+//* wiped off prompt result should keep its phase from bit to bit, frequent sign flip means
+//* predicted bits do not match received data, then prediction is dropped and held off for
+//* WIPEOFF_HOLDOFF_BITS so that channel goes back to normal coherent integration
+// Parameters:
+//   ChannelState: Pointer to channel state structure
+// Return value:
+//   1 if data bit wiped off, 0 if predicted bit not available or mismatch detected
+int CohBufferWipeOff(PCHANNEL_STATE ChannelState)
+{
+	PBIT_WIPEOFF BitWipeoff = &CHANNEL_BIT_WIPEOFF(ChannelState);
+	PNAV_BIT_PREDICT Predict = &BitWipeoff->Current;
+	U32 *CohBuffer = CHANNEL_COH_BUFFER(ChannelState) + ChannelState->FftCount * CORRELATOR_NUM;
+	int i, BitIndex;
+	S32 CohResult;
+	int Dot;
+
+	if (GetPredictBitNumber(ChannelState) == 0)
+		return 0;
+	BitIndex = (int)(CHANNEL_DATA_STREAM(ChannelState).BitCount - Predict->StartBit);
+	if (Predict->BitStream[BitIndex >> 5] & (0x80000000 >> (BitIndex & 0x1f)))
+	{
+		for (i = 0; i < CORRELATOR_NUM; i ++)
+		{
+			CohResult = (S32)CohBuffer[i];
+			CohBuffer[i] = ((U32)(-(CohResult >> 16)) << 16) | ((U32)(-(int)((S16)CohResult)) & 0xffff);
+		}
+	}
+
+	// compare phase of wiped off prompt result (Cor4 at CohBuffer[3]) with previous bit
+	if (BitWipeoff->PrevPrompt != 0)
+	{
+		Dot = (S16)(CohBuffer[3] >> 16) * (S16)(BitWipeoff->PrevPrompt >> 16) + (S16)(CohBuffer[3] & 0xffff) * (S16)(BitWipeoff->PrevPrompt & 0xffff);
+		if (Dot < 0)
+			BitWipeoff->MismatchCount += WIPEOFF_MISMATCH_STEP;
+		else if (BitWipeoff->MismatchCount > 0)
+			BitWipeoff->MismatchCount --;
+	}
+	BitWipeoff->PrevPrompt = CohBuffer[3];
+	if (BitWipeoff->MismatchCount >= WIPEOFF_MISMATCH_TH)
+	{
+		Predict->BitNumber = 0;
+		BitWipeoff->HoldOffBit = CHANNEL_DATA_STREAM(ChannelState).BitCount + WIPEOFF_HOLDOFF_BITS;
+		return 0;
+	}
+	return 1;
+}
+
 #define BUTTERFLY(N, real, image, cos_value, sin_value) \
 do { \
     int temp_r, temp_i; \
@@ -407,6 +500,59 @@ void SearchPeakFft(int NoncohBuffer[], PSEARCH_PEAK_RESULT SearchResult)
 	SearchResult->RightBinPower = IntSqrt(SearchResult->RightBinPower);
 }
 
+//*************** Search signal around predicted code phase and Doppler on tracking hold ****************
+//* each noncoherent round covers 7 correlators by 8 FFT bins, if signal found, code phase
+//* and carrier frequency are moved to the peak, otherwise move to next search cell
+//* frequency offset cells are skipped when aided by PVT because carrier frequency follows prediction
+// Parameters:
+//   ChannelState: Pointer to channel state structure
+// Return value:
+//   1 if signal found, 0 if not found
+int ReacqSearch(PCHANNEL_STATE ChannelState)
+{
+	SEARCH_PEAK_RESULT SearchResult;
+	int PrevCell = ChannelState->CodeSearchCount, NextCell;
+	int CodeJump, FreqStep, Found;
+	int BinFreq = (int)((125LL << 32) / ((S64)ChannelState->CoherentNumber * SAMPLE_FREQ));	// 1000/(8*Tc)Hz bin width in carrier frequency control word
+	unsigned int StateValue;
+
+	if (ChannelState->FastCN0 > 2800)	// signal found, move peak to center correlator and center FFT bin
+	{
+		SearchPeakFft(CHANNEL_NONCOH_BUFFER(ChannelState), &SearchResult);
+		CodeJump = -SearchResult.CorDiff;	// positive CorDiff means local code ahead of signal
+		FreqStep = SearchResult.FreqBinDiff * BinFreq;
+		Found = 1;
+	}
+	else	// move to next search cell
+	{
+		NextCell = PrevCell;
+		do
+		{
+			if (++NextCell == REACQ_CELL_NUMBER)
+				NextCell = 0;
+		} while ((ChannelState->State & STATE_VECTOR_AIDED) && ReacqSearchCell[NextCell][1] != 0);
+		CodeJump = ReacqSearchCell[NextCell][0] - ReacqSearchCell[PrevCell][0];
+		FreqStep = (ReacqSearchCell[NextCell][1] - ReacqSearchCell[PrevCell][1]) * BinFreq * MAX_BIN_NUM;
+		ChannelState->CodeSearchCount = NextCell;
+		Found = 0;
+	}
+
+	if (CodeJump)
+	{
+		StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)));
+		StateValue |= (CodeJump & 0xff) << 8;
+		SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
+	}
+	if (FreqStep)
+	{
+		ChannelState->CarrierFreqBase += FreqStep;
+		STATE_BUF_SET_CARRIER_FREQ(&(ChannelState->StateBufferCache), ChannelState->CarrierFreqBase);
+		ChannelState->State |= STATE_CACHE_FREQ_DIRTY;
+	}
+
+	return Found;
+}
+
 //*************** PLL/FLL/DLL loop filter ****************
 //* update carrier frequency and code frequency acccording to dicriminator output
 // Parameters:
@@ -464,6 +610,42 @@ void DoTrackingLoop(PCHANNEL_STATE ChannelState)
 	ChannelState->State &= ~TRACKING_UPDATE;	// clear tracking update flags
 }
 
+//*************** Apply carrier and code frequency predicted by PVT Kalman filter ****************
+//* called on coherent interrupt after PVT task sets AidUpdate
+//* on weak signal or signal lost stage, FLL/DLL base frequency is replaced by predicted value
+//* and scalar loops only track the residual, on PVT degradation or strong signal the loops
+//* continue from current frequency without aiding
+// Parameters:
+//   ChannelState: Pointer to channel state structure
+// Return value:
+//   none
+void VectorAidingUpdate(PCHANNEL_STATE ChannelState)
+{
+	PSTATE_BUFFER StateBuffer = &(ChannelState->StateBufferCache);
+	S64 Frequency;
+
+	if (ChannelState->AidUpdate == VECTOR_AIDING_VALID && STAGE_VECTOR_AIDING(ChannelState->State & STAGE_MASK))
+	{
+		// carrier frequency (IF + Doppler) * 2^32 / fs, Doppler has scale factor of 256
+		Frequency = (FREQ_ID_IS_L1CA(ChannelState->FreqID) || (ChannelState->State & STATE_ENABLE_BOC)) ? IF_FREQ : IF_FREQ_BOC;
+		Frequency = ((Frequency << 8) + ChannelState->AidDoppler) << 24;
+		ChannelState->CarrierFreqBase = (U32)((Frequency + SAMPLE_FREQ / 2) / SAMPLE_FREQ);
+		// code frequency (RF + Doppler) / 770 * 2^32 / fs
+		Frequency = ((((S64)RF_FREQ) << 8) + ChannelState->AidDoppler) << 24;
+		ChannelState->CodeFreqBase = (U32)((Frequency / 770 + SAMPLE_FREQ / 2) / SAMPLE_FREQ);
+		STATE_BUF_SET_CARRIER_FREQ(StateBuffer, ChannelState->CarrierFreqBase);
+		STATE_BUF_SET_CODE_FREQ(StateBuffer, ChannelState->CodeFreqBase);
+		ChannelState->FrequencyAcc = ChannelState->DelayAcc = 0;
+		ChannelState->State |= (STATE_VECTOR_AIDED | STATE_CACHE_FREQ_DIRTY);
+	}
+	else if (ChannelState->State & STATE_VECTOR_AIDED)	// hand over to scalar loops
+	{
+		ChannelState->State &= ~STATE_VECTOR_AIDED;
+		ChannelState->VectorFreqAcc = ChannelState->VectorDelayAcc = ChannelState->VectorDiscCount = 0;
+	}
+	ChannelState->AidUpdate = VECTOR_AIDING_NONE;
+}
+
 //*************** Calculate loop filter coefficients ****************
 // Parameters:
 //   ChannelState: Pointer to channel state structure
@@ -484,6 +666,7 @@ void CalculateLoopCoefficients(PCHANNEL_STATE ChannelState, PTRACKING_CONFIG Cur
 		Order = CurTrackingConfig->BandWidthPLL16x >> 16;
 		BnT = ((CurTrackingConfig->BandWidthPLL16x & 0xffff) * Tc + 5) / 10;	// 16x of 0.01 BnT
 		GetCoefficients(BnT, Order, Coef);
+		ScaleCoefficients(Coef, ChannelState);
 		ChannelState->pll_k1 = (Coef[0] + (Tc << 3)) / (Tc << 4);	// scale 2^29/fs/Tc = (2^33/fs)/(16Tc)
 		ChannelState->pll_k2 = (Coef[1] + (Tc << 1)) / (Tc << 2);	// scale 2^31/fs/Tc = (2^33/fs)/(4Tc)
 		ChannelState->pll_k3 = (Coef[2] + (Tc << 1)) / (Tc << 2);	// scale 2^31/fs/Tc = (2^33/fs)/(4Tc)
@@ -496,6 +679,7 @@ void CalculateLoopCoefficients(PCHANNEL_STATE ChannelState, PTRACKING_CONFIG Cur
 		Order = CurTrackingConfig->BandWidthFLL16x >> 16;
 		BnT = ((CurTrackingConfig->BandWidthFLL16x & 0xffff) * T + 5) / 10;	// 16x of 0.01 BnT
 		GetCoefficients(BnT, Order, Coef);
+		ScaleCoefficients(Coef, ChannelState);
 		ChannelState->fll_k1 = (Coef[0] + (Tc << 3)) / (Tc << 4);	// scale 2^29/fs/Tc = (2^33/fs)/(16Tc)
 		ChannelState->fll_k2 = (Coef[1] + (Tc << 1)) / (Tc << 2);	// scale 2^31/fs/Tc = (2^33/fs)/(4Tc)
 	}
@@ -507,6 +691,7 @@ void CalculateLoopCoefficients(PCHANNEL_STATE ChannelState, PTRACKING_CONFIG Cur
 		Order = CurTrackingConfig->BandWidthDLL16x >> 16;
 		BnT = ((CurTrackingConfig->BandWidthDLL16x & 0xffff) * T + 5) / 10;	// 16x of 0.01 BnT
 		GetCoefficients(BnT, Order, Coef);
+		ScaleCoefficients(Coef, ChannelState);
 		ChannelState->dll_k1 = (Coef[0] + (T >> 1)) / T;	// scale 2^33/fs/T = (2^33/fs)/(T)
 		ChannelState->dll_k2 = (Coef[1] + (T >> 1)) / T;	// scale 2^33/fs/T = (2^33/fs)/(T)
 	}
@@ -586,6 +771,23 @@ void GetCoefficients(int BnT16x, int Order, int Coef[3])
 	}
 }
 
+//*************** Scale loop filter coefficients to sample rate of channel input ****************
+//* coefficient table is calculated with L1 sample rate, L5 input has different sample rate
+// Parameters:
+//   Coef: coefficients got from GetCoefficients()
+//   ChannelState: Pointer to channel state structure
+// Return value:
+//   none
+void ScaleCoefficients(int Coef[3], PCHANNEL_STATE ChannelState)
+{
+	int i;
+
+	if (!FREQ_ID_IS_L5(ChannelState->FreqID))
+		return;
+	for (i = 0; i < 3; i ++)
+		Coef[i] = (int)(((S64)Coef[i] * SAMPLE_FREQ + SAMPLE_FREQ_L5 / 2) / SAMPLE_FREQ_L5);
+}
+
 void AdjustLockIndicator(int *LockIndicator, int Adjustment)
 {
 	Adjustment = ABS(Adjustment);
@@ -31,19 +31,30 @@ static TRACKING_CONFIG TrackingConfigTable[] = {
  {  1,  4,   2,      0,    1,      0,  80|C2,  80|C2,   200,},	// 8 for GAL E1 pull-in
  {  4,  1,   5,      0,    2, 320|C2,   0|C2,  80|C2,  1500,},	// 9 for GAL E1 bit_sync
  {  4,  1,   5,      0,    2, 320|C2,   0|C2,  80|C2,  5000,},	//10 for GAL E1 track 0
+ { 20,  5,   4,      0,    3,   0|C2,  16|C2,   8|C2,    -1,},	//11 for GPS L1 track 3 (data wipe-off)
+ {  1,  5,   2,      0,    2,      0,  80|C2,  80|C2,   200,},	//12 for GPS L5 pull-in
+ {  5,  1,   4,      0,    3, 320|C2,   0|C2,  80|C2,  5000,},	//13 for GPS L5 track 0
+ { 20,  1,   4,      0,    3, 240|C2,   0|C2,  40|C2,    -1,},	//14 for GPS L5 track 1
+ {  1,  2,  10,      0,    1,      0,      0,      0, 30000,},	//15 for SBAS tracking hold
+ {  2,  1,  10,      0,    1, 320|C2,   0|C2,  80|C2,  5000,},	//16 for SBAS track 0
+ {  2,  1,  10,      0,    1, 240|C2,   0|C2,  40|C2,    -1,},	//17 for SBAS track 1
+ {  1,  2,  20,      0,    1,   0|C2,  80|C2,  40|C2,    -1,},	//18 for SBAS track 2
 };
 
-PTRACKING_CONFIG TrackingConfig[][4] = {	// pointer to TrackingConfigTable for different stage and different signal
-	&TrackingConfigTable[2], &TrackingConfigTable[1], &TrackingConfigTable[2], &TrackingConfigTable[2],	// tracking hold
-	&TrackingConfigTable[0], &TrackingConfigTable[8], &TrackingConfigTable[0], &TrackingConfigTable[0],	// pull-in
-	&TrackingConfigTable[1], &TrackingConfigTable[9], &TrackingConfigTable[1], &TrackingConfigTable[1],	// bit_sync
-	&TrackingConfigTable[3], &TrackingConfigTable[10],&TrackingConfigTable[6], &TrackingConfigTable[3],	// track 0
-	&TrackingConfigTable[4], &TrackingConfigTable[4], &TrackingConfigTable[7], &TrackingConfigTable[4],	// track 1
-	&TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[5],	// track 2
+PTRACKING_CONFIG TrackingConfig[][6] = {	// pointer to TrackingConfigTable for different stage and different signal (SBAS at last column)
+	&TrackingConfigTable[2], &TrackingConfigTable[1], &TrackingConfigTable[2], &TrackingConfigTable[2], &TrackingConfigTable[2], &TrackingConfigTable[15],	// tracking hold
+	&TrackingConfigTable[0], &TrackingConfigTable[8], &TrackingConfigTable[0], &TrackingConfigTable[0], &TrackingConfigTable[12],&TrackingConfigTable[0],	// pull-in
+	&TrackingConfigTable[1], &TrackingConfigTable[9], &TrackingConfigTable[1], &TrackingConfigTable[1], &TrackingConfigTable[1], &TrackingConfigTable[1],	// bit_sync
+	&TrackingConfigTable[3], &TrackingConfigTable[10],&TrackingConfigTable[6], &TrackingConfigTable[3], &TrackingConfigTable[13],&TrackingConfigTable[16],	// track 0
+	&TrackingConfigTable[4], &TrackingConfigTable[4], &TrackingConfigTable[7], &TrackingConfigTable[4], &TrackingConfigTable[14],&TrackingConfigTable[17],	// track 1
+	&TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[5], &TrackingConfigTable[18],	// track 2
+	&TrackingConfigTable[11],&TrackingConfigTable[11],&TrackingConfigTable[11],&TrackingConfigTable[11],&TrackingConfigTable[11],&TrackingConfigTable[18],	// track 3
 };
 
 void CalculateLoopCoefficients(PCHANNEL_STATE ChannelState, PTRACKING_CONFIG CurTrackingConfig);
 void SetNHConfig(PCHANNEL_STATE ChannelState, int NHPos, const unsigned int *NHCode);
+int GetPredictBitNumber(PCHANNEL_STATE ChannelState);
+int ReacqSearch(PCHANNEL_STATE ChannelState);
 
 //*************** Switch tracking stage of a tracking channel ****************
 // Parameters:
@@ -53,7 +64,7 @@ void SetNHConfig(PCHANNEL_STATE ChannelState, int NHPos, const unsigned int *NHC
 //   none
 void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage)
 {
-	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[STAGE_CONFIG_INDEX(TrackingStage)][ChannelState->FreqID];
+	PTRACKING_CONFIG CurTrackingConfig = TrackingConfig[STAGE_CONFIG_INDEX(TrackingStage)][SIGNAL_CONFIG_INDEX(ChannelState)];
 	unsigned int PrevStage = (ChannelState->State & STAGE_MASK);
 	int CohCount;
 
@@ -68,14 +79,25 @@ void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage
 //	if (TrackingStage >= STAGE_PULL_IN)
 		CalculateLoopCoefficients(ChannelState, CurTrackingConfig);
 
+	// leaving weak signal stages, hand over to scalar loops
+	if ((ChannelState->State & STATE_VECTOR_AIDED) && !STAGE_VECTOR_AIDING(TrackingStage))
+	{
+		ChannelState->State &= ~STATE_VECTOR_AIDED;
+		ChannelState->VectorFreqAcc = ChannelState->VectorDelayAcc = ChannelState->VectorDiscCount = 0;
+	}
+
 	if (TrackingStage == STAGE_HOLD3)
 	{
 		// restore carrier and code frequency to values before lose lock
-		ChannelState->CarrierFreqBase = ChannelState->CarrierFreqSave;
-		ChannelState->CodeFreqBase = ChannelState->CodeFreqSave;
-		STATE_BUF_SET_CARRIER_FREQ(&(ChannelState->StateBufferCache), ChannelState->CarrierFreqSave);
-		STATE_BUF_SET_CODE_FREQ(&(ChannelState->StateBufferCache), ChannelState->CodeFreqSave);
-		ChannelState->State |= STATE_CACHE_FREQ_DIRTY;
+		// if aided by PVT, keep following predicted frequency instead
+		if (!(ChannelState->State & STATE_VECTOR_AIDED))
+		{
+			ChannelState->CarrierFreqBase = ChannelState->CarrierFreqSave;
+			ChannelState->CodeFreqBase = ChannelState->CodeFreqSave;
+			STATE_BUF_SET_CARRIER_FREQ(&(ChannelState->StateBufferCache), ChannelState->CarrierFreqSave);
+			STATE_BUF_SET_CODE_FREQ(&(ChannelState->StateBufferCache), ChannelState->CodeFreqSave);
+			ChannelState->State |= STATE_CACHE_FREQ_DIRTY;
+		}
 		ChannelState->CodeSearchCount = 0;
 	}
 	else if (TrackingStage == STAGE_PULL_IN)
@@ -84,9 +106,10 @@ void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage
 	else if (TrackingStage == STAGE_TRACK)
 	{
 		// reset data for data decode, switch to tracking stage at epoch of bit edge
-		ChannelState->DataStream.PrevReal = ChannelState->DataStream.PrevImag = ChannelState->DataStream.PrevSymbol = 0;
-		ChannelState->DataStream.CurReal = ChannelState->DataStream.CurImag = 0;
-		ChannelState->DataStream.DataCount = ChannelState->DataStream.CurrentAccTime = 0;
+		CHANNEL_DATA_STREAM(ChannelState).PrevReal = CHANNEL_DATA_STREAM(ChannelState).PrevImag = CHANNEL_DATA_STREAM(ChannelState).PrevSymbol = 0;
+		CHANNEL_DATA_STREAM(ChannelState).CurReal = CHANNEL_DATA_STREAM(ChannelState).CurImag = 0;
+		CHANNEL_DATA_STREAM(ChannelState).DataCount = CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime = 0;
+		CHANNEL_DATA_STREAM(ChannelState).SymbolAmp = 0;
 		if (PrevStage == STAGE_BIT_SYNC)	// switch from bit sync, need to align to bit edge
 		{
 			CohCount = ChannelState->BitSyncResult % CurTrackingConfig->CoherentNumber;
@@ -115,7 +138,7 @@ void SwitchTrackingStage(PCHANNEL_STATE ChannelState, unsigned int TrackingStage
 int StageDetermination(PCHANNEL_STATE ChannelState)
 {
 	int CurStage = ChannelState->State & STAGE_MASK;
-	int Time, Jump;
+	int Time;
 	unsigned int StateValue;
 	int StageChange = 0;
 	PSTATE_BUFFER StateBuffer = &(ChannelState->StateBufferCache);
@@ -152,14 +175,55 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 		// switch to track 1 and set STATE_CACHE_CONFIG_DIRTY
 		SwitchTrackingStage(ChannelState,  STAGE_TRACK + 1);
 		ChannelState->BitSyncResult = 0;
-		ChannelState->DataStream.DataCount = ChannelState->DataStream.CurrentAccTime = 0;	// reset data count for data stream decode
-		ChannelState->DataStream.StartIndex = ChannelState->FrameCounter;
+		CHANNEL_DATA_STREAM(ChannelState).DataCount = CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime = 0;	// reset data count for data stream decode
+		CHANNEL_DATA_STREAM(ChannelState).StartIndex = ChannelState->FrameCounter;
+	}
+	// E1 set pilot channel CS25 after data sync
+	else if (FREQ_ID_IS_E1(ChannelState->FreqID) && (ChannelState->BitSyncResult & 0x1800) && (ChannelState->TrackingTime % 4) == 0)	// data sync finished and at 4ms boundary
+	{
+		// switch to decode E1-B data channel, E1-B is in phase with E1-C so data decoded in I branch
+		STATE_BUF_SET_PRN_CONFIG2(StateBuffer, PRN_CONFIG2_E1(ChannelState->Svid));
+		SetRegValue((U32)(&(ChannelState->StateBufferHW->PrnConfig2)), StateBuffer->PrnConfig2);
+		STATE_BUF_ENABLE_PRN2(StateBuffer);
+		STATE_BUF_ENABLE_BOC(StateBuffer);	// enable BOC
+		STATE_BUF_SET_NARROW_FACTOR(StateBuffer, 2);	// set correlator interval to 1/8 chip
+		// enable HW data decode, 4bit soft symbol so that 5 symbols of 20ms coherent fit in DecodeData
+		STATE_BUF_SET_BIT_LENGTH(StateBuffer, 4);
+		STATE_BUF_SET_DECODE_BIT(StateBuffer, 2);
+		// remove 1.023MHz carrier offset
+		ChannelState->StateBufferCache.CarrierFreq -= DIVIDE_ROUND(1023000LL << 32, SAMPLE_FREQ);
+		ChannelState->CarrierFreqBase -= DIVIDE_ROUND(1023000LL << 32, SAMPLE_FREQ);
+		ChannelState->CarrierFreqSave -= DIVIDE_ROUND(1023000LL << 32, SAMPLE_FREQ);
+		ChannelState->State |= (DATA_STREAM_PRN2 | STATE_ENABLE_BOC | STATE_CACHE_FREQ_DIRTY);
+		Time = ChannelState->BitSyncResult & 0x7ff;
+		// if negative stream, rotate phase by PI
+		if (ChannelState->BitSyncResult & 0x1000)
+		{
+			StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)));
+			StateValue ^= 0x80000000;
+			SetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)), StateValue);
+		}
+		// enable CS25, whole code fits in NH config so no segment update needed
+		Time += ChannelState->TrackingTime / 4;
+		Time %= 25;	// determine secondary code position at current time
+		ChannelState->FrameCounter = Time;
+		STATE_BUF_SET_NH_CONFIG(StateBuffer, 25, CS25_CODE);
+		SetRegValue((U32)(&(ChannelState->StateBufferHW->NHConfig)), StateBuffer->NHConfig);
+		StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)));
+		SET_FIELD(StateValue, 27, 5, Time);
+		SetRegValue((U32)(&(ChannelState->StateBufferHW->CorrState)), StateValue);
+		// switch to track 1 and set STATE_CACHE_CONFIG_DIRTY
+		SwitchTrackingStage(ChannelState,  STAGE_TRACK + 1);
+		ChannelState->BitSyncResult = 0;
+		CHANNEL_DATA_STREAM(ChannelState).DataCount = CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime = 0;	// reset data count for data stream decode
+		CHANNEL_DATA_STREAM(ChannelState).StartIndex = ChannelState->FrameCounter;
 	}
 
 	// lose lock, switch to hold
 	if (CurStage >= STAGE_PULL_IN && ChannelState->LoseLockCounter > 100 && ChannelState->NonCohCount == 0)
 	{
-		SwitchTrackingStage(ChannelState, STAGE_HOLD3);
+		// L5 channel is released and handed over from L1C/A again instead of searching by itself
+		SwitchTrackingStage(ChannelState, FREQ_ID_IS_L5(ChannelState->FreqID) ? STAGE_RELEASE : STAGE_HOLD3);
 		return 1;
 	}
 
@@ -169,27 +233,13 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 	case STAGE_HOLD3:	// holding when signal lost
 		if (ChannelState->FftCount == 0 && ChannelState->NonCohCount == 0)
 		{
-			if (ChannelState->FastCN0 > 2800)	// signal recovered
+			// search code/Doppler window on each noncoherent round
+			if (ReacqSearch(ChannelState))	// signal recovered and centered at peak
 			{
 				SwitchTrackingStage(ChannelState, STAGE_PULL_IN);
 				ChannelState->LoseLockCounter = 0;
 				StageChange = 1;
 			}
-			else	// scan code phases within code search range
-			{
-				if (++ChannelState->CodeSearchCount == 5)
-					Jump = ChannelState->CodeSearchCount / 2;
-				else
-					Jump = ChannelState->CodeSearchCount;
-				if ((ChannelState->CodeSearchCount & 1) == 0)
-					Jump = -Jump;
-				if (ChannelState->CodeSearchCount == 5)
-					ChannelState->CodeSearchCount = 0;
-				Jump *= 7;
-				StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)));
-				StateValue |= (Jump & 0xff) << 8;
-				SetRegValue((U32)(&(ChannelState->StateBufferHW->DumpCount)),  StateValue);
-			}
 		}
 		break;
 	case STAGE_BIT_SYNC:
@@ -199,7 +249,7 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 				SwitchTrackingStage(ChannelState, STAGE_RELEASE);
 			else
 			{
-				ChannelState->BitSyncResult = (ChannelState->TrackingTime- ChannelState->BitSyncResult) % 20;	// ms number passed bit edge
+				ChannelState->BitSyncResult = (ChannelState->TrackingTime- ChannelState->BitSyncResult) % CHANNEL_DATA_STREAM(ChannelState).TotalAccTime;	// ms number passed bit edge (20ms bit or 2ms SBAS symbol)
 				SwitchTrackingStage(ChannelState, STAGE_TRACK);
 			}
 			StageChange = 1;
@@ -218,6 +268,27 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 			SwitchTrackingStage(ChannelState, STAGE_TRACK);
 			StageChange = 1;
 		}
+		// at bit edge with navigation bits predicted for at least one FFT round, switch to track 3
+		else if (FREQ_ID_IS_L1CA(ChannelState->FreqID) && !CHANNEL_IS_SBAS(ChannelState) && CHANNEL_DATA_STREAM(ChannelState).CurrentAccTime == 0 && GetPredictBitNumber(ChannelState) >= 5)
+		{
+			// restart mismatch detection
+			CHANNEL_BIT_WIPEOFF(ChannelState).PrevPrompt = 0;
+			CHANNEL_BIT_WIPEOFF(ChannelState).MismatchCount = 0;
+			SwitchTrackingStage(ChannelState, STAGE_TRACK + 3);
+			StageChange = 1;
+		}
+		break;
+	case STAGE_TRACK + 3:
+		if (ChannelState->CN0HighCount > 500)	// CN0 high, switch to track 0
+		{
+			SwitchTrackingStage(ChannelState, STAGE_TRACK);
+			StageChange = 1;
+		}
+		else if (GetPredictBitNumber(ChannelState) == 0)	// prediction used up or mismatch, back to track 2
+		{
+			SwitchTrackingStage(ChannelState, STAGE_TRACK + 2);
+			StageChange = 1;
+		}
 		break;
 	}
 
@@ -235,12 +306,12 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 		break;
 	case STAGE_PULL_IN:
 		// reset data for bit/frame sync
-		ChannelState->BitSyncData.CorDataCount = 0;
-		ChannelState->BitSyncData.ChannelState = ChannelState;
-		ChannelState->BitSyncData.PrevCorData = 0;	// clear previous correlation result for first round
-		memset(ChannelState->ToggleCount, 0, sizeof(ChannelState->ToggleCount));
+		CHANNEL_BIT_SYNC_DATA(ChannelState).CorDataCount = 0;
+		CHANNEL_BIT_SYNC_DATA(ChannelState).ChannelState = ChannelState;
+		CHANNEL_BIT_SYNC_DATA(ChannelState).PrevCorData = 0;	// clear previous correlation result for first round
+		memset(CHANNEL_TOGGLE_COUNT(ChannelState), 0, sizeof(CHANNEL_TOGGLE_COUNT(ChannelState)));
 		ChannelState->BitSyncResult = 0;
-		if (FREQ_ID_IS_L1CA(ChannelState->FreqID))	// L1C/A need to do bit sync
+		if (FREQ_ID_IS_L1CA(ChannelState->FreqID))	// L1C/A need to do bit sync (SBAS sync to 2ms symbol)
 			SwitchTrackingStage(ChannelState, STAGE_BIT_SYNC);
 		else	// other signal switch to track 0
 			SwitchTrackingStage(ChannelState, STAGE_TRACK);
@@ -251,7 +322,7 @@ int StageDetermination(PCHANNEL_STATE ChannelState)
 			SwitchTrackingStage(ChannelState,  STAGE_TRACK + 1);
 			// if previous decoded acc data sign and symbol not consistent, rotate phase by PI
 			// in track 1 stage, will use acc data to determine symbol
-			if (((ChannelState->DataStream.PrevReal >> 31) & 1) ^ ChannelState->DataStream.PrevSymbol)
+			if (((CHANNEL_DATA_STREAM(ChannelState).PrevReal >> 31) & 1) ^ CHANNEL_DATA_STREAM(ChannelState).PrevSymbol)
 			{
 				StateValue = GetRegValue((U32)(&(ChannelState->StateBufferHW->CarrierPhase)));
 				StateValue ^= 0x80000000;
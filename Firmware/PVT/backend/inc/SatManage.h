@@ -13,6 +13,7 @@
 #include "DataTypes.h"
 
 void CalcSatelliteInfo(PCHANNEL_STATUS ObservationList[], int ObsCount);
+void LoadEpochGeometry(PEPOCH_GEOMETRY Geometry, PCHANNEL_STATUS ObservationList[], int ObsCount);
 int FilterObservation(PCHANNEL_STATUS ObservationList[], int ObsCount);
 void ApplyCorrection(PCHANNEL_STATUS ObservationList[], int ObsCount);
 
@@ -16,6 +16,12 @@
 static void LDLTDecompose(double *L, int dim);
 static void InvL(double *L, double *Inv, int dim);
 static void LTDLMultiply(double *L, double *Inv, int dim);
+static void SymMatrixInv4(double *SymMat);
+static void SymMatrixInv5(double *SymMat);
+static void SymMatrixInv6(double *SymMat);
+static void SymMatrixMultiply4(double *DeltaPos, double *Inv, double *Delta);
+static void SymMatrixMultiply5(double *DeltaPos, double *Inv, double *Delta);
+static void SymMatrixMultiply6(double *DeltaPos, double *Inv, double *Delta);
 
 //*************** Calculate column vector of Delta=Ht*W*MsrDelta ****************
 //* in which Ht is transpose of H matrix, W=Inv(R) is the weight matrix
@@ -29,33 +35,33 @@ static void LTDLMultiply(double *L, double *Inv, int dim);
 //   none
 void ComposeDelta(double *Delta, PHMATRIX H, double *MsrDelta, int dim)
 {
-	double *p1, *p2, *p3;
-	int i, j, SizeX = 0;
-
-	for(i=0; i< dim; i++)
-		SizeX += H->length[i];
-
-	if(H->Is2D)
-		SizeX += 1;
+	int i, j, k = 0;
+	double DeltaX = 0, DeltaY = 0, DeltaZ = 0, DeltaT;
 
 	// calculate transpose of H multiply MsrDelta (either Psr or Doppler)
-	for (i = 0; i < 3; i ++)
+	// all elements accumulated within one pass of observations
+	for (i = 0; i < dim; i ++)
 	{
-		Delta[i] = 0;
-		p1 = MsrDelta;
-		p2 = H->data[i];
-		p3 = H->weight;
-		for (j = SizeX; j > 0; j --)
-			Delta[i] += (*p1 ++) * (*p2 ++) * (*p3 ++);
+		DeltaT = 0;
+		for (j = H->length[i]; j > 0; j --, k ++)
+		{
+			DeltaX += MsrDelta[k] * H->data[0][k] * H->weight[k];
+			DeltaY += MsrDelta[k] * H->data[1][k] * H->weight[k];
+			DeltaZ += MsrDelta[k] * H->data[2][k] * H->weight[k];
+			DeltaT += MsrDelta[k] * H->weight[k];
+		}
+		Delta[i + 3] = DeltaT;
 	}
-	p1 = MsrDelta;
-	p3 = H->weight;
-	for (i = 0; i < dim; i ++)
+	// extra equation of 2D positioning does not have clock error
+	if (H->Is2D)
 	{
-		Delta[i + 3] = 0;
-		for (j = H->length[i]; j > 0; j --)
-			Delta[i + 3] += (*p1 ++) * (*p3 ++);
+		DeltaX += MsrDelta[k] * H->data[0][k] * H->weight[k];
+		DeltaY += MsrDelta[k] * H->data[1][k] * H->weight[k];
+		DeltaZ += MsrDelta[k] * H->data[2][k] * H->weight[k];
 	}
+	Delta[0] = DeltaX;
+	Delta[1] = DeltaY;
+	Delta[2] = DeltaZ;
 }
 
 //*************** Calculate product of Ht and H ****************
@@ -77,6 +83,7 @@ void ComposeDelta(double *Delta, PHMATRIX H, double *MsrDelta, int dim)
 //* the total length is 10 or 15 or 21 depend on dimension
 //* If InvP is not NULL, InvP is added to HtH
 //* In weighted LSQ, this function computes the Ht*W*H
+//* weight is applied while all elements are accumulated within one pass of observations
 // Parameters:
 //   H: pointer to H matrix
 //   InvP: pointer to InvP matrix
@@ -86,53 +93,72 @@ void ComposeDelta(double *Delta, PHMATRIX H, double *MsrDelta, int dim)
 //   none
 void GetHtH(PHMATRIX H, double *InvP, double *HtH, int dim)
 {
-	double *p1, *p2, *p3, *result = HtH, *pa = InvP;
-	int i, j, k;
-	int SizeX = 0, AddrOffset;
+	double *Row;
+	double hx, hy, hz, w;
+	double Hxx, Hxy, Hyy, Hxz, Hyz, Hzz;	// 3x3 part of x/y/z
+	double Htx, Hty, Htz, Htt;	// clock error row of one system
+	int i, j, k = 0;
 
-	for(i=0; i < dim; i ++)
-		SizeX += H->length[i];
+	// initial value is InvP or zero (diagonal of clock error is a small value to avoid singular)
+	if (InvP)
+		memcpy(HtH, InvP, sizeof(double) * SUM_N(dim + 3));
+	else
+	{
+		memset(HtH, 0, sizeof(double) * SUM_N(dim + 3));
+		for (i = 0; i < dim; i ++)
+			HtH[DIAG_INDEX(i + 3)] = 1e-11;
+	}
 
-	//if 2D positioning
-	if (H->Is2D)
-		SizeX ++;
-	
-	for (i = 0; i < 3; i ++)
+	Hxx = HtH[0];
+	Hxy = HtH[1];
+	Hyy = HtH[2];
+	Hxz = HtH[3];
+	Hyz = HtH[4];
+	Hzz = HtH[5];
+	for (i = 0; i <= dim; i ++)
 	{
-		for (j = 0; j <= i; j ++)
+		// last loop for extra equation of 2D positioning which does not have clock error
+		if (i == dim && !H->Is2D)
+			break;
+		if (i < dim)
 		{
-			p1 = H->data[i];
-			p2 = H->data[j];
-			p3 = H->weight;
-			*result = InvP ? (*pa ++) : 0;
-			for (k = SizeX; k > 0; k --)
-				*result += (*p1 ++) * (*p2 ++) * (*p3 ++);
-			result ++;
+			Row = HtH + SUM_N(i + 3);
+			Htx = Row[0];
+			Hty = Row[1];
+			Htz = Row[2];
+			Htt = Row[i + 3];
 		}
-	}
-	
-	AddrOffset = 0;
-	for (i = 0; i < dim; i ++)
-	{
-		for (j = 0; j < 3; j ++)
+		for (j = (i < dim) ? H->length[i] : 1; j > 0; j --, k ++)
+		{
+			hx = H->data[0][k];
+			hy = H->data[1][k];
+			hz = H->data[2][k];
+			w = H->weight[k];
+			Hxx += hx * hx * w;
+			Hxy += hy * hx * w;
+			Hyy += hy * hy * w;
+			Hxz += hz * hx * w;
+			Hyz += hz * hy * w;
+			Hzz += hz * hz * w;
+			Htx += hx * w;
+			Hty += hy * w;
+			Htz += hz * w;
+			Htt += w;
+		}
+		if (i < dim)
 		{
-			*result = InvP ? (*pa ++) : 0;
-			p2 = H->data[j] + AddrOffset;
-			p3 = H->weight + AddrOffset;
-			for (k = H->length[i]; k > 0; k --)
-				*result += (*p2 ++) * (*p3 ++);
-			result ++;
+			Row[0] = Htx;
+			Row[1] = Hty;
+			Row[2] = Htz;
+			Row[i + 3] = Htt;
 		}
-		for (j = i; j > 0; j --)
-			*result ++ = InvP ? (*pa ++) : 0;
-	
-		*result = InvP ? (*pa ++) : 1e-11;
-		p3 = H->weight + AddrOffset;
-		for (k = H->length[i]; k > 0; k --)
-			*result += (*p3 ++);
-		result ++;
-		AddrOffset += H->length[i];
 	}
+	HtH[0] = Hxx;
+	HtH[1] = Hxy;
+	HtH[2] = Hyy;
+	HtH[3] = Hxz;
+	HtH[4] = Hyz;
+	HtH[5] = Hzz;
 }
 
 //*************** Calculate inversion of a symmetrical matrix ****************
@@ -146,9 +172,27 @@ void GetHtH(PHMATRIX H, double *InvP, double *HtH, int dim)
 //   none
 void SymMatrixInv(double *SymMat, double *WorkSpace, int dim)
 {
-	LDLTDecompose(SymMat, dim);				// in place calculate matrix L
-	InvL(SymMat, WorkSpace, dim);			// matrix Inv(L) in TempVector
-	LTDLMultiply(WorkSpace, SymMat, dim);	// put Inv(HtH) back to SymMat
+	// use unrolled kernels for dimensions used in LSQ, generic loops for others
+	// callers and dimensions (KF does scalar sequential update so never inverts a matrix in firmware):
+	//   PvtDopplerLsq: 4, PvtFlexibleTime: 5, LSQResolve for position and velocity: 4~6 (3+number of systems)
+	//   RTS smoother in PostProc: STATE_VECTOR_SIZE, host only and done once per epoch, uses generic loops
+	switch (dim)
+	{
+	case 4:
+		SymMatrixInv4(SymMat);
+		break;
+	case 5:
+		SymMatrixInv5(SymMat);
+		break;
+	case 6:
+		SymMatrixInv6(SymMat);
+		break;
+	default:
+		LDLTDecompose(SymMat, dim);				// in place calculate matrix L
+		InvL(SymMat, WorkSpace, dim);			// matrix Inv(L) in TempVector
+		LTDLMultiply(WorkSpace, SymMat, dim);	// put Inv(HtH) back to SymMat
+		break;
+	}
 }
 
 //*************** Do Cholesky decomposition of a symmetrical matrix ****************
@@ -313,6 +357,20 @@ void SymMatrixMultiply(double *DeltaPos, double *Inv, double *Delta, int dim)
 	int i, j;
 	double *p1, *p2;
 
+	// use unrolled kernels for dimensions used in LSQ, generic loops for others (see callers in SymMatrixInv())
+	switch (dim)
+	{
+	case 4:
+		SymMatrixMultiply4(DeltaPos, Inv, Delta);
+		return;
+	case 5:
+		SymMatrixMultiply5(DeltaPos, Inv, Delta);
+		return;
+	case 6:
+		SymMatrixMultiply6(DeltaPos, Inv, Delta);
+		return;
+	}
+
 	for (i = 0; i < dim; i ++)
 	{
 		DeltaPos[i] = 0;
@@ -328,3 +386,265 @@ void SymMatrixMultiply(double *DeltaPos, double *Inv, double *Delta, int dim)
 		}
 	}
 }
+
+//*************** Calculate inversion of a 4x4 symmetrical matrix ****************
+//* unrolled from LDLTDecompose, InvL and LTDLMultiply with the same operation order
+// Parameters:
+//   SymMat: pointer to symmetrical matrix
+// Return value:
+//   none
+void SymMatrixInv4(double *SymMat)
+{
+	double L[10], Inv[10], f[6];
+
+	memcpy(L, SymMat, sizeof(L));
+
+	// LDLTDecompose
+	L[2] = L[2] - L[1] * L[1] / L[0];
+	L[4] = L[4] - L[3] * L[1] / L[0];
+	L[5] = L[5] - L[3] * L[3] / L[0] - L[4] * L[4] / L[2];
+	L[7] = L[7] - L[6] * L[1] / L[0];
+	L[8] = L[8] - L[6] * L[3] / L[0] - L[7] * L[4] / L[2];
+	L[9] = L[9] - L[6] * L[6] / L[0] - L[7] * L[7] / L[2] - L[8] * L[8] / L[5];
+
+	// InvL, use Inv[DIAG] to hold reciprocal of diagonal first
+	Inv[0] = 1 / L[0];
+	Inv[2] = 1 / L[2];
+	Inv[1] = (-Inv[0] * L[1]) * Inv[2];
+	Inv[5] = 1 / L[5];
+	Inv[4] = (-Inv[2] * L[4]) * Inv[5];
+	Inv[3] = (-Inv[1] * L[4] - Inv[0] * L[3]) * Inv[5];
+	Inv[9] = 1 / L[9];
+	Inv[8] = (-Inv[5] * L[8]) * Inv[9];
+	Inv[7] = (-Inv[4] * L[8] - Inv[2] * L[7]) * Inv[9];
+	Inv[6] = (-Inv[3] * L[8] - Inv[1] * L[7] - Inv[0] * L[6]) * Inv[9];
+
+	// LTDLMultiply, f holds factor L(i+1,j)/L(i+1,i+1) of InvL
+	f[0] = Inv[8] / Inv[9];
+	f[1] = Inv[7] / Inv[9];
+	f[2] = Inv[6] / Inv[9];
+	f[3] = Inv[4] / Inv[5];
+	f[4] = Inv[3] / Inv[5];
+	f[5] = Inv[1] / Inv[2];
+	SymMat[0] = Inv[0] + Inv[6] * f[2] + Inv[3] * f[4] + Inv[1] * f[5];
+	SymMat[1] = Inv[1] + Inv[6] * f[1] + Inv[3] * f[3];
+	SymMat[2] = Inv[2] + Inv[7] * f[1] + Inv[4] * f[3];
+	SymMat[3] = Inv[3] + Inv[6] * f[0];
+	SymMat[4] = Inv[4] + Inv[7] * f[0];
+	SymMat[5] = Inv[5] + Inv[8] * f[0];
+	SymMat[6] = Inv[6];
+	SymMat[7] = Inv[7];
+	SymMat[8] = Inv[8];
+	SymMat[9] = Inv[9];
+}
+
+//*************** Calculate inversion of a 5x5 symmetrical matrix ****************
+//* unrolled from LDLTDecompose, InvL and LTDLMultiply with the same operation order
+// Parameters:
+//   SymMat: pointer to symmetrical matrix
+// Return value:
+//   none
+void SymMatrixInv5(double *SymMat)
+{
+	double L[15], Inv[15], f[10];
+
+	memcpy(L, SymMat, sizeof(L));
+
+	// LDLTDecompose
+	L[2] = L[2] - L[1] * L[1] / L[0];
+	L[4] = L[4] - L[3] * L[1] / L[0];
+	L[5] = L[5] - L[3] * L[3] / L[0] - L[4] * L[4] / L[2];
+	L[7] = L[7] - L[6] * L[1] / L[0];
+	L[8] = L[8] - L[6] * L[3] / L[0] - L[7] * L[4] / L[2];
+	L[9] = L[9] - L[6] * L[6] / L[0] - L[7] * L[7] / L[2] - L[8] * L[8] / L[5];
+	L[11] = L[11] - L[10] * L[1] / L[0];
+	L[12] = L[12] - L[10] * L[3] / L[0] - L[11] * L[4] / L[2];
+	L[13] = L[13] - L[10] * L[6] / L[0] - L[11] * L[7] / L[2] - L[12] * L[8] / L[5];
+	L[14] = L[14] - L[10] * L[10] / L[0] - L[11] * L[11] / L[2] - L[12] * L[12] / L[5] - L[13] * L[13] / L[9];
+
+	// InvL, use Inv[DIAG] to hold reciprocal of diagonal first
+	Inv[0] = 1 / L[0];
+	Inv[2] = 1 / L[2];
+	Inv[1] = (-Inv[0] * L[1]) * Inv[2];
+	Inv[5] = 1 / L[5];
+	Inv[4] = (-Inv[2] * L[4]) * Inv[5];
+	Inv[3] = (-Inv[1] * L[4] - Inv[0] * L[3]) * Inv[5];
+	Inv[9] = 1 / L[9];
+	Inv[8] = (-Inv[5] * L[8]) * Inv[9];
+	Inv[7] = (-Inv[4] * L[8] - Inv[2] * L[7]) * Inv[9];
+	Inv[6] = (-Inv[3] * L[8] - Inv[1] * L[7] - Inv[0] * L[6]) * Inv[9];
+	Inv[14] = 1 / L[14];
+	Inv[13] = (-Inv[9] * L[13]) * Inv[14];
+	Inv[12] = (-Inv[8] * L[13] - Inv[5] * L[12]) * Inv[14];
+	Inv[11] = (-Inv[7] * L[13] - Inv[4] * L[12] - Inv[2] * L[11]) * Inv[14];
+	Inv[10] = (-Inv[6] * L[13] - Inv[3] * L[12] - Inv[1] * L[11] - Inv[0] * L[10]) * Inv[14];
+
+	// LTDLMultiply, f holds factor L(i+1,j)/L(i+1,i+1) of InvL
+	f[0] = Inv[13] / Inv[14];
+	f[1] = Inv[12] / Inv[14];
+	f[2] = Inv[11] / Inv[14];
+	f[3] = Inv[10] / Inv[14];
+	f[4] = Inv[8] / Inv[9];
+	f[5] = Inv[7] / Inv[9];
+	f[6] = Inv[6] / Inv[9];
+	f[7] = Inv[4] / Inv[5];
+	f[8] = Inv[3] / Inv[5];
+	f[9] = Inv[1] / Inv[2];
+	SymMat[0] = Inv[0] + Inv[10] * f[3] + Inv[6] * f[6] + Inv[3] * f[8] + Inv[1] * f[9];
+	SymMat[1] = Inv[1] + Inv[10] * f[2] + Inv[6] * f[5] + Inv[3] * f[7];
+	SymMat[2] = Inv[2] + Inv[11] * f[2] + Inv[7] * f[5] + Inv[4] * f[7];
+	SymMat[3] = Inv[3] + Inv[10] * f[1] + Inv[6] * f[4];
+	SymMat[4] = Inv[4] + Inv[11] * f[1] + Inv[7] * f[4];
+	SymMat[5] = Inv[5] + Inv[12] * f[1] + Inv[8] * f[4];
+	SymMat[6] = Inv[6] + Inv[10] * f[0];
+	SymMat[7] = Inv[7] + Inv[11] * f[0];
+	SymMat[8] = Inv[8] + Inv[12] * f[0];
+	SymMat[9] = Inv[9] + Inv[13] * f[0];
+	SymMat[10] = Inv[10];
+	SymMat[11] = Inv[11];
+	SymMat[12] = Inv[12];
+	SymMat[13] = Inv[13];
+	SymMat[14] = Inv[14];
+}
+
+//*************** Calculate inversion of a 6x6 symmetrical matrix ****************
+//* unrolled from LDLTDecompose, InvL and LTDLMultiply with the same operation order
+// Parameters:
+//   SymMat: pointer to symmetrical matrix
+// Return value:
+//   none
+void SymMatrixInv6(double *SymMat)
+{
+	double L[21], Inv[21], f[15];
+
+	memcpy(L, SymMat, sizeof(L));
+
+	// LDLTDecompose
+	L[2] = L[2] - L[1] * L[1] / L[0];
+	L[4] = L[4] - L[3] * L[1] / L[0];
+	L[5] = L[5] - L[3] * L[3] / L[0] - L[4] * L[4] / L[2];
+	L[7] = L[7] - L[6] * L[1] / L[0];
+	L[8] = L[8] - L[6] * L[3] / L[0] - L[7] * L[4] / L[2];
+	L[9] = L[9] - L[6] * L[6] / L[0] - L[7] * L[7] / L[2] - L[8] * L[8] / L[5];
+	L[11] = L[11] - L[10] * L[1] / L[0];
+	L[12] = L[12] - L[10] * L[3] / L[0] - L[11] * L[4] / L[2];
+	L[13] = L[13] - L[10] * L[6] / L[0] - L[11] * L[7] / L[2] - L[12] * L[8] / L[5];
+	L[14] = L[14] - L[10] * L[10] / L[0] - L[11] * L[11] / L[2] - L[12] * L[12] / L[5] - L[13] * L[13] / L[9];
+	L[16] = L[16] - L[15] * L[1] / L[0];
+	L[17] = L[17] - L[15] * L[3] / L[0] - L[16] * L[4] / L[2];
+	L[18] = L[18] - L[15] * L[6] / L[0] - L[16] * L[7] / L[2] - L[17] * L[8] / L[5];
+	L[19] = L[19] - L[15] * L[10] / L[0] - L[16] * L[11] / L[2] - L[17] * L[12] / L[5] - L[18] * L[13] / L[9];
+	L[20] = L[20] - L[15] * L[15] / L[0] - L[16] * L[16] / L[2] - L[17] * L[17] / L[5] - L[18] * L[18] / L[9] - L[19] * L[19] / L[14];
+
+	// InvL, use Inv[DIAG] to hold reciprocal of diagonal first
+	Inv[0] = 1 / L[0];
+	Inv[2] = 1 / L[2];
+	Inv[1] = (-Inv[0] * L[1]) * Inv[2];
+	Inv[5] = 1 / L[5];
+	Inv[4] = (-Inv[2] * L[4]) * Inv[5];
+	Inv[3] = (-Inv[1] * L[4] - Inv[0] * L[3]) * Inv[5];
+	Inv[9] = 1 / L[9];
+	Inv[8] = (-Inv[5] * L[8]) * Inv[9];
+	Inv[7] = (-Inv[4] * L[8] - Inv[2] * L[7]) * Inv[9];
+	Inv[6] = (-Inv[3] * L[8] - Inv[1] * L[7] - Inv[0] * L[6]) * Inv[9];
+	Inv[14] = 1 / L[14];
+	Inv[13] = (-Inv[9] * L[13]) * Inv[14];
+	Inv[12] = (-Inv[8] * L[13] - Inv[5] * L[12]) * Inv[14];
+	Inv[11] = (-Inv[7] * L[13] - Inv[4] * L[12] - Inv[2] * L[11]) * Inv[14];
+	Inv[10] = (-Inv[6] * L[13] - Inv[3] * L[12] - Inv[1] * L[11] - Inv[0] * L[10]) * Inv[14];
+	Inv[20] = 1 / L[20];
+	Inv[19] = (-Inv[14] * L[19]) * Inv[20];
+	Inv[18] = (-Inv[13] * L[19] - Inv[9] * L[18]) * Inv[20];
+	Inv[17] = (-Inv[12] * L[19] - Inv[8] * L[18] - Inv[5] * L[17]) * Inv[20];
+	Inv[16] = (-Inv[11] * L[19] - Inv[7] * L[18] - Inv[4] * L[17] - Inv[2] * L[16]) * Inv[20];
+	Inv[15] = (-Inv[10] * L[19] - Inv[6] * L[18] - Inv[3] * L[17] - Inv[1] * L[16] - Inv[0] * L[15]) * Inv[20];
+
+	// LTDLMultiply, f holds factor L(i+1,j)/L(i+1,i+1) of InvL
+	f[0] = Inv[19] / Inv[20];
+	f[1] = Inv[18] / Inv[20];
+	f[2] = Inv[17] / Inv[20];
+	f[3] = Inv[16] / Inv[20];
+	f[4] = Inv[15] / Inv[20];
+	f[5] = Inv[13] / Inv[14];
+	f[6] = Inv[12] / Inv[14];
+	f[7] = Inv[11] / Inv[14];
+	f[8] = Inv[10] / Inv[14];
+	f[9] = Inv[8] / Inv[9];
+	f[10] = Inv[7] / Inv[9];
+	f[11] = Inv[6] / Inv[9];
+	f[12] = Inv[4] / Inv[5];
+	f[13] = Inv[3] / Inv[5];
+	f[14] = Inv[1] / Inv[2];
+	SymMat[0] = Inv[0] + Inv[15] * f[4] + Inv[10] * f[8] + Inv[6] * f[11] + Inv[3] * f[13] + Inv[1] * f[14];
+	SymMat[1] = Inv[1] + Inv[15] * f[3] + Inv[10] * f[7] + Inv[6] * f[10] + Inv[3] * f[12];
+	SymMat[2] = Inv[2] + Inv[16] * f[3] + Inv[11] * f[7] + Inv[7] * f[10] + Inv[4] * f[12];
+	SymMat[3] = Inv[3] + Inv[15] * f[2] + Inv[10] * f[6] + Inv[6] * f[9];
+	SymMat[4] = Inv[4] + Inv[16] * f[2] + Inv[11] * f[6] + Inv[7] * f[9];
+	SymMat[5] = Inv[5] + Inv[17] * f[2] + Inv[12] * f[6] + Inv[8] * f[9];
+	SymMat[6] = Inv[6] + Inv[15] * f[1] + Inv[10] * f[5];
+	SymMat[7] = Inv[7] + Inv[16] * f[1] + Inv[11] * f[5];
+	SymMat[8] = Inv[8] + Inv[17] * f[1] + Inv[12] * f[5];
+	SymMat[9] = Inv[9] + Inv[18] * f[1] + Inv[13] * f[5];
+	SymMat[10] = Inv[10] + Inv[15] * f[0];
+	SymMat[11] = Inv[11] + Inv[16] * f[0];
+	SymMat[12] = Inv[12] + Inv[17] * f[0];
+	SymMat[13] = Inv[13] + Inv[18] * f[0];
+	SymMat[14] = Inv[14] + Inv[19] * f[0];
+	SymMat[15] = Inv[15];
+	SymMat[16] = Inv[16];
+	SymMat[17] = Inv[17];
+	SymMat[18] = Inv[18];
+	SymMat[19] = Inv[19];
+	SymMat[20] = Inv[20];
+}
+
+//*************** Calculate 4x4 symmetrical matrix multiply a column vector ****************
+//* unrolled from SymMatrixMultiply with the same operation order
+// Parameters:
+//   DeltaPos: pointer to result vector
+//   Inv: pointer to symmetrical matrix
+//   Delta: pointer to column vector
+// Return value:
+//   none
+void SymMatrixMultiply4(double *DeltaPos, double *Inv, double *Delta)
+{
+	DeltaPos[0] = Inv[0] * Delta[0] + Inv[1] * Delta[1] + Inv[3] * Delta[2] + Inv[6] * Delta[3];
+	DeltaPos[1] = Inv[1] * Delta[0] + Inv[2] * Delta[1] + Inv[4] * Delta[2] + Inv[7] * Delta[3];
+	DeltaPos[2] = Inv[3] * Delta[0] + Inv[4] * Delta[1] + Inv[5] * Delta[2] + Inv[8] * Delta[3];
+	DeltaPos[3] = Inv[6] * Delta[0] + Inv[7] * Delta[1] + Inv[8] * Delta[2] + Inv[9] * Delta[3];
+}
+
+//*************** Calculate 5x5 symmetrical matrix multiply a column vector ****************
+//* unrolled from SymMatrixMultiply with the same operation order
+// Parameters:
+//   DeltaPos: pointer to result vector
+//   Inv: pointer to symmetrical matrix
+//   Delta: pointer to column vector
+// Return value:
+//   none
+void SymMatrixMultiply5(double *DeltaPos, double *Inv, double *Delta)
+{
+	DeltaPos[0] = Inv[0] * Delta[0] + Inv[1] * Delta[1] + Inv[3] * Delta[2] + Inv[6] * Delta[3] + Inv[10] * Delta[4];
+	DeltaPos[1] = Inv[1] * Delta[0] + Inv[2] * Delta[1] + Inv[4] * Delta[2] + Inv[7] * Delta[3] + Inv[11] * Delta[4];
+	DeltaPos[2] = Inv[3] * Delta[0] + Inv[4] * Delta[1] + Inv[5] * Delta[2] + Inv[8] * Delta[3] + Inv[12] * Delta[4];
+	DeltaPos[3] = Inv[6] * Delta[0] + Inv[7] * Delta[1] + Inv[8] * Delta[2] + Inv[9] * Delta[3] + Inv[13] * Delta[4];
+	DeltaPos[4] = Inv[10] * Delta[0] + Inv[11] * Delta[1] + Inv[12] * Delta[2] + Inv[13] * Delta[3] + Inv[14] * Delta[4];
+}
+
+//*************** Calculate 6x6 symmetrical matrix multiply a column vector ****************
+//* unrolled from SymMatrixMultiply with the same operation order
+// Parameters:
+//   DeltaPos: pointer to result vector
+//   Inv: pointer to symmetrical matrix
+//   Delta: pointer to column vector
+// Return value:
+//   none
+void SymMatrixMultiply6(double *DeltaPos, double *Inv, double *Delta)
+{
+	DeltaPos[0] = Inv[0] * Delta[0] + Inv[1] * Delta[1] + Inv[3] * Delta[2] + Inv[6] * Delta[3] + Inv[10] * Delta[4] + Inv[15] * Delta[5];
+	DeltaPos[1] = Inv[1] * Delta[0] + Inv[2] * Delta[1] + Inv[4] * Delta[2] + Inv[7] * Delta[3] + Inv[11] * Delta[4] + Inv[16] * Delta[5];
+	DeltaPos[2] = Inv[3] * Delta[0] + Inv[4] * Delta[1] + Inv[5] * Delta[2] + Inv[8] * Delta[3] + Inv[12] * Delta[4] + Inv[17] * Delta[5];
+	DeltaPos[3] = Inv[6] * Delta[0] + Inv[7] * Delta[1] + Inv[8] * Delta[2] + Inv[9] * Delta[3] + Inv[13] * Delta[4] + Inv[18] * Delta[5];
+	DeltaPos[4] = Inv[10] * Delta[0] + Inv[11] * Delta[1] + Inv[12] * Delta[2] + Inv[13] * Delta[3] + Inv[14] * Delta[4] + Inv[19] * Delta[5];
+	DeltaPos[5] = Inv[15] * Delta[0] + Inv[16] * Delta[1] + Inv[17] * Delta[2] + Inv[18] * Delta[3] + Inv[19] * Delta[4] + Inv[20] * Delta[5];
+}
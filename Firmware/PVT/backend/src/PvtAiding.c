@@ -14,12 +14,17 @@
 
 #include <math.h>
 
+// maximum variance of predicted Doppler in (m/s)^2 to provide vector tracking aiding
+#define VECTOR_AIDING_MAX_VAR 1.0
+
 static int PredictSatelliteParam(double Time, PGNSS_EPHEMERIS Ephemeris, PKINEMATIC_INFO pReceiver, PSAT_PREDICT_PARAM SatParam);
+static int PredictSatelliteParamAlm(double Time, PMIDI_ALMANAC Almanac, PKINEMATIC_INFO ReceiverPos, PSAT_PREDICT_PARAM SatParam);
+static int GetSatelliteParam(PSATELLITE_INFO pSatInfo, PKINEMATIC_INFO ReceiverPos, PSAT_PREDICT_PARAM SatParam);
 
 // get satellite in view with maximum 32 satellites
 int GetSatelliteInView(SAT_PREDICT_PARAM SatList[32])
 {
-	int i, sat_num = 0;
+	int i, sat_num = 0, InView;
 	PGNSS_EPHEMERIS Ephemeris;
 	PSATELLITE_INFO SatelliteInfo;
 	double Time;
@@ -35,9 +40,13 @@ int GetSatelliteInView(SAT_PREDICT_PARAM SatList[32])
 	{
 		if (sat_num >= 32)
 			break;
-		if (!(Ephemeris[i].flag & 1))
+		if (Ephemeris[i].flag & 1)
+			InView = PredictSatelliteParam(Time, &Ephemeris[i], &(g_ReceiverInfo.PosVel), &SatList[sat_num]);
+		else if (g_GpsAlmanac[i].flag && g_ReceiverInfo.WeekNumber >= 0)	// use almanac if ephemeris not available
+			InView = PredictSatelliteParamAlm(Time, &g_GpsAlmanac[i], &(g_ReceiverInfo.PosVel), &SatList[sat_num]);
+		else
 			continue;
-		if (PredictSatelliteParam(Time, &Ephemeris[i], &(g_ReceiverInfo.PosVel), &SatList[sat_num]))
+		if (InView)
 		{
 			SatList[sat_num].FreqID = FREQ_L1CA;
 			SatList[sat_num].Svid = (U8)(i + 1);
@@ -80,6 +89,92 @@ int GetSatelliteInView(SAT_PREDICT_PARAM SatList[32])
 	return sat_num;
 }
 
+//*************** Get satellites in view to aid acquisition after Doppler positioning ****************
+//* satellite list is given only once after coarse position obtained by Doppler positioning
+//* predicted Doppler includes receiver clock drifting estimated together with position
+// Parameters:
+//   SatList: predicted Doppler of satellites in view
+// Return value:
+//   number of satellites in view
+int GetAcqAiding(SAT_PREDICT_PARAM SatList[32])
+{
+	int i, sat_num;
+
+	if ((g_ReceiverInfo.PosFlag & DOPPLER_POS_AIDING) == 0)
+		return 0;
+	g_ReceiverInfo.PosFlag &= ~DOPPLER_POS_AIDING;
+
+	sat_num = GetSatelliteInView(SatList);
+	for (i = 0; i < sat_num; i ++)
+		SatList[i].Doppler += g_PvtCoreData.StateVector[3] / GPS_L1_WAVELENGTH;
+
+	return sat_num;
+}
+
+//*************** Predict Doppler of tracking channels using KF state for vector tracking ****************
+//* prediction is only valid when KF positioning succeeded in current epoch and
+//* variance of velocity and clock drifting is small enough, otherwise channels
+//* will hand over to scalar tracking loops
+// Parameters:
+//   AidingList: predicted Doppler (including clock drifting) for each logic channel
+// Return value:
+//   bit mask of channels with valid prediction
+U32 GetVectorAiding(SAT_PREDICT_PARAM AidingList[TOTAL_CHANNEL_NUMBER])
+{
+	int i, sv_index;
+	U32 AidingMask = 0;
+	PGNSS_EPHEMERIS Ephemeris;
+	double Time, ClkDrifting, Variance;
+
+	if ((g_PvtConfig.PvtConfigFlags & PVT_CONFIG_VECTOR_TRACKING) == 0)
+		return 0;
+	if (g_ReceiverInfo.CurrentPosType != PosTypeKFPos || (g_ReceiverInfo.PosFlag & (PVT_USE_GPS | PVT_USE_BDS | PVT_USE_GAL)) == 0)
+		return 0;
+	// sum of variance of VX/VY/VZ/TDOT
+	Variance = 0.0;
+	for (i = 0; i < 4; i ++)
+		Variance += KFStateVariance(g_PvtCoreData.PMatrix, i);
+	if (Variance > VECTOR_AIDING_MAX_VAR)
+		return 0;
+	ClkDrifting = g_PvtCoreData.StateVector[3];
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if (!(g_ChannelStatus[i].ChannelFlag & CHANNEL_ACTIVE) || SVID_IS_SBAS(g_ChannelStatus[i].FreqID, g_ChannelStatus[i].svid))	// no ephemeris for SBAS
+			continue;
+		sv_index = g_ChannelStatus[i].svid - 1;
+		switch (g_ChannelStatus[i].FreqID)
+		{
+		case FREQ_L1CA:
+		case FREQ_L1C:
+			Ephemeris = &g_GpsEphemeris[sv_index];
+			Time = g_ReceiverInfo.GpsMsCount * 0.001;
+			break;
+		case FREQ_B1C:
+			Ephemeris = &g_BdsEphemeris[sv_index];
+			Time = (g_ReceiverInfo.GpsMsCount - 14000) * 0.001;
+			break;
+		case FREQ_E1:
+			Ephemeris = &g_GalileoEphemeris[sv_index];
+			Time = g_ReceiverInfo.GpsMsCount * 0.001;
+			break;
+		default:
+			continue;
+		}
+		if (!(Ephemeris->flag & 1))
+			continue;
+		if (PredictSatelliteParam(Time, Ephemeris, &(g_ReceiverInfo.PosVel), &AidingList[i]))
+		{
+			AidingList[i].Doppler += ClkDrifting / GPS_L1_WAVELENGTH;
+			AidingList[i].FreqID = g_ChannelStatus[i].FreqID;
+			AidingList[i].Svid = g_ChannelStatus[i].svid;
+			AidingMask |= (1 << i);
+		}
+	}
+
+	return AidingMask;
+}
+
 int PredictSatelliteParam(double Time, PGNSS_EPHEMERIS Ephemeris, PKINEMATIC_INFO ReceiverPos, PSAT_PREDICT_PARAM SatParam)
 {
 	SATELLITE_INFO SatInfo;
@@ -89,10 +184,23 @@ int PredictSatelliteParam(double Time, PGNSS_EPHEMERIS Ephemeris, PKINEMATIC_INF
 	// apply relativistic correction to clock
 //	Trel = WGS_F_GTR * Ephemeris[sv_index].ecc * Ephemeris[sv_index].sqrtA * sin(Ephemeris[sv_index].Ek);
 //	DeltaT += Trel;
-	SatParam->PredictPsr = GeometryDistance(ReceiverPos, &(SatInfo.PosVel));
-	SatParam->Doppler = -SatRelativeSpeed(ReceiverPos, &(SatInfo.PosVel)) / GPS_L1_WAVELENGTH;
-	SatElAz(ReceiverPos, &SatInfo);
-	if (SatInfo.el > DEG2RAD(5))
+	return GetSatelliteParam(&SatInfo, ReceiverPos, SatParam);
+}
+
+int PredictSatelliteParamAlm(double Time, PMIDI_ALMANAC Almanac, PKINEMATIC_INFO ReceiverPos, PSAT_PREDICT_PARAM SatParam)
+{
+	SATELLITE_INFO SatInfo;
+
+	GpsSatPosSpeedAlm(g_ReceiverInfo.WeekNumber, (int)Time, Almanac, &(SatInfo.PosVel));
+	return GetSatelliteParam(&SatInfo, ReceiverPos, SatParam);
+}
+
+int GetSatelliteParam(PSATELLITE_INFO pSatInfo, PKINEMATIC_INFO ReceiverPos, PSAT_PREDICT_PARAM SatParam)
+{
+	SatParam->PredictPsr = GeometryDistance(ReceiverPos, &(pSatInfo->PosVel));
+	SatParam->Doppler = -SatRelativeSpeed(ReceiverPos, &(pSatInfo->PosVel)) / GPS_L1_WAVELENGTH;
+	SatElAz(ReceiverPos, pSatInfo);
+	if (pSatInfo->el > DEG2RAD(5))
 		return 1;
 
 	return 0;
@@ -28,11 +28,18 @@
 #define STATE_DT_BDS (g_PvtCoreData.StateVector[8])
 #define STATE_DT_GAL (g_PvtCoreData.StateVector[9])
 
+#define P_INDEX(i, j) ((i) * ((i) + 1) / 2 + (j))	// index of element (i,j) (j<=i) in P matrix
+
+static void ComposePMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFlag);
+static void AddQMatrix(double *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT);
 static void CalcQMatrix(double Qh, double Qv, PCONVERT_MATRIX pConvertMatrix, double QMatrix[]);
 static double ObservationVariance(PCHANNEL_STATUS pChannelStatus, PSATELLITE_INFO pSatInfo, BOOL bVel);
 static BOOL PsrObservationCheck(PCHANNEL_STATUS pChannelStatus, double DeltaPsr);
 static BOOL DopplerObservationCheck(PCHANNEL_STATUS pChannelStatus, double DeltaDoppler);
-static void SequencialUpdate(double UpdateVector[], double H[3], double *P, double Innovation, double r, int SystemIndex);
+static void SequencialUpdate(double UpdateVector[], double H[3], KF_COV_TYPE *P, double Innovation, double r, int SystemIndex);
+#if defined PVT_KF_UD_FLOAT
+static void LdlFactorize(float *Matrix);
+#endif
 
 /* In Kalman filter, the P matrix is a symmetric matrix and is stored with following order
  p00
@@ -48,9 +55,12 @@ static void SequencialUpdate(double UpdateVector[], double H[3], double *P, doub
  \----v----/  |  \----v----/  |   |   |
   VX/VY/VZ  TDOT    X/Y/Z    DTG DTC DTE
 The P matrix elements have the same order as state vector, only lower triangle elements is stored
+If PVT_KF_UD_FLOAT is defined, P=L*D*L' is kept in single precision factorized form with the same order,
+in which L is unit lower triangle matrix stored below diagonal and diagonal elements store D
+State vector itself is always kept in double precision and the filter only outputs update values to it
 */
 
-//*************** Initialize P matrix for Kalman filter ****************
+//*************** Compose initial P matrix for Kalman filter ****************
 // assumptions here are:
 //   if using weighted LSQ:
 //     PMatrixInit is the Inv(HtWH) calculated in velocity calculation, in which W is the weight of PSR variance
@@ -68,7 +78,7 @@ The P matrix elements have the same order as state vector, only lower triangle e
 //   PosFlag: flags of LSQ position result indicate which system used in LSQ PVT
 // Return value:
 //   none
-void InitPMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFlag)
+void ComposePMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFlag)
 {
 	int i, j;
 	double *pdest;
@@ -114,6 +124,19 @@ void InitPMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFla
 	}
 }
 
+#if !defined PVT_KF_UD_FLOAT
+//*************** Initialize P matrix for Kalman filter ****************
+// Parameters:
+//   PMatrix: pointer to P matrix to be intialized
+//   PMatrixInit: pointer to array used to initialize P matrix
+//   PosFlag: flags of LSQ position result indicate which system used in LSQ PVT
+// Return value:
+//   none
+void InitPMatrix(KF_COV_TYPE *PMatrix, const double *PMatrixInit, unsigned int PosFlag)
+{
+	ComposePMatrix(PMatrix, PMatrixInit, PosFlag);
+}
+
 //*************** Do Kalman filter prediction ****************
 // because state prediction has already been calculated, so only P matrix prediction is done here
 // given state vector as [VX VY VZ TDOT X Y Z DT_GPS DT_BDS DT_GAL], the one-step transition matrix Phi(A) is
@@ -143,7 +166,7 @@ void InitPMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFla
 //   DeltaT: time interval
 // Return value:
 //   none
-void KFPrediction(double *PMatrix, double DeltaT)
+void KFPrediction(KF_COV_TYPE *PMatrix, double DeltaT)
 {
 	const int line_start[] = {0, 1, 3, 6, 10, 15, 21, 28, 36, 45, 55};
 	int i, j;
@@ -221,6 +244,31 @@ void KFPrediction(double *PMatrix, double DeltaT)
 }
 
 //*************** Add Q matrix to P matrix ****************
+// Parameters:
+//   PMatrix: pointer to P matrix
+//   QConfig: array of Qh, Qv and Qf
+//   pConvertMatrix: pointer to ECEF to ENU conversion matrix
+//   DeltaT: time interval
+// Return value:
+//   none
+void KFAddQMatrix(KF_COV_TYPE *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT)
+{
+	AddQMatrix(PMatrix, QConfig, pConvertMatrix, DeltaT);
+}
+
+//*************** Get variance of one state from P matrix ****************
+// Parameters:
+//   PMatrix: pointer to P matrix
+//   StateIndex: index of state in state vector
+// Return value:
+//   diagonal element of P matrix corresponding to the state
+double KFStateVariance(const KF_COV_TYPE *PMatrix, int StateIndex)
+{
+	return PMatrix[P_INDEX(StateIndex, StateIndex)];
+}
+#endif
+
+//*************** Calculate and add Q matrix to P matrix ****************
 // the following is the Q matrix calculation and adding to P matrix
 //         xdot   ydot   zdot    tdot       x      y      z      dt1   dt2   dt3
 // xdot / Qxx*T1               |       |                      |                   \
@@ -246,7 +294,7 @@ void KFPrediction(double *PMatrix, double DeltaT)
 //   DeltaT: time interval
 // Return value:
 //   none
-void KFAddQMatrix(double *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT)
+void AddQMatrix(double *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT)
 {
 	int i, j;
 	double Qh = QConfig[0], Qv = QConfig[1], Qf = QConfig[2], Qxyz[9];
@@ -339,6 +387,8 @@ void CalcQMatrix(double Qh, double Qv, PCONVERT_MATRIX pConvertMatrix, double QM
 }
 
 //*************** Do Kalman filter positioning ****************
+//* range and LOS are calculated once on epoch geometry at predicted position, residual of each
+//* sequencial update is linearized to current state with position update of previous observations
 // Parameters:
 //   ObservationList: raw measurement pointer array
 //   ObsCount: number of observations
@@ -349,53 +399,61 @@ int KFPosition(PCHANNEL_STATUS ObservationList[], int ObsCount, int PosUseSatCou
 {
 	int i, j;
 	int SystemIndex = 0;
-	int sv_index;
-	const int DtIndex[3] = { 35, 44, 54 };
 	double UpdateVector[STATE_VECTOR_SIZE];
 	double DeltaPsr, DeltaDoppler;
-	double H[3];
-	double GeoDistance;
+	double H[3], dP[3];
+	double RangeRate;
 	double *dT = &STATE_DT_GPS;
 	int PrevFreqID = -1;
-	PSATELLITE_INFO SatelliteInfo = g_GpsSatelliteInfo;
+	PSATELLITE_INFO pSatInfo;
 	int UseSystemMask = 0;
+	PEPOCH_GEOMETRY Geometry = &(g_PvtCoreData.Geometry);
 
 	for (i = 0; i < PVT_MAX_SYSTEM_ID; i ++)
 		PosUseSatCount[i] = g_PvtCoreData.h.length[i] = 0;
 
+	UpdateEpochGeometry(Geometry, &(STATE_X));
 	for (i = 0; i < ObsCount; i ++)
 	{
 		// observations are arranged to put same system together and with order GPS, BDS, Galileo
 		if (ObservationList[i]->FreqID == FREQ_B1C && PrevFreqID != FREQ_B1C)
 		{
 			PrevFreqID = FREQ_B1C;
-			SatelliteInfo = g_BdsSatelliteInfo;
 			SystemIndex = 1;
 		}
 		else if (ObservationList[i]->FreqID == FREQ_E1 && PrevFreqID != FREQ_E1)
 		{
 			PrevFreqID = FREQ_E1;
-			SatelliteInfo = g_GalileoSatelliteInfo;
 			SystemIndex = 2;
 		}
-		sv_index = ObservationList[i]->svid - 1;
-
-		// calculate PSR and Doppler residual
-		GeoDistance = GeometryDistanceXYZ(&(STATE_X), SatelliteInfo[sv_index].PosVel.PosVel);
-		DeltaPsr = GeoDistance - ObservationList[i]->PseudoRange - dT[SystemIndex];
-		DeltaDoppler = SatRelativeSpeedXYZ(&STATE_VX, SatelliteInfo[sv_index].PosVel.PosVel) + ObservationList[i]->Doppler - STATE_TDOT;
+		pSatInfo = Geometry->SatInfo[i];
+		H[0] = Geometry->LosX[i];
+		H[1] = Geometry->LosY[i];
+		H[2] = Geometry->LosZ[i];
+
+		// calculate PSR and Doppler residual, position moved from geometry calculation changes range by -LOS*dP
+		// and changes satellite range rate by -(Vs-(LOS*Vs)*LOS)*dP/r
+		dP[0] = STATE_X - Geometry->ReceiverPos[0];
+		dP[1] = STATE_Y - Geometry->ReceiverPos[1];
+		dP[2] = STATE_Z - Geometry->ReceiverPos[2];
+		DeltaPsr = Geometry->Range[i] - (H[0] * dP[0] + H[1] * dP[1] + H[2] * dP[2]);
+		DeltaPsr -= ObservationList[i]->PseudoRange + dT[SystemIndex];
+		RangeRate = Geometry->SatRangeRate[i] * Geometry->RangeScale[i];
+		DeltaDoppler = Geometry->SatRangeRate[i] - (H[0] * STATE_VX + H[1] * STATE_VY + H[2] * STATE_VZ) * Geometry->RangeScale[i];
+		DeltaDoppler -= ((Geometry->SatVx[i] - RangeRate * H[0]) * dP[0] + (Geometry->SatVy[i] - RangeRate * H[1]) * dP[1] + (Geometry->SatVz[i] - RangeRate * H[2]) * dP[2]) / Geometry->Range[i];
+		DeltaDoppler += ObservationList[i]->Doppler - STATE_TDOT;
 
 		// calculate square root of variance of PSR and Doppler
-		ObservationList[i]->PsrVariance = ObservationVariance(ObservationList[i], &SatelliteInfo[sv_index], 0);
-		ObservationList[i]->DopplerVariance = ObservationVariance(ObservationList[i], &SatelliteInfo[sv_index], 1);
+		ObservationList[i]->PsrVariance = ObservationVariance(ObservationList[i], pSatInfo, 0);
+		ObservationList[i]->DopplerVariance = ObservationVariance(ObservationList[i], pSatInfo, 1);
 
-		SatelliteInfo[sv_index].VectorX = g_PvtCoreData.h.data[0][i] = H[0] = (SatelliteInfo[sv_index].PosVel.x - STATE_X) / GeoDistance;
-		SatelliteInfo[sv_index].VectorY = g_PvtCoreData.h.data[1][i] = H[1] = (SatelliteInfo[sv_index].PosVel.y - STATE_Y) / GeoDistance;
-		SatelliteInfo[sv_index].VectorZ = g_PvtCoreData.h.data[2][i] = H[2] = (SatelliteInfo[sv_index].PosVel.z - STATE_Z) / GeoDistance;
-		SatelliteInfo[sv_index].SatInfoFlag |= SAT_INFO_LOS_VALID | SAT_INFO_LOS_MATCH;
+		pSatInfo->VectorX = g_PvtCoreData.h.data[0][i] = H[0];
+		pSatInfo->VectorY = g_PvtCoreData.h.data[1][i] = H[1];
+		pSatInfo->VectorZ = g_PvtCoreData.h.data[2][i] = H[2];
+		pSatInfo->SatInfoFlag |= SAT_INFO_LOS_VALID | SAT_INFO_LOS_MATCH;
 		g_PvtCoreData.h.weight[i] = 1.0;// weight reserved for future weighted LSQ expansion
 
-		if (fabs(g_PvtCoreData.PMatrix[DtIndex[SystemIndex]]) > 1e10 || PsrObservationCheck(ObservationList[i], DeltaPsr))
+		if (KFStateVariance(g_PvtCoreData.PMatrix, STATE_VECTOR_SIZE - PVT_MAX_SYSTEM_ID + SystemIndex) > 1e10 || PsrObservationCheck(ObservationList[i], DeltaPsr))
 		{
 			UseSystemMask |= (1 << SystemIndex);
 			SequencialUpdate(UpdateVector, H, g_PvtCoreData.PMatrix, DeltaPsr, ObservationList[i]->PsrVariance, SystemIndex + 1);
@@ -447,6 +505,10 @@ double ObservationVariance(PCHANNEL_STATUS pChannelStatus, PSATELLITE_INFO pSatI
 		Elevation = 0.0872664626;	// 5 degree
 	Var += 0.5 / sin(Elevation);
 
+	// iono-free combination amplifies L1 code noise by gamma/(gamma-1) (L5 code noise is much smaller)
+	if (!bVel && (pChannelStatus->ChannelFlag & IONO_FREE))
+		Var *= GPS_L1_L5_GAMMA / (GPS_L1_L5_GAMMA - 1.0);
+
 	if(bVel)
 		Var /= 20.;
 
@@ -501,6 +563,7 @@ BOOL DopplerObservationCheck(PCHANNEL_STATUS pChannelStatus, double DeltaDoppler
 		return 0;
 }
 
+#if !defined PVT_KF_UD_FLOAT
 //*************** sequencial update of one PSR or Doppler observation in Kalman filter ****************
 // The H matrix for update of each system has the following values:
 //   for GPS PSR: H = [0 0 0 0 rx ry rz 1 0 0]
@@ -544,7 +607,7 @@ BOOL DopplerObservationCheck(PCHANNEL_STATUS pChannelStatus, double DeltaDoppler
 //   SystemIndex: 1~3 for GPS/BDS/Galileo PSR update respectively, 0 for Doppler update
 // Return value:
 //   whether observation is valid
-void SequencialUpdate(double UpdateVector[], double H[3], double *P, double Innovation, double r, int SystemIndex)
+void SequencialUpdate(double UpdateVector[], double H[3], KF_COV_TYPE *P, double Innovation, double r, int SystemIndex)
 {
 	int i, j, len;
 	const int start_pos1[4] = { 6, 28, 36, 45};
@@ -607,3 +670,224 @@ void SequencialUpdate(double UpdateVector[], double H[3], double *P, double Inno
 		}
 	}
 }
+#else
+//*************** Initialize L-D factors of P matrix for Kalman filter ****************
+//* initial P matrix is composed in double precision then factorized into single precision
+// Parameters:
+//   PMatrix: pointer to L-D factors to be intialized
+//   PMatrixInit: pointer to array used to initialize P matrix
+//   PosFlag: flags of LSQ position result indicate which system used in LSQ PVT
+// Return value:
+//   none
+void InitPMatrix(KF_COV_TYPE *PMatrix, const double *PMatrixInit, unsigned int PosFlag)
+{
+	int i;
+	double P[P_MATRIX_SIZE];
+
+	ComposePMatrix(P, PMatrixInit, PosFlag);
+	for (i = 0; i < P_MATRIX_SIZE; i ++)
+		PMatrix[i] = (float)P[i];
+	LdlFactorize(PMatrix);
+}
+
+//*************** Do Kalman filter prediction on L-D factors ****************
+//* transition matrix A=I+N in which N only has dT at (4,0) (5,1) (6,2) (7,3) (8,3) (9,3)
+//* so A*L is still unit lower triangle and A*P*A'=(A*L)*D*(A*L)' with D unchanged
+//* row of X/Y/Z in L adds dT times row of VX/VY/VZ, row of DT adds dT times row of TDOT
+// Parameters:
+//   PMatrix: pointer to L-D factors
+//   DeltaT: time interval
+// Return value:
+//   none
+void KFPrediction(KF_COV_TYPE *PMatrix, double DeltaT)
+{
+	int i, j, Src;
+	float dT = (float)DeltaT;
+
+	for (i = 4; i < STATE_VECTOR_SIZE; i ++)
+	{
+		Src = (i < 7) ? (i - 4) : 3;
+		for (j = 0; j < Src; j ++)
+			PMatrix[P_INDEX(i, j)] += PMatrix[P_INDEX(Src, j)] * dT;
+		PMatrix[P_INDEX(i, Src)] += dT;	// diagonal element of L is 1
+	}
+}
+
+//*************** Add Q matrix to L-D factors ****************
+//* Thornton time update with modified weighted Gram-Schmidt (MWGS) orthogonalization
+//* Q matrix is composed in double precision and factorized as Q=Lq*Dq*Lq', A*L is already done by KFPrediction()
+//* so A*P*A'+Q=W*Dw*W' with W=[A*L Lq] and Dw=diag(D,Dq), rows of W are orthogonalized from first row:
+//*   D(k)=w(k)*Dw*w(k)', for i>k: L(i,k)=w(i)*Dw*w(k)'/D(k), w(i)=w(i)-L(i,k)*w(k)
+//* new D is a weighted sum of squares so it never turns negative by rounding error
+//* row k of W only has non-zero elements in first k+1 columns of each half
+// Parameters:
+//   PMatrix: pointer to L-D factors
+//   QConfig: array of Qh, Qv and Qf
+//   pConvertMatrix: pointer to ECEF to ENU conversion matrix
+//   DeltaT: time interval
+// Return value:
+//   none
+void KFAddQMatrix(KF_COV_TYPE *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT)
+{
+	int i, j, k;
+	double Q[P_MATRIX_SIZE];
+	float QFactor[P_MATRIX_SIZE];
+	float W[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE * 2], Dw[STATE_VECTOR_SIZE * 2], WD[STATE_VECTOR_SIZE * 2];
+	float d, t;
+
+	memset(Q, 0, sizeof(Q));
+	AddQMatrix(Q, QConfig, pConvertMatrix, DeltaT);
+	for (i = 0; i < P_MATRIX_SIZE; i ++)
+		QFactor[i] = (float)Q[i];
+	LdlFactorize(QFactor);
+
+	// compose W=[L Lq] and Dw=[D Dq], elements above diagonal of each half are never accessed
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+	{
+		Dw[i] = PMatrix[P_INDEX(i, i)];
+		Dw[STATE_VECTOR_SIZE + i] = QFactor[P_INDEX(i, i)];
+		for (j = 0; j < i; j ++)
+		{
+			W[i][j] = PMatrix[P_INDEX(i, j)];
+			W[i][STATE_VECTOR_SIZE + j] = QFactor[P_INDEX(i, j)];
+		}
+		W[i][i] = W[i][STATE_VECTOR_SIZE + i] = 1.0f;
+	}
+
+	for (k = 0; k < STATE_VECTOR_SIZE; k ++)
+	{
+		d = 0.0f;
+		for (j = 0; j <= k; j ++)
+		{
+			WD[j] = W[k][j] * Dw[j];
+			WD[STATE_VECTOR_SIZE + j] = W[k][STATE_VECTOR_SIZE + j] * Dw[STATE_VECTOR_SIZE + j];
+			d += WD[j] * W[k][j] + WD[STATE_VECTOR_SIZE + j] * W[k][STATE_VECTOR_SIZE + j];
+		}
+		PMatrix[P_INDEX(k, k)] = d;
+		for (i = k + 1; i < STATE_VECTOR_SIZE; i ++)
+		{
+			t = 0.0f;
+			for (j = 0; j <= k; j ++)
+				t += W[i][j] * WD[j] + W[i][STATE_VECTOR_SIZE + j] * WD[STATE_VECTOR_SIZE + j];
+			t = (d > 0.0f) ? t / d : 0.0f;
+			PMatrix[P_INDEX(i, k)] = t;
+			for (j = 0; j <= k; j ++)
+			{
+				W[i][j] -= t * W[k][j];
+				W[i][STATE_VECTOR_SIZE + j] -= t * W[k][STATE_VECTOR_SIZE + j];
+			}
+		}
+	}
+}
+
+//*************** Get variance of one state from L-D factors ****************
+//* P(i,i)=D(i)+sum(L(i,j)^2*D(j)) for j<i
+// Parameters:
+//   PMatrix: pointer to L-D factors
+//   StateIndex: index of state in state vector
+// Return value:
+//   diagonal element of P matrix corresponding to the state
+double KFStateVariance(const KF_COV_TYPE *PMatrix, int StateIndex)
+{
+	int i;
+	const float *L = PMatrix + P_INDEX(StateIndex, 0);
+	float Variance = L[StateIndex];
+
+	for (i = 0; i < StateIndex; i ++)
+		Variance += L[i] * L[i] * PMatrix[P_INDEX(i, i)];
+
+	return (double)Variance;
+}
+
+//*************** sequencial update of one PSR or Doppler observation with Bierman algorithm ****************
+//* H vector is the same as double precision version
+//* innovation is calculated in double precision by caller, so only small values are processed in single precision
+//* with f=L'*H' and v=D*f, process j from last state to first state with a=r at beginning:
+//*   a'=a+f(j)*v(j), D(j)=D(j)*a/a', b(j)=v(j)
+//*   for i>j: L(i,j)=L(i,j)-b(i)*f(j)/a, b(i)=b(i)+L(i,j)*v(j) (old L(i,j) used for b(i))
+//* gain vector is K=b/a at the end
+// Parameters:
+//   UpdateVector: update values to state vector
+//   H: first three elements (rx/ry/rz) of H matrix
+//   P: pointer to L-D factors
+//   Innovation: innovation (residual) of observation
+//   r: variance of observation
+//   SystemIndex: 1~3 for GPS/BDS/Galileo PSR update respectively, 0 for Doppler update
+// Return value:
+//   none
+void SequencialUpdate(double UpdateVector[], double H[3], KF_COV_TYPE *P, double Innovation, double r, int SystemIndex)
+{
+	int i, j;
+	float h[STATE_VECTOR_SIZE], f[STATE_VECTOR_SIZE], b[STATE_VECTOR_SIZE];
+	float Alpha, AlphaNew, v, Lij, Factor;
+
+	// compose full H vector
+	memset(h, 0, sizeof(h));
+	i = (SystemIndex == 0) ? 0 : 4;
+	h[i] = (float)H[0];
+	h[i+1] = (float)H[1];
+	h[i+2] = (float)H[2];
+	h[(SystemIndex == 0) ? 3 : (6 + SystemIndex)] = 1.0f;
+
+	// f = L'*h
+	for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+	{
+		f[j] = h[j];
+		for (i = j + 1; i < STATE_VECTOR_SIZE; i ++)
+			f[j] += P[P_INDEX(i, j)] * h[i];
+	}
+
+	Alpha = (float)r;
+	for (j = STATE_VECTOR_SIZE - 1; j >= 0; j --)
+	{
+		v = P[P_INDEX(j, j)] * f[j];
+		AlphaNew = Alpha + f[j] * v;
+		P[P_INDEX(j, j)] *= Alpha / AlphaNew;
+		b[j] = v;
+		Factor = -f[j] / Alpha;
+		for (i = j + 1; i < STATE_VECTOR_SIZE; i ++)
+		{
+			Lij = P[P_INDEX(i, j)];
+			P[P_INDEX(i, j)] = Lij + b[i] * Factor;
+			b[i] += Lij * v;
+		}
+		Alpha = AlphaNew;
+	}
+
+	// update vector K*Innovation with K=b/Alpha
+	Factor = (float)Innovation / Alpha;
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		UpdateVector[i] = (double)(b[i] * Factor);
+}
+
+//*************** L-D factorization of symmetric matrix ****************
+//* Matrix=L*D*L' is done in place with the same order as P matrix
+//* pivot not significantly positive (semi-definite matrix such as Q) is set to zero
+//* together with corresponding column of L
+// Parameters:
+//   Matrix: pointer to symmetric matrix, output L-D factors
+// Return value:
+//   none
+void LdlFactorize(float *Matrix)
+{
+	int i, j, k;
+	float d, t;
+
+	for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+	{
+		d = Matrix[P_INDEX(j, j)];
+		for (k = 0; k < j; k ++)
+			d -= Matrix[P_INDEX(j, k)] * Matrix[P_INDEX(j, k)] * Matrix[P_INDEX(k, k)];
+		if (d <= Matrix[P_INDEX(j, j)] * 1e-6f)
+			d = 0.0f;
+		Matrix[P_INDEX(j, j)] = d;
+		for (i = j + 1; i < STATE_VECTOR_SIZE; i ++)
+		{
+			t = Matrix[P_INDEX(i, j)];
+			for (k = 0; k < j; k ++)
+				t -= Matrix[P_INDEX(i, k)] * Matrix[P_INDEX(j, k)] * Matrix[P_INDEX(k, k)];
+			Matrix[P_INDEX(i, j)] = (d > 0.0f) ? t / d : 0.0f;
+		}
+	}
+}
+#endif
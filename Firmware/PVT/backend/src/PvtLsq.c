@@ -11,6 +11,7 @@
 #include "DataTypes.h"
 #include "GlobalVar.h"
 #include "SupportPackage.h"
+#include "SatManage.h"
 #include <math.h>
 
 // in order to adapt to multiple system, state placement in core data is as following:
@@ -27,9 +28,28 @@
 #define STATE_DT_BDS (g_PvtCoreData.StateVector[8])
 #define STATE_DT_GAL (g_PvtCoreData.StateVector[9])
 
+// normal distribution quantile of RAIM false alarm probability 1e-5 and missed detection probability 1e-3
+#define RAIM_FALSE_ALARM_Z 4.265
+#define RAIM_MISSED_DETECTION_K 3.090
+
+// Doppler only coarse position fix check thresholds
+#define DOPPLER_FIX_MIN_OBS 5				// at least one redundant observation to check residual
+#define DOPPLER_FIX_MAX_RMS 5.0				// maximum post-fit residual RMS in m/s
+#define DOPPLER_FIX_MAX_DOP 20000.0			// maximum horizontal position error in meter per m/s Doppler error
+#define DOPPLER_FIX_MAX_STEP 2000000.0		// maximum horizontal step of each iteration in meter
+#define DOPPLER_FIX_SAME_DISTANCE 100000.0	// candidates closer than this are treated as same solution
+#define DOPPLER_FIX_AMBIGUITY_RATIO 4.0		// second solution with residual less than this ratio makes fix ambiguous
+#define DOPPLER_FIX_NOISE_FLOOR 0.25		// residual variance floor in (m/s)^2 for ambiguity check
+
 static void LSQResolve(double *DeltaPos, PHMATRIX H, double *DeltaPsr, double *InvMatrix, int dim);
+static int RaimFde(PCHANNEL_STATUS ObservationList[], int ObsCount, double *DeltaMsr, double *SolutionDelta, int SystemNumber, int SystemIndex[]);
+static double ChiSquareThreshold(int Dof);
+static void ComposeHRow(double *HRow, int Index, int Dim, int System);
+static int DopplerLsqSolve(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount, double *State, double *Residual, double *Dop);
+static double DopplerLsqAccumulate(PCHANNEL_STATUS ObservationList[], int ObsCount, double *State, double *HtH, double *Delta);
 
 //*************** Do LSQ position/velocity calculation ****************
+//* range and LOS of each iteration are calculated on epoch geometry loaded with the observation list
 // Parameters:
 //   ObservationList: raw measurement pointer array
 //   ObsCount: number of observations
@@ -41,17 +61,15 @@ static void LSQResolve(double *DeltaPos, PHMATRIX H, double *DeltaPsr, double *I
 int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 {
 	int i, iteration;
-	int sv_index;
 	int SystemNumber = 0;
 	int SystemIndex[PVT_MAX_SYSTEM_ID];		// clock error index
 	int PrevFreqID;
-	PSATELLITE_INFO SatelliteInfo;
 	double SolutionDelta[PVT_MAX_SYSTEM_ID+3];	// maximum 3 position + clock error
 	double DeltaMsr[DIMENSION_MAX_X];
-	double GeoDistance;
 	double Residual;
 	double dT;
 	int UseSystemMask = 0;
+	PEPOCH_GEOMETRY Geometry = &(g_PvtCoreData.Geometry);
 
 	if (ObsCount < 3)
 		return -1;
@@ -60,7 +78,6 @@ int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 	for (iteration = 0; iteration < LoopCount; iteration ++)
 	{
 		PrevFreqID = -1;
-		SatelliteInfo = g_GpsSatelliteInfo;
 		dT = STATE_DT_GPS;
 		UseSystemMask = 0;
 		if ((ObservationList[0]->FreqID == FREQ_L1CA) || (ObservationList[0]->FreqID == FREQ_L1C))	// whether has GPS observation
@@ -75,13 +92,13 @@ int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 		for (i = 0; i < PVT_MAX_SYSTEM_ID; i ++)
 			g_PvtCoreData.h.length[i] = 0;
 
+		UpdateEpochGeometry(Geometry, &(STATE_X));
 		for (i = 0; i < ObsCount; i ++)
 		{
 			// observations are arranged to put same system together and with order GPS, BDS, Galileo
 			if (ObservationList[i]->FreqID == FREQ_B1C && PrevFreqID != FREQ_B1C)
 			{
 				PrevFreqID = FREQ_B1C;
-				SatelliteInfo = g_BdsSatelliteInfo;
 				dT = STATE_DT_BDS;
 				SystemIndex[SystemNumber] = 1;
 				SystemNumber ++;
@@ -90,21 +107,16 @@ int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 			else if (ObservationList[i]->FreqID == FREQ_E1 && PrevFreqID != FREQ_E1)
 			{
 				PrevFreqID = FREQ_E1;
-				SatelliteInfo = g_GalileoSatelliteInfo;
 				dT = STATE_DT_GAL;
 				SystemIndex[SystemNumber] = 2;
 				SystemNumber ++;
 				UseSystemMask |= PVT_USE_GAL;
 			}
-			sv_index = ObservationList[i]->svid - 1;
 
-			GeoDistance = GeometryDistanceXYZ(&(STATE_X), SatelliteInfo[sv_index].PosVel.PosVel);
-			DeltaMsr[i] = GeoDistance - ObservationList[i]->PseudoRange - dT;
-							
-			SatelliteInfo[sv_index].VectorX = g_PvtCoreData.h.data[0][i] = (SatelliteInfo[sv_index].PosVel.x - STATE_X) / GeoDistance;
-			SatelliteInfo[sv_index].VectorY = g_PvtCoreData.h.data[1][i] = (SatelliteInfo[sv_index].PosVel.y - STATE_Y) / GeoDistance;
-			SatelliteInfo[sv_index].VectorZ = g_PvtCoreData.h.data[2][i] = (SatelliteInfo[sv_index].PosVel.z - STATE_Z) / GeoDistance;
-			SatelliteInfo[sv_index].SatInfoFlag |= SAT_INFO_LOS_VALID | SAT_INFO_LOS_MATCH;
+			DeltaMsr[i] = Geometry->Range[i] - ObservationList[i]->PseudoRange - dT;
+			g_PvtCoreData.h.data[0][i] = Geometry->LosX[i];
+			g_PvtCoreData.h.data[1][i] = Geometry->LosY[i];
+			g_PvtCoreData.h.data[2][i] = Geometry->LosZ[i];
 			g_PvtCoreData.h.weight[i] = 1.0;// weight reserved for future weighted LSQ expansion
 			g_PvtCoreData.h.length[SystemNumber-1] ++;
 		}
@@ -124,28 +136,38 @@ int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 			break;
 	}
 
+	// LOS vector in H matrix of last iteration assigned to satellite information
+	for (i = 0; i < ObsCount; i ++)
+	{
+		Geometry->SatInfo[i]->VectorX = g_PvtCoreData.h.data[0][i];
+		Geometry->SatInfo[i]->VectorY = g_PvtCoreData.h.data[1][i];
+		Geometry->SatInfo[i]->VectorZ = g_PvtCoreData.h.data[2][i];
+		Geometry->SatInfo[i]->SatInfoFlag |= SAT_INFO_LOS_VALID | SAT_INFO_LOS_MATCH;
+	}
+
+	// integrity check of converged solution, faulty observations excluded from velocity calculation
+	if ((g_PvtConfig.PvtConfigFlags & PVT_CONFIG_RAIM) && iteration < LoopCount)
+	{
+		if ((ObsCount = RaimFde(ObservationList, ObsCount, DeltaMsr, SolutionDelta, SystemNumber, SystemIndex)) < 0)
+			return 0;
+	}
+
+	// observation list changed by exclusion, otherwise use geometry of last iteration (position change less than 1mm)
+	if (ObsCount != Geometry->SatCount)
+	{
+		LoadEpochGeometry(Geometry, ObservationList, ObsCount);
+		UpdateEpochGeometry(Geometry, &(STATE_X));
+	}
+
 	// calculate receiver velocity
 	for (i = 1; i < SystemNumber; i ++)
 		g_PvtCoreData.h.length[0] += g_PvtCoreData.h.length[i];
 
-	PrevFreqID = FREQ_L1CA;
-	SatelliteInfo = g_GpsSatelliteInfo;
+	// relative speed is range rate of satellite minus receiver velocity projected to LOS
 	for (i = 0; i < ObsCount; i ++)
 	{
-		// observations are arranged to put same system together and with order GPS, BDS, Galileo
-		if (ObservationList[i]->FreqID == FREQ_B1C && PrevFreqID != FREQ_B1C)
-		{
-			PrevFreqID = FREQ_B1C;
-			SatelliteInfo = g_BdsSatelliteInfo;
-		}
-		else if (ObservationList[i]->FreqID == FREQ_E1 && PrevFreqID != FREQ_E1)
-		{
-			PrevFreqID = FREQ_E1;
-			SatelliteInfo = g_GalileoSatelliteInfo;
-		}
-		sv_index = ObservationList[i]->svid - 1;
-		DeltaMsr[i] = SatRelativeSpeedXYZ(&STATE_VX, SatelliteInfo[sv_index].PosVel.PosVel) + ObservationList[i]->Doppler;// - STATE_TDOT;
-							
+		DeltaMsr[i] = Geometry->SatRangeRate[i] - (Geometry->LosX[i] * STATE_VX + Geometry->LosY[i] * STATE_VY + Geometry->LosZ[i] * STATE_VZ) * Geometry->RangeScale[i];
+		DeltaMsr[i] += ObservationList[i]->Doppler;// - STATE_TDOT;
 		// for velocity, H matrix has already initialized in position calculation, do not need to calculate again
 //		g_PvtCoreData.h.weight[i] = 1.0;	// weight can be assigned different value for velocity calculation
 	}
@@ -160,6 +182,326 @@ int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
 	return (iteration == LoopCount) ? 0 : UseSystemMask;
 }
 
+//*************** Do LSQ position fix with receiver time error as extra unknown ****************
+//* used when transmit time is recovered from sub-millisecond code phase and predicted PSR
+//* receiver time may have error up to several seconds, satellite position calculated at transmit time
+//* has error of satellite movement, so H matrix has extra column of satellite range rate
+//* and the time error is solved together with position and clock error (GPS only)
+// Parameters:
+//   ObservationList: raw measurement pointer array
+//   ObsCount: number of observations
+//   LoopCount: maximum iteration number
+//   TimeError: receiver time error in second, add to receiver time to get correct time
+// Return value:
+//   -1 for not enough observations
+//	 0 for not converge within given iterations
+//   >0 for success with bit mask indicate participated system
+int PvtFlexibleTime(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount, double *TimeError)
+{
+	int i, j, k, index, iteration;
+	int sv_index;
+	PSATELLITE_INFO SatelliteInfo = g_GpsSatelliteInfo;
+	double SolutionDelta[5];	// 3 position + clock error + time error
+	double DeltaMsr[DIMENSION_MAX_X];
+	double HtH[15], Delta[5], HRow[5];
+	double TempVector[15];
+	double GeoDistance, Time;
+	double Residual;
+	double TimeAdjust = 0.0;
+
+	// GPS observations are placed at beginning of the list
+	for (i = 0; i < ObsCount; i ++)
+		if ((ObservationList[i]->FreqID != FREQ_L1CA) && (ObservationList[i]->FreqID != FREQ_L1C))
+			break;
+	ObsCount = i;
+	if (ObsCount < 5)
+		return -1;
+
+	// LSQ iteration
+	for (iteration = 0; iteration < LoopCount; iteration ++)
+	{
+		for (i = 0; i < 15; i ++)
+			HtH[i] = 0.0;
+		for (i = 0; i < 5; i ++)
+			Delta[i] = 0.0;
+
+		for (i = 0; i < ObsCount; i ++)
+		{
+			sv_index = ObservationList[i]->svid - 1;
+			// recalculate satellite position with transmit time adjusted by time error
+			Time = (ObservationList[i]->TransmitTimeMs + ObservationList[i]->TransmitTime) * 0.001 + TimeAdjust;
+			Time -= ClockCorrection(&g_GpsEphemeris[sv_index], Time);
+			SatPosSpeedEph(Time, &g_GpsEphemeris[sv_index], &(SatelliteInfo[sv_index].PosVel));
+
+			GeoDistance = GeometryDistanceXYZ(&(STATE_X), SatelliteInfo[sv_index].PosVel.PosVel);
+			DeltaMsr[i] = GeoDistance - ObservationList[i]->PseudoRange - STATE_DT_GPS;
+
+			SatelliteInfo[sv_index].VectorX = HRow[0] = g_PvtCoreData.h.data[0][i] = (SatelliteInfo[sv_index].PosVel.x - STATE_X) / GeoDistance;
+			SatelliteInfo[sv_index].VectorY = HRow[1] = g_PvtCoreData.h.data[1][i] = (SatelliteInfo[sv_index].PosVel.y - STATE_Y) / GeoDistance;
+			SatelliteInfo[sv_index].VectorZ = HRow[2] = g_PvtCoreData.h.data[2][i] = (SatelliteInfo[sv_index].PosVel.z - STATE_Z) / GeoDistance;
+			SatelliteInfo[sv_index].SatInfoFlag |= SAT_INFO_LOS_VALID | SAT_INFO_LOS_MATCH;
+			g_PvtCoreData.h.weight[i] = 1.0;
+			HRow[3] = 1.0;
+			// later transmit time gives larger distance if satellite is departing
+			HRow[4] = -(HRow[0] * SatelliteInfo[sv_index].PosVel.vx + HRow[1] * SatelliteInfo[sv_index].PosVel.vy + HRow[2] * SatelliteInfo[sv_index].PosVel.vz);
+
+			// accumulate HtH (lower triangle in vector format) and Ht*DeltaMsr
+			for (j = 0, index = 0; j < 5; j ++)
+			{
+				Delta[j] += HRow[j] * DeltaMsr[i];
+				for (k = 0; k <= j; k ++)
+					HtH[index ++] += HRow[j] * HRow[k];
+			}
+		}
+
+		SymMatrixInv(HtH, TempVector, 5);
+		SymMatrixMultiply(SolutionDelta, HtH, Delta, 5);
+
+		// apply correction
+		STATE_X += SolutionDelta[0];
+		STATE_Y += SolutionDelta[1];
+		STATE_Z += SolutionDelta[2];
+		STATE_DT_GPS += SolutionDelta[3];
+		TimeAdjust += SolutionDelta[4];
+
+		Residual = fabs(SolutionDelta[0]) + fabs(SolutionDelta[1]) + fabs(SolutionDelta[2]);
+		if (Residual < 1e-3)
+			break;
+	}
+	*TimeError = TimeAdjust;
+
+	// calculate receiver velocity
+	for (i = 0; i < PVT_MAX_SYSTEM_ID; i ++)
+		g_PvtCoreData.h.length[i] = 0;
+	g_PvtCoreData.h.length[0] = ObsCount;
+	for (i = 0; i < ObsCount; i ++)
+	{
+		sv_index = ObservationList[i]->svid - 1;
+		DeltaMsr[i] = SatRelativeSpeedXYZ(&STATE_VX, SatelliteInfo[sv_index].PosVel.PosVel) + ObservationList[i]->Doppler;
+	}
+	LSQResolve(SolutionDelta, &(g_PvtCoreData.h), DeltaMsr, g_PvtCoreData.PosInvMatrix, 1);
+
+	// assign result
+	STATE_VX = SolutionDelta[0];
+	STATE_VY = SolutionDelta[1];
+	STATE_VZ = SolutionDelta[2];
+	STATE_TDOT = SolutionDelta[3];
+
+	return (iteration == LoopCount) ? 0 : PVT_USE_GPS;
+}
+
+//*************** Do LSQ coarse position fix using Doppler only ****************
+//* used when receiver position is unknown, receiver is assumed to be static on earth surface
+//* the cost function has local minima far from truth, so the iteration is started from average position
+//* of satellites and from sub-satellite point of each satellite, each candidate is accepted only if
+//* it converges within LoopCount, post-fit residual RMS and Doppler DOP pass the threshold
+//* the candidate with minimum residual is used, if another accepted candidate far away has residual
+//* comparable to it, the fix is ambiguous and rejected
+//* receiver state is only updated on success, so a diverged solution will never be used for aiding
+// Parameters:
+//   ObservationList: raw measurement pointer array (GPS only)
+//   ObsCount: number of observations
+//   LoopCount: maximum iteration number of each candidate
+// Return value:
+//   -1 for not enough observations, no candidate passes check or ambiguous result
+//	 0 for no candidate converges within given iterations
+//   >0 for success with bit mask indicate participated system
+int PvtDopplerLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount)
+{
+	int i, start, result;
+	int Converged = 0;
+	PSATELLITE_INFO SatelliteInfo = g_GpsSatelliteInfo;
+	double State[4], BestState[4], SecondState[4];	// position + clock drifting
+	double Residual, Dop, Distance;
+	double BestResidual = -1.0, SecondResidual = -1.0;
+
+	// one redundant observation is needed to verify solution with residual
+	if (ObsCount < DOPPLER_FIX_MIN_OBS)
+		return -1;
+
+	for (start = -1; start < ObsCount; start ++)
+	{
+		// first start from average position of satellites, then from each sub-satellite point
+		// (the position will be scaled to earth surface at the beginning of each iteration)
+		State[0] = State[1] = State[2] = State[3] = 0.0;
+		for (i = (start < 0) ? 0 : start; i < ((start < 0) ? ObsCount : start + 1); i ++)
+		{
+			State[0] += SatelliteInfo[ObservationList[i]->svid - 1].PosVel.x;
+			State[1] += SatelliteInfo[ObservationList[i]->svid - 1].PosVel.y;
+			State[2] += SatelliteInfo[ObservationList[i]->svid - 1].PosVel.z;
+		}
+
+		result = DopplerLsqSolve(ObservationList, ObsCount, LoopCount, State, &Residual, &Dop);
+		if (result == 0)
+			continue;
+		Converged = 1;
+		// post-fit residual RMS with 4 parameters removed and horizontal geometry of the solution
+		if (Residual > (ObsCount - 4) * DOPPLER_FIX_MAX_RMS * DOPPLER_FIX_MAX_RMS || Dop > DOPPLER_FIX_MAX_DOP)
+			continue;
+
+		// keep minimum residual solution and the best one far away from it
+		if (BestResidual >= 0.0)
+		{
+			Distance = sqrt((State[0] - BestState[0]) * (State[0] - BestState[0]) + (State[1] - BestState[1]) * (State[1] - BestState[1]) + (State[2] - BestState[2]) * (State[2] - BestState[2]));
+			if (Distance < DOPPLER_FIX_SAME_DISTANCE)
+			{
+				if (Residual < BestResidual)
+				{
+					BestResidual = Residual;
+					for (i = 0; i < 4; i ++) BestState[i] = State[i];
+				}
+				continue;
+			}
+		}
+		if (BestResidual < 0.0 || Residual < BestResidual)
+		{
+			if (BestResidual >= 0.0)
+			{
+				SecondResidual = BestResidual;
+				for (i = 0; i < 4; i ++) SecondState[i] = BestState[i];
+			}
+			BestResidual = Residual;
+			for (i = 0; i < 4; i ++) BestState[i] = State[i];
+		}
+		else if (SecondResidual < 0.0 || Residual < SecondResidual)
+		{
+			SecondResidual = Residual;
+			for (i = 0; i < 4; i ++) SecondState[i] = State[i];
+		}
+	}
+
+	if (BestResidual < 0.0)
+		return Converged ? -1 : 0;
+	// a second solution far away explains the measurements nearly as well, can not tell which is right
+	if (SecondResidual >= 0.0)
+	{
+		Distance = sqrt((SecondState[0] - BestState[0]) * (SecondState[0] - BestState[0]) + (SecondState[1] - BestState[1]) * (SecondState[1] - BestState[1]) + (SecondState[2] - BestState[2]) * (SecondState[2] - BestState[2]));
+		if (Distance >= DOPPLER_FIX_SAME_DISTANCE && SecondResidual < BestResidual * DOPPLER_FIX_AMBIGUITY_RATIO + (ObsCount - 4) * DOPPLER_FIX_NOISE_FLOOR)
+			return -1;
+	}
+
+	STATE_X = BestState[0];
+	STATE_Y = BestState[1];
+	STATE_Z = BestState[2];
+	STATE_TDOT = BestState[3];
+
+	return PVT_USE_GPS;
+}
+
+//*************** Iterate Doppler only LSQ from one initial position ****************
+//* position is scaled to earth radius after each iteration because height is hardly observable
+//* horizontal step is limited to DOPPLER_FIX_MAX_STEP to avoid jumping over to another local minimum
+//* after convergence, residual and geometry are evaluated again at the final position
+// Parameters:
+//   ObservationList: raw measurement pointer array (GPS only)
+//   ObsCount: number of observations
+//   LoopCount: maximum iteration number
+//   State: initial position and clock drifting as input, solution as output
+//   Residual: sum of squared post-fit residual
+//   Dop: horizontal DOP from Inv(HtH), horizontal position error in meter per m/s Doppler error
+// Return value:
+//   1 for converge, 0 for not converge within given iterations
+static int DopplerLsqSolve(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount, double *State, double *Residual, double *Dop)
+{
+	int iteration;
+	double SolutionDelta[4];
+	double HtH[10], Delta[4], Up[3];
+	double TempVector[10];
+	double Scale, Step;
+
+	for (iteration = 0; iteration < LoopCount; iteration ++)
+	{
+		DopplerLsqAccumulate(ObservationList, ObsCount, State, HtH, Delta);
+		SymMatrixInv(HtH, TempVector, 4);
+		SymMatrixMultiply(SolutionDelta, HtH, Delta, 4);
+
+		// vertical part of correction is removed by scaling, only check horizontal movement
+		Scale = (SolutionDelta[0] * State[0] + SolutionDelta[1] * State[1] + SolutionDelta[2] * State[2]) / WGS_AXIS_A;
+		Step = SolutionDelta[0] * SolutionDelta[0] + SolutionDelta[1] * SolutionDelta[1] + SolutionDelta[2] * SolutionDelta[2] - Scale * Scale;
+		// damp large step, clock drifting is linear and not limited
+		Scale = (Step > DOPPLER_FIX_MAX_STEP * DOPPLER_FIX_MAX_STEP) ? DOPPLER_FIX_MAX_STEP / sqrt(Step) : 1.0;
+		State[0] += SolutionDelta[0] * Scale;
+		State[1] += SolutionDelta[1] * Scale;
+		State[2] += SolutionDelta[2] * Scale;
+		State[3] += SolutionDelta[3];
+		if (Step < 100.0)
+			break;
+	}
+	if (iteration == LoopCount)
+		return 0;
+
+	*Residual = DopplerLsqAccumulate(ObservationList, ObsCount, State, HtH, Delta);
+	SymMatrixInv(HtH, TempVector, 4);
+	// remove vertical variance U'*P*U from trace of position part, U is unit up vector
+	Up[0] = State[0] / WGS_AXIS_A;
+	Up[1] = State[1] / WGS_AXIS_A;
+	Up[2] = State[2] / WGS_AXIS_A;
+	Scale = Up[0] * Up[0] * HtH[0] + Up[1] * Up[1] * HtH[2] + Up[2] * Up[2] * HtH[5] + 2 * (Up[0] * Up[1] * HtH[1] + Up[0] * Up[2] * HtH[3] + Up[1] * Up[2] * HtH[4]);
+	Scale = HtH[0] + HtH[2] + HtH[5] - Scale;
+	*Dop = (Scale > 0.0) ? sqrt(Scale) : 0.0;
+
+	return 1;
+}
+
+//*************** Accumulate HtH and Ht*DeltaMsr of Doppler only LSQ ****************
+//* position is scaled to earth surface first
+//* Doppler of each satellite is minus range rate LOS*Vs plus receiver clock drifting, range rate changes
+//* with receiver position with partial derivative -(Vs-(LOS*Vs)*LOS)/r, so H row is (Vs-(LOS*Vs)*LOS)/r
+//* satellite position and velocity should be calculated in advance
+// Parameters:
+//   ObservationList: raw measurement pointer array (GPS only)
+//   ObsCount: number of observations
+//   State: receiver position and clock drifting
+//   HtH: HtH in lower triangle vector format
+//   Delta: Ht*DeltaMsr
+// Return value:
+//   sum of squared Doppler residual
+static double DopplerLsqAccumulate(PCHANNEL_STATUS ObservationList[], int ObsCount, double *State, double *HtH, double *Delta)
+{
+	int i, j, k, index;
+	PSATELLITE_INFO SatelliteInfo;
+	double HRow[4], Los[3];
+	double GeoDistance, RangeRate, DeltaMsr, Scale;
+	double Residual = 0.0;
+
+	Scale = WGS_AXIS_A / sqrt(State[0] * State[0] + State[1] * State[1] + State[2] * State[2]);
+	State[0] *= Scale;
+	State[1] *= Scale;
+	State[2] *= Scale;
+
+	for (i = 0; i < 10; i ++)
+		HtH[i] = 0.0;
+	for (i = 0; i < 4; i ++)
+		Delta[i] = 0.0;
+
+	for (i = 0; i < ObsCount; i ++)
+	{
+		SatelliteInfo = &g_GpsSatelliteInfo[ObservationList[i]->svid - 1];
+		GeoDistance = GeometryDistanceXYZ(State, SatelliteInfo->PosVel.PosVel);
+		Los[0] = (SatelliteInfo->PosVel.x - State[0]) / GeoDistance;
+		Los[1] = (SatelliteInfo->PosVel.y - State[1]) / GeoDistance;
+		Los[2] = (SatelliteInfo->PosVel.z - State[2]) / GeoDistance;
+		RangeRate = Los[0] * SatelliteInfo->PosVel.vx + Los[1] * SatelliteInfo->PosVel.vy + Los[2] * SatelliteInfo->PosVel.vz;
+		// Doppler is -RangeRate plus clock drifting, same convention as PvtLsq()
+		DeltaMsr = ObservationList[i]->Doppler + RangeRate - State[3];
+		Residual += DeltaMsr * DeltaMsr;
+
+		HRow[0] = (SatelliteInfo->PosVel.vx - RangeRate * Los[0]) / GeoDistance;
+		HRow[1] = (SatelliteInfo->PosVel.vy - RangeRate * Los[1]) / GeoDistance;
+		HRow[2] = (SatelliteInfo->PosVel.vz - RangeRate * Los[2]) / GeoDistance;
+		HRow[3] = 1.0;
+
+		for (j = 0, index = 0; j < 4; j ++)
+		{
+			Delta[j] += HRow[j] * DeltaMsr;
+			for (k = 0; k <= j; k ++)
+				HtH[index ++] += HRow[j] * HRow[k];
+		}
+	}
+
+	return Residual;
+}
+
 /*******************************************
 * LSQ resolve of DeltaPsr=H*DeltaPos
 *********************************************/
@@ -188,3 +530,217 @@ void LSQResolve(double *DeltaPos, PHMATRIX H, double *DeltaPsr, double *InvMatri
 	// calculate Inv(HtH)*Delta
 	SymMatrixMultiply(DeltaPos, InvMatrix, Delta, dim+3);
 }
+
+//*************** Receiver autonomous integrity monitoring with fault detection and exclusion ****************
+//* uses Inv(HtWH) of converged LSQ and post-fit residual, each leave-one-out solution is derived
+//* by rank-one downdate (Sherman-Morrison) instead of recalculating matrix inversion:
+//*   leverage l=w*h'Ph, SSE without observation i is SSE-w*r^2/(1-l)
+//*   solution without observation i is x-Ph*w*r/(1-l), Inv(HtWH) becomes P+w*Ph*h'P/(1-l)
+//* observation with minimum SSE after exclusion is excluded until SSE passes chi-square test
+//* or maximum exclusion number reached, protection levels are calculated with final geometry
+// Parameters:
+//   ObservationList: raw measurement pointer array, excluded observations removed on return
+//   ObsCount: number of observations
+//   DeltaMsr: measurement difference of last LSQ iteration
+//   SolutionDelta: solution of last LSQ iteration
+//   SystemNumber: number of system participated
+//   SystemIndex: clock error index of each participated system
+// Return value:
+//   number of observations after exclusion, -1 if fault detected but can not be excluded
+int RaimFde(PCHANNEL_STATUS ObservationList[], int ObsCount, double *DeltaMsr, double *SolutionDelta, int SystemNumber, int SystemIndex[])
+{
+	int i, j, k, dim = SystemNumber + 3;
+	int ExcludeIndex, ExcludeCount = 0, ActiveCount = ObsCount;
+	unsigned char ObsSystem[DIMENSION_MAX_X], ObsActive[DIMENSION_MAX_X];
+	double P[PVT_MAX_SYSTEM_ID+3][PVT_MAX_SYSTEM_ID+3];
+	double Residual[DIMENSION_MAX_X], PH[PVT_MAX_SYSTEM_ID+3], HRow[PVT_MAX_SYSTEM_ID+3], DeltaX[PVT_MAX_SYSTEM_ID+3];
+	double SSE, ExcludeSSE, Leverage, Threshold = 0.0, Slope, MaxSlopeH = 0.0, MaxSlopeV = 0.0;
+	double Variance = g_PvtConfig.RaimSigma * g_PvtConfig.RaimSigma;
+	double Value, East, North, Up;
+	PCONVERT_MATRIX ConvertMatrix = &(g_ReceiverInfo.ConvertMatrix);
+
+	// unpack Inv(HtWH) from vector format
+	for (i = 0, k = 0; i < dim; i ++)
+		for (j = 0; j <= i; j ++, k ++)
+			P[i][j] = P[j][i] = g_PvtCoreData.PosInvMatrix[k];
+
+	// system of each observation and post-fit residual
+	for (i = 0, k = 0; k < SystemNumber; k ++)
+		for (j = 0; j < g_PvtCoreData.h.length[k]; j ++, i ++)
+			ObsSystem[i] = (unsigned char)k;
+	SSE = 0.0;
+	for (i = 0; i < ObsCount; i ++)
+	{
+		ComposeHRow(HRow, i, dim, ObsSystem[i]);
+		Residual[i] = DeltaMsr[i];
+		for (j = 0; j < dim; j ++)
+			Residual[i] -= HRow[j] * SolutionDelta[j];
+		SSE += g_PvtCoreData.h.weight[i] * Residual[i] * Residual[i];
+		ObsActive[i] = 1;
+	}
+
+	g_ReceiverInfo.ProtectionLevel[0] = g_ReceiverInfo.ProtectionLevel[1] = 0.0;
+	while (1)
+	{
+		// RAIM not available without redundant observations
+		if (ActiveCount <= dim)
+			break;
+		Threshold = ChiSquareThreshold(ActiveCount - dim);
+		if (SSE <= Threshold * Variance)
+			break;
+		// fault detected, exclusion needs at least one more redundant observation
+		if (ExcludeCount >= g_PvtConfig.RaimMaxExclude || ActiveCount <= dim + 1)
+			return -1;
+
+		// find observation that gives minimum SSE after exclusion
+		ExcludeIndex = -1;
+		ExcludeSSE = SSE;
+		for (i = 0; i < ObsCount; i ++)
+		{
+			if (!ObsActive[i])
+				continue;
+			ComposeHRow(HRow, i, dim, ObsSystem[i]);
+			Leverage = 0.0;
+			for (j = 0; j < dim; j ++)
+			{
+				for (k = 0, PH[j] = 0.0; k < dim; k ++)
+					PH[j] += P[j][k] * HRow[k];
+				Leverage += HRow[j] * PH[j];
+			}
+			Leverage = 1.0 - g_PvtCoreData.h.weight[i] * Leverage;
+			if (Leverage < 1e-6)	// only observation of its system, exclusion makes matrix singular
+				continue;
+			Value = SSE - g_PvtCoreData.h.weight[i] * Residual[i] * Residual[i] / Leverage;
+			if (Value < ExcludeSSE)
+			{
+				ExcludeSSE = Value;
+				ExcludeIndex = i;
+			}
+		}
+		if (ExcludeIndex < 0)
+			return -1;
+
+		// downdate solution, residual and Inv(HtWH) to remove excluded observation
+		ComposeHRow(HRow, ExcludeIndex, dim, ObsSystem[ExcludeIndex]);
+		Leverage = 0.0;
+		for (j = 0; j < dim; j ++)
+		{
+			for (k = 0, PH[j] = 0.0; k < dim; k ++)
+				PH[j] += P[j][k] * HRow[k];
+			Leverage += HRow[j] * PH[j];
+		}
+		Value = g_PvtCoreData.h.weight[ExcludeIndex] / (1.0 - g_PvtCoreData.h.weight[ExcludeIndex] * Leverage);
+		for (j = 0; j < dim; j ++)
+			DeltaX[j] = -PH[j] * Value * Residual[ExcludeIndex];
+		for (j = 0; j < dim; j ++)
+			for (k = 0; k < dim; k ++)
+				P[j][k] += PH[j] * PH[k] * Value;
+		for (i = 0; i < ObsCount; i ++)
+		{
+			ComposeHRow(HRow, i, dim, ObsSystem[i]);
+			for (j = 0; j < dim; j ++)
+				Residual[i] -= HRow[j] * DeltaX[j];
+		}
+		STATE_X += DeltaX[0];
+		STATE_Y += DeltaX[1];
+		STATE_Z += DeltaX[2];
+		for (i = 0; i < SystemNumber; i ++)
+			g_PvtCoreData.StateVector[SystemIndex[i]+7] += DeltaX[3+i];
+
+		SSE = ExcludeSSE;
+		ObsActive[ExcludeIndex] = 0;
+		ActiveCount --;
+		ExcludeCount ++;
+	}
+
+	// protection levels use maximum slope of position error to test statistic among observations
+	if (ActiveCount > dim)
+	{
+		for (i = 0; i < ObsCount; i ++)
+		{
+			if (!ObsActive[i])
+				continue;
+			ComposeHRow(HRow, i, dim, ObsSystem[i]);
+			Leverage = 0.0;
+			for (j = 0; j < dim; j ++)
+			{
+				for (k = 0, PH[j] = 0.0; k < dim; k ++)
+					PH[j] += P[j][k] * HRow[k];
+				Leverage += HRow[j] * PH[j];
+			}
+			Leverage = 1.0 - g_PvtCoreData.h.weight[i] * Leverage;
+			if (Leverage < 1e-6)
+				continue;
+			East = ConvertMatrix->x2e * PH[0] + ConvertMatrix->y2e * PH[1];
+			North = ConvertMatrix->x2n * PH[0] + ConvertMatrix->y2n * PH[1] + ConvertMatrix->z2n * PH[2];
+			Up = ConvertMatrix->x2u * PH[0] + ConvertMatrix->y2u * PH[1] + ConvertMatrix->z2u * PH[2];
+			Value = g_PvtCoreData.h.weight[i] / Leverage;
+			Slope = (East * East + North * North) * Value;
+			if (MaxSlopeH < Slope)
+				MaxSlopeH = Slope;
+			Slope = Up * Up * Value;
+			if (MaxSlopeV < Slope)
+				MaxSlopeV = Slope;
+		}
+		Value = g_PvtConfig.RaimSigma * (sqrt(Threshold) + RAIM_MISSED_DETECTION_K);
+		g_ReceiverInfo.ProtectionLevel[0] = sqrt(MaxSlopeH) * Value;
+		g_ReceiverInfo.ProtectionLevel[1] = sqrt(MaxSlopeV) * Value;
+	}
+
+	// remove excluded observations from list and H matrix
+	if (ExcludeCount > 0)
+	{
+		for (i = 0, k = 0; i < ObsCount; i ++)
+		{
+			if (!ObsActive[i])
+			{
+				g_PvtCoreData.h.length[ObsSystem[i]] --;
+				continue;
+			}
+			ObservationList[k] = ObservationList[i];
+			g_PvtCoreData.h.data[0][k] = g_PvtCoreData.h.data[0][i];
+			g_PvtCoreData.h.data[1][k] = g_PvtCoreData.h.data[1][i];
+			g_PvtCoreData.h.data[2][k] = g_PvtCoreData.h.data[2][i];
+			g_PvtCoreData.h.weight[k] = g_PvtCoreData.h.weight[i];
+			k ++;
+		}
+		ObsCount = k;
+	}
+
+	return ObsCount;
+}
+
+//*************** Chi-square test threshold of RAIM ****************
+//* Wilson-Hilferty approximation of inverse chi-square distribution with false alarm probability 1e-5
+// Parameters:
+//   Dof: degree of freedom
+// Return value:
+//   threshold of normalized SSE
+double ChiSquareThreshold(int Dof)
+{
+	double Value = 2.0 / (9.0 * Dof);
+
+	Value = 1.0 - Value + RAIM_FALSE_ALARM_Z * sqrt(Value);
+	return Dof * Value * Value * Value;
+}
+
+//*************** Compose one row of H matrix ****************
+//* 3 LOS elements followed by 1 at clock error position of its system
+// Parameters:
+//   HRow: place to hold H matrix row
+//   Index: index of observation
+//   Dim: dimension of H matrix row
+//   System: system index of the observation
+// Return value:
+//   none
+void ComposeHRow(double *HRow, int Index, int Dim, int System)
+{
+	int i;
+
+	HRow[0] = g_PvtCoreData.h.data[0][Index];
+	HRow[1] = g_PvtCoreData.h.data[1][Index];
+	HRow[2] = g_PvtCoreData.h.data[2][Index];
+	for (i = 3; i < Dim; i ++)
+		HRow[i] = 0.0;
+	HRow[3 + System] = 1.0;
+}
@@ -19,6 +19,7 @@
 #include <stdio.h>
 
 static int PvtFix(int MsInterval);
+static int DopplerPosFix(void);
 static PositionType GetPosMethod(PCHANNEL_STATUS ObservationList[], int *Count, PositionType PrevPosType);
 
 // in order to adapt to multiple system, state placement in core data is as following:
@@ -98,6 +99,9 @@ void PvtProc(int CurMsInterval)
 	int PosFixResult;
 	SYSTEM_TIME UtcTime;
 
+	// get coarse position by Doppler positioning if there is no receiver position
+	if (g_ReceiverInfo.PosQuality == UnknownPos && g_ReceiverInfo.GpsTimeQuality >= ExtSetTime)
+		DopplerPosFix();
 	PosFixResult = PvtFix(CurMsInterval);
 	// TODO: update satellite in view list, adjust observation time etc.
 	if (1 && PosFixResult >= 0)
@@ -130,8 +134,8 @@ int PvtFix(int MsInterval)
 	int i, PosResult;
 	int SatCount = 0;
 	PCHANNEL_STATUS ObservationList[DIMENSION_MAX_X];
-	double DeltaT;
-	const double Q[3] = { 25.0, 25.0, 0.25 };	// Qh and Qv are 5^2, Qf is 0.5^2;
+	double DeltaT, TimeError;
+	const double Q[3] = { KF_QH, KF_QV, KF_QF };
 	int PosUseSatCount[PVT_MAX_SYSTEM_ID];
 
 	// use position in g_ReceiverInfo as initial position/velocity
@@ -155,6 +159,8 @@ int PvtFix(int MsInterval)
 	{
 		if ((g_ChannelStatus[i].FreqID != FREQ_L1CA) && (g_ChannelStatus[i].FreqID != FREQ_L1C))
 			continue;
+		if (g_ChannelStatus[i].svid > MAX_GPS_SAT_ID)	// SBAS satellite not used in position fix
+			continue;
 		if ((g_ChannelStatus[i].ChannelFlag & MEASUREMENT_VALID) && g_GpsEphemeris[g_ChannelStatus[i].svid-1].flag)
 			ObservationList[SatCount++] = &g_ChannelStatus[i];
 	}
@@ -184,6 +190,8 @@ int PvtFix(int MsInterval)
 
 	g_ReceiverInfo.PrevPosType = g_ReceiverInfo.CurrentPosType;
 	g_ReceiverInfo.CurrentPosType = GetPosMethod(ObservationList, &SatCount, g_ReceiverInfo.PrevPosType);
+	// geometry loaded in CalcSatelliteInfo() has observations removed by filtering
+	LoadEpochGeometry(&(g_PvtCoreData.Geometry), ObservationList, SatCount);
 
 	// state prediction using constant velocity model
 	DeltaT = MsInterval / 1000.0;
@@ -231,13 +239,25 @@ int PvtFix(int MsInterval)
 	}
 	else if (g_ReceiverInfo.CurrentPosType == PosTypeFlexTime)	// unknown transmit time PVT
 	{
-/*		if ((MsAdjust = PvtFlexibleTime(ObservationList, SatCount)) == 0x80000000)
+		if ((PosResult = PvtFlexibleTime(ObservationList, SatCount, 7, &TimeError)) <= 0)
 		{
 			return -1;
 		}
-		g_ReceiverInfo.GpsMsCount += MsAdjust;
+		// adjust receiver time with integer millisecond, remaining error less than 0.5ms is negligible to satellite position
+		g_ReceiverInfo.GpsMsCount += (int)floor(TimeError * 1000 + 0.5);
+		if (g_ReceiverInfo.GpsMsCount < 0)
+		{
+			g_ReceiverInfo.GpsMsCount += 604800000;
+			g_ReceiverInfo.WeekNumber --;
+		}
+		else if (g_ReceiverInfo.GpsMsCount >= 604800000)
+		{
+			g_ReceiverInfo.GpsMsCount -= 604800000;
+			g_ReceiverInfo.WeekNumber ++;
+		}
 		g_ReceiverInfo.PosQuality = FlexTimePos;
-		g_ReceiverInfo.GpsTimeQuality = FlexTime;*/
+		g_ReceiverInfo.GpsTimeQuality = FlexTime;
+		g_ReceiverInfo.PosFlag |= PosResult;
 	}
 
 	// for LSQ, determine whether can transfer to KF
@@ -264,6 +284,53 @@ int PvtFix(int MsInterval)
 	return 0;
 }
 
+//*************** Coarse position fix using Doppler of tracking L1C/A channels ****************
+//* satellite position and velocity are calculated by ephemeris or by almanac if ephemeris not available
+//* the result is used as external set position to do satellite prediction for acquisition
+// Parameters:
+//   none
+// Return value:
+//   -1 if Doppler positioning fails, otherwise 0
+int DopplerPosFix(void)
+{
+	int i, sv_index;
+	int SatCount = 0;
+	PCHANNEL_STATUS ObservationList[DIMENSION_MAX_X];
+	double Time;
+
+	// satellite position at receiver time minus nominal travel time
+	Time = (g_ReceiverInfo.GpsMsCount - 75) * 0.001;
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER && SatCount < DIMENSION_MAX_X; i ++)
+	{
+		if (!(g_ChannelStatus[i].ChannelFlag & CHANNEL_ACTIVE) || g_ChannelStatus[i].FreqID != FREQ_L1CA)
+			continue;
+		if (((g_ChannelStatus[i].state & STAGE_MASK) < STAGE_TRACK) || g_ChannelStatus[i].cn0 < 1000)
+			continue;
+		sv_index = g_ChannelStatus[i].svid - 1;
+		if (g_GpsEphemeris[sv_index].flag)
+			SatPosSpeedEph(Time, &g_GpsEphemeris[sv_index], &(g_GpsSatelliteInfo[sv_index].PosVel));
+		else if (g_GpsAlmanac[sv_index].flag && g_ReceiverInfo.WeekNumber >= 0)
+			GpsSatPosSpeedAlm(g_ReceiverInfo.WeekNumber, (int)Time, &g_GpsAlmanac[sv_index], &(g_GpsSatelliteInfo[sv_index].PosVel));
+		else
+			continue;
+		g_GpsSatelliteInfo[sv_index].SatInfoFlag = SAT_INFO_POSVEL_VALID | (g_GpsEphemeris[sv_index].flag ? SAT_INFO_BY_EPH : 0);
+		ObservationList[SatCount++] = &g_ChannelStatus[i];
+	}
+
+	if (PvtDopplerLsq(ObservationList, SatCount, 10) <= 0)
+		return -1;
+
+	g_ReceiverInfo.PosVel.x = STATE_X;
+	g_ReceiverInfo.PosVel.y = STATE_Y;
+	g_ReceiverInfo.PosVel.z = STATE_Z;
+	g_ReceiverInfo.PosVel.vx = g_ReceiverInfo.PosVel.vy = g_ReceiverInfo.PosVel.vz = 0.0;
+	g_ReceiverInfo.ClkDrifting = STATE_TDOT / LIGHT_SPEED;
+	EcefToLlh(&(g_ReceiverInfo.PosVel), &(g_ReceiverInfo.PosLLH));
+	g_ReceiverInfo.PosQuality = ExtSetPos;
+	g_ReceiverInfo.PosFlag |= DOPPLER_POS_AIDING;
+	return 0;
+}
+
 //*************** Determine method to do position fix ****************
 //* the determination uses the following order:
 //* first to check whether can do Kalman filter
@@ -302,7 +369,8 @@ PositionType GetPosMethod(PCHANNEL_STATUS ObservationList[], int *Count, Positio
 	if (SystemMask & PVT_USE_BDS) RedundantSat --;
 	if (SystemMask & PVT_USE_GAL) RedundantSat --;
 
-	if (ObservationList[0]->ChannelFlag & TRANSTIME_ESTIMATE)	// transmit time is estimated, need one extra observation
+	// transmit time is estimated and receiver time not accurate enough, need one extra observation
+	if ((ObservationList[0]->ChannelFlag & TRANSTIME_ESTIMATE) && g_ReceiverInfo.GpsTimeQuality < FlexTime)
 		return (RedundantSat >= 4) ? PosTypeFlexTime : PosTypeNone;
 	else if (RedundantSat >= 2)
 		return (RedundantSat == 2) ? PosType2D : PosTypeLSQ;
@@ -7,18 +7,21 @@
 //----------------------------------------------------------------------
 
 #include "DataTypes.h"
+#include "SupportPackage.h"
 #include <math.h>
 
 #define COS_5 0.99619469809174553
 #define SIN_5 0.087155742747658173559
 
+#define SAT_POS_BATCH_SIZE 16	// number of satellites in one group of batch position calculation
+
 //*************** Calculate satellite clock correction ****************
 // Parameters:
 //   pEph: pointer to ephemeris
 //   TransmitTime: transmit time within week
 // Return value:
 //   satellite clock correction
-double ClockCorrection(PGNSS_EPHEMERIS pEph, double TransmitTime)
+double ClockCorrection(const GNSS_EPHEMERIS *pEph, double TransmitTime)
 {
 	double TimeDiff = TransmitTime - pEph->toc;
 	double ClockAdj;
@@ -40,114 +43,173 @@ double ClockCorrection(PGNSS_EPHEMERIS pEph, double TransmitTime)
 //   pointer to satellite position and velocity
 // Return value:
 //   0 if ephemeris expire, otherwise 1
-int SatPosSpeedEph(double TransmitTime, PGNSS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel)
+int SatPosSpeedEph(double TransmitTime, const GNSS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel)
 {
-	int i;
-	double delta_t;
-	double Mk, Ek, Ek1, Ek_dot;
-	double phi, phi_dot;
-	double uk, rk, ik;
-	double uk_dot, rk_dot, ik_dot;
-	double xp, yp, omega;
-	double xp_dot, yp_dot;
-	double sin_temp, cos_temp;
+	int EphOK;
 
-	// calculate time difference
-	delta_t = TransmitTime - pEph->toe;
-	// protection for time ring back at week end
-	if (delta_t > 302400.0)
-		delta_t -= 604800;
-	if (delta_t < -302400.0)
-		delta_t += 604800;
+	SatPosSpeedEphBatch(1, &TransmitTime, &pEph, &pPosVel, &EphOK);
+	return EphOK;
+}
 
-	// get Ek from Mk with recursive algorithm
-	Ek1 = Ek = Mk = pEph->M0 + (pEph->n * delta_t);
-	for (i = 0; i < 10; i ++)
+//*************** Calculate satellite position and velocity of multiple satellites using ephemeris ****************
+//* ephemeris is read only, derived variables are calculated on publish
+//* satellites are processed in groups of SAT_POS_BATCH_SIZE, sin()/cos() are evaluated in separate loops
+//* over angle arrays so that compiler can vectorize them with SIMD math library
+//* Ek is solved by two Newton-Raphson iterations from initial value with error in order of ecc^3,
+//* sin/cos of final Ek, 2phi and u(k) are derived with angle addition instead of atan2()/sin()/cos()
+// Parameters:
+//   Number: number of satellites
+//   TransmitTime: array of transmit time within week
+//   EphList: array of pointers to ephemeris
+//   PosVelList: array of pointers to satellite position and velocity
+//   EphOK: array to hold result of each satellite, 0 if ephemeris expire, otherwise 1
+// Return value:
+//   none
+void SatPosSpeedEphBatch(int Number, const double *TransmitTime, const GNSS_EPHEMERIS *const *EphList, PKINEMATIC_INFO *PosVelList, int *EphOK)
+{
+	int i, Start, Count;
+	const GNSS_EPHEMERIS *pEph;
+	PKINEMATIC_INFO pPosVel;
+	double delta_t[SAT_POS_BATCH_SIZE], Mk[SAT_POS_BATCH_SIZE], Ek[SAT_POS_BATCH_SIZE];
+	double Ecc[SAT_POS_BATCH_SIZE], Perigee[SAT_POS_BATCH_SIZE];
+	double SinA[SAT_POS_BATCH_SIZE], CosA[SAT_POS_BATCH_SIZE], SinB[SAT_POS_BATCH_SIZE], CosB[SAT_POS_BATCH_SIZE];
+	double ik[SAT_POS_BATCH_SIZE], omega[SAT_POS_BATCH_SIZE];
+	double xp[SAT_POS_BATCH_SIZE], yp[SAT_POS_BATCH_SIZE], xp_dot[SAT_POS_BATCH_SIZE], yp_dot[SAT_POS_BATCH_SIZE], ik_dot[SAT_POS_BATCH_SIZE];
+	double Delta, SinE, CosE, Ek1, Ek_dot;
+	double SinPhi, CosPhi, phi_dot, du;
+	double rk, uk_dot, rk_dot;
+	double sin_temp, cos_temp, temp;
+
+	for (Start = 0; Start < Number; Start += SAT_POS_BATCH_SIZE)
 	{
-		Ek = Mk + pEph->ecc * sin(Ek);
-		if (fabs(Ek - Ek1) < 1e-14)
-			break;
-		Ek1 = Ek;
-	}
-	pEph->Ek = Ek;
+		Count = Number - Start;
+		if (Count > SAT_POS_BATCH_SIZE)
+			Count = SAT_POS_BATCH_SIZE;
 
-	// assign Ek1 as 1-e*cos(Ek)
-	Ek1 = 1.0 - (pEph->ecc * cos(Ek));
+		// calculate time difference and mean anomaly
+		for (i = 0; i < Count; i ++)
+		{
+			pEph = EphList[Start + i];
+			delta_t[i] = TransmitTime[Start + i] - pEph->toe;
+			// protection for time ring back at week end
+			if (delta_t[i] > 302400.0)
+				delta_t[i] -= 604800;
+			if (delta_t[i] < -302400.0)
+				delta_t[i] += 604800;
+			Mk[i] = pEph->M0 + (pEph->n * delta_t[i]);
+			Ecc[i] = pEph->ecc;
+			Perigee[i] = pEph->w;
+		}
 
-	// get phi(k) with atan2
-	phi = atan2(pEph->root_ecc * sin(Ek), cos(Ek) - pEph->ecc) + pEph->w;
-	sin_temp = sin(phi + phi);
-	cos_temp = cos(phi + phi);
+		// initial value of Ek and first Newton-Raphson iteration
+		for (i = 0; i < Count; i ++)
+			Ek[i] = Mk[i] + Ecc[i] * sin(Mk[i]) * (1.0 + Ecc[i] * cos(Mk[i]));
+		for (i = 0; i < Count; i ++)
+			Ek[i] -= (Ek[i] - Ecc[i] * sin(Ek[i]) - Mk[i]) / (1.0 - Ecc[i] * cos(Ek[i]));
+		for (i = 0; i < Count; i ++)
+		{
+			SinA[i] = sin(Ek[i]);
+			CosA[i] = cos(Ek[i]);
+			SinB[i] = sin(Perigee[i]);
+			CosB[i] = cos(Perigee[i]);
+		}
 
-	// get u(k), r(k) and i(k)
-	uk = phi;
-	rk = pEph->axis * Ek1;
-	ik = pEph->i0 + (pEph->idot * delta_t);
-	// apply 2nd order correction to u(k), r(k) and i(k)
-	uk += (pEph->cuc * cos_temp) + (pEph->cus * sin_temp);
-	rk += (pEph->crc * cos_temp) + (pEph->crs * sin_temp);
-	ik += (pEph->cic * cos_temp) + (pEph->cis * sin_temp);
-	// calculate derivatives of r(k) and u(k)
-	Ek_dot = pEph->n / Ek1;
-	uk_dot = phi_dot = Ek_dot * pEph->root_ecc / Ek1;
-	phi_dot = phi_dot * 2.0;
-	rk_dot = pEph->axis * pEph->ecc * sin(Ek) * Ek_dot;
-	rk_dot += ((pEph->crs * cos_temp) - (pEph->crc * sin_temp)) * phi_dot;
-	uk_dot += ((pEph->cus * cos_temp) - (pEph->cuc * sin_temp)) * phi_dot;
-	ik_dot = pEph->idot + ((pEph->cis * cos_temp) - (pEph->cic * sin_temp)) * phi_dot;
+		// second iteration and position/velocity in orbit plane
+		for (i = 0; i < Count; i ++)
+		{
+			pEph = EphList[Start + i];
+			// correction of second iteration is small enough to get sin/cos of Ek with angle addition
+			Delta = (Ek[i] - Ecc[i] * SinA[i] - Mk[i]) / (1.0 - Ecc[i] * CosA[i]);
+			temp = 1.0 - 0.5 * Delta * Delta;
+			SinE = SinA[i] * temp - CosA[i] * Delta;
+			CosE = CosA[i] * temp + SinA[i] * Delta;
+
+			// assign Ek1 as 1-e*cos(Ek)
+			Ek1 = 1.0 - (Ecc[i] * CosE);
+
+			// phi is true anomaly plus w, sin/cos of true anomaly are root_ecc*sin(Ek)/Ek1 and (cos(Ek)-e)/Ek1
+			sin_temp = pEph->root_ecc * SinE / Ek1;
+			cos_temp = (CosE - Ecc[i]) / Ek1;
+			SinPhi = sin_temp * CosB[i] + cos_temp * SinB[i];
+			CosPhi = cos_temp * CosB[i] - sin_temp * SinB[i];
+			sin_temp = 2.0 * SinPhi * CosPhi;
+			cos_temp = CosPhi * CosPhi - SinPhi * SinPhi;
+
+			// get r(k) and i(k) with 2nd order correction, du is correction to u(k)
+			du = (pEph->cuc * cos_temp) + (pEph->cus * sin_temp);
+			rk = pEph->axis * Ek1 + (pEph->crc * cos_temp) + (pEph->crs * sin_temp);
+			ik[i] = pEph->i0 + (pEph->idot * delta_t[i]) + (pEph->cic * cos_temp) + (pEph->cis * sin_temp);
+			// calculate derivatives of r(k) and u(k)
+			Ek_dot = pEph->n / Ek1;
+			uk_dot = phi_dot = Ek_dot * pEph->root_ecc / Ek1;
+			phi_dot = phi_dot * 2.0;
+			rk_dot = pEph->axis * Ecc[i] * SinE * Ek_dot;
+			rk_dot += ((pEph->crs * cos_temp) - (pEph->crc * sin_temp)) * phi_dot;
+			uk_dot += ((pEph->cus * cos_temp) - (pEph->cuc * sin_temp)) * phi_dot;
+			ik_dot[i] = pEph->idot + ((pEph->cis * cos_temp) - (pEph->cic * sin_temp)) * phi_dot;
+
+			// calculate Xp and Yp and corresponding derivatives, u(k) = phi + du with du less than 1e-4
+			temp = 1.0 - 0.5 * du * du;
+			sin_temp = SinPhi * temp + CosPhi * du;
+			cos_temp = CosPhi * temp - SinPhi * du;
+			xp[i] = rk * cos_temp;
+			yp[i] = rk * sin_temp;
+			xp_dot[i] = rk_dot * cos_temp - yp[i] * uk_dot;
+			yp_dot[i] = rk_dot * sin_temp + xp[i] * uk_dot;
+			omega[i] = pEph->omega_t + pEph->omega_delta * delta_t[i];
+		}
 
-	// calculate Xp and Yp and corresponding derivatives
-	sin_temp = sin(uk);
-	cos_temp = cos(uk);
-	xp = rk * cos_temp;
-	yp = rk * sin_temp;
-	xp_dot = rk_dot * cos_temp - yp * uk_dot;
-	yp_dot = rk_dot * sin_temp + xp * uk_dot;
+		for (i = 0; i < Count; i ++)
+		{
+			SinA[i] = sin(omega[i]);
+			CosA[i] = cos(omega[i]);
+			SinB[i] = sin(ik[i]);
+			CosB[i] = cos(ik[i]);
+		}
 
-	// get final position and speed in ECEF coordinate
-	omega = pEph->omega_t + pEph->omega_delta * delta_t;
-	sin_temp = sin(omega);
-	cos_temp = cos(omega);
-	phi = sin(ik);
-	pPosVel->z = yp * phi;
-	pPosVel->vz = yp_dot * phi;
-
-	phi = cos(ik);
-	pPosVel->x = xp * cos_temp - yp * phi * sin_temp;
-	pPosVel->y = xp * sin_temp + yp * phi * cos_temp;
-	// phi_dot assign as yp_dot * cos(ik) - z * ik_dot
-	phi_dot = yp_dot * phi - pPosVel->z * ik_dot;
-	pPosVel->vx = xp_dot * cos_temp - phi_dot * sin_temp;
-	pPosVel->vy = xp_dot * sin_temp + phi_dot * cos_temp;
-	pPosVel->vx -= pPosVel->y * pEph->omega_delta;
-	pPosVel->vy += pPosVel->x * pEph->omega_delta;
-	pPosVel->vz += yp * ik_dot * phi;
-
-/*	if (pEph->svid >= MIN_BD2_SVID && pEph->svid < MIN_BD2_SVID + 5)
-	{
-		// first rotate -5 degree
-		yp = pPosVel->y * COS_5 - pPosVel->z * SIN_5; // rotated y
-		pPosVel->z = pPosVel->z * COS_5 + pPosVel->y * SIN_5; // rotated z
-		yp_dot = pPosVel->vy * COS_5 - pPosVel->vz * SIN_5; // rotated vy
-		pPosVel->vz = pPosVel->vz * COS_5 + pPosVel->vy * SIN_5; // rotated vz
-		// rotate delta_t * CGS2000_OMEGDOTE
-		omega = CGCS2000_OMEGDOTE * delta_t;
-		sin_temp = sin(omega);
-		cos_temp = cos(omega);
-		pPosVel->y = yp * cos_temp - pPosVel->x * sin_temp;
-		pPosVel->x = pPosVel->x * cos_temp + yp * sin_temp;
-		pPosVel->vy = yp_dot * cos_temp - pPosVel->vx * sin_temp;
-		pPosVel->vx = pPosVel->vx * cos_temp + yp_dot * sin_temp;
-		// earth rotate compensation on velocity
-		pPosVel->vx += pPosVel->y * CGCS2000_OMEGDOTE;
-		pPosVel->vy -= pPosVel->x * CGCS2000_OMEGDOTE;
-	}*/
-
-	// if ephemeris expire, return 0
-	if (delta_t < -7200.0 || delta_t > 7200.0)
-		return 0;
-	else
-		return 1;
+		// get final position and speed in ECEF coordinate
+		for (i = 0; i < Count; i ++)
+		{
+			pEph = EphList[Start + i];
+			pPosVel = PosVelList[Start + i];
+			sin_temp = SinA[i];
+			cos_temp = CosA[i];
+			pPosVel->z = yp[i] * SinB[i];
+			pPosVel->vz = yp_dot[i] * SinB[i];
+
+			pPosVel->x = xp[i] * cos_temp - yp[i] * CosB[i] * sin_temp;
+			pPosVel->y = xp[i] * sin_temp + yp[i] * CosB[i] * cos_temp;
+			// phi_dot assign as yp_dot * cos(ik) - z * ik_dot
+			phi_dot = yp_dot[i] * CosB[i] - pPosVel->z * ik_dot[i];
+			pPosVel->vx = xp_dot[i] * cos_temp - phi_dot * sin_temp;
+			pPosVel->vy = xp_dot[i] * sin_temp + phi_dot * cos_temp;
+			pPosVel->vx -= pPosVel->y * pEph->omega_delta;
+			pPosVel->vy += pPosVel->x * pEph->omega_delta;
+			pPosVel->vz += yp[i] * ik_dot[i] * CosB[i];
+
+/*			if (pEph->svid >= MIN_BD2_SVID && pEph->svid < MIN_BD2_SVID + 5)
+			{
+				// first rotate -5 degree
+				temp = pPosVel->y * COS_5 - pPosVel->z * SIN_5; // rotated y
+				pPosVel->z = pPosVel->z * COS_5 + pPosVel->y * SIN_5; // rotated z
+				phi_dot = pPosVel->vy * COS_5 - pPosVel->vz * SIN_5; // rotated vy
+				pPosVel->vz = pPosVel->vz * COS_5 + pPosVel->vy * SIN_5; // rotated vz
+				// rotate delta_t * CGS2000_OMEGDOTE
+				sin_temp = sin(CGCS2000_OMEGDOTE * delta_t[i]);
+				cos_temp = cos(CGCS2000_OMEGDOTE * delta_t[i]);
+				pPosVel->y = temp * cos_temp - pPosVel->x * sin_temp;
+				pPosVel->x = pPosVel->x * cos_temp + temp * sin_temp;
+				pPosVel->vy = phi_dot * cos_temp - pPosVel->vx * sin_temp;
+				pPosVel->vx = pPosVel->vx * cos_temp + phi_dot * sin_temp;
+				// earth rotate compensation on velocity
+				pPosVel->vx += pPosVel->y * CGCS2000_OMEGDOTE;
+				pPosVel->vy -= pPosVel->x * CGCS2000_OMEGDOTE;
+			}*/
+
+			// if ephemeris expire, result is 0
+			EphOK[Start + i] = (delta_t[i] < -7200.0 || delta_t[i] > 7200.0) ? 0 : 1;
+		}
+	}
 }
 
 //*************** Calculate satellite position and velocity using almanac ****************
@@ -365,3 +427,76 @@ void SatElAz(PKINEMATIC_INFO pReceiver, PSATELLITE_INFO pSatellite)
 
 	pSatellite->SatInfoFlag |= (SAT_INFO_ELAZ_VALID | SAT_INFO_ELAZ_MATCH);
 }
+
+//*************** Calculate range and LOS vector of all satellites in epoch geometry ****************
+//* earth rotate correction is applied to range the same as GeometryDistanceXYZ()
+//* loop has no branch and only accesses arrays so that compiler can vectorize it
+// Parameters:
+//   Geometry: pointer to epoch geometry with satellite position and velocity loaded
+//   ReceiverPos: pointer to receiver position array
+// Return value:
+//   none
+void UpdateEpochGeometry(PEPOCH_GEOMETRY Geometry, const double *ReceiverPos)
+{
+	int i;
+	double x = ReceiverPos[0], y = ReceiverPos[1], z = ReceiverPos[2];
+	double dx, dy, dz, Distance, Range;
+
+	Geometry->ReceiverPos[0] = x;
+	Geometry->ReceiverPos[1] = y;
+	Geometry->ReceiverPos[2] = z;
+	for (i = 0; i < Geometry->SatCount; i ++)
+	{
+		dx = Geometry->SatX[i] - x;
+		dy = Geometry->SatY[i] - y;
+		dz = Geometry->SatZ[i] - z;
+		Distance = sqrt(dx * dx + dy * dy + dz * dz);
+		Range = Distance + (Geometry->SatX[i] * y - Geometry->SatY[i] * x) * (WGS_OMEGDOTE / LIGHT_SPEED);
+		Geometry->Range[i] = Range;
+		Geometry->LosX[i] = dx / Range;
+		Geometry->LosY[i] = dy / Range;
+		Geometry->LosZ[i] = dz / Range;
+		Geometry->SatRangeRate[i] = (dx * Geometry->SatVx[i] + dy * Geometry->SatVy[i] + dz * Geometry->SatVz[i]) / Distance;
+		Geometry->RangeScale[i] = Range / Distance;
+	}
+}
+
+//*************** Calculate elevation and azimuth of all satellites in epoch geometry ****************
+//* same algorithm as SatElAz(), result put in Elevation and Azimuth arrays of epoch geometry
+// Parameters:
+//   Geometry: pointer to epoch geometry with satellite position loaded
+//   ReceiverPos: pointer to receiver position array
+// Return value:
+//   none
+void EpochGeometryElAz(PEPOCH_GEOMETRY Geometry, const double *ReceiverPos)
+{
+	int i;
+	double x = ReceiverPos[0], y = ReceiverPos[1], z = ReceiverPos[2];
+	double P = x * x + y * y, R = sqrt(P + z * z);
+	double dx, dy, dz, S, SinEl, North, East;
+
+	if (R < 1e-10)
+	{
+		for (i = 0; i < Geometry->SatCount; i ++)
+		{
+			Geometry->Elevation[i] = (PI / 2);
+			Geometry->Azimuth[i] = 0;
+		}
+		return;
+	}
+
+	for (i = 0; i < Geometry->SatCount; i ++)
+	{
+		dx = x - Geometry->SatX[i];
+		dy = y - Geometry->SatY[i];
+		dz = z - Geometry->SatZ[i];
+		S = x * dx + y * dy;
+		SinEl = (-S - z * dz) / R / sqrt(dx * dx + dy * dy + dz * dz);
+		SinEl = (SinEl > 1.) ? 1. : ((SinEl < -1.) ? -1. : SinEl);
+		Geometry->Elevation[i] = asin(SinEl);
+		North = (z * S - P * dz) / R;
+		East = y * dx - x * dy;
+		Geometry->Azimuth[i] = atan2(East, North);
+		Geometry->Azimuth[i] += (Geometry->Azimuth[i] < 0) ? (2 * PI) : 0;
+	}
+}
@@ -10,14 +10,28 @@
 #include "DataTypes.h"
 #include "GlobalVar.h"
 #include "SupportPackage.h"
+#include "SatManage.h"
 #include <string.h>
 #include <math.h>
 
 static double GpsIonoDelay(PGPS_IONO_PARAM pIonoParam, LLH *ReceiverPos, int WeekMsCount, PSATELLITE_INFO pSatInfo);
 static double TropoDelay(double Elevation, PRECEIVER_INFO pReceiverInfo);
 static double GetTropoParam(int ParamIndex, int LatDegree, double SeasonVar);
+static PCHANNEL_STATUS FindL5Channel(int svid);
+static int ApplySbasCorrection(PCHANNEL_STATUS pChannelStatus, PSATELLITE_INFO pSatInfo);
+static int SbasIonoDelay(LLH *ReceiverPos, int WeekMsCount, PSATELLITE_INFO pSatInfo, double *Delay);
+static int SbasCellDelay(double Lat, double Lon, int Spacing, int WeekMsCount, double *Delay);
+static int SbasIgpDelay(int Lat, int Lon, int WeekMsCount, double *Delay);
+
+#define SBAS_IONO_HEIGHT 350000.0		// ionosphere shell height of SBAS grid
+#define SBAS_EARTH_RADIUS 6378136.3
+
+// fast correction timeout in second for each degradation factor indicator (en route through non-precision approach)
+static const int SbasFastTimeout[16] = { 180, 180, 153, 135, 135, 117, 99, 81, 63, 45, 45, 27, 27, 27, 18, 18 };
 
 //*************** Calculate satellite information of given satellite list ****************
+//* satellite position of all observations calculated with one batch call
+//* epoch geometry loaded with the list and el/az calculated on geometry arrays
 // Parameters:
 //   ObservationList: raw measurement pointer array
 //   ObsCount: number of observations
@@ -27,12 +41,18 @@ void CalcSatelliteInfo(PCHANNEL_STATUS ObservationList[], int ObsCount)
 {
 	int i;
 	int sv_index;
-	int EphOK = 1;
+	int EvalCount = 0;
 	double Time, Trel;
 	PGNSS_EPHEMERIS Ephemeris;
-	PSATELLITE_INFO SatelliteInfo;
-
-	// calculate satellite position and velocity
+	PSATELLITE_INFO SatelliteInfo, pSatInfo;
+	PSATELLITE_INFO SatInfoList[DIMENSION_MAX_X], EvalSatInfo[DIMENSION_MAX_X];
+	double TimeList[DIMENSION_MAX_X];
+	const GNSS_EPHEMERIS *EphList[DIMENSION_MAX_X];
+	PKINEMATIC_INFO PosVelList[DIMENSION_MAX_X];
+	int EphOK[DIMENSION_MAX_X];
+	PEPOCH_GEOMETRY Geometry = &(g_PvtCoreData.Geometry);
+
+	// calculate signal transmit time and find satellites need to calculate position and velocity
 	for (i = 0; i < ObsCount; i ++)
 	{
 		switch (ObservationList[i]->FreqID)
@@ -56,26 +76,92 @@ void CalcSatelliteInfo(PCHANNEL_STATUS ObservationList[], int ObsCount)
 		}
 
 		sv_index = ObservationList[i]->svid - 1;
+		pSatInfo = SatInfoList[i] = &(SatelliteInfo[sv_index]);
 		// calculate signal transmit time and correct satellite clock error
 		Time = (ObservationList[i]->TransmitTimeMs + ObservationList[i]->TransmitTime) * 0.001;
 		ObservationList[i]->DeltaT = ClockCorrection(&(Ephemeris[sv_index]), Time);
 		Time -= ObservationList[i]->DeltaT;
 		// use transmit time to calculate satellite position and velocity
-		EphOK = SatPosSpeedEph(Time, &(Ephemeris[sv_index]), &(SatelliteInfo[sv_index].PosVel));
-		// apply relativistic correction to clock
-		Trel = WGS_F_GTR * Ephemeris[sv_index].ecc * Ephemeris[sv_index].sqrtA * sin(Ephemeris[sv_index].Ek);
+		// another signal of same satellite at same epoch reuses result unless ephemeris published in between
+		if (pSatInfo->Time != ObservationList[i]->TransmitTimeMs || pSatInfo->EphVersion != Ephemeris[sv_index].version ||
+			(pSatInfo->SatInfoFlag & (SAT_INFO_POSVEL_VALID | SAT_INFO_BY_EPH)) != (SAT_INFO_POSVEL_VALID | SAT_INFO_BY_EPH))
+		{
+			TimeList[EvalCount] = Time;
+			EphList[EvalCount] = &(Ephemeris[sv_index]);
+			PosVelList[EvalCount] = &(pSatInfo->PosVel);
+			EvalSatInfo[EvalCount ++] = pSatInfo;
+			// mark as calculated so that following signal of same satellite will not be added again
+			pSatInfo->Time = ObservationList[i]->TransmitTimeMs;
+			pSatInfo->SatInfoFlag = SAT_INFO_POSVEL_VALID | SAT_INFO_BY_EPH;
+		}
+		pSatInfo->EphVersion = Ephemeris[sv_index].version;
+	}
+
+	SatPosSpeedEphBatch(EvalCount, TimeList, EphList, PosVelList, EphOK);
+	for (i = 0; i < EvalCount; i ++)
+		if (!EphOK[i])
+			EvalSatInfo[i]->SatInfoFlag |= SAT_INFO_EPH_EXPIRE;
+
+	for (i = 0; i < ObsCount; i ++)
+	{
+		pSatInfo = SatInfoList[i];
+		// apply relativistic correction to clock, F*e*sqrt(A)*sin(Ek) equals -2(r.v)/c^2
+		Trel = pSatInfo->PosVel.x * pSatInfo->PosVel.vx + pSatInfo->PosVel.y * pSatInfo->PosVel.vy + pSatInfo->PosVel.z * pSatInfo->PosVel.vz;
+		Trel *= -2.0 / (LIGHT_SPEED * LIGHT_SPEED);
 		ObservationList[i]->DeltaT += Trel;
-		// compensate satellite transmit time calculation with Trel difference (before calling SatPosSpeedEph(), Ek is not calculated)
+		// compensate satellite transmit time calculation with Trel difference (transmit time used by SatPosSpeedEph() does not include Trel)
 		// generally this is not necessory because the compensation is very small
-//		SatelliteInfo[sv_index].PosVel.x -= Trel * SatelliteInfo[sv_index].PosVel.vx;
-//		SatelliteInfo[sv_index].PosVel.y -= Trel * SatelliteInfo[sv_index].PosVel.vy;
-//		SatelliteInfo[sv_index].PosVel.z -= Trel * SatelliteInfo[sv_index].PosVel.vz;
-		// this is the time tag that used to calculate el/az and set flag
-		SatelliteInfo[sv_index].Time = ObservationList[i]->TransmitTimeMs;
-		SatelliteInfo[sv_index].SatInfoFlag = SAT_INFO_POSVEL_VALID | SAT_INFO_BY_EPH | (EphOK ? 0 : SAT_INFO_EPH_EXPIRE);
-		if (g_ReceiverInfo.PosQuality >= ExtSetPos)
-			SatElAz(&(g_ReceiverInfo.PosVel), &(SatelliteInfo[sv_index]));
+//		pSatInfo->PosVel.x -= Trel * pSatInfo->PosVel.vx;
+//		pSatInfo->PosVel.y -= Trel * pSatInfo->PosVel.vy;
+//		pSatInfo->PosVel.z -= Trel * pSatInfo->PosVel.vz;
+		// el/az and LOS flags set again with latest satellite position
+		pSatInfo->SatInfoFlag &= (SAT_INFO_POSVEL_VALID | SAT_INFO_BY_EPH | SAT_INFO_EPH_EXPIRE);
+	}
+
+	LoadEpochGeometry(Geometry, ObservationList, ObsCount);
+	if (g_ReceiverInfo.PosQuality >= ExtSetPos)
+	{
+		EpochGeometryElAz(Geometry, g_ReceiverInfo.PosVel.PosVel);
+		for (i = 0; i < ObsCount; i ++)
+		{
+			SatInfoList[i]->el = Geometry->Elevation[i];
+			SatInfoList[i]->az = Geometry->Azimuth[i];
+			SatInfoList[i]->SatInfoFlag |= (SAT_INFO_ELAZ_VALID | SAT_INFO_ELAZ_MATCH);
+		}
+	}
+}
+
+//*************** Load satellite position of observations to epoch geometry ****************
+//* satellite position and velocity should be calculated in advance, range and LOS not calculated here
+//* the geometry should be loaded again after observation list changed
+// Parameters:
+//   Geometry: pointer to epoch geometry
+//   ObservationList: raw measurement pointer array
+//   ObsCount: number of observations
+// Return value:
+//   none
+void LoadEpochGeometry(PEPOCH_GEOMETRY Geometry, PCHANNEL_STATUS ObservationList[], int ObsCount)
+{
+	int i;
+	PSATELLITE_INFO SatelliteInfo = g_GpsSatelliteInfo, pSatInfo;
+
+	for (i = 0; i < ObsCount; i ++)
+	{
+		if (ObservationList[i]->FreqID == FREQ_B1C)
+			SatelliteInfo = g_BdsSatelliteInfo;
+		else if (ObservationList[i]->FreqID == FREQ_E1)
+			SatelliteInfo = g_GalileoSatelliteInfo;
+		else
+			SatelliteInfo = g_GpsSatelliteInfo;
+		pSatInfo = Geometry->SatInfo[i] = &(SatelliteInfo[ObservationList[i]->svid - 1]);
+		Geometry->SatX[i] = pSatInfo->PosVel.x;
+		Geometry->SatY[i] = pSatInfo->PosVel.y;
+		Geometry->SatZ[i] = pSatInfo->PosVel.z;
+		Geometry->SatVx[i] = pSatInfo->PosVel.vx;
+		Geometry->SatVy[i] = pSatInfo->PosVel.vy;
+		Geometry->SatVz[i] = pSatInfo->PosVel.vz;
 	}
+	Geometry->SatCount = ObsCount;
 }
 
 //*************** Filter raw measurements ****************
@@ -143,6 +229,9 @@ void ApplyCorrection(PCHANNEL_STATUS ObservationList[], int ObsCount)
 {
 	int i, sv_index;
 	PSATELLITE_INFO SatelliteInfo = g_GpsSatelliteInfo;
+	PCHANNEL_STATUS pL5Status;
+	double IonoDelay;
+	int SbasCorrected;
 
 	// calculate Tclk + Trel - Tgd - Ttrop  - Tiono (earth rotate correction applied in GeometryDistanceXYZ())
 	// ObservationList[i]->DeltaT has already assigned with clock error and relativistic correction in CalcSatelliteInfo()
@@ -150,9 +239,32 @@ void ApplyCorrection(PCHANNEL_STATUS ObservationList[], int ObsCount)
 	{
 		sv_index = ObservationList[i]->svid - 1;
 
-		// group delay
+		// L1/L5 iono-free combination if L5 of same satellite is available (IS-GPS-705 L1/L5 dual frequency correction)
+		// PR = (PR5 - gamma*PR1 + c*(ISC_L5Q5 - gamma*ISC_L1CA)) / (1 - gamma) - c*TGD
+		// ionosphere delay on L1 is (PR5-PR1)/(gamma-1), TGD applied as single frequency below
+		if (ObservationList[i]->FreqID == FREQ_L1CA && (pL5Status = FindL5Channel(ObservationList[i]->svid)) != NULL)
+		{
+			IonoDelay = (pL5Status->PseudoRangeOrigin - ObservationList[i]->PseudoRangeOrigin) / (GPS_L1_L5_GAMMA - 1.0);
+			if (IonoDelay > -10.0 && IonoDelay < 100.0)	// reject combination with unreasonable ionosphere delay
+			{
+				ObservationList[i]->DeltaT -= IonoDelay / LIGHT_SPEED;
+				ObservationList[i]->DeltaT -= (g_GpsEphemeris[sv_index].isc_l5q5 - GPS_L1_L5_GAMMA * g_GpsEphemeris[sv_index].isc_l1ca) / (GPS_L1_L5_GAMMA - 1.0);
+				ObservationList[i]->ChannelFlag |= IONO_FREE;
+			}
+		}
+
+		// SBAS fast and long-term correction
+		SbasCorrected = 0;
+		if (ObservationList[i]->FreqID == FREQ_L1CA && g_SbasCorrection.ProviderSvid != 0)
+			SbasCorrected = ApplySbasCorrection(ObservationList[i], &SatelliteInfo[sv_index]);
+
+		// group delay, single frequency L1C/A also applies ISC_L1CA (Tgd - ISC_L1CA)
 		if (ObservationList[i]->FreqID == FREQ_L1CA || ObservationList[i]->FreqID == FREQ_L1C)
+		{
 			ObservationList[i]->DeltaT -= g_GpsEphemeris[sv_index].tgd;
+			if (ObservationList[i]->FreqID == FREQ_L1CA && !(ObservationList[i]->ChannelFlag & IONO_FREE))
+				ObservationList[i]->DeltaT += g_GpsEphemeris[sv_index].isc_l1ca;
+		}
 		else if (ObservationList[i]->FreqID == FREQ_B1C)
 		{
 			ObservationList[i]->DeltaT -= g_BdsEphemeris[sv_index].tgd;
@@ -166,8 +278,12 @@ void ApplyCorrection(PCHANNEL_STATUS ObservationList[], int ObsCount)
 		// ionosphere delay
 		if (g_ReceiverInfo.PosQuality != UnknownPos && (SatelliteInfo[sv_index].SatInfoFlag & SAT_INFO_ELAZ_VALID)) 	// user position and satellite el/az valid
 		{
-			// ionosphere correction
-			if (g_GpsIonoParam.flag)	// first try GPS ionosphere parameter
+			// ionosphere correction, skipped if already removed by iono-free combination
+			if (ObservationList[i]->ChannelFlag & IONO_FREE)
+				;
+			else if (SbasCorrected && SbasIonoDelay(&(g_ReceiverInfo.PosLLH), g_ReceiverInfo.GpsMsCount, &SatelliteInfo[sv_index], &IonoDelay))	// SBAS grid first if satellite corrected by SBAS
+				ObservationList[i]->DeltaT -= IonoDelay;
+			else if (g_GpsIonoParam.flag)	// then try GPS ionosphere parameter
 				ObservationList[i]->DeltaT -= GpsIonoDelay(&g_GpsIonoParam, &(g_ReceiverInfo.PosLLH), g_ReceiverInfo.GpsMsCount, &SatelliteInfo[sv_index]);
 //			else if (g_BdsIonoParam.flag)	// then try BD2 ionosphere parameter
 //				ObservationList[i]->DeltaT -= BdsIonoDelay(&g_BdsIonoParam, &(g_ReceiverInfo.PosLLH), g_ReceiverInfo.GpsMsCount, &SatelliteInfo[sv_index]);
@@ -181,6 +297,223 @@ void ApplyCorrection(PCHANNEL_STATUS ObservationList[], int ObsCount)
 	}
 }
 
+//*************** Find L5 channel of given GPS satellite ****************
+// Parameters:
+//   svid: satellite ID
+// Return value:
+//   pointer to channel status of L5 channel with valid raw measurement, NULL if not found
+PCHANNEL_STATUS FindL5Channel(int svid)
+{
+	int i;
+
+	for (i = 0; i < TOTAL_CHANNEL_NUMBER; i ++)
+	{
+		if (g_ChannelStatus[i].FreqID == FREQ_L5 && g_ChannelStatus[i].svid == svid && (g_ChannelStatus[i].ChannelFlag & MEASUREMENT_VALID))
+			return &g_ChannelStatus[i];
+	}
+	return (PCHANNEL_STATUS)0;
+}
+
+//*************** Apply SBAS fast and long-term correction ****************
+//* long-term correction applies to satellite position and clock if IODE matches ephemeris
+//* fast correction applies to pseudorange, satellite with UDREI>=14 is not corrected
+// Parameters:
+//   pChannelStatus: pointer to channel status of GPS L1C/A observation
+//   pSatInfo: pointer to satellite information structure
+// Return value:
+//   1 if fast correction applied, otherwise 0
+int ApplySbasCorrection(PCHANNEL_STATUS pChannelStatus, PSATELLITE_INFO pSatInfo)
+{
+	PSBAS_SAT_CORRECTION pCorrection = &g_SbasCorrection.SatCorrection[pChannelStatus->svid - 1];
+	int Now = g_ReceiverInfo.GpsMsCount;
+	int Age, Timeout;
+	double dt;
+
+	if (!(pCorrection->flag & SBAS_CORR_FAST) || pCorrection->udrei >= 14)
+		return 0;
+	Timeout = (pCorrection->flag & SBAS_CORR_AI_VALID) ? SbasFastTimeout[pCorrection->ai] * 1000 : SBAS_FAST_CORR_TIMEOUT;
+	Age = (Now - pCorrection->FastTime + 604800000) % 604800000;
+	if (Age > Timeout)
+		return 0;
+
+	// long-term correction, reference time t0 is time within day
+	if ((pCorrection->flag & SBAS_CORR_LONG_TERM) && !(g_GpsEphemeris[pChannelStatus->svid - 1].flag & EPH_FLAG_CNAV2) &&
+		pCorrection->iode == g_GpsEphemeris[pChannelStatus->svid - 1].iode2 &&
+		(Now - pCorrection->LongTermTime + 604800000) % 604800000 <= SBAS_LONG_TERM_TIMEOUT)
+	{
+		dt = 0.0;
+		if (pCorrection->flag & SBAS_CORR_VELOCITY)
+		{
+			dt = fmod((pChannelStatus->TransmitTimeMs + pChannelStatus->TransmitTime) * 0.001, 86400.0) - pCorrection->t0;
+			if (dt > 43200.0)
+				dt -= 86400.0;
+			else if (dt < -43200.0)
+				dt += 86400.0;
+		}
+		pSatInfo->PosVel.x += pCorrection->dx + pCorrection->dvx * dt;
+		pSatInfo->PosVel.y += pCorrection->dy + pCorrection->dvy * dt;
+		pSatInfo->PosVel.z += pCorrection->dz + pCorrection->dvz * dt;
+		pSatInfo->PosVel.vx += pCorrection->dvx;
+		pSatInfo->PosVel.vy += pCorrection->dvy;
+		pSatInfo->PosVel.vz += pCorrection->dvz;
+		pChannelStatus->DeltaT += pCorrection->daf0 + pCorrection->daf1 * dt;
+	}
+
+	// fast correction with range rate correction
+	pChannelStatus->DeltaT += (pCorrection->prc + pCorrection->rrc * Age * 0.001) / LIGHT_SPEED;
+	return 1;
+}
+
+//*************** Calculate ionosphere delay using SBAS grid ****************
+// Parameters:
+//   ReceiverPos: pointer to receiver position (lat/lon/altitude)
+//   WeekMsCount: millisecond count within week
+//   pSatInfo: pointer to satellite information structure
+//   Delay: ionosphere delay in seconds
+// Return value:
+//   1 if grid available at ionosphere pierce point, otherwise 0
+int SbasIonoDelay(LLH *ReceiverPos, int WeekMsCount, PSATELLITE_INFO pSatInfo, double *Delay)
+{
+	double CosEl = SBAS_EARTH_RADIUS / (SBAS_EARTH_RADIUS + SBAS_IONO_HEIGHT) * cos(pSatInfo->el);
+	double Psi, LatPP, LonPP, VerticalDelay;
+
+	// ionosphere pierce point
+	Psi = PI / 2 - pSatInfo->el - asin(CosEl);
+	LatPP = asin(sin(ReceiverPos->lat) * cos(Psi) + cos(ReceiverPos->lat) * sin(Psi) * cos(pSatInfo->az));
+	LonPP = ReceiverPos->lon + asin(sin(Psi) * sin(pSatInfo->az) / cos(LatPP));
+	LatPP *= 180.0 / PI;
+	LonPP *= 180.0 / PI;
+	if (LonPP >= 180.0)
+		LonPP -= 360.0;
+	else if (LonPP < -180.0)
+		LonPP += 360.0;
+
+	// 5x5 degree cell first, then 10x10 degree cell, polar region not supported
+	if (fabs(LatPP) > 75.0)
+		return 0;
+	if (!(fabs(LatPP) <= 55.0 && SbasCellDelay(LatPP, LonPP, 5, WeekMsCount, &VerticalDelay)) && !SbasCellDelay(LatPP, LonPP, 10, WeekMsCount, &VerticalDelay))
+		return 0;
+	*Delay = VerticalDelay / sqrt(1.0 - CosEl * CosEl) / LIGHT_SPEED;	// slant delay with obliquity factor
+	return 1;
+}
+
+//*************** Interpolate vertical delay of IGP cell containing pierce point ****************
+//* 4 IGPs use bilinear interpolation, 3 IGPs use triangle interpolation if pierce point within the triangle
+// Parameters:
+//   Lat: latitude of pierce point in degree
+//   Lon: longitude of pierce point in degree
+//   Spacing: cell size in degree (5 or 10)
+//   WeekMsCount: millisecond count within week
+//   Delay: vertical delay in meter
+// Return value:
+//   1 if interpolation success, otherwise 0
+int SbasCellDelay(double Lat, double Lon, int Spacing, int WeekMsCount, double *Delay)
+{
+	int i, Lat0, Lon0, ValidCount = 0, Missing = -1;
+	int CornerX, CornerY;
+	double x, y, CornerDelay[4];
+
+	// 10 degree cell latitude boundary at 5 degree offset to match IGP at 55/65/75
+	Lat0 = (Spacing == 5) ? (int)floor(Lat / 5) * 5 : (int)floor((Lat - 5) / 10) * 10 + 5;
+	Lon0 = (int)floor(Lon / Spacing) * Spacing;
+	x = (Lon - Lon0) / Spacing;
+	y = (Lat - Lat0) / Spacing;
+
+	// corner order is SW, SE, NE, NW
+	for (i = 0; i < 4; i ++)
+	{
+		if (SbasIgpDelay(Lat0 + ((i >= 2) ? Spacing : 0), Lon0 + ((i == 1 || i == 2) ? Spacing : 0), WeekMsCount, &CornerDelay[i]))
+			ValidCount ++;
+		else
+			Missing = i;
+	}
+
+	if (ValidCount == 4)
+	{
+		*Delay = (1 - x) * (1 - y) * CornerDelay[0] + x * (1 - y) * CornerDelay[1] + x * y * CornerDelay[2] + (1 - x) * y * CornerDelay[3];
+		return 1;
+	}
+	if (ValidCount < 3)
+		return 0;
+	// mirror the cell to put missing corner at (1,1), the other corners form triangle (0,0)-(1,0)-(0,1)
+	if (Missing == 0 || Missing == 3)
+		x = 1 - x;
+	if (Missing < 2)
+		y = 1 - y;
+	if (x + y > 1.0)	// pierce point outside triangle
+		return 0;
+	*Delay = 0.0;
+	for (i = 0; i < 4; i ++)
+	{
+		if (i == Missing)
+			continue;
+		CornerX = ((i == 1 || i == 2) != (Missing == 1 || Missing == 2)) ? 0 : 1;
+		CornerY = ((i >= 2) != (Missing >= 2)) ? 0 : 1;
+		*Delay += (CornerX ? x : (CornerY ? y : 1 - x - y)) * CornerDelay[i];
+	}
+	return 1;
+}
+
+//*************** Get vertical delay of IGP ****************
+//* in each band, odd 5 degree column has IGP at 55S~55N, even column adds 65/75
+//* and longitude 180W/90W/0/90E adds 85N, longitude 140W/50W/40E/130E adds 85S
+// Parameters:
+//   Lat: latitude of IGP in degree
+//   Lon: longitude of IGP in degree
+//   WeekMsCount: millisecond count within week
+//   Delay: vertical delay in meter
+// Return value:
+//   1 if IGP delay available, otherwise 0
+int SbasIgpDelay(int Lat, int Lon, int WeekMsCount, double *Delay)
+{
+	int Band, Column, ColumnLon, Index = 0, LatIndex;
+	int North85, South85;
+	PSBAS_IGP_BAND pBand;
+	unsigned short Value;
+
+	if (Lon >= 180)
+		Lon -= 360;
+	Band = (Lon + 180) / 40;
+	Column = ((Lon + 180) % 40) / 5;
+	pBand = &g_SbasCorrection.IgpBand[Band];
+	if (Band >= SBAS_IGP_BAND_NUMBER || !pBand->MaskValid || (Lat % 5) != 0)
+		return 0;
+
+	// count IGPs of previous columns in band
+	for (ColumnLon = Lon - Column * 5; ColumnLon <= Lon; ColumnLon += 5)
+	{
+		North85 = (ColumnLon == -180 || ColumnLon == -90 || ColumnLon == 0 || ColumnLon == 90);
+		South85 = (ColumnLon == -140 || ColumnLon == -50 || ColumnLon == 40 || ColumnLon == 130);
+		if (ColumnLon != Lon)
+		{
+			Index += ((ColumnLon % 10) != 0) ? 23 : ((North85 || South85) ? 28 : 27);
+			continue;
+		}
+		// index within current column
+		if (Lat >= -55 && Lat <= 55)
+			LatIndex = (Lat + 55) / 5 + (((ColumnLon % 10) != 0) ? 0 : 2);
+		else if ((ColumnLon % 10) != 0)
+			return 0;
+		else if (Lat == -75 || Lat == -65)
+			LatIndex = (Lat + 75) / 10;
+		else if (Lat == 65 || Lat == 75)
+			LatIndex = (Lat - 65) / 10 + 25;
+		else if (Lat == 85 && North85)
+			LatIndex = 27;
+		else if (Lat == -85 && South85)
+			LatIndex = -1;
+		else
+			return 0;
+		Index += LatIndex + (South85 ? 1 : 0);
+	}
+
+	Value = pBand->Delay[Index];
+	if (Value == 0xffff || ((WeekMsCount / 16000 - pBand->Time[Index] + 37800) % 37800) * 16 > SBAS_IONO_GRID_TIMEOUT)
+		return 0;
+	*Delay = (Value >> 4) * 0.125;
+	return 1;
+}
+
 //*************** Calculate ionosphere delay ****************
 // Parameters:
 //   pIonoParam: pointer to ionosphere parameter structure
@@ -0,0 +1,33 @@
+//----------------------------------------------------------------------
+// FecDecode.h:
+//   Declaration of FEC decode and CRC functions shared by navigation message decoders
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#ifndef __FEC_DECODE_H__
+#define __FEC_DECODE_H__
+
+#include "CommonDefines.h"
+
+#define VITERBI_STATE_NUMBER 64		// constraint length 7
+#define VITERBI_DECISION_SIZE 128	// decision history of Viterbi decoder, must be power of 2
+#define VITERBI_UNKNOWN_STATE -1	// start state of encoder unknown
+
+// K=7 rate 1/2 Viterbi decoder with G1=171(oct) and G2=133(oct)
+typedef struct
+{
+	int Metric[VITERBI_STATE_NUMBER];		// path metric, normalized to state 0
+	U64 Decision[VITERBI_DECISION_SIZE];	// ACS decisions of each step, bit n for state n
+	unsigned int StepCount;
+} VITERBI_DECODER, *PVITERBI_DECODER;
+
+void ViterbiReset(PVITERBI_DECODER Decoder, int StartState);
+void ViterbiStep(PVITERBI_DECODER Decoder, int Symbol1, int Symbol2);
+int ViterbiBestState(PVITERBI_DECODER Decoder);
+void ViterbiTraceback(PVITERBI_DECODER Decoder, int State, int TracebackLength, int OutputLength, U32 *Bits);
+void Crc24qInit();
+unsigned int Crc24q(const U8 *Data, int Length);
+
+#endif //__FEC_DECODE_H__
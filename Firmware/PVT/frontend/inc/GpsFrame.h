@@ -15,5 +15,6 @@ void GpsFrameSync(PCHANNEL_STATUS pChannelStatus, int data_count, unsigned int d
 void GpsFastFrameSync(PCHANNEL_STATUS pChannelStatus, PCHANNEL_STATUS pChannelRef, PBB_MEASUREMENT pMsr, PBB_MEASUREMENT pMsrRef);
 void GpsPredictFrameSync(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int GpsMsCount);
 unsigned int GetParity(unsigned int word);
+int GpsPredictBits(PCHANNEL_STATUS pChannelStatus, unsigned int BitStream[2]);
 
 #endif //__GPS_FRAME_H__
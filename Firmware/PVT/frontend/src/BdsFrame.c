@@ -171,15 +171,52 @@ void BdsFrameProc(PCHANNEL_STATUS pChannelStatus)
 {
 	PBDS_FRAME_INFO pFrameInfo = (PBDS_FRAME_INFO)(pChannelStatus->FrameInfo);
 	int svid = pChannelStatus->svid;
+	GNSS_EPHEMERIS Ephemeris;
 
 	if (!(pFrameInfo->FrameFlag & 2))
 		return;
 
-	g_BdsEphemeris[svid - 1].svid = svid;
-	DecodeBdsEphemeris(&g_BdsEphemeris[svid - 1], pFrameInfo->SubFrame2Data);
+	// decode into staging copy, current ephemeris replaced only after validation
+	memcpy(&Ephemeris, &g_BdsEphemeris[svid - 1], sizeof(GNSS_EPHEMERIS));
+	Ephemeris.svid = svid;
+	DecodeBdsEphemeris(&Ephemeris, pFrameInfo->SubFrame2Data);
+	PublishEphemeris(&g_BdsEphemeris[svid - 1], &Ephemeris);
 	pFrameInfo->FrameFlag &= ~2;
 }
 
+// B-CNAV1 subframe 2 fields, position is bit index within subframe 2 data stream
+// axis holds delta to reference semi-major axis, toe/toc hold value in unit of 300s
+static const NAV_FIELD_DESC BdsSubframe2Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, week, 0, 13, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, iodc, 21, 10, 0, NAV_FIELD_SHORT),
+	NAV_FIELD(GNSS_EPHEMERIS, iode2, 31, 8, 0, NAV_FIELD_CHAR),
+	// Ephemeris I
+	NAV_FIELD(GNSS_EPHEMERIS, toe, 39, 11, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, axis, 52, 26, 9, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, axis_dot, 78, 25, 21, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, delta_n, 103, 17, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, M0, 143, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, ecc, 176, 33, 34, NAV_FIELD_DOUBLE),
+	NAV_FIELD(GNSS_EPHEMERIS, w, 209, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	// Ephemeris II
+	NAV_FIELD(GNSS_EPHEMERIS, omega0, 242, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, i0, 275, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, omega_dot, 308, 19, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, idot, 327, 15, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cis, 342, 16, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cic, 358, 16, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crs, 374, 24, 8, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crc, 398, 24, 8, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cus, 422, 21, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cuc, 443, 21, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	// clock
+	NAV_FIELD(GNSS_EPHEMERIS, toc, 464, 11, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, af0, 475, 25, 34, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af1, 500, 22, 50, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af2, 522, 11, 66, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, tgd, 557, 12, 34, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+};
+
 //*************** Decode BDS frame data to get ephemeris ****************
 // Parameters:
 //   pEph: pointer to ephemeris structure
@@ -188,10 +225,8 @@ void BdsFrameProc(PCHANNEL_STATUS pChannelStatus)
 //   1 if decode success, otherwise 0
 int DecodeBdsEphemeris(PGNSS_EPHEMERIS pEph, const unsigned int *FrameData)
 {
-	int idata;
+	NAV_MESSAGE Subframe = { FrameData, 32, -1 };
 	unsigned int type;
-	long long ilong;
-	unsigned long long ulong;
 
 /*	pEph->health = GET_UBITS(WORD3, 8, 6);
 	if (pEph->health != 0)
@@ -202,67 +237,15 @@ int DecodeBdsEphemeris(PGNSS_EPHEMERIS pEph, const unsigned int *FrameData)
 	pEph->health = 0;
 	pEph->flag = 1;
 
-	pEph->week = GET_UBITS(FrameData[0], 19, 13);
-	pEph->iodc = GET_UBITS(FrameData[0], 1, 10);
-	pEph->iode2 = GET_UBITS(FrameData[1], 25, 7) | ((FrameData[0] & 1) ? 128 : 0);
+	DecodeNavFields(&Subframe, BdsSubframe2Fields, NAV_FIELD_NUMBER(BdsSubframe2Fields), pEph);
 	//	pEph->ura = GET_UBITS(WORD3, 14, 4);
-
-	// Ephemeris I:
-	type = GET_UBITS(FrameData[1], 12, 2);
-	pEph->toe = (int)GET_UBITS(FrameData[1], 14, 11) * 300;
-	idata = (GET_BITS(FrameData[1], 0, 12) << 14) | GET_UBITS(FrameData[2], 18, 14);
-	pEph->axis = ((type == 3) ? 27906100.0 : 42162200.0) + ScaleDouble(idata, 9);	// major-axis
-	idata = (GET_BITS(FrameData[2], 0, 18) << 7) | GET_UBITS(FrameData[3], 25, 7);
-	pEph->axis_dot = ScaleDouble(idata, 21);
-	pEph->delta_n = ScaleDouble(GET_BITS(FrameData[3], 8, 17), 44) * PI; // .44 * PI
-	idata = (GET_BITS(FrameData[3], 0, 8) << 15) | GET_UBITS(FrameData[4], 15, 17);
-//	pEph->delta_n_dot = ScaleDouble(idata, 58) * PI;	// .57 * PI * 1/2
-	ilong = GET_BITS(FrameData[4], 0, 17);
-	ilong  = (ilong << 16) | GET_UBITS(FrameData[5], 16, 16);
-	pEph->M0 = ScaleDoubleLong(ilong, 32) * PI;	// .32 * PI
-	ulong = GET_UBITS(FrameData[5], 0, 16);
-	ulong  = (ulong << 17) | GET_UBITS(FrameData[6], 15, 17);
-	pEph->ecc = ScaleDoubleULong(ulong, 34);	// .34
-	ilong = GET_BITS(FrameData[6], 0, 15);
-	ilong  = (ilong << 18) | GET_UBITS(FrameData[7], 14, 18);
-	pEph->w = ScaleDoubleLong(ilong, 32) * PI;	// .32 * PI
-
-	// Ephemeris II:
-	ilong = GET_BITS(FrameData[7], 0, 14);
-	ilong  = (ilong << 19) | GET_UBITS(FrameData[8], 13, 19);
-	pEph->omega0 = ScaleDoubleLong(ilong, 32) * PI;	// .32 * PI
-	ilong = GET_BITS(FrameData[8], 0, 13);
-	ilong  = (ilong << 20) | GET_UBITS(FrameData[9], 12, 20);
-	pEph->i0 = ScaleDoubleLong(ilong, 32) * PI;	// .32 * PI
-	idata = (GET_BITS(FrameData[9], 0, 12) << 7) | GET_UBITS(FrameData[10], 25, 7);
-	pEph->omega_dot = ScaleDouble(idata, 44) * PI;	// .44 * PI
-	pEph->idot = ScaleDouble(GET_BITS(FrameData[10], 10, 15), 44) * PI; // .44 * PI
-	idata = (GET_BITS(FrameData[10], 0, 10) << 6) | GET_UBITS(FrameData[11], 26, 6);
-	pEph->cis = ScaleDouble(idata, 30);	// .30
-	pEph->cic = ScaleDouble(GET_BITS(FrameData[11], 10, 16), 30); // .30
-	idata = (GET_BITS(FrameData[11], 0, 10) << 14) | GET_UBITS(FrameData[12], 18, 14);
-	pEph->crs = ScaleDouble(idata, 8);	// .8
-	idata = (GET_BITS(FrameData[12], 0, 18) << 6) | GET_UBITS(FrameData[13], 26, 6);
-	pEph->crc = ScaleDouble(idata, 8);	// .8
-	pEph->cus = ScaleDouble(GET_BITS(FrameData[13], 5, 21), 30); // .30
-	idata = (GET_BITS(FrameData[13], 0, 5) << 16) | GET_UBITS(FrameData[14], 16, 16);
-	pEph->cuc = ScaleDouble(idata, 30);	// .30
-
-
-	// clock
-	pEph->tgd = ScaleDouble(GET_BITS(FrameData[17], 7, 12), 34); // .34
-	pEph->toc = (int)GET_UBITS(FrameData[14], 5, 11) * 300;
-	idata = (GET_BITS(FrameData[14], 0, 5) << 20) | GET_UBITS(FrameData[15], 12, 20);
-	pEph->af0 = ScaleDouble(idata, 34); // .34
-	idata = (GET_BITS(FrameData[15], 0, 12) << 10) | GET_UBITS(FrameData[16], 22, 10);
-	pEph->af1 = ScaleDouble(idata, 50); // .50
-	pEph->af2 = ScaleDouble(GET_BITS(FrameData[16], 11, 11), 66); // .66
-
-	// calculate derived variables
-	pEph->sqrtA = sqrt(pEph->axis);
-	pEph->n = WGS_SQRT_GM / (pEph->sqrtA * pEph->axis) + pEph->delta_n;
-	pEph->root_ecc = sqrt(1.0 - pEph->ecc * pEph->ecc);
-	pEph->omega_t = pEph->omega0 - WGS_OMEGDOTE * pEph->toe;
-	pEph->omega_delta = pEph->omega_dot - WGS_OMEGDOTE;
+	// delta_n_dot (23bit signed at bit 120, .57 * PI) not decoded
+
+	// fields with scale other than power of 2
+	type = (unsigned int)GetNavBits(&Subframe, 50, 2);
+	pEph->axis += (type == 3) ? 27906100.0 : 42162200.0;	// major-axis
+	pEph->toe *= 300;
+	pEph->toc *= 300;
+	pEph->sqrtA = sqrt(pEph->axis);	// other derived variables calculated in PublishEphemeris()
 	return 1;
 }
@@ -0,0 +1,165 @@
+//----------------------------------------------------------------------
+// FecDecode.c:
+//   K=7 Viterbi decoder and CRC-24Q used by SBAS and Galileo I/NAV decode
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <string.h>
+
+#include "FecDecode.h"
+
+#define STATE_METRIC_MIN (-0x100000)	// initial metric of impossible states
+
+static U32 Crc24qTable[256];
+
+// output of G1=171(oct) and G2=133(oct) for encoder register 2i (newest bit at bit6)
+// register 2i+1 and 2i+64 have complementary output, 2i+65 has same output
+static const U8 BranchOutput[32] = {
+	0, 1, 0, 1, 3, 2, 3, 2, 3, 2, 3, 2, 0, 1, 0, 1,
+	2, 3, 2, 3, 1, 0, 1, 0, 1, 0, 1, 0, 2, 3, 2, 3,
+};
+
+//*************** Reset Viterbi decoder ****************
+// Parameters:
+//   Decoder: pointer to Viterbi decoder
+//   StartState: encoder state at first step, VITERBI_UNKNOWN_STATE if not known
+// Return value:
+//   none
+void ViterbiReset(PVITERBI_DECODER Decoder, int StartState)
+{
+	int i;
+
+	memset(Decoder, 0, sizeof(VITERBI_DECODER));
+	if (StartState == VITERBI_UNKNOWN_STATE)
+		return;
+	for (i = 0; i < VITERBI_STATE_NUMBER; i ++)
+		Decoder->Metric[i] = (i == StartState) ? 0 : STATE_METRIC_MIN;
+}
+
+//*************** One step of K=7 rate 1/2 soft decision Viterbi decoder ****************
+//* state is the latest 6 input bits, with the latest bit at bit5
+//* butterfly i has predecessor 2i/2i+1 and successor i (input 0) and i+32 (input 1)
+//* add-compare-select has no branch so that the loop can be vectorized
+// Parameters:
+//   Decoder: pointer to Viterbi decoder
+//   Symbol1: soft symbol of G1 output, negative for bit 1
+//   Symbol2: soft symbol of G2 output, negative for bit 1
+// Return value:
+//   none
+void ViterbiStep(PVITERBI_DECODER Decoder, int Symbol1, int Symbol2)
+{
+	int i, Metric, Select0, Select1;
+	int Path0, Path1, Path2, Path3;
+	int BranchMetric[4];
+	int NewMetric[VITERBI_STATE_NUMBER];
+	U32 DecisionLow = 0, DecisionHigh = 0;
+
+	BranchMetric[0] = Symbol1 + Symbol2;
+	BranchMetric[1] = Symbol1 - Symbol2;
+	BranchMetric[2] = -Symbol1 + Symbol2;
+	BranchMetric[3] = -Symbol1 - Symbol2;
+
+	for (i = 0; i < VITERBI_STATE_NUMBER / 2; i ++)
+	{
+		Metric = BranchMetric[BranchOutput[i]];
+		Path0 = Decoder->Metric[2*i] + Metric;
+		Path1 = Decoder->Metric[2*i+1] - Metric;
+		Path2 = Decoder->Metric[2*i] - Metric;
+		Path3 = Decoder->Metric[2*i+1] + Metric;
+		Select0 = (Path1 > Path0);
+		Select1 = (Path3 > Path2);
+		NewMetric[i] = Path0 + ((Path1 - Path0) & -Select0);
+		NewMetric[i+32] = Path2 + ((Path3 - Path2) & -Select1);
+		DecisionLow |= (U32)Select0 << i;
+		DecisionHigh |= (U32)Select1 << i;
+	}
+	// normalize path metric to avoid overflow
+	for (i = 0; i < VITERBI_STATE_NUMBER; i ++)
+		Decoder->Metric[i] = NewMetric[i] - NewMetric[0];
+	Decoder->Decision[Decoder->StepCount & (VITERBI_DECISION_SIZE - 1)] = ((U64)DecisionHigh << 32) | DecisionLow;
+	Decoder->StepCount ++;
+}
+
+//*************** Find state with best path metric ****************
+// Parameters:
+//   Decoder: pointer to Viterbi decoder
+// Return value:
+//   state with largest path metric
+int ViterbiBestState(PVITERBI_DECODER Decoder)
+{
+	int i, State = 0;
+
+	for (i = 1; i < VITERBI_STATE_NUMBER; i ++)
+		if (Decoder->Metric[i] > Decoder->Metric[State])
+			State = i;
+	return State;
+}
+
+//*************** Trace back from given state to get decoded bits ****************
+//* the oldest OutputLength bits of TracebackLength steps are output
+// Parameters:
+//   Decoder: pointer to Viterbi decoder
+//   State: state at latest step to start traceback
+//   TracebackLength: number of steps to trace back, not exceed VITERBI_DECISION_SIZE
+//   OutputLength: number of bits to output
+//   Bits: array to hold decoded bits, first bit at MSB of Bits[0]
+// Return value:
+//   none
+void ViterbiTraceback(PVITERBI_DECODER Decoder, int State, int TracebackLength, int OutputLength, U32 *Bits)
+{
+	int i, BitIndex;
+	unsigned int Step = Decoder->StepCount;
+
+	memset(Bits, 0, sizeof(U32) * ((OutputLength + 31) / 32));
+	for (i = 0; i < TracebackLength; i ++)
+	{
+		Step --;
+		BitIndex = TracebackLength - 1 - i;
+		if (BitIndex < OutputLength)
+			Bits[BitIndex >> 5] |= (U32)(State >> 5) << (31 - (BitIndex & 0x1f));
+		State = ((State & 0x1f) << 1) | (int)((Decoder->Decision[Step & (VITERBI_DECISION_SIZE - 1)] >> State) & 1);
+	}
+}
+
+//*************** Initialize CRC-24Q table ****************
+// Parameters:
+//   none
+// Return value:
+//   none
+void Crc24qInit()
+{
+	int i, j;
+	unsigned int Crc;
+
+	// CRC-24Q table with polynomial 0x1864CFB
+	for (i = 0; i < 256; i ++)
+	{
+		Crc = (unsigned int)i << 16;
+		for (j = 0; j < 8; j ++)
+		{
+			Crc <<= 1;
+			if (Crc & 0x1000000)
+				Crc ^= 0x1864cfb;
+		}
+		Crc24qTable[i] = Crc & 0xffffff;
+	}
+}
+
+//*************** Calculate CRC-24Q ****************
+//* leading zero bits do not change CRC, so bit stream not aligned to byte can be padded with zeros in front
+// Parameters:
+//   Data: byte array
+//   Length: number of bytes
+// Return value:
+//   24bit CRC
+unsigned int Crc24q(const U8 *Data, int Length)
+{
+	unsigned int Crc = 0;
+	int i;
+
+	for (i = 0; i < Length; i ++)
+		Crc = ((Crc << 8) & 0xffffff) ^ Crc24qTable[(Crc >> 16) ^ Data[i]];
+	return Crc;
+}
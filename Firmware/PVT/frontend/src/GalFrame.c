@@ -0,0 +1,440 @@
+//----------------------------------------------------------------------
+// GalFrame.c:
+//   Galileo E1-B I/NAV page sync, Viterbi decode and word decode
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "PlatformCtrl.h"
+#include "ChannelManager.h"
+#include "DataTypes.h"
+#include "GlobalVar.h"
+#include "SupportPackage.h"
+#include "PvtEntry.h"
+#include "FecDecode.h"
+
+#define MAX_GAL_CHANNEL 8		// number of Galileo channels decoded simultaneously
+#define SYNC_LENGTH 10			// sync pattern length in symbols
+#define PAGE_PART_SYMBOLS 250	// symbols of one page part including sync pattern
+#define INTERLEAVE_ROWS 8		// block interleaver of 30 columns x 8 rows
+#define INTERLEAVE_COLUMNS 30
+#define PAGE_PART_BITS 120		// decoded bits of one page part including 6 tail bits
+#define SYNC_MISS_LIMIT 4		// drop page sync after this number of consecutive sync pattern miss
+#define STALE_DECODE_COUNT 64	// decode context not called in this number of tasks can be reused
+
+#define SYNC_PATTERN 0x160		// 0101100000 with first symbol at bit9
+#define EPH_WORD_MASK 0xf		// word type 1~4 needed for ephemeris
+
+// decode context of one Galileo channel
+typedef struct
+{
+	int LogicChannel;		// -1 if context not used
+	int Svid;
+	unsigned int LastCall;	// value of DecodeCallCount on latest call
+	int SymbolCount;		// number of symbols in Symbols[]
+	int PageSync;			// sync pattern position locked
+	int SyncMiss;			// consecutive sync pattern miss after page sync
+	int EvenValid;			// even page part in EvenPart[] waiting for odd part
+	U32 EvenPart[4];		// decoded bits of even page part, first bit at MSB of EvenPart[0]
+	int WordMask;			// bit n-1 set if word type n of StageIod received
+	int StageIod;			// IODnav of ephemeris being collected
+	GNSS_EPHEMERIS Ephemeris;	// ephemeris being collected
+	S8 Symbols[PAGE_PART_SYMBOLS+SYNC_LENGTH];	// page part with sync pattern at both ends
+} GAL_DECODE_CONTEXT, *PGAL_DECODE_CONTEXT;
+
+static GAL_DECODE_CONTEXT DecodeContext[MAX_GAL_CHANNEL];
+static unsigned int DecodeCallCount;
+static VITERBI_DECODER GalViterbi;	// page part is decoded within one call, so decoder is shared by all channels
+
+static PGAL_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid);
+static int MatchSyncPattern(const S8 *Symbols);
+static void DecodePagePart(const S8 *Symbols, int Polarity, U32 Bits[4]);
+static void CopyBits(U32 *Dest, int DestPos, const U32 *Src, int SrcPos, int Length);
+static void PageProc(PGAL_DECODE_CONTEXT Context, const U32 Bits[4]);
+static void GalWordDecode(PGAL_DECODE_CONTEXT Context, const U32 Word[4]);
+
+// I/NAV word type 1~4 for ephemeris and clock, position counted from first bit of 128bit word
+static const NAV_FIELD_DESC GalWord1Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, toe, 16, 14, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, M0, 30, 32, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, ecc, 62, 32, 33, NAV_FIELD_DOUBLE),
+	NAV_FIELD(GNSS_EPHEMERIS, sqrtA, 94, 32, 19, NAV_FIELD_DOUBLE),
+};
+
+static const NAV_FIELD_DESC GalWord2Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, omega0, 16, 32, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, i0, 48, 32, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, w, 80, 32, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, idot, 112, 14, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+};
+
+static const NAV_FIELD_DESC GalWord3Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, omega_dot, 16, 24, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, delta_n, 40, 16, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cuc, 56, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cus, 72, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crc, 88, 16, 5, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crs, 104, 16, 5, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, ura, 120, 8, 0, NAV_FIELD_CHAR),	// SISA
+};
+
+static const NAV_FIELD_DESC GalWord4Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, cic, 22, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cis, 38, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, toc, 54, 14, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, af0, 68, 31, 34, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af1, 99, 21, 46, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af2, 120, 6, 59, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+};
+
+// word type 5, BGD(E1,E5b) used as group delay of E1 single frequency
+static const NAV_FIELD_DESC GalWord5Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, tgd2, 47, 10, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, tgd, 57, 10, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, week, 73, 12, 0, NAV_FIELD_INT),
+};
+
+//*************** Galileo data decode initialization ****************
+// Parameters:
+//   none
+// Return value:
+//   none
+void GalDecodeInit()
+{
+	int i;
+
+	for (i = 0; i < MAX_GAL_CHANNEL; i ++)
+		DecodeContext[i].LogicChannel = -1;
+	DecodeCallCount = 0;
+	Crc24qInit();
+}
+
+//*************** Task to decode Galileo I/NAV data ****************
+//* 4bit soft symbols from HW data decode, expanded to 8bit soft symbols
+// Parameters:
+//   Param: Pointer to data stream structure
+// Return value:
+//   0
+int GalDecodeTask(void *Param)
+{
+	PDATA_STREAM DataStream = (PDATA_STREAM)Param;
+	S8 Symbols[256];
+	int i, Value;
+
+	for (i = 0; i < DataStream->DataCount && i < 256; i ++)
+	{
+		Value = (DataStream->DataBuffer[i/8] >> (28 - (i & 7) * 4)) & 0xf;
+		Value -= (Value & 0x8) << 1;	// sign extension
+		Symbols[i] = (S8)((Value * 2 + 1) * 8);	// -8~7 mapped to -120~120 symmetric to 0
+	}
+	GalSymbolDecode(DataStream->ChannelState->LogicChannel, DataStream->ChannelState->Svid, Symbols, i);
+
+	return 0;
+}
+
+//*************** Decode Galileo E1-B soft symbols of one channel ****************
+//* search sync pattern at both ends of 250 symbols and decode page part in between
+// Parameters:
+//   LogicChannel: logic channel the symbols come from
+//   Svid: Galileo satellite ID (1~36)
+//   Symbols: soft symbols in receive order, negative value for bit 1
+//   SymbolCount: number of symbols
+// Return value:
+//   none
+void GalSymbolDecode(int LogicChannel, int Svid, const S8 *Symbols, int SymbolCount)
+{
+	PGAL_DECODE_CONTEXT Context = GetDecodeContext(LogicChannel, Svid);
+	int i, Polarity, NextPolarity;
+	U32 Bits[4];
+
+	if (!Context)
+		return;
+	for (i = 0; i < SymbolCount; i ++)
+	{
+		Context->Symbols[Context->SymbolCount ++] = Symbols[i];
+		if (Context->SymbolCount < PAGE_PART_SYMBOLS + SYNC_LENGTH)
+			continue;
+
+		Polarity = MatchSyncPattern(Context->Symbols);
+		NextPolarity = MatchSyncPattern(Context->Symbols + PAGE_PART_SYMBOLS);
+		if (!Context->PageSync)
+		{
+			if (Polarity == 0 || Polarity != NextPolarity)	// search sync pattern by one symbol step
+			{
+				memmove(Context->Symbols, Context->Symbols + 1, PAGE_PART_SYMBOLS + SYNC_LENGTH - 1);
+				Context->SymbolCount --;
+				continue;
+			}
+			Context->PageSync = 1;
+			Context->EvenValid = 0;
+		}
+		else	// sync pattern position locked, tolerate occasional symbol errors in sync pattern
+		{
+			Context->SyncMiss = (Polarity != 0 && Polarity == NextPolarity) ? 0 : Context->SyncMiss + 1;
+			if (Polarity == 0)
+				Polarity = NextPolarity;
+			if (Polarity == 0 || Context->SyncMiss > SYNC_MISS_LIMIT)
+			{
+				Context->PageSync = 0;
+				memmove(Context->Symbols, Context->Symbols + 1, PAGE_PART_SYMBOLS + SYNC_LENGTH - 1);
+				Context->SymbolCount --;
+				continue;
+			}
+		}
+
+		DecodePagePart(Context->Symbols + SYNC_LENGTH, Polarity, Bits);
+		PageProc(Context, Bits);
+		memmove(Context->Symbols, Context->Symbols + PAGE_PART_SYMBOLS, SYNC_LENGTH);
+		Context->SymbolCount = SYNC_LENGTH;
+	}
+}
+
+//*************** Get decode context of a logic channel ****************
+//* allocate a new context if not found, context of other satellite on same channel is reset
+// Parameters:
+//   LogicChannel: logic channel
+//   Svid: Galileo satellite ID
+// Return value:
+//   pointer to decode context, NULL if no context available
+PGAL_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid)
+{
+	int i;
+	PGAL_DECODE_CONTEXT Context = (PGAL_DECODE_CONTEXT)0;
+
+	DecodeCallCount ++;
+	for (i = 0; i < MAX_GAL_CHANNEL; i ++)
+	{
+		if (DecodeContext[i].LogicChannel == LogicChannel)
+		{
+			Context = &DecodeContext[i];
+			break;
+		}
+	}
+	if (!Context)
+	{
+		for (i = 0; i < MAX_GAL_CHANNEL; i ++)
+		{
+			if (DecodeContext[i].LogicChannel < 0 || (DecodeCallCount - DecodeContext[i].LastCall) > STALE_DECODE_COUNT)
+			{
+				Context = &DecodeContext[i];
+				Context->Svid = 0;
+				break;
+			}
+		}
+	}
+	if (!Context)
+		return Context;
+	if (Context->Svid != Svid)
+	{
+		Context->LogicChannel = LogicChannel;
+		Context->Svid = Svid;
+		Context->SymbolCount = 0;
+		Context->PageSync = Context->SyncMiss = 0;
+		Context->EvenValid = 0;
+		Context->WordMask = 0;
+		Context->StageIod = -1;
+	}
+	Context->LastCall = DecodeCallCount;
+	return Context;
+}
+
+//*************** Match sync pattern by hard decision ****************
+// Parameters:
+//   Symbols: 10 soft symbols to match
+// Return value:
+//   1 for match, -1 for inverted match, 0 for not match
+int MatchSyncPattern(const S8 *Symbols)
+{
+	int i;
+	unsigned int Pattern = 0;
+
+	for (i = 0; i < SYNC_LENGTH; i ++)
+		Pattern = (Pattern << 1) | ((Symbols[i] < 0) ? 1 : 0);
+	if (Pattern == SYNC_PATTERN)
+		return 1;
+	else if (Pattern == (SYNC_PATTERN ^ 0x3ff))
+		return -1;
+	return 0;
+}
+
+//*************** Deinterleave and Viterbi decode one page part ****************
+//* symbols are written row by row into 8x30 block and read column by column
+//* G2 output is inverted on encoder, encoder starts and ends at state 0
+// Parameters:
+//   Symbols: 240 soft symbols following sync pattern
+//   Polarity: 1 for normal stream, -1 for inverted stream
+//   Bits: 120 decoded bits, first bit at MSB of Bits[0]
+// Return value:
+//   none
+void DecodePagePart(const S8 *Symbols, int Polarity, U32 Bits[4])
+{
+	int i, Symbol1, Symbol2;
+
+	ViterbiReset(&GalViterbi, 0);
+	for (i = 0; i < PAGE_PART_BITS; i ++)
+	{
+		// symbol 2i and 2i+1 after deinterleave
+		Symbol1 = Symbols[((2 * i) % INTERLEAVE_ROWS) * INTERLEAVE_COLUMNS + (2 * i) / INTERLEAVE_ROWS];
+		Symbol2 = Symbols[((2 * i + 1) % INTERLEAVE_ROWS) * INTERLEAVE_COLUMNS + (2 * i + 1) / INTERLEAVE_ROWS];
+		ViterbiStep(&GalViterbi, Symbol1 * Polarity, -Symbol2 * Polarity);
+	}
+	ViterbiTraceback(&GalViterbi, 0, PAGE_PART_BITS, PAGE_PART_BITS, Bits);
+}
+
+//*************** Copy bit field between bit arrays ****************
+// Parameters:
+//   Dest: destination array, first bit at MSB of Dest[0]
+//   DestPos: start bit position in destination
+//   Src: source array, first bit at MSB of Src[0]
+//   SrcPos: start bit position in source
+//   Length: number of bits to copy
+// Return value:
+//   none
+void CopyBits(U32 *Dest, int DestPos, const U32 *Src, int SrcPos, int Length)
+{
+	int i;
+	U32 Bit;
+
+	for (i = 0; i < Length; i ++, DestPos ++, SrcPos ++)
+	{
+		Bit = 0x80000000 >> (DestPos & 0x1f);
+		if (Src[SrcPos >> 5] & (0x80000000 >> (SrcPos & 0x1f)))
+			Dest[DestPos >> 5] |= Bit;
+		else
+			Dest[DestPos >> 5] &= ~Bit;
+	}
+}
+
+//*************** Assemble even and odd page part and check CRC ****************
+//* CRC-24Q covers 114bit even part and first 82bit of odd part
+// Parameters:
+//   Context: pointer to decode context
+//   Bits: 120 decoded bits of page part
+// Return value:
+//   none
+void PageProc(PGAL_DECODE_CONTEXT Context, const U32 Bits[4])
+{
+	NAV_MESSAGE OddPart = { Bits, 32, -1 };
+	U32 CrcData[7], Word[4];
+	U8 CrcBytes[25];
+	unsigned int Crc;
+	int i;
+
+	if ((Bits[0] & 0x80000000) == 0)	// even part
+	{
+		memcpy(Context->EvenPart, Bits, sizeof(Context->EvenPart));
+		Context->EvenValid = ((Bits[0] & 0x40000000) == 0);	// alert page not decoded
+		return;
+	}
+	if (!Context->EvenValid)
+		return;
+	Context->EvenValid = 0;
+
+	// 4 leading zeros to make 196bit byte aligned
+	CrcData[0] = 0;
+	CopyBits(CrcData, 4, Context->EvenPart, 0, 114);
+	CopyBits(CrcData, 118, Bits, 0, 82);
+	for (i = 0; i < 25; i ++)
+		CrcBytes[i] = (U8)(CrcData[i/4] >> (24 - (i & 3) * 8));
+	Crc = (unsigned int)GetNavBits(&OddPart, 82, 24);
+	if (Crc24q(CrcBytes, 25) != Crc)
+	{
+		DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "GAL SV%02d page CRC fail\n", Context->Svid);
+		return;
+	}
+
+	// 112bit data of even part and 16bit data of odd part
+	CopyBits(Word, 0, Context->EvenPart, 2, 112);
+	CopyBits(Word, 112, Bits, 2, 16);
+	GalWordDecode(Context, Word);
+}
+
+//*************** Decode I/NAV word ****************
+//* ephemeris is updated when word type 1~4 with same IODnav are all received
+// Parameters:
+//   Context: pointer to decode context
+//   Word: 128bit word, first bit at MSB of Word[0]
+// Return value:
+//   none
+void GalWordDecode(PGAL_DECODE_CONTEXT Context, const U32 Word[4])
+{
+	NAV_MESSAGE Message = { Word, 32, -1 };
+	PGNSS_EPHEMERIS pEph = &Context->Ephemeris;
+	GNSS_EPHEMERIS Ephemeris;
+	int Type = (int)(Word[0] >> 26);
+	int Iod, Health;
+
+	DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "GAL SV%02d word type %d\n", Context->Svid, Type);
+	if (Context->Svid < 1 || Context->Svid > TOTAL_GAL_SAT_NUMBER)
+		return;
+	if (Type == 5)
+	{
+		DecodeNavFields(&Message, GalWord5Fields, NAV_FIELD_NUMBER(GalWord5Fields), pEph);
+		pEph->week += 1024;		// GST week 0 is GPS week 1024
+		Health = (int)GetNavBits(&Message, 69, 2) | ((int)GetNavBits(&Message, 72, 1) << 2);	// E1-B HS and DVS
+		pEph->health = (unsigned char)Health;
+		Context->WordMask |= 0x10;
+		if (g_GalileoEphemeris[Context->Svid-1].flag)	// apply to current ephemeris as a new version
+		{
+			memcpy(&Ephemeris, &g_GalileoEphemeris[Context->Svid-1], sizeof(GNSS_EPHEMERIS));
+			Ephemeris.tgd = pEph->tgd;
+			Ephemeris.tgd2 = pEph->tgd2;
+			Ephemeris.week = pEph->week;
+			Ephemeris.health = pEph->health;
+			if (Health)
+				Ephemeris.flag = 0;
+			PublishEphemeris(&g_GalileoEphemeris[Context->Svid-1], &Ephemeris);
+		}
+		return;
+	}
+	if (Type < 1 || Type > 4)
+		return;
+
+	Iod = (int)GetNavBits(&Message, 6, 10);
+	if (Iod != Context->StageIod)	// new ephemeris set, discard words of previous IODnav
+	{
+		Context->StageIod = Iod;
+		Context->WordMask &= ~EPH_WORD_MASK;
+	}
+	switch (Type)
+	{
+	case 1:
+		DecodeNavFields(&Message, GalWord1Fields, NAV_FIELD_NUMBER(GalWord1Fields), pEph);
+		pEph->toe *= 60;
+		break;
+	case 2:
+		DecodeNavFields(&Message, GalWord2Fields, NAV_FIELD_NUMBER(GalWord2Fields), pEph);
+		break;
+	case 3:
+		DecodeNavFields(&Message, GalWord3Fields, NAV_FIELD_NUMBER(GalWord3Fields), pEph);
+		break;
+	case 4:
+		DecodeNavFields(&Message, GalWord4Fields, NAV_FIELD_NUMBER(GalWord4Fields), pEph);
+		pEph->toc *= 60;
+		break;
+	}
+	Context->WordMask |= (1 << (Type - 1));
+	if ((Context->WordMask & EPH_WORD_MASK) != EPH_WORD_MASK)
+		return;
+	Context->WordMask &= ~EPH_WORD_MASK;
+
+	pEph->iodc = (unsigned short)Iod;
+	pEph->iode2 = pEph->iode3 = (unsigned char)Iod;
+	pEph->svid = (unsigned char)Context->Svid;
+	if (!(Context->WordMask & 0x10))	// word type 5 not received yet
+	{
+		pEph->health = 0;
+		pEph->tgd = pEph->tgd2 = 0.;
+		pEph->week = g_GalileoEphemeris[Context->Svid-1].week;
+	}
+	pEph->flag = pEph->health ? 0 : 1;
+	pEph->axis_dot = 0.;
+	if (!PublishEphemeris(&g_GalileoEphemeris[Context->Svid-1], pEph))
+		return;
+	DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "GAL SV%02d ephemeris IODnav %d toe %d\n", Context->Svid, Iod, pEph->toe);
+}
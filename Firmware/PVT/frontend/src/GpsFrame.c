@@ -48,15 +48,25 @@ typedef struct
 static RAW_ALMANAC RawAlmanac[32];
 static unsigned int RawAlmanacMask;
 
+// received raw words (D1~D30 with positive polarity) used to predict navigation bits
+// subframe words in same order as NavDataStream (TLM at index 9)
+static unsigned int RawSubframe[32][3][10];
+static unsigned int RawSubframeMask[32];	// bit0~2 for subframe 1~3 valid, bit3 for TLM and HOW flags valid
+static unsigned int RawTlm[32];				// latest TLM word
+static unsigned int HowFlags[32];			// alert and anti-spoof flags in latest HOW word
+#define RAW_TLM_VALID 0x8
+
 static void FillInBits(unsigned int *target, unsigned int *src0, unsigned int *src1, int number);
 static int GetTowFromWord(unsigned int word);
 static int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data);
 static int DecodeGpsEphemeris(PGNSS_EPHEMERIS pEph, const unsigned int SubframeData[3][10]);
 static void DecodeGpsAlm(const unsigned int *SubframeData, int PageId);
-static void DecodeRawAlm(const int *data, PRAW_ALMANAC pAlm);
 static void ConvertAlmanac(PRAW_ALMANAC pRawAlm, PMIDI_ALMANAC pAlm, int week);
+static void SaveRawSubframe(int svid, int frame_id, const unsigned int *RawWords, int NegativeStream);
+static int PredictWord(int svid, int tow, int WordIndex, unsigned int *Word);
 
 extern BOOL GpsParityCheck(unsigned int word);
+extern unsigned int GetParity(unsigned int word);
 
 //*************** GPS data decode initialization ****************
 // Parameters:
@@ -66,6 +76,7 @@ extern BOOL GpsParityCheck(unsigned int word);
 void GpsDecodeInit()
 {
 	RawAlmanacMask = 0;
+	memset(RawSubframeMask, 0, sizeof(RawSubframeMask));
 }
 
 //*************** GPS Frame sync process ****************
@@ -356,6 +367,8 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 	int i, TOW, PageId;
 	int svid = pChannelStatus->svid;
 	PGPS_FRAME_INFO pFrameInfo = (PGPS_FRAME_INFO)(pChannelStatus->FrameInfo);
+	unsigned int RawWords[10];
+	GNSS_EPHEMERIS Ephemeris;
 
 	if (HOW_WORD & 0x40000000)
 		frame_id ^= 0x7;
@@ -378,6 +391,7 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 		return 6;
 
 	// restore contents d1~d24, by XOR D30* with D1~D24
+	memcpy(RawWords, data, sizeof(RawWords));
 	for (i = 9; i >= 0; i --)
 	{
 		if (!GpsParityCheck((unsigned int)(data[i])))
@@ -385,6 +399,8 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 		if (data[i] & 0x40000000)
 			data[i] ^= 0x3fffffc0;
 	}
+	// all words pass parity check, keep raw words for navigation bit prediction
+	SaveRawSubframe(svid, frame_id, RawWords, pFrameInfo->FrameFlag & NEGATIVE_STREAM);
 
 	// if match existing ephemeris, for subframe 1/2/3, do not do data decode
 	if (frame_id == 1)
@@ -441,8 +457,11 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 		{
 			if (g_GpsEphemeris[svid-1].flag == 0 || pFrameInfo->iodc != g_GpsEphemeris[svid-1].iodc)
 			{
-				g_GpsEphemeris[svid-1].svid = svid;
-				DecodeGpsEphemeris(&g_GpsEphemeris[svid-1], pFrameInfo->SubframeData);
+				// decode into staging copy, current ephemeris replaced only after validation
+				memcpy(&Ephemeris, &g_GpsEphemeris[svid-1], sizeof(GNSS_EPHEMERIS));
+				Ephemeris.svid = svid;
+				DecodeGpsEphemeris(&Ephemeris, pFrameInfo->SubframeData);
+				PublishEphemeris(&g_GpsEphemeris[svid-1], &Ephemeris);
 			}
 		}
 		else
@@ -456,6 +475,184 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 	return frame_id;
 }
 
+//*************** Save raw words of received subframe for navigation bit prediction ****************
+//* TLM and HOW flags are saved for all subframes, words 3~10 are saved for subframe 1~3
+//* if subframe 1~3 content differs from saved one (new upload), all saved subframes
+//* are dropped so that prediction stops until each subframe is received again
+// Parameters:
+//   svid: satellite ID
+//   frame_id: subframe ID
+//   RawWords: 10 received words (TLM at index 9) passed parity check
+//   NegativeStream: non-zero if received stream is inverted
+// Return value:
+//   none
+void SaveRawSubframe(int svid, int frame_id, const unsigned int *RawWords, int NegativeStream)
+{
+	int i;
+	unsigned int Word, Polarity = NegativeStream ? 0x3fffffff : 0;
+	unsigned int *SavedWords;
+
+	if (svid < 1 || svid > 32)
+		return;
+	svid --;
+	RawTlm[svid] = (RawWords[9] ^ Polarity) & 0x3fffffff;
+	Word = RawWords[8];
+	if (Word & 0x40000000)
+		Word ^= 0x3fffffc0;
+	HowFlags[svid] = Word & 0x1800;	// alert flag and anti-spoof flag
+	RawSubframeMask[svid] |= RAW_TLM_VALID;
+
+	if (frame_id > 3)
+		return;
+	SavedWords = RawSubframe[svid][frame_id-1];
+	if (RawSubframeMask[svid] & (1 << (frame_id - 1)))
+	{
+		for (i = 0; i < 8; i ++)
+			if (SavedWords[i] != ((RawWords[i] ^ Polarity) & 0x3fffffff))
+				break;
+		if (i < 8)	// predicted subframe is wrong, stop prediction on subframe 1~3
+			RawSubframeMask[svid] &= ~7;
+	}
+	for (i = 0; i < 8; i ++)
+		SavedWords[i] = (RawWords[i] ^ Polarity) & 0x3fffffff;
+	RawSubframeMask[svid] |= (1 << (frame_id - 1));
+}
+
+//*************** Predict one word of GPS LNAV data stream ****************
+//* TLM uses latest received TLM, HOW is generated from TOW with parity bits calculated
+//* word 3~10 of subframe 1~3 use saved raw words, word 3~10 of subframe 4/5 cannot predict
+// Parameters:
+//   svid: satellite ID
+//   tow: TOW of the subframe
+//   WordIndex: 0 for TLM, 1 for HOW, 2~9 for word 3~10
+//   Word: predicted 30bit word (D1 at bit29)
+// Return value:
+//   1 if the word can be predicted, otherwise 0
+int PredictWord(int svid, int tow, int WordIndex, unsigned int *Word)
+{
+	int t, frame_id = tow % 5 + 1;
+	unsigned int HowData, HowWord, Parity;
+
+	svid --;
+	if ((RawSubframeMask[svid] & RAW_TLM_VALID) == 0)
+		return 0;
+	if (WordIndex == 0)
+	{
+		*Word = RawTlm[svid];
+		return 1;
+	}
+	else if (WordIndex == 1)
+	{
+		// d1~d17 TOW of next subframe, d18/d19 flags, d20~d22 subframe ID, d23/d24 solved to make D29/D30 zero
+		t = (tow >= MAX_GPS_TOW) ? 0 : (tow + 1);
+		HowData = ((unsigned int)t << 13) | HowFlags[svid] | (frame_id << 8);
+		for (Parity = 0; Parity < 4; Parity ++)
+		{
+			HowWord = HowData | (Parity << 6);
+			if (RawTlm[svid] & 1)	// D30* of TLM is 1, invert d1~d24
+				HowWord ^= 0x3fffffc0;
+			HowWord |= (RawTlm[svid] << 30);	// D29* and D30* at bit31 and bit30
+			if ((GetParity(HowWord) & 3) == 0)
+			{
+				*Word = (HowWord & 0x3fffffc0) | GetParity(HowWord);
+				return 1;
+			}
+		}
+		return 0;
+	}
+	else if (frame_id <= 3 && (RawSubframeMask[svid] & (1 << (frame_id - 1))))
+	{
+		*Word = RawSubframe[svid][frame_id-1][9-WordIndex];
+		return 1;
+	}
+	return 0;
+}
+
+//*************** Predict navigation bits following received data stream ****************
+//* prediction starts from the bit following the last bit put into frame buffer
+//* and stops at the first word cannot be predicted
+// Parameters:
+//   pChannelStatus: pointer to channel status structure
+//   BitStream: predicted bits with first bit at MSB of BitStream[0]
+// Return value:
+//   number of predicted bits (maximum 64)
+int GpsPredictBits(PCHANNEL_STATUS pChannelStatus, unsigned int BitStream[2])
+{
+	PGPS_FRAME_INFO pFrameInfo = (PGPS_FRAME_INFO)(pChannelStatus->FrameInfo);
+	int BitIndex, BitNumber = 0, WordIndex, tow, Shift;
+	unsigned int Word;
+
+	BitStream[0] = BitStream[1] = 0;
+	if (pFrameInfo->FrameStatus <= 30 || pFrameInfo->tow < 0 || (pFrameInfo->FrameFlag & POLARITY_VALID) == 0 || pChannelStatus->svid < 1 || pChannelStatus->svid > 32)
+		return 0;
+	// NavBitNumber includes D29 and D30 of previous subframe
+	BitIndex = pFrameInfo->NavBitNumber - 2;
+	tow = pFrameInfo->tow;
+	if (BitIndex < 0 || BitIndex >= 300)
+		return 0;
+
+	while (BitNumber < 64)
+	{
+		WordIndex = BitIndex / 30;
+		if (!PredictWord(pChannelStatus->svid, tow, WordIndex, &Word))
+			break;
+		// put remaining bits of the word into bit stream
+		for (Shift = 29 - BitIndex % 30; Shift >= 0 && BitNumber < 64; Shift --, BitNumber ++, BitIndex ++)
+			BitStream[BitNumber >> 5] |= ((Word >> Shift) & 1) << (31 - (BitNumber & 0x1f));
+		if (BitIndex == 300)	// move to next subframe
+		{
+			BitIndex = 0;
+			tow = (tow >= MAX_GPS_TOW) ? 0 : (tow + 1);
+		}
+	}
+	// predicted words are positive polarity, invert to match received stream
+	if (pFrameInfo->FrameFlag & NEGATIVE_STREAM)
+	{
+		BitStream[0] ^= (BitNumber >= 32) ? 0xffffffff : ~(0xffffffff >> BitNumber);
+		if (BitNumber > 32)
+			BitStream[1] ^= ~(0xffffffff >> (BitNumber - 32));
+	}
+
+	return BitNumber;
+}
+
+// field position is bit index within 300bit subframe (D1 of WORD1 as bit 0)
+// fields interrupted by parity bits are given as MSB part and LSB part
+static const NAV_FIELD_DESC GpsSubframe1Fields[] = {
+	NAV_FIELD2(GNSS_EPHEMERIS, iodc, 82, 2, 210, 8, 0, NAV_FIELD_SHORT),
+	NAV_FIELD(GNSS_EPHEMERIS, week, 60, 10, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, ura, 72, 4, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(GNSS_EPHEMERIS, tgd, 196, 8, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, toc, 218, 16, -4, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, af0, 270, 22, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af1, 248, 16, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af2, 240, 8, 55, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+};
+
+static const NAV_FIELD_DESC GpsSubframe2Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, iode2, 60, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(GNSS_EPHEMERIS, crs, 68, 16, 5, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, delta_n, 90, 16, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD2(GNSS_EPHEMERIS, M0, 106, 8, 120, 24, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cuc, 150, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD2(GNSS_EPHEMERIS, ecc, 166, 8, 180, 24, 33, NAV_FIELD_DOUBLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cus, 210, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD2(GNSS_EPHEMERIS, sqrtA, 226, 8, 240, 24, 19, NAV_FIELD_DOUBLE),
+	NAV_FIELD(GNSS_EPHEMERIS, toe, 270, 16, -4, NAV_FIELD_INT),
+};
+
+static const NAV_FIELD_DESC GpsSubframe3Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, iode3, 270, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(GNSS_EPHEMERIS, cic, 60, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD2(GNSS_EPHEMERIS, omega0, 76, 8, 90, 24, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cis, 120, 16, 29, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD2(GNSS_EPHEMERIS, i0, 136, 8, 150, 24, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, crc, 180, 16, 5, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD2(GNSS_EPHEMERIS, w, 196, 8, 210, 24, 31, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, omega_dot, 240, 24, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, idot, 278, 14, 43, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+};
+
 //*************** Decode GPS frame data to get ephemeris ****************
 // Parameters:
 //   pEph: pointer to ephemeris structure
@@ -464,11 +661,10 @@ int GpsFrameDecode(PCHANNEL_STATUS pChannelStatus, unsigned int *data)
 //   1 if decode success, otherwise 0
 int DecodeGpsEphemeris(PGNSS_EPHEMERIS pEph, const unsigned int SubframeData[3][10])
 {
-	const int *data;
+	NAV_MESSAGE Subframe = { SubframeData[0], 30, 9 };
 
 	// subframe 1:
-	data = (const int *)SubframeData[0];
-	pEph->health = GET_UBITS(WORD3, 8, 6);
+	pEph->health = (unsigned char)GetNavBits(&Subframe, 76, 6);
 	if (pEph->health != 0)
 	{
 		pEph->flag = 0;
@@ -476,48 +672,21 @@ int DecodeGpsEphemeris(PGNSS_EPHEMERIS pEph, const unsigned int SubframeData[3][
 	}
 	pEph->flag = 1;
 
-	pEph->iodc = ((WORD3 << 2) & 0x300) | GET_UBITS(WORD8, 22, 8);
-	pEph->week = 1024 + (int)GET_UBITS(WORD3, 20, 10);
+	DecodeNavFields(&Subframe, GpsSubframe1Fields, NAV_FIELD_NUMBER(GpsSubframe1Fields), pEph);
+	pEph->week += 1024;
 	if (pEph->week < 500)	// week number for 2009/3/28 and later
 		pEph->week += 1024;
-	pEph->ura = GET_UBITS(WORD3, 14, 4);
-	pEph->tgd = ScaleDouble(GET_BITS(WORD7, 6, 8), 31); // .31
-	pEph->toc = (int)GET_UBITS(WORD8, 6, 16) * 16;
-	pEph->af0 = ScaleDouble(GET_BITS(WORD10, 8, 22), 31); // .31
-	pEph->af1 = ScaleDouble(GET_BITS(WORD9, 6, 16), 43); // .43
-	pEph->af2 = ScaleDouble(GET_BITS(WORD9, 22, 8), 55); // .55
 
 	// subframe 2:
-	data = (int *)SubframeData[1];
-	pEph->iode2 = GET_UBITS(WORD3, 22, 8);
-	pEph->crs = ScaleDouble(GET_BITS(WORD3, 6, 16), 5); // .5
-	pEph->delta_n = ScaleDouble(GET_BITS(WORD4, 14, 16), 43) * PI; // .43 * PI
-	pEph->M0 = ScaleDouble(((WORD4 << 18) & 0xff000000) | GET_UBITS(WORD5, 6, 24), 31) * PI; // .31 * PI
-	pEph->cuc = ScaleDouble(GET_BITS(WORD6, 14, 16), 29); // .29
-	pEph->ecc = ScaleDoubleU(((WORD6 << 18) & 0xff000000) | GET_UBITS(WORD7, 6, 24), 33); // .33
-	pEph->cus = ScaleDouble(GET_BITS(WORD8, 14, 16), 29); // .29
-	pEph->sqrtA = ScaleDoubleU(((WORD8 << 18) & 0xff000000) | GET_UBITS(WORD9, 6, 24), 19); // .19
-	pEph->toe = (int)GET_UBITS(WORD10, 14, 16) * 16;
+	Subframe.Data = SubframeData[1];
+	DecodeNavFields(&Subframe, GpsSubframe2Fields, NAV_FIELD_NUMBER(GpsSubframe2Fields), pEph);
 
 	// subframe 3:
-	data = (int *)SubframeData[2];
-	pEph->iode3 = GET_UBITS(WORD10, 22, 8);
-	pEph->cic = ScaleDouble(GET_BITS(WORD3, 14, 16), 29); // .29
-	pEph->omega0 = ScaleDouble(((WORD3 << 18) & 0xff000000) | GET_UBITS(WORD4, 6, 24), 31) * PI; // .31 * PI
-	pEph->cis = ScaleDouble(GET_BITS(WORD5, 14, 16), 29); // .29
-	pEph->i0 = ScaleDouble(((WORD5 << 18) & 0xff000000) | GET_UBITS(WORD6, 6, 24), 31) * PI; // .31 * PI
-	pEph->crc = ScaleDouble(GET_BITS(WORD7, 14, 16), 5); // .5
-	pEph->w = ScaleDouble(((WORD7 << 18) & 0xff000000) | GET_UBITS(WORD8, 6, 24), 31) * PI; // .31 * PI
-	pEph->omega_dot = ScaleDouble(GET_BITS(WORD9, 6, 24), 43) * PI; 
-	pEph->idot = ScaleDouble(GET_BITS(WORD10, 8, 14), 43) * PI; // .43 * PI
-
-	// calculate derived variables
+	Subframe.Data = SubframeData[2];
+	DecodeNavFields(&Subframe, GpsSubframe3Fields, NAV_FIELD_NUMBER(GpsSubframe3Fields), pEph);
+	// derived variables calculated in PublishEphemeris()
 	pEph->axis_dot = 0.;
-	pEph->axis = pEph->sqrtA * pEph->sqrtA;
-	pEph->n = WGS_SQRT_GM / (pEph->sqrtA * pEph->axis) + pEph->delta_n;
-	pEph->root_ecc = sqrt(1.0 - pEph->ecc * pEph->ecc);
-	pEph->omega_t = pEph->omega0 - WGS_OMEGDOTE * pEph->toe;
-	pEph->omega_delta = pEph->omega_dot - WGS_OMEGDOTE;
+	pEph->isc_l1ca = pEph->isc_l5q5 = 0.;	// ISC only broadcast in CNAV message
 	return 1;
 }
 
@@ -529,6 +698,44 @@ static const int pg2svid4[] = {57,25,26,27,28,57,29,30,31,32,57,62,52,53,54,57,5
 // This is the order in which the subframe 5 page ID's are subcommutated.
 static const int pg2svid5[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,51};
 
+// subframe 4 page 18 (page ID 56)
+static const NAV_FIELD_DESC GpsIonoFields[] = {
+	NAV_FIELD(GPS_IONO_PARAM, a0, 68, 8, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, a1, 76, 8, 27, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, a2, 90, 8, 24, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, a3, 98, 8, 24, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, b0, 106, 8, -11, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, b1, 120, 8, -14, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, b2, 128, 8, -16, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GPS_IONO_PARAM, b3, 136, 8, -16, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+};
+
+static const NAV_FIELD_DESC GpsUtcFields[] = {
+	NAV_FIELD2(UTC_PARAM, A0, 180, 24, 210, 8, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(UTC_PARAM, A1, 150, 24, 50, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(UTC_PARAM, tot, 218, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(UTC_PARAM, WN, 226, 8, 0, NAV_FIELD_SHORT),
+	NAV_FIELD(UTC_PARAM, TLS, 240, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(UTC_PARAM, WNLSF, 248, 8, 0, NAV_FIELD_SHORT),
+	NAV_FIELD(UTC_PARAM, DN, 256, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(UTC_PARAM, TLSF, 270, 8, 0, NAV_FIELD_CHAR),
+};
+
+// raw almanac in subframe 4/5 page, af0 is interrupted by af1
+static const NAV_FIELD_DESC GpsRawAlmFields[] = {
+	NAV_FIELD(RAW_ALMANAC, toa, 90, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(RAW_ALMANAC, health, 136, 8, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(RAW_ALMANAC, ecc, 68, 16, 0, NAV_FIELD_SHORT),
+	NAV_FIELD(RAW_ALMANAC, delta_i, 98, 16, 0, NAV_FIELD_SHORT | NAV_FIELD_SIGNED),
+	NAV_FIELD(RAW_ALMANAC, omega_dot, 120, 16, 0, NAV_FIELD_SHORT | NAV_FIELD_SIGNED),
+	NAV_FIELD(RAW_ALMANAC, sqrtA, 150, 24, 0, NAV_FIELD_INT),
+	NAV_FIELD(RAW_ALMANAC, omega0, 180, 24, 0, NAV_FIELD_INT | NAV_FIELD_SIGNED),
+	NAV_FIELD(RAW_ALMANAC, w, 210, 24, 0, NAV_FIELD_INT | NAV_FIELD_SIGNED),
+	NAV_FIELD(RAW_ALMANAC, M0, 240, 24, 0, NAV_FIELD_INT | NAV_FIELD_SIGNED),
+	NAV_FIELD2(RAW_ALMANAC, af0, 270, 8, 289, 3, 0, NAV_FIELD_SHORT | NAV_FIELD_SIGNED),
+	NAV_FIELD(RAW_ALMANAC, af1, 278, 11, 0, NAV_FIELD_SHORT | NAV_FIELD_SIGNED),
+};
+
 //*************** Decode GPS subframe 4/5 ****************
 // Parameters:
 //   SubframeData: array of 10 WORD of subframe4/5
@@ -538,6 +745,7 @@ static const int pg2svid5[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,2
 void DecodeGpsAlm(const unsigned int *SubframeData, int PageId)
 {
 	int *data = (int *)SubframeData;
+	NAV_MESSAGE Subframe = { SubframeData, 30, 9 };
 	int i, PageNumber;
 	int week;
 	PRAW_ALMANAC pAlm;
@@ -569,7 +777,7 @@ void DecodeGpsAlm(const unsigned int *SubframeData, int PageId)
 		if ((RawAlmanacMask & (1 << (PageNumber-1))) != 0)	// do not repeat decode same page
 			return;
 		pAlm = &RawAlmanac[PageNumber-1];	// page number is svid, minus 1 to get index
-		DecodeRawAlm(data, pAlm);
+		DecodeNavFields(&Subframe, GpsRawAlmFields, NAV_FIELD_NUMBER(GpsRawAlmFields), pAlm);
 		RawAlmanacMask |= (1 << (PageNumber-1));
 	}
 	else if (PageNumber == 63)//get 6 bit sv health
@@ -646,26 +854,12 @@ void DecodeGpsAlm(const unsigned int *SubframeData, int PageId)
 	}
 	else if (PageNumber == 56)	// ionosphere and UTC parameters
 	{
-		g_GpsIonoParam.a0 = ScaleDouble(GET_BITS(WORD3, 14, 8), 30);
-		g_GpsIonoParam.a1 = ScaleDouble(GET_BITS(WORD3,  6, 8), 27);
-		g_GpsIonoParam.a2 = ScaleDouble(GET_BITS(WORD4, 22, 8), 24);
-		g_GpsIonoParam.a3 = ScaleDouble(GET_BITS(WORD4, 14, 8), 24);
-		g_GpsIonoParam.b0 = ScaleDouble(GET_BITS(WORD4,  6, 8), -11);
-		g_GpsIonoParam.b1 = ScaleDouble(GET_BITS(WORD5, 22, 8), -14);
-		g_GpsIonoParam.b2 = ScaleDouble(GET_BITS(WORD5, 14, 8), -16);
-		g_GpsIonoParam.b3 = ScaleDouble(GET_BITS(WORD5,  6, 8), -16);
+		DecodeNavFields(&Subframe, GpsIonoFields, NAV_FIELD_NUMBER(GpsIonoFields), &g_GpsIonoParam);
 		g_GpsIonoParam.flag = 1;
 
 		if (WeekNumber >= 0)
 		{
-			g_GpsUtcParam.A0 = ScaleDouble(((WORD7 << 2) & 0xffffff00) | GET_UBITS(WORD8, 22, 8), 30);
-			g_GpsUtcParam.A1 = ScaleDouble(GET_BITS(WORD6, 6, 24), 50);
-			g_GpsUtcParam.tot = GET_UBITS(WORD8, 14, 8);// * 4096
-			g_GpsUtcParam.WN = GET_UBITS(WORD8, 6, 8);
-			g_GpsUtcParam.TLS = GET_UBITS(WORD9, 22, 8);
-			g_GpsUtcParam.WNLSF = GET_UBITS(WORD9, 14, 8);
-			g_GpsUtcParam.DN = GET_UBITS(WORD9, 6, 8);
-			g_GpsUtcParam.TLSF = GET_UBITS(WORD10, 22, 8);
+			DecodeNavFields(&Subframe, GpsUtcFields, NAV_FIELD_NUMBER(GpsUtcFields), &g_GpsUtcParam);	// tot in unit of 4096s
 			g_GpsUtcParam.flag = 1;
 
 			// restore WN and WNLSF from truncated value
@@ -684,30 +878,6 @@ void DecodeGpsAlm(const unsigned int *SubframeData, int PageId)
 	}
 }
 
-//*************** Decode subframe data to raw almanac ****************
-//* raw almanac is fixed point almanac parameters decoded from data segment of subframe data
-//* the raw almanac will be converted to almanac structure after week number decoded
-// Parameters:
-//   dData: array of 10 WORD of subframe4/5
-//   pAlm: pointer to raw almanac
-// Return value:
-//   none
-void DecodeRawAlm(const int *data, PRAW_ALMANAC pAlm)
-{
-	pAlm->toa = (int)GET_UBITS(WORD4, 22, 8);
-	pAlm->health = GET_UBITS(WORD5, 6, 8);
-	pAlm->ecc = GET_UBITS(WORD3, 6, 16);
-	pAlm->delta_i = GET_BITS(WORD4, 6, 16);
-	pAlm->omega_dot = GET_BITS(WORD5, 14, 16);
-	pAlm->sqrtA = GET_UBITS(WORD6, 6, 24);
-	pAlm->omega0 = GET_BITS(WORD7, 6, 24);
-	pAlm->w = GET_BITS(WORD8, 6, 24);
-	pAlm->M0 = GET_BITS(WORD9, 6, 24);
-	pAlm->af0 = (short)GET_BITS(WORD10, 22, 8) << 3;
-	pAlm->af0 |= GET_UBITS(WORD10, 8, 3);
-	pAlm->af1 = (short)GET_BITS(WORD10, 11, 11);
-}
-
 //*************** Convert raw almanac to almanac structure ****************
 // Parameters:
 //   pRawAlm: pointer to raw almanac
@@ -0,0 +1,408 @@
+//----------------------------------------------------------------------
+// L1cFrame.c:
+//   GPS L1C CNAV-2 TOI decode, de-interleaving and hard decision subframe decode
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "PlatformCtrl.h"
+#include "ChannelManager.h"
+#include "DataTypes.h"
+#include "GlobalVar.h"
+#include "SupportPackage.h"
+#include "PvtEntry.h"
+#include "FecDecode.h"
+
+#define MAX_L1C_CHANNEL 4		// number of L1C channels decoded simultaneously
+#define FRAME_SYMBOLS 1800		// 18s frame of 10ms symbols
+#define TOI_SYMBOLS 52			// subframe 1, TOI MSB plus BCH(51,8) codeword
+#define SUBFRAME2_SYMBOLS 1200	// LDPC(1200,600), information bits first
+#define SUBFRAME3_SYMBOLS 548	// LDPC(548,274), information bits first
+#define SUBFRAME2_BITS 600		// 576 data bits and 24 CRC bits
+#define SUBFRAME3_BITS 274		// 250 data bits and 24 CRC bits
+#define INTERLEAVE_ROWS 38		// block interleaver of subframe 2 and 3, written row by row and read column by column
+#define INTERLEAVE_COLUMNS 46
+#define STALE_DECODE_COUNT 64	// decode context not called in this number of tasks can be reused
+
+// feedback taps of 8 stage LFSR generating TOI BCH codeword, g(x)=763(oct), oldest stage at bit7
+// the LFSR has period 51, so codewords form cyclic (51,8) code with weights 24 and 32 (reversed taps have period 255)
+#define BCH_LFSR_TAPS 0xcf
+#define BCH_CODEWORD_MASK 0x7ffffffffffffULL	// 51bit
+// TOI and TOI^0x100 are complementary, 52 symbol code has minimum distance 20, so up to 9 symbol errors are corrected
+#define TOI_MAX_ERRORS 9
+#define CNAV2_AREF 26559710.0	// reference semi-major axis
+#define CNAV2_OMEGA_DOT_REF (-2.6e-9 * PI)	// reference rate of right ascension in rad/s
+
+// decode context of one L1C channel
+typedef struct
+{
+	int LogicChannel;		// -1 if context not used
+	int Svid;
+	unsigned int LastCall;	// value of DecodeCallCount on latest call
+	int SymbolCount;		// number of symbols of current frame in Symbols[], -1 if waiting for frame start
+	S8 Symbols[FRAME_SYMBOLS];
+} L1C_DECODE_CONTEXT, *PL1C_DECODE_CONTEXT;
+
+static L1C_DECODE_CONTEXT DecodeContext[MAX_L1C_CHANNEL];
+static unsigned int DecodeCallCount;
+static U64 BchCodeword[256];	// 51bit BCH codeword of 8 TOI LSBs, first symbol at bit50
+// frame is decoded within one call, so working buffers are shared by all channels
+static S8 Deinterleaved[SUBFRAME2_SYMBOLS + SUBFRAME3_SYMBOLS];
+
+static PL1C_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid);
+static int DecodeToi(const S8 *Symbols);
+static int DecodeSubframe(const S8 *Symbols, int BitNumber, int Polarity, U32 *Bits);
+static int CheckCrc(const U32 *Bits, int BitNumber);
+static int L1cFrameDecode(PL1C_DECODE_CONTEXT Context);
+static void DecodeCnav2Ephemeris(int Svid, const U32 *Subframe2);
+
+// CNAV-2 subframe 2 ephemeris and clock fields, position is bit index within subframe 2
+// axis holds delta to reference semi-major axis, toe holds value in unit of 300s
+static const NAV_FIELD_DESC L1cSubframe2Fields[] = {
+	NAV_FIELD(GNSS_EPHEMERIS, week, 0, 13, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, health, 32, 1, 0, NAV_FIELD_CHAR),
+	NAV_FIELD(GNSS_EPHEMERIS, ura, 33, 5, 0, NAV_FIELD_CHAR),	// URA_ED index
+	NAV_FIELD(GNSS_EPHEMERIS, toe, 38, 11, 0, NAV_FIELD_INT),
+	NAV_FIELD(GNSS_EPHEMERIS, axis, 49, 26, 9, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, axis_dot, 75, 25, 21, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, delta_n, 100, 17, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, M0, 140, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, ecc, 173, 33, 34, NAV_FIELD_DOUBLE),
+	NAV_FIELD(GNSS_EPHEMERIS, w, 206, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, omega0, 239, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, i0, 272, 33, 32, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, omega_dot, 305, 17, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, idot, 322, 15, 44, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED | NAV_FIELD_SEMI_CIRCLE),
+	NAV_FIELD(GNSS_EPHEMERIS, cis, 337, 16, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cic, 353, 16, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crs, 369, 24, 8, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, crc, 393, 24, 8, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cus, 417, 21, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, cuc, 438, 21, 30, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af0, 470, 26, 35, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af1, 496, 20, 48, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, af2, 516, 10, 60, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+	NAV_FIELD(GNSS_EPHEMERIS, tgd, 526, 13, 35, NAV_FIELD_DOUBLE | NAV_FIELD_SIGNED),
+};
+
+//*************** GPS L1C data decode initialization ****************
+// Parameters:
+//   none
+// Return value:
+//   none
+void L1cDecodeInit()
+{
+	int i, j;
+	unsigned int State, Feedback;
+
+	for (i = 0; i < MAX_L1C_CHANNEL; i ++)
+		DecodeContext[i].LogicChannel = -1;
+	DecodeCallCount = 0;
+	Crc24qInit();
+
+	// BCH(51,8) codeword, LFSR loaded with 8 LSBs of TOI and shifted 51 times
+	for (i = 0; i < 256; i ++)
+	{
+		State = (unsigned int)i;
+		BchCodeword[i] = 0;
+		for (j = 0; j < 51; j ++)
+		{
+			BchCodeword[i] = (BchCodeword[i] << 1) | ((State >> 7) & 1);
+			Feedback = State & BCH_LFSR_TAPS;
+			Feedback ^= Feedback >> 4;
+			Feedback ^= Feedback >> 2;
+			Feedback ^= Feedback >> 1;
+			State = ((State << 1) | (Feedback & 1)) & 0xff;
+		}
+	}
+}
+
+//*************** Task to decode GPS L1C CNAV-2 data ****************
+//* 8bit soft symbols from HW data decode of L1C data channel
+// Parameters:
+//   Param: Pointer to data stream structure
+// Return value:
+//   0
+int L1cDecodeTask(void *Param)
+{
+	PDATA_STREAM DataStream = (PDATA_STREAM)Param;
+	S8 Symbols[128];
+	int i;
+
+	for (i = 0; i < DataStream->DataCount && i < 128; i ++)
+		Symbols[i] = (S8)(DataStream->DataBuffer[i/4] >> (24 - (i & 3) * 8));
+	L1cSymbolDecode(DataStream->ChannelState->LogicChannel, DataStream->ChannelState->Svid, DataStream->StartIndex, Symbols, i);
+
+	return 0;
+}
+
+//*************** Decode GPS L1C soft symbols of one channel ****************
+//* symbols are collected from frame start given by pilot overlay code sync
+//* frame info of the channel uses B-CNAV1 layout, tow is time of next frame start
+// Parameters:
+//   LogicChannel: logic channel the symbols come from
+//   Svid: GPS satellite ID (1~32)
+//   FrameIndex: position of first symbol within 1800 symbol frame
+//   Symbols: soft symbols in receive order, negative value for bit 1
+//   SymbolCount: number of symbols
+// Return value:
+//   none
+void L1cSymbolDecode(int LogicChannel, int Svid, int FrameIndex, const S8 *Symbols, int SymbolCount)
+{
+	PL1C_DECODE_CONTEXT Context = GetDecodeContext(LogicChannel, Svid);
+	PBDS_FRAME_INFO FrameInfo = (PBDS_FRAME_INFO)g_ChannelStatus[LogicChannel].FrameInfo;
+	int i, Position, Tow;
+
+	if (!Context || FrameIndex < 0)
+		return;
+	for (i = 0; i < SymbolCount; i ++)
+	{
+		Position = (FrameIndex + i) % FRAME_SYMBOLS;
+		if (Position == 0)
+			Context->SymbolCount = 0;
+		if (Context->SymbolCount != Position)	// wait for next frame start
+			continue;
+		Context->Symbols[Context->SymbolCount ++] = Symbols[i];
+		if (Context->SymbolCount < FRAME_SYMBOLS)
+			continue;
+
+		Tow = L1cFrameDecode(Context);
+		if (Tow >= 0)
+			FrameInfo->tow = Tow;
+		else if (FrameInfo->tow >= 0)	// keep time of frame start if frame decode fail
+			FrameInfo->tow = (FrameInfo->tow + 18) % 604800;
+	}
+	FrameInfo->NavBitNumber = (unsigned short)((FrameIndex + SymbolCount) % FRAME_SYMBOLS);
+}
+
+//*************** Get decode context of a logic channel ****************
+//* allocate a new context if not found, context of other satellite on same channel is reset
+// Parameters:
+//   LogicChannel: logic channel
+//   Svid: GPS satellite ID
+// Return value:
+//   pointer to decode context, NULL if no context available
+PL1C_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid)
+{
+	int i;
+	PL1C_DECODE_CONTEXT Context = (PL1C_DECODE_CONTEXT)0;
+
+	DecodeCallCount ++;
+	for (i = 0; i < MAX_L1C_CHANNEL; i ++)
+	{
+		if (DecodeContext[i].LogicChannel == LogicChannel)
+		{
+			Context = &DecodeContext[i];
+			break;
+		}
+	}
+	if (!Context)
+	{
+		for (i = 0; i < MAX_L1C_CHANNEL; i ++)
+		{
+			if (DecodeContext[i].LogicChannel < 0 || (DecodeCallCount - DecodeContext[i].LastCall) > STALE_DECODE_COUNT)
+			{
+				Context = &DecodeContext[i];
+				Context->Svid = 0;
+				break;
+			}
+		}
+	}
+	if (!Context)
+		return Context;
+	if (Context->Svid != Svid)
+	{
+		Context->LogicChannel = LogicChannel;
+		Context->Svid = Svid;
+		Context->SymbolCount = -1;
+	}
+	Context->LastCall = DecodeCallCount;
+	return Context;
+}
+
+//*************** Maximum likelihood decode of TOI ****************
+//* TOI MSB is sent as first symbol and XORed onto BCH codeword of 8 LSBs,
+//* so TOI and TOI^0x100 have complementary 52 symbols, correlate with 256 codewords
+//* decoded TOI is encoded again and compared with hard decision of received symbols,
+//* TOI is not trusted if more symbols differ than the code can correct
+// Parameters:
+//   Symbols: 52 soft symbols of subframe 1
+// Return value:
+//   9bit TOI, -1 if round trip check fails
+int DecodeToi(const S8 *Symbols)
+{
+	int i, Toi, Correlation, BestToi = 0, BestCorrelation = 0;
+	int Errors = 0;
+	U64 Codeword;
+
+	for (Toi = 0; Toi < 256; Toi ++)
+	{
+		Codeword = BchCodeword[Toi];
+		Correlation = Symbols[0];
+		for (i = 1; i < TOI_SYMBOLS; i ++)
+			Correlation += ((Codeword >> (TOI_SYMBOLS - 1 - i)) & 1) ? -Symbols[i] : Symbols[i];
+		if (Correlation > BestCorrelation || -Correlation > BestCorrelation)
+		{
+			BestCorrelation = (Correlation < 0) ? -Correlation : Correlation;
+			BestToi = (Correlation < 0) ? (Toi | 0x100) : Toi;	// negative correlation means TOI MSB is 1
+		}
+	}
+
+	// encode TOI again with MSB as first symbol at bit51
+	Codeword = (BestToi & 0x100) ? ((BchCodeword[BestToi & 0xff] ^ BCH_CODEWORD_MASK) | (1ULL << 51)) : BchCodeword[BestToi];
+	for (i = 0; i < TOI_SYMBOLS; i ++)
+		if ((int)((Codeword >> (TOI_SYMBOLS - 1 - i)) & 1) != (Symbols[i] < 0 ? 1 : 0))
+			Errors ++;
+	return (Errors <= TOI_MAX_ERRORS) ? BestToi : -1;
+}
+
+//*************** Hard decision decode of one subframe ****************
+//* LDPC code is systematic, information bits are hard decided from first BitNumber symbols
+//* and verified by CRC-24Q, parity symbols are not used
+// Parameters:
+//   Symbols: de-interleaved soft symbols, negative value for bit 1
+//   BitNumber: number of information bits
+//   Polarity: 1 for normal stream, -1 for inverted stream
+//   Bits: decoded bits, first bit at MSB of Bits[0]
+// Return value:
+//   1 if CRC check pass, otherwise 0
+int DecodeSubframe(const S8 *Symbols, int BitNumber, int Polarity, U32 *Bits)
+{
+	int i;
+
+	memset(Bits, 0, sizeof(U32) * ((BitNumber + 31) / 32));
+	for (i = 0; i < BitNumber; i ++)
+		if ((Polarity < 0) ? (Symbols[i] > 0) : (Symbols[i] < 0))
+			Bits[i >> 5] |= 0x80000000 >> (i & 0x1f);
+	return CheckCrc(Bits, BitNumber);
+}
+
+//*************** Check CRC-24Q at end of subframe ****************
+// Parameters:
+//   Bits: subframe bits, first bit at MSB of Bits[0]
+//   BitNumber: number of subframe bits including 24bit CRC
+// Return value:
+//   1 if CRC check pass, otherwise 0
+int CheckCrc(const U32 *Bits, int BitNumber)
+{
+	NAV_MESSAGE Message = { Bits, 32, -1 };
+	U8 CrcBytes[SUBFRAME2_BITS / 8];
+	int i, DataBits = BitNumber - 24;
+	int PadBits = (8 - (DataBits & 7)) & 7;	// leading zeros to make data byte aligned
+
+	CrcBytes[0] = (U8)GetNavBits(&Message, 0, 8 - PadBits);
+	for (i = 1; i < (DataBits + PadBits) / 8; i ++)
+		CrcBytes[i] = (U8)GetNavBits(&Message, i * 8 - PadBits, 8);
+	return Crc24q(CrcBytes, (DataBits + PadBits) / 8) == (unsigned int)GetNavBits(&Message, DataBits, 24);
+}
+
+//*************** Decode a complete L1C frame ****************
+//* stream polarity is determined by the one passing subframe 2 CRC
+// Parameters:
+//   Context: pointer to decode context holding 1800 symbols of frame
+// Return value:
+//   time of next frame start in seconds within week, -1 if decode fail or TOI not trusted
+int L1cFrameDecode(PL1C_DECODE_CONTEXT Context)
+{
+	NAV_MESSAGE Message;
+	U32 Subframe2[(SUBFRAME2_BITS + 31) / 32], Subframe3[(SUBFRAME3_BITS + 31) / 32];
+	int i, Toi, Polarity, Tow;
+
+	Toi = DecodeToi(Context->Symbols);
+	// symbol n after TOI is row n%38 and column n/38 of interleaver block
+	for (i = 0; i < SUBFRAME2_SYMBOLS + SUBFRAME3_SYMBOLS; i ++)
+		Deinterleaved[(i % INTERLEAVE_ROWS) * INTERLEAVE_COLUMNS + i / INTERLEAVE_ROWS] = Context->Symbols[TOI_SYMBOLS + i];
+
+	Polarity = 1;
+	if (!DecodeSubframe(Deinterleaved, SUBFRAME2_BITS, Polarity, Subframe2))
+	{
+		Polarity = -1;
+		if (!DecodeSubframe(Deinterleaved, SUBFRAME2_BITS, Polarity, Subframe2))
+		{
+			DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "L1C SV%02d subframe 2 CRC fail\n", Context->Svid);
+			return -1;
+		}
+	}
+	Message.Data = Subframe2;
+	Message.WordBits = 32;
+	Message.LastWord = -1;
+	if (Toi < 0)	// TOI fails round trip check, frame time unknown but CRC checked ephemeris still used
+	{
+		DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "L1C SV%02d TOI check fail\n", Context->Svid);
+		Tow = -1;
+	}
+	else
+	{
+		if (Polarity < 0)
+			Toi ^= 0x100;
+		// TOI is the 18s epoch count of next frame within 2 hour epoch given by ITOW
+		Tow = (int)GetNavBits(&Message, 13, 8) * 7200 + Toi * 18;
+		Tow %= 604800;
+		DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "L1C SV%02d TOI %d tow %d\n", Context->Svid, Toi, Tow);
+	}
+	DecodeCnav2Ephemeris(Context->Svid, Subframe2);
+	// if week number not valid, decode week number
+	if ((g_ReceiverInfo.PosFlag & GPS_WEEK_VALID) == 0)
+	{
+		g_ReceiverInfo.WeekNumber = (int)GetNavBits(&Message, 0, 13);
+		g_ReceiverInfo.PosFlag |= GPS_WEEK_VALID;
+	}
+
+	if (DecodeSubframe(Deinterleaved + SUBFRAME2_SYMBOLS, SUBFRAME3_BITS, Polarity, Subframe3))
+	{
+		Message.Data = Subframe3;
+		DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "L1C SV%02d subframe 3 page %d\n", Context->Svid, (int)GetNavBits(&Message, 8, 6));
+	}
+	return Tow;
+}
+
+//*************** Decode CNAV-2 subframe 2 to get ephemeris ****************
+//* LNAV ephemeris is kept if valid, CNAV-2 has no IODC and clock reference time is toe
+// Parameters:
+//   Svid: GPS satellite ID
+//   Subframe2: 600bit subframe 2 with CRC checked
+// Return value:
+//   none
+void DecodeCnav2Ephemeris(int Svid, const U32 *Subframe2)
+{
+	NAV_MESSAGE Subframe = { Subframe2, 32, -1 };
+	GNSS_EPHEMERIS Ephemeris;
+	PGNSS_EPHEMERIS pEph = &Ephemeris;
+	int IscL1cp;
+
+	if (Svid < 1 || Svid > TOTAL_GPS_SAT_NUMBER)
+		return;
+	if ((g_GpsEphemeris[Svid-1].flag & 1) && !(g_GpsEphemeris[Svid-1].flag & EPH_FLAG_CNAV2))
+		return;
+
+	memset(pEph, 0, sizeof(GNSS_EPHEMERIS));
+	DecodeNavFields(&Subframe, L1cSubframe2Fields, NAV_FIELD_NUMBER(L1cSubframe2Fields), pEph);
+	if ((g_GpsEphemeris[Svid-1].flag & EPH_FLAG_CNAV2) && g_GpsEphemeris[Svid-1].toe == pEph->toe * 300)
+		return;	// same ephemeris already decoded
+	// delta_n_dot (23bit signed at bit 117) not decoded
+
+	// fields with scale other than power of 2
+	pEph->toe *= 300;
+	pEph->toc = pEph->toe;
+	pEph->axis += CNAV2_AREF;
+	pEph->omega_dot += CNAV2_OMEGA_DOT_REF;
+	// group delay of L1C pilot is TGD-ISC_L1CP, value -4096 means not available
+	if (GetNavBits(&Subframe, 526, 13) == 0x1000)
+		pEph->tgd = 0.;
+	IscL1cp = (int)GetNavBits(&Subframe, 539, 13);
+	if (IscL1cp != 0x1000)
+		pEph->tgd -= ScaleDouble((IscL1cp & 0x1000) ? (IscL1cp - 0x2000) : IscL1cp, 35);
+	pEph->iodc = 0xffff;	// out of range of LNAV IODC
+	pEph->iode2 = pEph->iode3 = (unsigned char)(pEph->toe / 300);
+	pEph->svid = (unsigned char)Svid;
+	pEph->flag = pEph->health ? 0 : (1 | EPH_FLAG_CNAV2);
+	pEph->sqrtA = sqrt(pEph->axis);	// other derived variables calculated in PublishEphemeris()
+	if (!PublishEphemeris(&g_GpsEphemeris[Svid-1], pEph))
+		return;
+	DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "L1C SV%02d CNAV-2 ephemeris toe %d\n", Svid, pEph->toe);
+}
@@ -20,9 +20,23 @@
 #include <stdio.h>
 
 static unsigned int FrameStatusBuffer[sizeof(GPS_FRAME_INFO)*32/4];
+static int XcorrCount[TOTAL_CHANNEL_NUMBER];	// consecutive epochs of data identical to a stronger channel
+static int CoarseTimeValid;		// integer millisecond of L1C/A transmit time resolved by predicted PSR
+static double CoarsePsrOffset;	// offset in millisecond to align predicted PSR to code phase of reference channel
+
+typedef struct
+{
+	int Channel;	// logic channel
+	int Doppler;	// Doppler in Hz (modulo 1kHz for L1C/A)
+	int BitPos;		// code count within data bit in unit of 1/2 chip
+} XCORR_CHECK_ITEM, *PXCORR_CHECK_ITEM;
 
 static void ProcessReceiverTime(int CurMsInterval, int DefaultMsInterval);
 static void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int CurMsInterval, int DefaultMsInterval);
+static int PredictGpsPsr(PBB_MEASUREMENT Measurements, unsigned int ActiveMask);
+static void CheckCrossCorrelation(PBB_MEASUREMENT Measurements, unsigned int ActiveMask);
+static void SortXcorrItem(XCORR_CHECK_ITEM ItemList[], int ItemCount);
+static int CompareDataStream(PBB_MEASUREMENT pMsr1, PBB_MEASUREMENT pMsr2);
 
 #define INIT_GPS_FRAME(gps_frame) \
 do \
@@ -46,6 +60,7 @@ static void InitFrame(int ch_num)
 static void InitChannel(int ch_num)
 {
 	g_ChannelStatus[ch_num].ChannelFlag = g_ChannelStatus[ch_num].ChannelErrorFlag = 0;
+	XcorrCount[ch_num] = 0;
 	InitFrame(ch_num);
 }
 
@@ -115,15 +130,23 @@ void MsrProc(PBB_MEASUREMENT Measurements, unsigned int ActiveMask, int CurMsInt
 		g_ChannelStatus[ch_num].LockTime = Measurements[ch_num].TrackingTime;
 		g_ChannelStatus[ch_num].state = Measurements[ch_num].State;
 		g_ChannelStatus[ch_num].ChannelFlag |= CHANNEL_ACTIVE;
+		// L1C/A Doppler is available before transmit time determined, used by Doppler positioning
+		if (FreqID == FREQ_L1CA)
+		{
+			g_ChannelStatus[ch_num].DopplerHz = (double)Measurements[ch_num].CarrierFreq * ScaleDoubleU(SAMPLE_FREQ, 32) - IF_FREQ;
+			g_ChannelStatus[ch_num].Doppler = g_ChannelStatus[ch_num].DopplerHz * GPS_L1_WAVELENGTH;
+		}
 
-		// if data count less than expected in time interval, there is signal loss, init frame
-		if (Measurements[ch_num].DataNumber < CurMsInterval / ((FREQ_ID_IS_L1CA(FreqID) ? 20 : (FREQ_ID_IS_E1(FreqID) ? 4 : 10))) - 1)
+		// if data count less than expected in time interval, there is signal loss, init frame (L5 pilot has no data)
+		if (!FREQ_ID_IS_L5(FreqID) && Measurements[ch_num].DataNumber < CurMsInterval / ((FREQ_ID_IS_L1CA(FreqID) ? 20 : (FREQ_ID_IS_E1(FreqID) ? 4 : 10))) - 1)
 			InitFrame(ch_num);
 
 		// if bit sync get, do frame process
 		if ((Measurements[ch_num].State & STAGE_MASK) >= STAGE_TRACK && Measurements[ch_num].CN0 > 0)
 		{
-			if (FreqID == FREQ_L1CA)
+			if (SVID_IS_SBAS(FreqID, svid))	// SBAS message decoded in SbasDecodeTask()
+				;
+			else if (FreqID == FREQ_L1CA)
 				GpsFrameSync(&g_ChannelStatus[ch_num], Measurements[ch_num].DataNumber, Measurements[ch_num].DataStreamAddr[0], Measurements[ch_num].DataStreamAddr[1], -1);
 			else if (FreqID == FREQ_B1C)
 				BdsFrameProc(&g_ChannelStatus[ch_num]);
@@ -139,14 +162,25 @@ void MsrProc(PBB_MEASUREMENT Measurements, unsigned int ActiveMask, int CurMsInt
 	// determine or predict receiver time
 	ProcessReceiverTime(CurMsInterval, DefaultMsInterval);
 
+	// predict PSR of L1C/A channels without frame sync to resolve integer millisecond of transmit time
+	CoarseTimeValid = 0;
+	if (g_ReceiverInfo.GpsTimeQuality >= ExtSetTime && g_ReceiverInfo.PosQuality >= ExtSetPos)
+		CoarseTimeValid = PredictGpsPsr(Measurements, ActiveMask);
+
 	// loop to do measurement calculation if receiver time determined
 	meas_num = 0;
-	if (g_ReceiverInfo.GpsTimeQuality >= CoarseTime)
+	if (g_ReceiverInfo.GpsTimeQuality >= CoarseTime || CoarseTimeValid)
 	{
 		for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
 		{
-			// if corresponding channel is not activated
-			if ((ActiveMask & (1 << ch_num)) != 0)
+			// if corresponding channel is not activated, L5 channel calculated after L1C/A channel of same satellite
+			// SBAS channel only used for correction decoding
+			if ((ActiveMask & (1 << ch_num)) != 0 && !FREQ_ID_IS_L5(g_ChannelStatus[ch_num].FreqID) && !SVID_IS_SBAS(g_ChannelStatus[ch_num].FreqID, g_ChannelStatus[ch_num].svid))
+				CalculateRawMsr(&g_ChannelStatus[ch_num], &Measurements[ch_num], CurMsInterval, DefaultMsInterval);
+		}
+		for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+		{
+			if ((ActiveMask & (1 << ch_num)) != 0 && FREQ_ID_IS_L5(g_ChannelStatus[ch_num].FreqID))
 				CalculateRawMsr(&g_ChannelStatus[ch_num], &Measurements[ch_num], CurMsInterval, DefaultMsInterval);
 			if (g_ChannelStatus[ch_num].ChannelFlag & MEASUREMENT_VALID)
 				meas_num ++;
@@ -165,7 +199,190 @@ void MsrProc(PBB_MEASUREMENT Measurements, unsigned int ActiveMask, int CurMsInt
 		}
 	}
 
-	// TODO: check for cross correlation by comparing data message
+	// check for cross correlation by comparing Doppler, bit edge and data message
+	if (g_PvtConfig.PvtConfigFlags & PVT_CONFIG_XCORR_CHECK)
+		CheckCrossCorrelation(Measurements, ActiveMask);
+}
+
+//*************** Check channels tracking cross correlation peak of a stronger signal ****************
+//* L1C/A channels are sorted by Doppler modulo 1kHz, channel pairs within Doppler threshold
+//* are suspected if C/N0 gap large enough and bit edges aligned within 1ms, suspected weaker
+//* channel is confirmed if data stream identical (or inverted) to stronger one for several epochs
+// Parameters:
+//   Measurements: baseband measurement array arranged by channel
+//   ActiveMask: channel active (baseband measurement valid) indicator
+// Return value:
+//   none
+void CheckCrossCorrelation(PBB_MEASUREMENT Measurements, unsigned int ActiveMask)
+{
+	XCORR_CHECK_ITEM ItemList[TOTAL_CHANNEL_NUMBER+1];
+	int i, j, ItemCount = 0;
+	int ch_num, Strong, Weak, Diff;
+	unsigned int ConfirmMask = 0;
+
+	for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+	{
+		if ((ActiveMask & (1 << ch_num)) == 0 || Measurements[ch_num].FreqID != FREQ_L1CA || (Measurements[ch_num].State & STAGE_MASK) < STAGE_TRACK)
+			continue;
+		if (SVID_IS_SBAS(Measurements[ch_num].FreqID, Measurements[ch_num].Svid))	// SBAS data stream is soft symbol
+			continue;
+		ItemList[ItemCount].Channel = ch_num;
+		ItemList[ItemCount].Doppler = (int)(((S64)Measurements[ch_num].CarrierFreq * SAMPLE_FREQ) >> 32) - IF_FREQ;
+		ItemList[ItemCount].Doppler = ((ItemList[ItemCount].Doppler % 1000) + 1000) % 1000;
+		ItemList[ItemCount].BitPos = Measurements[ch_num].CodeCount;
+		ItemCount ++;
+	}
+	SortXcorrItem(ItemList, ItemCount);
+
+	// compare each channel with following channels within Doppler threshold (wrap around at 1kHz)
+	for (i = 0; i < ItemCount; i ++)
+	{
+		for (j = i + 1; j < i + ItemCount; j ++)
+		{
+			Diff = ItemList[j % ItemCount].Doppler - ItemList[i].Doppler;
+			if (j >= ItemCount)
+				Diff += 1000;
+			if (Diff > g_PvtConfig.XcorrDopplerTh)
+				break;
+			Strong = ItemList[i].Channel;
+			Weak = ItemList[j % ItemCount].Channel;
+			if (Measurements[Strong].CN0 < Measurements[Weak].CN0)
+			{
+				Strong = Weak;
+				Weak = ItemList[i].Channel;
+			}
+			if ((int)Measurements[Strong].CN0 - (int)Measurements[Weak].CN0 < g_PvtConfig.XcorrCN0Gap)
+				continue;
+			// cross correlation peak has bit edge aligned with stronger signal within 1ms
+			Diff = (Measurements[Strong].CodeCount - Measurements[Weak].CodeCount + 40920 * 2) % 40920;
+			if (Diff > 2046 && Diff < 40920 - 2046)
+				continue;
+			if (CompareDataStream(&Measurements[Strong], &Measurements[Weak]))
+				ConfirmMask |= (1 << Weak);
+		}
+	}
+
+	for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+	{
+		if ((ConfirmMask & (1 << ch_num)) == 0)
+		{
+			XcorrCount[ch_num] = 0;
+			continue;
+		}
+		if (++XcorrCount[ch_num] < g_PvtConfig.XcorrConfirmCount)
+			continue;
+		g_ChannelStatus[ch_num].ChannelErrorFlag |= CHANNEL_ERR_XCORR;
+		g_ChannelStatus[ch_num].ChannelFlag &= ~MEASUREMENT_FLAGS;	// do not use measurement of this epoch
+//		DEBUG_OUTPUT(OUTPUT_CONTROL(MEASUREMENT, INFO), "SV%02d cross correlation detected\n", g_ChannelStatus[ch_num].svid);
+	}
+}
+
+//*************** Sort cross correlation check items by Doppler ****************
+//* heap sort in ascending order
+// Parameters:
+//   ItemList: array of items to be sorted
+//   ItemCount: number of items
+// Return value:
+//   none
+void SortXcorrItem(XCORR_CHECK_ITEM ItemList[], int ItemCount)
+{
+	int i, Parent, Child, End;
+	XCORR_CHECK_ITEM Item;
+
+	for (End = ItemCount, i = ItemCount / 2 - 1; End > 1; )
+	{
+		if (i >= 0)	// build heap
+			Parent = i --;
+		else	// move largest to end and rebuild heap
+		{
+			Item = ItemList[0]; ItemList[0] = ItemList[--End]; ItemList[End] = Item;
+			Parent = 0;
+		}
+		// sift down
+		while ((Child = Parent * 2 + 1) < End)
+		{
+			if (Child + 1 < End && ItemList[Child + 1].Doppler > ItemList[Child].Doppler)
+				Child ++;
+			if (ItemList[Parent].Doppler >= ItemList[Child].Doppler)
+				break;
+			Item = ItemList[Parent]; ItemList[Parent] = ItemList[Child]; ItemList[Child] = Item;
+			Parent = Child;
+		}
+	}
+}
+
+//*************** Compare data stream of two channels in current epoch ****************
+// Parameters:
+//   pMsr1: baseband measurement of the first channel
+//   pMsr2: baseband measurement of the second channel
+// Return value:
+//   1 if data stream identical or inverted, 0 if different or not enough data
+int CompareDataStream(PBB_MEASUREMENT pMsr1, PBB_MEASUREMENT pMsr2)
+{
+	int i, WordNumber, DataNumber = pMsr1->DataNumber;
+	unsigned int Diff, Mask, DiffAll = 0, SameAll = 0;
+
+	if (DataNumber < 8 || pMsr2->DataNumber != DataNumber)
+		return 0;
+	WordNumber = (DataNumber + 31) / 32;
+	for (i = 0; i < WordNumber; i ++)
+	{
+		// data stream is MSB first, mask out unused bits in last word
+		Mask = (i == WordNumber - 1 && (DataNumber & 0x1f)) ? ~(0xffffffff >> (DataNumber & 0x1f)) : 0xffffffff;
+		Diff = (pMsr1->DataStreamAddr[i] ^ pMsr2->DataStreamAddr[i]) & Mask;
+		DiffAll |= Diff;
+		SameAll |= (~Diff) & Mask;
+	}
+	return (DiffAll == 0 || SameAll == 0);
+}
+
+//*************** Get mask of channels detected tracking cross correlation ****************
+// Parameters:
+//   none
+// Return value:
+//   bit mask of channels to be released
+U32 GetXcorrChannelMask()
+{
+	int ch_num;
+	U32 Mask = 0;
+
+	for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+		if ((g_ChannelStatus[ch_num].ChannelFlag & CHANNEL_ACTIVE) && (g_ChannelStatus[ch_num].ChannelErrorFlag & CHANNEL_ERR_XCORR))
+			Mask |= (1 << ch_num);
+
+	return Mask;
+}
+
+//*************** Predict navigation bits following current measurement ****************
+//* only GPS L1C/A with frame sync is predicted
+// Parameters:
+//   Measurements: baseband measurements of current epoch
+//   ActiveMask: bit mask of active channels
+//   PredictList: predicted bits of each logic channel
+// Return value:
+//   bit mask of channels with valid prediction
+U32 GetNavBitPrediction(PBB_MEASUREMENT Measurements, unsigned int ActiveMask, NAV_BIT_PREDICT PredictList[TOTAL_CHANNEL_NUMBER])
+{
+	int ch_num, BitNumber;
+	U32 PredictMask = 0;
+
+	for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+	{
+		if ((ActiveMask & (1 << ch_num)) == 0 || !(g_ChannelStatus[ch_num].ChannelFlag & CHANNEL_ACTIVE))
+			continue;
+		if (g_ChannelStatus[ch_num].FreqID != FREQ_L1CA || SVID_IS_SBAS(g_ChannelStatus[ch_num].FreqID, g_ChannelStatus[ch_num].svid))
+			continue;
+		BitNumber = GpsPredictBits(&g_ChannelStatus[ch_num], PredictList[ch_num].BitStream);
+		if (BitNumber == 0)
+			continue;
+		PredictList[ch_num].FreqID = g_ChannelStatus[ch_num].FreqID;
+		PredictList[ch_num].Svid = g_ChannelStatus[ch_num].svid;
+		PredictList[ch_num].BitNumber = (U16)BitNumber;
+		PredictList[ch_num].StartBit = Measurements[ch_num].BitCount;
+		PredictMask |= (1 << ch_num);
+	}
+
+	return PredictMask;
 }
 
 //*************** Estimate or calculate receiver time ****************
@@ -228,6 +445,12 @@ void ProcessReceiverTime(int CurMsInterval, int DefaultMsInterval)
 				WeekMsCount += ((pBdsFrameInfo->FrameFlag & 0xc) == 0xc) ? 80 : 140;
 			}
 			break;
+		case FREQ_L1C:
+			pBdsFrameInfo = (PBDS_FRAME_INFO)(g_ChannelStatus[i].FrameInfo);
+			// L1C frame info has same layout as BDS, tow set by L1cDecodeTask() on CNAV-2 frame decode
+			if (pBdsFrameInfo->tow >= 0)
+				WeekMsCount = pBdsFrameInfo->tow * 1000 + pBdsFrameInfo->NavBitNumber * 10 + 80;
+			break;
 		default:	// TODO: other satellite system
 			break;
 		}
@@ -256,9 +479,10 @@ void ProcessReceiverTime(int CurMsInterval, int DefaultMsInterval)
 //   none
 void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int CurMsInterval, int DefaultMsInterval)
 {
-	int Count;
-	int IFFreq = IF_FREQ, sv_index = pChannelStatus->svid - 1;
+	int Count, ch_num;
+	int IFFreq = IF_FREQ, SampleFreq = SAMPLE_FREQ, sv_index = pChannelStatus->svid - 1;
 	double WaveLength = GPS_L1_WAVELENGTH, PsrDiff;
+	PCHANNEL_STATUS pL1Status;
 	PGPS_FRAME_INFO pGpsFrameInfo = (PGPS_FRAME_INFO)(pChannelStatus->FrameInfo);
 	PBDS_FRAME_INFO pBdsFrameInfo = (PBDS_FRAME_INFO)(pChannelStatus->FrameInfo);
 
@@ -272,7 +496,7 @@ void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int C
 	// integer part of code count and fractional part of code NCO
 	pChannelStatus->TransmitTime = (double)pMsr->CodeCount + ScaleDoubleU(pMsr->CodeNCO, 32);
 	// divide correlator interval to get fractional part of transmit time in unit of millisecond
-	pChannelStatus->TransmitTime /= 2046.;
+	pChannelStatus->TransmitTime /= FREQ_ID_IS_L5(pChannelStatus->FreqID) ? 20460. : 2046.;
 
 	// determine integer part of transmit time
 	switch (pChannelStatus->FreqID)
@@ -283,6 +507,14 @@ void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int C
 			// transmit time is current tow*6000ms plus bit_count*20ms
 			pChannelStatus->TransmitTimeMs = pGpsFrameInfo->tow * 6000 + (pGpsFrameInfo->NavBitNumber - 2) * 20;
 		}
+		else if (CoarseTimeValid && (g_GpsSatelliteInfo[sv_index].SatInfoFlag & SAT_INFO_PSR_VALID))	// coarse time, only sub-millisecond code phase used
+		{
+			pChannelStatus->TransmitTime -= (int)pChannelStatus->TransmitTime;
+			PsrDiff = g_GpsSatelliteInfo[sv_index].PsrPredict / LIGHT_SPEED_MS;
+			PsrDiff += pChannelStatus->TransmitTime + CoarsePsrOffset;
+			pChannelStatus->TransmitTimeMs = g_ReceiverInfo.GpsMsCount - (int)floor(PsrDiff + 0.5);
+			pChannelStatus->ChannelFlag |= TRANSTIME_ESTIMATE;
+		}
 		else if (g_ReceiverInfo.PosQuality >= KalmanPos && pChannelStatus->LockTime > 0 && (g_GpsSatelliteInfo[sv_index].SatInfoFlag & SAT_INFO_PSR_VALID))	// recover transmit time from valid receiver position
 		{
 			PsrDiff = g_GpsSatelliteInfo[sv_index].PsrPredict / LIGHT_SPEED_MS;
@@ -301,14 +533,39 @@ void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int C
 		else
 			return;
 		break;
+	case FREQ_L1C:
+		if (pBdsFrameInfo->tow >= 0)	// transmit time get from CNAV-2 frame
+			pChannelStatus->TransmitTimeMs = pBdsFrameInfo->tow * 1000 + pBdsFrameInfo->NavBitNumber * 10;
+		else
+			return;
+		break;
+	case FREQ_L5:
+		// transmit time within 20ms NH period, integer part resolved by L1C/A channel of same satellite
+		for (ch_num = 0, pL1Status = g_ChannelStatus; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++, pL1Status ++)
+			if (pL1Status->FreqID == FREQ_L1CA && pL1Status->svid == pChannelStatus->svid && (pL1Status->ChannelFlag & MEASUREMENT_VALID))
+				break;
+		if (ch_num == TOTAL_CHANNEL_NUMBER)
+			return;
+		// NH period and L1C/A data bit both align to 20ms, select the period closest to L1C/A transmit time
+		pChannelStatus->TransmitTimeMs = pL1Status->TransmitTimeMs;
+		PsrDiff = pL1Status->TransmitTime - pChannelStatus->TransmitTime;
+		if (PsrDiff > 10.)
+			pChannelStatus->TransmitTimeMs += 20;
+		else if (PsrDiff < -10.)
+			pChannelStatus->TransmitTimeMs -= 20;
+		pChannelStatus->ChannelFlag |= (pL1Status->ChannelFlag & TRANSTIME_ESTIMATE);
+		IFFreq = IF_FREQ_L5;
+		SampleFreq = SAMPLE_FREQ_L5;
+		WaveLength = GPS_L5_WAVELENGTH;
+		break;
 	default:	// TODO: other satellite system
 		return;
 	}
 
 	// Doppler is actual carrier frequency minus nominal number
-	if (pChannelStatus->FreqID != FREQ_L1CA && !(pChannelStatus->state & STATE_ENABLE_BOC))
+	if (pChannelStatus->FreqID != FREQ_L1CA && pChannelStatus->FreqID != FREQ_L5 && !(pChannelStatus->state & STATE_ENABLE_BOC))
 		IFFreq += 1023000;
-	pChannelStatus->DopplerHz = (double)pMsr->CarrierFreq * ScaleDoubleU(SAMPLE_FREQ, 32) - IFFreq;
+	pChannelStatus->DopplerHz = (double)pMsr->CarrierFreq * ScaleDoubleU(SampleFreq, 32) - IFFreq;
 	pChannelStatus->Doppler = pChannelStatus->DopplerHz * WaveLength;
 
 	// pseudorange = (Tr-Tt) * LIGHT_SPEED
@@ -351,3 +608,58 @@ void CalculateRawMsr(PCHANNEL_STATUS pChannelStatus, PBB_MEASUREMENT pMsr, int C
 
 	pChannelStatus->ChannelFlag |= MEASUREMENT_VALID;
 }
+
+//*************** Predict PSR of L1C/A channels using receiver position and time ****************
+//* predicted PSR recovers integer millisecond of transmit time for channels without frame sync
+//* in coarse time mode (receiver time from external source or 5 satellite positioning)
+//* the channel with highest CN0 is selected as reference, and an offset is applied to all predicted PSR
+//* to make reference channel has integer millisecond travel time, so common error of receiver time,
+//* receiver clock and position within +-0.5ms will not cause different integer millisecond among channels
+// Parameters:
+//   Measurements: baseband measurement array arranged by channel
+//   ActiveMask: channel active (baseband measurement valid) indicator
+// Return value:
+//   1 if coarse time mode and reference channel found, otherwise 0
+int PredictGpsPsr(PBB_MEASUREMENT Measurements, unsigned int ActiveMask)
+{
+	int ch_num, sv_index, RefCN0 = 0;
+	int CoarseTimeMode = ((g_PvtConfig.PvtConfigFlags & PVT_CONFIG_COARSE_TIME) && g_ReceiverInfo.GpsTimeQuality <= FlexTime);
+	double Time, ClkCorrection, PsrMs;
+	PGPS_FRAME_INFO pGpsFrameInfo;
+	PSATELLITE_INFO pSatInfo;
+
+	for (ch_num = 0; ch_num < TOTAL_CHANNEL_NUMBER; ch_num ++)
+	{
+		if ((ActiveMask & (1 << ch_num)) == 0 || g_ChannelStatus[ch_num].FreqID != FREQ_L1CA || SVID_IS_SBAS(g_ChannelStatus[ch_num].FreqID, g_ChannelStatus[ch_num].svid))
+			continue;
+		sv_index = g_ChannelStatus[ch_num].svid - 1;
+		pSatInfo = &g_GpsSatelliteInfo[sv_index];
+		pSatInfo->SatInfoFlag &= ~SAT_INFO_PSR_VALID;
+		if (((g_ChannelStatus[ch_num].state & STAGE_MASK) < STAGE_TRACK) || (g_ChannelStatus[ch_num].cn0 <= 500) || !g_GpsEphemeris[sv_index].flag)
+			continue;
+		// only channel without frame sync needs prediction unless in coarse time mode
+		pGpsFrameInfo = (PGPS_FRAME_INFO)(g_ChannelStatus[ch_num].FrameInfo);
+		if (!CoarseTimeMode && pGpsFrameInfo->FrameStatus >= 30 && pGpsFrameInfo->tow >= 0)
+			continue;
+
+		// satellite position at receiver time minus nominal travel time, error of 10ms travel time is only several meters
+		Time = (g_ReceiverInfo.GpsMsCount - 75) * 0.001;
+		ClkCorrection = ClockCorrection(&g_GpsEphemeris[sv_index], Time);
+		SatPosSpeedEph(Time - ClkCorrection, &g_GpsEphemeris[sv_index], &(pSatInfo->PosVel));
+		pSatInfo->GeoDistance = GeometryDistance(&(g_ReceiverInfo.PosVel), &(pSatInfo->PosVel));
+		pSatInfo->PsrPredict = pSatInfo->GeoDistance - ClkCorrection * LIGHT_SPEED;
+		pSatInfo->SatInfoFlag |= SAT_INFO_PSR_VALID;
+
+		// select reference channel and calculate offset to align sub-millisecond part
+		if (CoarseTimeMode && g_ChannelStatus[ch_num].cn0 > RefCN0)
+		{
+			RefCN0 = g_ChannelStatus[ch_num].cn0;
+			PsrMs = (double)Measurements[ch_num].CodeCount + ScaleDoubleU(Measurements[ch_num].CodeNCO, 32);
+			PsrMs /= 2046.;
+			PsrMs = pSatInfo->PsrPredict / LIGHT_SPEED_MS + (PsrMs - (int)PsrMs);
+			CoarsePsrOffset = floor(PsrMs + 0.5) - PsrMs;
+		}
+	}
+
+	return (RefCN0 > 0) ? 1 : 0;
+}
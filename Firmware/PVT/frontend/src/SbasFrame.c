@@ -0,0 +1,594 @@
+//----------------------------------------------------------------------
+// SbasFrame.c:
+//   SBAS symbol Viterbi decode, message sync and correction decode
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "PlatformCtrl.h"
+#include "ChannelManager.h"
+#include "DataTypes.h"
+#include "GlobalVar.h"
+#include "SupportPackage.h"
+#include "PvtEntry.h"
+#include "FecDecode.h"
+
+#define MAX_SBAS_CHANNEL 2		// number of SBAS channels decoded simultaneously, each channel uses 2 decoders
+#define TRACEBACK_LENGTH 96		// traceback steps, including 32 output bits
+#define OUTPUT_BITS 32			// number of bits output on each traceback
+#define PHASE_UNLOCK_BITS 1000	// release symbol pair alignment if no valid message in 4 message periods
+#define STALE_DECODE_COUNT 16	// decode context not called in this number of tasks can be reused
+
+// Viterbi decoder and message window of one symbol pair alignment
+typedef struct
+{
+	VITERBI_DECODER Viterbi;
+	U32 Window[8];			// latest 256 decoded bits, LSB of Window[7] is the latest bit
+	int BitsSinceMessage;	// bit count after last valid message
+} SBAS_VITERBI, *PSBAS_VITERBI;
+
+// decode context of one SBAS channel
+typedef struct
+{
+	int LogicChannel;		// -1 if context not used
+	int Svid;
+	unsigned int LastCall;	// value of DecodeCallCount on latest call
+	int PrevValid;			// previous symbol valid
+	int PrevParity;			// decoder phase using previous symbol as first symbol of a pair
+	int LockedPhase;		// phase of decoder getting valid message, -1 if not locked
+	S8 PrevSymbol;
+	SBAS_VITERBI Decoder[2];
+} SBAS_DECODE_CONTEXT, *PSBAS_DECODE_CONTEXT;
+
+static SBAS_DECODE_CONTEXT DecodeContext[MAX_SBAS_CHANNEL];
+static unsigned int DecodeCallCount;
+
+static PSBAS_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid);
+static void DecoderReset(PSBAS_VITERBI Decoder);
+static int MessageSync(PSBAS_VITERBI Decoder, U32 Bits, U8 Message[32]);
+static unsigned int GetMessageBits(const U8 Message[32], int Pos, int Length);
+static int GetMessageSignedBits(const U8 Message[32], int Pos, int Length);
+static void SbasMessageDecode(int Svid, const U8 Message[32]);
+static PSBAS_SAT_CORRECTION SlotCorrection(int Slot);
+static void SetFastCorrection(int Slot, int Prc, int Udrei, int Now);
+static void DecodeFastCorrection(const U8 Message[32], int Type, int Now);
+static void DecodeLongTermHalf(const U8 Message[32], int Offset, int Now);
+static void DecodeGeoNav(const U8 Message[32]);
+static void DecodeIgpMask(const U8 Message[32]);
+static void DecodeIonoDelay(const U8 Message[32], int Now);
+
+//*************** SBAS data decode initialization ****************
+// Parameters:
+//   none
+// Return value:
+//   none
+void SbasDecodeInit()
+{
+	int i;
+
+	for (i = 0; i < MAX_SBAS_CHANNEL; i ++)
+		DecodeContext[i].LogicChannel = -1;
+	DecodeCallCount = 0;
+	Crc24qInit();
+
+	memset(&g_SbasCorrection, 0, sizeof(g_SbasCorrection));
+	for (i = 0; i < SBAS_IGP_BAND_NUMBER; i ++)
+		memset(g_SbasCorrection.IgpBand[i].Delay, 0xff, sizeof(g_SbasCorrection.IgpBand[i].Delay));
+}
+
+//*************** Task to decode SBAS navigation data ****************
+//* 8bit soft symbols in data stream, negative value for bit 1
+// Parameters:
+//   Param: Pointer to data stream structure
+// Return value:
+//   0
+int SbasDecodeTask(void *Param)
+{
+	PDATA_STREAM DataStream = (PDATA_STREAM)Param;
+	S8 Symbols[128];
+	int i;
+
+	for (i = 0; i < DataStream->DataCount && i < 128; i ++)
+		Symbols[i] = (S8)(DataStream->DataBuffer[i/4] >> (24 - (i & 3) * 8));
+	SbasSymbolDecode(DataStream->ChannelState->LogicChannel, DataStream->ChannelState->Svid, Symbols, i);
+
+	return 0;
+}
+
+//*************** Decode SBAS soft symbols of one channel ****************
+//* two decoders try both symbol pair alignment until one gets valid message
+// Parameters:
+//   LogicChannel: logic channel the symbols come from
+//   Svid: SBAS satellite ID (33~51)
+//   Symbols: soft symbols in receive order, negative value for bit 1
+//   SymbolCount: number of symbols
+// Return value:
+//   none
+void SbasSymbolDecode(int LogicChannel, int Svid, const S8 *Symbols, int SymbolCount)
+{
+	PSBAS_DECODE_CONTEXT Context = GetDecodeContext(LogicChannel, Svid);
+	PSBAS_VITERBI Decoder;
+	U8 Message[32];
+	int i, Phase;
+	U32 Bits;
+
+	if (!Context)
+		return;
+	for (i = 0; i < SymbolCount; i ++)
+	{
+		Phase = Context->PrevParity;
+		Context->PrevParity ^= 1;
+		if (!Context->PrevValid)
+		{
+			Context->PrevSymbol = Symbols[i];
+			Context->PrevValid = 1;
+			continue;
+		}
+		if (Context->LockedPhase >= 0 && Context->LockedPhase != Phase)
+		{
+			Context->PrevSymbol = Symbols[i];
+			continue;
+		}
+		Decoder = &Context->Decoder[Phase];
+		ViterbiStep(&Decoder->Viterbi, Context->PrevSymbol, Symbols[i]);
+		Context->PrevSymbol = Symbols[i];
+		if (Decoder->Viterbi.StepCount < TRACEBACK_LENGTH || (Decoder->Viterbi.StepCount & (OUTPUT_BITS - 1)) != 0)
+			continue;
+
+		ViterbiTraceback(&Decoder->Viterbi, ViterbiBestState(&Decoder->Viterbi), TRACEBACK_LENGTH, OUTPUT_BITS, &Bits);
+		if (MessageSync(Decoder, Bits, Message))
+		{
+			if (Context->LockedPhase < 0)
+			{
+				Context->LockedPhase = Phase;
+				DecoderReset(&Context->Decoder[Phase ^ 1]);
+			}
+			SbasMessageDecode(Svid, Message);
+		}
+		else if (Context->LockedPhase >= 0 && Decoder->BitsSinceMessage > PHASE_UNLOCK_BITS)
+		{
+			Context->LockedPhase = -1;	// try both alignment again
+			DecoderReset(&Context->Decoder[Phase ^ 1]);
+		}
+	}
+}
+
+//*************** Get decode context of a logic channel ****************
+//* allocate a new context if not found, context of other satellite on same channel is reset
+// Parameters:
+//   LogicChannel: logic channel
+//   Svid: SBAS satellite ID
+// Return value:
+//   pointer to decode context, NULL if no context available
+PSBAS_DECODE_CONTEXT GetDecodeContext(int LogicChannel, int Svid)
+{
+	int i;
+	PSBAS_DECODE_CONTEXT Context = (PSBAS_DECODE_CONTEXT)0;
+
+	DecodeCallCount ++;
+	for (i = 0; i < MAX_SBAS_CHANNEL; i ++)
+	{
+		if (DecodeContext[i].LogicChannel == LogicChannel)
+		{
+			Context = &DecodeContext[i];
+			break;
+		}
+	}
+	if (!Context)
+	{
+		for (i = 0; i < MAX_SBAS_CHANNEL; i ++)
+		{
+			if (DecodeContext[i].LogicChannel < 0 || (DecodeCallCount - DecodeContext[i].LastCall) > STALE_DECODE_COUNT)
+			{
+				Context = &DecodeContext[i];
+				Context->Svid = 0;
+				break;
+			}
+		}
+	}
+	if (!Context)
+		return Context;
+	if (Context->Svid != Svid)
+	{
+		Context->LogicChannel = LogicChannel;
+		Context->Svid = Svid;
+		Context->PrevValid = Context->PrevParity = 0;
+		Context->LockedPhase = -1;
+		DecoderReset(&Context->Decoder[0]);
+		DecoderReset(&Context->Decoder[1]);
+	}
+	Context->LastCall = DecodeCallCount;
+	return Context;
+}
+
+//*************** Reset Viterbi decoder and message window ****************
+// Parameters:
+//   Decoder: pointer to Viterbi decoder
+// Return value:
+//   none
+void DecoderReset(PSBAS_VITERBI Decoder)
+{
+	ViterbiReset(&Decoder->Viterbi, VITERBI_UNKNOWN_STATE);
+	memset(Decoder->Window, 0, sizeof(Decoder->Window));
+	Decoder->BitsSinceMessage = 0;
+}
+
+//*************** Put decoded bits into message window and find 250bit message ****************
+//* message with preamble 0x53/0x9A/0xC6 (or inverted) and passing CRC-24Q check is found
+// Parameters:
+//   Decoder: pointer to Viterbi decoder holding message window
+//   Bits: 32 decoded bits, first bit at MSB
+//   Message: 256bit buffer to hold message, 250bit message starts at bit 6
+// Return value:
+//   1 if valid message found, otherwise 0
+int MessageSync(PSBAS_VITERBI Decoder, U32 Bits, U8 Message[32])
+{
+	int i, j, Found = 0;
+	unsigned int Preamble, Crc;
+	U32 *Window = Decoder->Window;
+	U8 Candidate[32];
+
+	for (i = 0; i < 32; i ++, Bits <<= 1)
+	{
+		for (j = 0; j < 7; j ++)
+			Window[j] = (Window[j] << 1) | (Window[j+1] >> 31);
+		Window[7] = (Window[7] << 1) | (Bits >> 31);
+		Decoder->BitsSinceMessage ++;
+
+		// preamble at bit 6~13 of window
+		Preamble = (Window[0] >> 18) & 0xff;
+		if (Preamble != 0x53 && Preamble != 0x9a && Preamble != 0xc6 && Preamble != 0xac && Preamble != 0x65 && Preamble != 0x39)
+			continue;
+		for (j = 0; j < 32; j ++)
+			Candidate[j] = (U8)(Window[j/4] >> (24 - (j & 3) * 8));
+		if (Preamble == 0xac || Preamble == 0x65 || Preamble == 0x39)	// phase reversed
+			for (j = 0; j < 32; j ++)
+				Candidate[j] ^= 0xff;
+		Candidate[0] &= 0x3;	// 6 leading zeros do not change CRC
+		Crc = ((unsigned int)Candidate[29] << 16) | ((unsigned int)Candidate[30] << 8) | Candidate[31];
+		if (Crc24q(Candidate, 29) != Crc)
+			continue;
+		memcpy(Message, Candidate, sizeof(Candidate));
+		Decoder->BitsSinceMessage = 0;
+		Found = 1;
+	}
+
+	return Found;
+}
+
+//*************** Get unsigned bit field of message ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+//   Pos: bit position of field counted from first bit of preamble
+//   Length: bit length of field (no more than 32)
+// Return value:
+//   field value
+unsigned int GetMessageBits(const U8 Message[32], int Pos, int Length)
+{
+	unsigned int Value = 0;
+	int i;
+
+	for (i = Pos + 6; i < Pos + 6 + Length; i ++)
+		Value = (Value << 1) | ((Message[i >> 3] >> (7 - (i & 7))) & 1);
+	return Value;
+}
+
+//*************** Get signed bit field of message ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+//   Pos: bit position of field counted from first bit of preamble
+//   Length: bit length of field (no more than 32)
+// Return value:
+//   sign extended field value
+int GetMessageSignedBits(const U8 Message[32], int Pos, int Length)
+{
+	unsigned int Value = GetMessageBits(Message, Pos, Length);
+
+	if (Length < 32 && (Value & (1U << (Length - 1))))
+		Value |= ~0U << Length;
+	return (int)Value;
+}
+
+//*************** Decode SBAS message ****************
+//* only messages from one SBAS satellite are used unless it times out
+// Parameters:
+//   Svid: SBAS satellite ID the message comes from
+//   Message: 256bit message buffer, message starts at bit 6
+// Return value:
+//   none
+void SbasMessageDecode(int Svid, const U8 Message[32])
+{
+	int i, Type, Iodf, Now = g_ReceiverInfo.GpsMsCount;
+	PSBAS_SAT_CORRECTION pCorrection;
+
+	if (g_ReceiverInfo.GpsTimeQuality == UnknownTime || Now < 0)	// correction needs time tag
+		return;
+	if (g_SbasCorrection.ProviderSvid != Svid)
+	{
+		if (g_SbasCorrection.ProviderSvid != 0 && (Now - g_SbasCorrection.ProviderTime + 604800000) % 604800000 < SBAS_PROVIDER_TIMEOUT)
+			return;
+		// switch to new provider, corrections of previous provider discarded
+		memset(&g_SbasCorrection, 0, sizeof(g_SbasCorrection));
+		for (i = 0; i < SBAS_IGP_BAND_NUMBER; i ++)
+			memset(g_SbasCorrection.IgpBand[i].Delay, 0xff, sizeof(g_SbasCorrection.IgpBand[i].Delay));
+		g_SbasCorrection.ProviderSvid = Svid;
+	}
+	g_SbasCorrection.ProviderTime = Now;
+
+	Type = (int)GetMessageBits(Message, 8, 6);
+	DEBUG_OUTPUT(OUTPUT_CONTROL(DATA_DECODE, INFO), "SBAS SV%02d message type %d\n", Svid, Type);
+	switch (Type)
+	{
+	case 0:		// test mode, contents same as type 2
+	case 2:
+	case 3:
+	case 4:
+	case 5:
+		DecodeFastCorrection(Message, Type ? Type : 2, Now);
+		break;
+	case 1:		// PRN mask
+		g_SbasCorrection.MaskCount = 0;
+		for (i = 0; i < 210 && g_SbasCorrection.MaskCount < SBAS_MAX_MASK_SAT; i ++)
+			if (GetMessageBits(Message, 14 + i, 1))
+				g_SbasCorrection.MaskPrn[g_SbasCorrection.MaskCount ++] = (U8)(i + 1);
+		g_SbasCorrection.iodp = (U8)GetMessageBits(Message, 224, 2);
+		break;
+	case 6:		// integrity information
+		for (i = 0; i < g_SbasCorrection.MaskCount; i ++)
+		{
+			Iodf = (int)GetMessageBits(Message, 14 + (i / 13) * 2, 2);	// IODF of the fast correction group
+			if (Iodf == 3 || Iodf == g_SbasCorrection.iodf[i / 13])
+				SetFastCorrection(i, 0x7fffffff, (int)GetMessageBits(Message, 22 + i * 4, 4), Now);
+		}
+		break;
+	case 7:		// fast correction degradation factor
+		if ((int)GetMessageBits(Message, 18, 2) != g_SbasCorrection.iodp)
+			break;
+		for (i = 0; i < g_SbasCorrection.MaskCount; i ++)
+		{
+			if ((pCorrection = SlotCorrection(i)) == 0)
+				continue;
+			pCorrection->ai = (U8)GetMessageBits(Message, 22 + i * 4, 4);
+			pCorrection->flag |= SBAS_CORR_AI_VALID;
+		}
+		break;
+	case 9:		// GEO navigation message
+		DecodeGeoNav(Message);
+		break;
+	case 18:	// IGP mask
+		DecodeIgpMask(Message);
+		break;
+	case 24:	// mixed fast and long-term correction
+		if ((int)GetMessageBits(Message, 110, 2) == g_SbasCorrection.iodp)
+		{
+			Type = (int)GetMessageBits(Message, 112, 2);	// block ID, same slots as message type 2~5
+			g_SbasCorrection.iodf[Type] = (U8)GetMessageBits(Message, 114, 2);
+			for (i = 0; i < 6; i ++)
+				SetFastCorrection(Type * 13 + i, GetMessageSignedBits(Message, 14 + i * 12, 12), (int)GetMessageBits(Message, 86 + i * 4, 4), Now);
+		}
+		DecodeLongTermHalf(Message, 120, Now);
+		break;
+	case 25:	// long-term correction
+		DecodeLongTermHalf(Message, 14, Now);
+		DecodeLongTermHalf(Message, 120, Now);
+		break;
+	case 26:	// ionosphere delay
+		DecodeIonoDelay(Message, Now);
+		break;
+	default:
+		break;
+	}
+}
+
+//*************** Get correction structure of a PRN mask slot ****************
+// Parameters:
+//   Slot: index of PRN mask slot (start from 0)
+// Return value:
+//   pointer to correction structure, NULL if slot is not a GPS satellite
+PSBAS_SAT_CORRECTION SlotCorrection(int Slot)
+{
+	int Prn;
+
+	if (Slot < 0 || Slot >= g_SbasCorrection.MaskCount)
+		return (PSBAS_SAT_CORRECTION)0;
+	Prn = g_SbasCorrection.MaskPrn[Slot];
+	if (Prn < MIN_GPS_SAT_ID || Prn > MAX_GPS_SAT_ID)
+		return (PSBAS_SAT_CORRECTION)0;
+	return &g_SbasCorrection.SatCorrection[Prn - 1];
+}
+
+//*************** Set fast correction of a PRN mask slot ****************
+//* range rate correction derived from difference of successive fast corrections
+// Parameters:
+//   Slot: index of PRN mask slot (start from 0)
+//   Prc: fast correction in 0.125m, 0x7fffffff to update UDREI only
+//   Udrei: UDRE indicator
+//   Now: receiver ms count
+// Return value:
+//   none
+void SetFastCorrection(int Slot, int Prc, int Udrei, int Now)
+{
+	PSBAS_SAT_CORRECTION pCorrection = SlotCorrection(Slot);
+	double NewPrc;
+	int Age;
+
+	if (!pCorrection)
+		return;
+	pCorrection->udrei = (U8)Udrei;
+	if (Prc == 0x7fffffff)
+		return;
+	if (Udrei >= 14)	// not monitored or do not use
+	{
+		pCorrection->flag &= ~SBAS_CORR_FAST;
+		return;
+	}
+	NewPrc = Prc * 0.125;
+	Age = (Now - pCorrection->FastTime + 604800000) % 604800000;
+	if ((pCorrection->flag & SBAS_CORR_FAST) && Age > 0 && Age <= SBAS_FAST_CORR_TIMEOUT)
+		pCorrection->rrc = (NewPrc - pCorrection->prc) * 1000 / Age;
+	else
+		pCorrection->rrc = 0.0;
+	pCorrection->prc = NewPrc;
+	pCorrection->FastTime = Now;
+	pCorrection->flag |= SBAS_CORR_FAST;
+}
+
+//*************** Decode fast correction message type 2~5 ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+//   Type: message type
+//   Now: receiver ms count
+// Return value:
+//   none
+void DecodeFastCorrection(const U8 Message[32], int Type, int Now)
+{
+	int i;
+
+	if ((int)GetMessageBits(Message, 16, 2) != g_SbasCorrection.iodp)
+		return;
+	g_SbasCorrection.iodf[Type - 2] = (U8)GetMessageBits(Message, 14, 2);
+	for (i = 0; i < 13; i ++)
+		SetFastCorrection((Type - 2) * 13 + i, GetMessageSignedBits(Message, 18 + i * 12, 12), (int)GetMessageBits(Message, 174 + i * 4, 4), Now);
+}
+
+//*************** Decode half message of long-term correction ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+//   Offset: start bit of 106bit half message
+//   Now: receiver ms count
+// Return value:
+//   none
+void DecodeLongTermHalf(const U8 Message[32], int Offset, int Now)
+{
+	int i, Pos;
+	PSBAS_SAT_CORRECTION pCorrection;
+
+	if (GetMessageBits(Message, Offset, 1) == 0)	// velocity code 0, two satellites without velocity
+	{
+		if ((int)GetMessageBits(Message, Offset + 103, 2) != g_SbasCorrection.iodp)
+			return;
+		for (i = 0; i < 2; i ++)
+		{
+			Pos = Offset + 1 + i * 51;
+			if ((pCorrection = SlotCorrection((int)GetMessageBits(Message, Pos, 6) - 1)) == 0)
+				continue;
+			pCorrection->iode = (U8)GetMessageBits(Message, Pos + 6, 8);
+			pCorrection->dx = GetMessageSignedBits(Message, Pos + 14, 9) * 0.125;
+			pCorrection->dy = GetMessageSignedBits(Message, Pos + 23, 9) * 0.125;
+			pCorrection->dz = GetMessageSignedBits(Message, Pos + 32, 9) * 0.125;
+			pCorrection->daf0 = ScaleDouble(GetMessageSignedBits(Message, Pos + 41, 10), 31);
+			pCorrection->dvx = pCorrection->dvy = pCorrection->dvz = pCorrection->daf1 = 0.0;
+			pCorrection->t0 = 0;
+			pCorrection->LongTermTime = Now;
+			pCorrection->flag = (pCorrection->flag & ~SBAS_CORR_VELOCITY) | SBAS_CORR_LONG_TERM;
+		}
+	}
+	else	// velocity code 1, one satellite with velocity
+	{
+		if ((int)GetMessageBits(Message, Offset + 104, 2) != g_SbasCorrection.iodp)
+			return;
+		if ((pCorrection = SlotCorrection((int)GetMessageBits(Message, Offset + 1, 6) - 1)) == 0)
+			return;
+		pCorrection->iode = (U8)GetMessageBits(Message, Offset + 7, 8);
+		pCorrection->dx = GetMessageSignedBits(Message, Offset + 15, 11) * 0.125;
+		pCorrection->dy = GetMessageSignedBits(Message, Offset + 26, 11) * 0.125;
+		pCorrection->dz = GetMessageSignedBits(Message, Offset + 37, 11) * 0.125;
+		pCorrection->daf0 = ScaleDouble(GetMessageSignedBits(Message, Offset + 48, 11), 31);
+		pCorrection->dvx = ScaleDouble(GetMessageSignedBits(Message, Offset + 59, 8), 11);
+		pCorrection->dvy = ScaleDouble(GetMessageSignedBits(Message, Offset + 67, 8), 11);
+		pCorrection->dvz = ScaleDouble(GetMessageSignedBits(Message, Offset + 75, 8), 11);
+		pCorrection->daf1 = ScaleDouble(GetMessageSignedBits(Message, Offset + 83, 8), 39);
+		pCorrection->t0 = (int)GetMessageBits(Message, Offset + 91, 13) * 16;
+		pCorrection->LongTermTime = Now;
+		pCorrection->flag |= (SBAS_CORR_LONG_TERM | SBAS_CORR_VELOCITY);
+	}
+}
+
+//*************** Decode GEO navigation message type 9 ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+// Return value:
+//   none
+void DecodeGeoNav(const U8 Message[32])
+{
+	PSBAS_GEO_NAV pGeoNav = &g_SbasCorrection.GeoNav;
+
+	pGeoNav->t0 = (int)GetMessageBits(Message, 22, 13) * 16;
+	pGeoNav->ura = (U8)GetMessageBits(Message, 35, 4);
+	pGeoNav->x = GetMessageSignedBits(Message, 39, 30) * 0.08;
+	pGeoNav->y = GetMessageSignedBits(Message, 69, 30) * 0.08;
+	pGeoNav->z = GetMessageSignedBits(Message, 99, 25) * 0.4;
+	pGeoNav->vx = GetMessageSignedBits(Message, 124, 17) * 0.000625;
+	pGeoNav->vy = GetMessageSignedBits(Message, 141, 17) * 0.000625;
+	pGeoNav->vz = GetMessageSignedBits(Message, 158, 18) * 0.004;
+	pGeoNav->ax = GetMessageSignedBits(Message, 176, 10) * 0.0000125;
+	pGeoNav->ay = GetMessageSignedBits(Message, 186, 10) * 0.0000125;
+	pGeoNav->az = GetMessageSignedBits(Message, 196, 10) * 0.0000625;
+	pGeoNav->af0 = ScaleDouble(GetMessageSignedBits(Message, 206, 12), 31);
+	pGeoNav->af1 = ScaleDouble(GetMessageSignedBits(Message, 218, 8), 40);
+	pGeoNav->flag = 1;
+}
+
+//*************** Decode IGP mask message type 18 ****************
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+// Return value:
+//   none
+void DecodeIgpMask(const U8 Message[32])
+{
+	int i, Band = (int)GetMessageBits(Message, 18, 4);
+	int Iodi = (int)GetMessageBits(Message, 22, 2);
+	PSBAS_IGP_BAND pBand;
+
+	if (Band >= SBAS_IGP_BAND_NUMBER)	// polar band not supported
+		return;
+	pBand = &g_SbasCorrection.IgpBand[Band];
+	if (!pBand->MaskValid || pBand->iodi != Iodi)	// grid delay of previous mask discarded
+		memset(pBand->Delay, 0xff, sizeof(pBand->Delay));
+	memset(pBand->Mask, 0, sizeof(pBand->Mask));
+	for (i = 0; i < SBAS_BAND_IGP_NUMBER; i ++)
+		if (GetMessageBits(Message, 24 + i, 1))
+			pBand->Mask[i / 32] |= 0x80000000U >> (i & 0x1f);
+	pBand->iodi = (U8)Iodi;
+	pBand->MaskValid = 1;
+}
+
+//*************** Decode ionosphere delay message type 26 ****************
+//* block n holds GIVD/GIVEI of the 15n~15n+14th IGP set in band mask
+// Parameters:
+//   Message: 256bit message buffer, message starts at bit 6
+//   Now: receiver ms count
+// Return value:
+//   none
+void DecodeIonoDelay(const U8 Message[32], int Now)
+{
+	int i, Band = (int)GetMessageBits(Message, 14, 4);
+	int Block = (int)GetMessageBits(Message, 18, 4);
+	int Index = 0, Pos, Givei;
+	PSBAS_IGP_BAND pBand;
+
+	if (Band >= SBAS_IGP_BAND_NUMBER)
+		return;
+	pBand = &g_SbasCorrection.IgpBand[Band];
+	if (!pBand->MaskValid || pBand->iodi != (int)GetMessageBits(Message, 217, 2))
+		return;
+	for (i = 0; i < SBAS_BAND_IGP_NUMBER; i ++)
+	{
+		if (!(pBand->Mask[i / 32] & (0x80000000U >> (i & 0x1f))))
+			continue;
+		if (Index >= Block * 15 && Index < Block * 15 + 15)
+		{
+			Pos = 22 + (Index - Block * 15) * 13;
+			Givei = (int)GetMessageBits(Message, Pos + 9, 4);
+			pBand->Delay[i] = (Givei == 15) ? 0xffff : (unsigned short)((GetMessageBits(Message, Pos, 9) << 4) | Givei);
+			pBand->Time[i] = (unsigned short)(Now / 16000);
+		}
+		if (++Index >= Block * 15 + 15)
+			break;
+	}
+}
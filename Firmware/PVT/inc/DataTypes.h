@@ -164,6 +164,7 @@ typedef struct
 #define HALF_CYCLE			0x40	// may have half cycle
 #define CYCLE_SLIP			0x80	// possible cycle between epochs
 #define TRANSTIME_ESTIMATE	0x100	// TransmitTimeMs is estimated instead of from navigation data
+#define IONO_FREE			0x200	// pseudorange corrected by L1/L5 iono-free combination
 #define MEASUREMENT_FLAGS	0xff0	// bit 4~11 reserved for raw measurement related flags
 // definitions for ChannelErrorFlag field
 #define CHANNEL_ERR_BIT_SYNC		0x01	// bit sync error
@@ -181,10 +182,11 @@ typedef struct // GPS ephemeris, also used by GPS/Galileo/BDS/QZSS
 	unsigned char	iode3;
 
 	unsigned char	ura;
-	unsigned char	flag;	// bit0 means ephemeris valid
+	unsigned char	flag;	// bit0 means ephemeris valid, bit1 means GPS ephemeris from CNAV-2
 	unsigned char	health;
 	unsigned char	svid;
 
+	unsigned int	version;	// increased each time ephemeris is published
 	int	toe;
 	int	toc;
 	int	week;
@@ -208,6 +210,8 @@ typedef struct // GPS ephemeris, also used by GPS/Galileo/BDS/QZSS
 	double cis;			// Amplitude of the Sine Harmonic Correction Term to the Angle of Inclination
 	double tgd;			// Group Delay for L1C/A, L1C, E1 and B1C
 	double tgd2;		// Group Delay for B2a
+	double isc_l1ca;	// GPS inter-signal correction of L1C/A, 0 if not broadcast in decoded message
+	double isc_l5q5;	// GPS inter-signal correction of L5 pilot, 0 if not broadcast in decoded message
 	double af0;			// Satellite Clock Correction
 	double af1;			// Satellite Clock Correction
 	double af2;			// Satellite Clock Correction
@@ -218,8 +222,12 @@ typedef struct // GPS ephemeris, also used by GPS/Galileo/BDS/QZSS
 	double root_ecc;	// Square Root of One Minus Ecc Square
 	double omega_t;		// Longitude of Ascending Node of Orbit Plane at toe
 	double omega_delta;	// Delta Between omega_dot and WGS_OMEGDOTE
-	double Ek;			// Ek, derived from Mk
 } GNSS_EPHEMERIS, *PGNSS_EPHEMERIS;
+#define EPH_FLAG_CNAV2	0x02	// GPS ephemeris decoded from L1C CNAV-2, replaced by LNAV ephemeris
+// layout tag saved with ephemeris parameter blocks, increase EPH_LAYOUT_VERSION when GNSS_EPHEMERIS changes
+// ephemeris blocks saved with a different tag are discarded on load
+#define EPH_LAYOUT_VERSION	3
+#define EPH_LAYOUT_TAG	((EPH_LAYOUT_VERSION << 16) | sizeof(GNSS_EPHEMERIS))
 
 typedef struct        			
 {
@@ -283,6 +291,7 @@ typedef struct
 	double BdsClkError;		// receiver clock error to BDS time, in second
 	double ClkDrifting;		// receiver clock drifting, in m/s
 	double DopArray[8];		// HDOP, VDOP, PDOP, TDOP, SigmaEE, SigmaNN, SigmaEN, reserved
+	double ProtectionLevel[2];	// horizontal and vertical protection level from RAIM in meter, 0 if not available
 
 	int GpsMsCount;			// millisecond count within a week, identical to all systems
 	int WeekNumber;			// week number of receiver time used by GPS
@@ -305,6 +314,7 @@ typedef struct
 #define PVT_USE_BDS			(1 << SYSTEM_BDS)
 #define PVT_USE_GAL			(1 << SYSTEM_GAL)
 #define GPS_WEEK_VALID		0x1000
+#define DOPPLER_POS_AIDING	0x2000	// position from Doppler positioning not yet used to aid acquisition
 
 typedef struct
 {
@@ -313,6 +323,11 @@ typedef struct
 	unsigned long long GalileoSatMaskOut;
 	unsigned long long BdsSatMaskOut;
 	double ElevationMask;	// in radian
+	int XcorrDopplerTh;		// Doppler difference threshold in Hz (modulo 1kHz for L1C/A) to suspect cross correlation
+	int XcorrCN0Gap;		// minimum C/N0 gap in 0.01dB between stronger and weaker channel to suspect cross correlation
+	int XcorrConfirmCount;	// number of consecutive epochs with identical data to confirm cross correlation
+	double RaimSigma;		// standard deviation of pseudorange error in meter for RAIM test
+	int RaimMaxExclude;		// maximum number of observations RAIM can exclude
 } PVT_CONFIG, *PPVT_CONFIG;
 // definitions for PvtConfigFlags field
 #define PVT_CONFIG_USE_GPS			(1 << SYSTEM_GPS)
@@ -320,6 +335,10 @@ typedef struct
 #define PVT_CONFIG_USE_GAL			(1 << SYSTEM_GAL)
 #define PVT_CONFIG_USE_KF			(0x100)
 #define PVT_CONFIG_WEIGHTED_LSQ		(0x200)
+#define PVT_CONFIG_VECTOR_TRACKING	(0x400)	// KF state aids tracking loops of weak channels
+#define PVT_CONFIG_XCORR_CHECK		(0x800)	// detect and release channels tracking cross correlation peak
+#define PVT_CONFIG_COARSE_TIME		(0x1000)	// position fix with sub-millisecond code phase before TOW decoded
+#define PVT_CONFIG_RAIM				(0x2000)	// LSQ integrity check with fault detection and exclusion
 
 typedef struct
 {
@@ -340,6 +359,7 @@ typedef struct
 	unsigned char HealthFlag;	// bit0~7:  healthy flag of ephemeris
 								// bit8~15: healthy flag of almanac
 	unsigned short CN0;
+	unsigned int EphVersion;	// version of ephemeris used to calculate position and velocity
 } SATELLITE_INFO, *PSATELLITE_INFO;
 // definitions for SatInfoFlag field
 #define SAT_INFO_POSVEL_VALID	0x01	// satellite position and velocity in structure is valid
@@ -392,6 +412,64 @@ typedef  struct _PACKED_
 	unsigned long	flag; // 1, availble   
 } UTC_PARAM, *PUTC_PARAM;
 
+// SBAS correction of one GPS satellite
+typedef struct
+{
+	double prc;				// fast correction, meter
+	double rrc;				// range rate correction derived from successive fast corrections, m/s
+	double dx, dy, dz;		// long-term satellite position correction, meter
+	double dvx, dvy, dvz;	// long-term satellite velocity correction, m/s
+	double daf0, daf1;		// long-term satellite clock correction, second and s/s
+	int FastTime;			// receiver ms count of fast correction received
+	int LongTermTime;		// receiver ms count of long-term correction received
+	int t0;					// reference time of long-term correction velocity in second within day
+	unsigned char udrei;	// UDRE indicator, 14: not monitored, 15: do not use
+	unsigned char ai;		// fast correction degradation factor indicator
+	unsigned char iode;		// IODE the long-term correction applies to
+	unsigned char flag;		// combination of SBAS_CORR_XXX flags
+} SBAS_SAT_CORRECTION, *PSBAS_SAT_CORRECTION;
+// definitions for flag field
+#define SBAS_CORR_FAST			0x01	// fast correction valid
+#define SBAS_CORR_LONG_TERM		0x02	// long-term correction valid
+#define SBAS_CORR_VELOCITY		0x04	// long-term correction has velocity and clock drift terms
+#define SBAS_CORR_AI_VALID		0x08	// degradation factor indicator received
+
+// SBAS ionosphere grid of one IGP band
+typedef struct
+{
+	U32 Mask[7];						// 201bit IGP mask, MSB of Mask[0] for first IGP
+	unsigned short Delay[SBAS_BAND_IGP_NUMBER];	// GIVD (0.125m) << 4 | GIVEI, 0xffff for not available
+	unsigned short Time[SBAS_BAND_IGP_NUMBER];	// receive time of GIVD in unit of 16 seconds within week
+	unsigned char iodi;
+	unsigned char MaskValid;
+} SBAS_IGP_BAND, *PSBAS_IGP_BAND;
+
+// SBAS GEO navigation message (type 9)
+typedef struct
+{
+	double x, y, z;			// meter
+	double vx, vy, vz;		// m/s
+	double ax, ay, az;		// m/s^2
+	double af0, af1;		// second and s/s
+	int t0;					// second within day
+	unsigned char ura;
+	unsigned char flag;
+} SBAS_GEO_NAV, *PSBAS_GEO_NAV;
+
+// SBAS corrections decoded from one provider
+typedef struct
+{
+	SBAS_SAT_CORRECTION SatCorrection[TOTAL_GPS_SAT_NUMBER];
+	SBAS_IGP_BAND IgpBand[SBAS_IGP_BAND_NUMBER];
+	SBAS_GEO_NAV GeoNav;
+	unsigned char MaskPrn[SBAS_MAX_MASK_SAT];	// PRN of each slot in PRN mask
+	unsigned char MaskCount;	// number of satellites in PRN mask, 0 if mask not received
+	unsigned char iodp;
+	unsigned char iodf[4];		// IODF of fast correction type 2~5
+	int ProviderSvid;			// SBAS satellite (SatID) correction decoded from, 0 if no provider
+	int ProviderTime;			// receiver ms count of last message from provider
+} SBAS_CORRECTION, *PSBAS_CORRECTION;
+
 // H matrix used for PVT
 typedef struct
 {
@@ -401,6 +479,28 @@ typedef struct
 	double data[3][DIMENSION_MAX_X];	// H matrix value
 } HMATRIX, *PHMATRIX;
 
+// geometry of observations in one epoch, each array in order of observation list
+typedef struct
+{
+	int SatCount;
+	PSATELLITE_INFO SatInfo[DIMENSION_MAX_X];	// satellite information of each observation
+	double SatX[DIMENSION_MAX_X], SatY[DIMENSION_MAX_X], SatZ[DIMENSION_MAX_X];		// satellite position
+	double SatVx[DIMENSION_MAX_X], SatVy[DIMENSION_MAX_X], SatVz[DIMENSION_MAX_X];	// satellite velocity
+	double ReceiverPos[3];				// receiver position of range and LOS calculation
+	double Range[DIMENSION_MAX_X];		// geometry distance with earth rotate correction
+	double LosX[DIMENSION_MAX_X], LosY[DIMENSION_MAX_X], LosZ[DIMENSION_MAX_X];	// satellite minus receiver position divided by Range
+	double SatRangeRate[DIMENSION_MAX_X];	// satellite velocity projected to LOS without earth rotate correction
+	double RangeScale[DIMENSION_MAX_X];	// Range divided by distance without earth rotate correction
+	double Elevation[DIMENSION_MAX_X], Azimuth[DIMENSION_MAX_X];
+} EPOCH_GEOMETRY, *PEPOCH_GEOMETRY;
+
+// covariance storage of Kalman filter, single precision L-D factors or double precision P matrix
+#if defined PVT_KF_UD_FLOAT
+typedef float KF_COV_TYPE;
+#else
+typedef double KF_COV_TYPE;
+#endif
+
 // PVT core data for internal use
 typedef struct
 {
@@ -409,9 +509,10 @@ typedef struct
 	unsigned long long	PosUseSat[PVT_MAX_SYSTEM_ID];
 
 	double StateVector[STATE_VECTOR_SIZE];		// [vx vy vz tdot x y z dt1 dt2 dt3]
-	double PMatrix[P_MATRIX_SIZE];
+	KF_COV_TYPE PMatrix[P_MATRIX_SIZE];		// P matrix, or packed L-D factors of P matrix if PVT_KF_UD_FLOAT defined
 
 	HMATRIX h;
+	EPOCH_GEOMETRY Geometry;	// satellite geometry of observation list in current epoch
 
 	double PosInvMatrix[(PVT_MAX_SYSTEM_ID + 3) * (PVT_MAX_SYSTEM_ID + 4) / 2];	// Inv(HtH) for position
 	double VelInvMatrix[10];	// Inv(HtH) for velocity
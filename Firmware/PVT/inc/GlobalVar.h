@@ -28,6 +28,8 @@ EXTERN GPS_IONO_PARAM g_GpsIonoParam;
 EXTERN BDS_IONO_PARAM g_BdsIonoParam;
 EXTERN UTC_PARAM g_GpsUtcParam;
 EXTERN UTC_PARAM g_BdsUtcParam;
+// SBAS corrections
+EXTERN SBAS_CORRECTION g_SbasCorrection;
 // positioning result and internal data
 EXTERN RECEIVER_INFO g_ReceiverInfo;
 EXTERN PVT_CONFIG g_PvtConfig;
@@ -26,6 +26,7 @@
 
 #define LIGHT_SPEED		299792458.0				// speed of light
 #define GPS_L1_WAVELENGTH 0.19029367279836488
+#define GPS_L1_L5_GAMMA 1.7932703213610586		// (154/115)^2, ratio of ionosphere delay on L5 to L1
 #define LIGHT_SPEED_MS (LIGHT_SPEED * 0.001)		// distance light travels within 1ms
 
 #define PVT_MAX_SYSTEM_ID 3						// max system used in PVT
@@ -34,6 +35,11 @@
 #define DIMENSION_MAX_Y 3
 #define STATE_VECTOR_SIZE (7 + PVT_MAX_SYSTEM_ID)	// 3 position, 3 velocity, 1 clock drift plus clock error
 #define P_MATRIX_SIZE (STATE_VECTOR_SIZE * (STATE_VECTOR_SIZE + 1) / 2)
+#define KF_QH 25.0	// KF process noise of horizontal acceleration, 5^2
+#define KF_QV 25.0	// KF process noise of vertical acceleration, 5^2
+#define KF_QF 0.25	// KF process noise of clock drifting, 0.5^2
+// define PVT_KF_UD_FLOAT to use single precision U-D factorized Kalman filter on targets without double precision FPU
+//#define PVT_KF_UD_FLOAT
 
 #define MAX_GPS_TOW		100799
 #define MAX_BDS_TOW		604799
@@ -42,6 +48,7 @@
 #define TOTAL_GPS_SAT_NUMBER 32
 #define TOTAL_GAL_SAT_NUMBER 50
 #define TOTAL_BDS_SAT_NUMBER 63
+#define TOTAL_SBAS_SAT_NUMBER 19
 
 #define MIN_GPS_SAT_ID 1
 #define MAX_GPS_SAT_ID (MIN_GPS_SAT_ID + TOTAL_GPS_SAT_NUMBER - 1)
@@ -49,6 +56,17 @@
 #define MAX_GAL_SAT_ID (MIN_GAL_SAT_ID + TOTAL_GAL_SAT_NUMBER - 1)
 #define MIN_BDS_SAT_ID 161
 #define MAX_BDS_SAT_ID (MIN_BDS_SAT_ID + TOTAL_BDS_SAT_NUMBER - 1)
+#define MIN_SBAS_SAT_ID 33	// SBAS PRN120~138 tracked as L1C/A with SatID 33~51
+#define MAX_SBAS_SAT_ID (MIN_SBAS_SAT_ID + TOTAL_SBAS_SAT_NUMBER - 1)
+
+// SBAS message and correction
+#define SBAS_MAX_MASK_SAT 51		// maximum number of satellites in PRN mask
+#define SBAS_IGP_BAND_NUMBER 9		// IGP band 0~8 (polar band 9~10 not supported)
+#define SBAS_BAND_IGP_NUMBER 201	// maximum IGP number in one band
+#define SBAS_FAST_CORR_TIMEOUT 30000		// fast correction maximum age in ms if no degradation factor received
+#define SBAS_LONG_TERM_TIMEOUT 360000		// long-term correction maximum age in ms
+#define SBAS_IONO_GRID_TIMEOUT 600			// ionosphere grid maximum age in second
+#define SBAS_PROVIDER_TIMEOUT 60000			// switch to other SBAS satellite if no message from provider in ms
 
 #define GET_SAT_ID(FreqID, svid) ((FreqID == FREQ_E1) ? (MIN_GAL_SAT_ID + (svid) - 1) : ((FreqID == FREQ_B1C) ? (MIN_BDS_SAT_ID + (svid) - 1) : (svid)))
 
@@ -20,7 +20,20 @@ void GpsDecodeInit();
 void BdsDecodeInit();
 int BdsDecodeTask(void *Param);
 void BdsFrameDecode(int LogicChannel, unsigned short *FrameBuffer, int ResiduleBits);
+void SbasDecodeInit();
+int SbasDecodeTask(void *Param);
+void SbasSymbolDecode(int LogicChannel, int Svid, const S8 *Symbols, int SymbolCount);
+void GalDecodeInit();
+int GalDecodeTask(void *Param);
+void GalSymbolDecode(int LogicChannel, int Svid, const S8 *Symbols, int SymbolCount);
+void L1cDecodeInit();
+int L1cDecodeTask(void *Param);
+void L1cSymbolDecode(int LogicChannel, int Svid, int FrameIndex, const S8 *Symbols, int SymbolCount);
 PRECEIVER_INFO GetReceiverInfo();
 int GetSatelliteInView(SAT_PREDICT_PARAM SatList[32]);
+int GetAcqAiding(SAT_PREDICT_PARAM SatList[32]);
+U32 GetVectorAiding(SAT_PREDICT_PARAM AidingList[TOTAL_CHANNEL_NUMBER]);
+U32 GetXcorrChannelMask();
+U32 GetNavBitPrediction(PBB_MEASUREMENT Measurements, unsigned int ActiveMask, NAV_BIT_PREDICT PredictList[TOTAL_CHANNEL_NUMBER]);
 
 #endif //__PVT_ENTRY_H__
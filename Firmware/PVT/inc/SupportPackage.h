@@ -9,6 +9,7 @@
 #ifndef __SUPPORT_PACKAGE_H__
 #define __SUPPORT_PACKAGE_H__
 
+#include <stddef.h>
 #include "DataTypes.h"
 
 // ONES(n) is macro to get n continuous 1s
@@ -27,12 +28,58 @@ do \
 
 #define CUBE(x) ((x) * (x) * (x))
 
+// navigation message field descriptor
+// field position counts from first bit (MSB) of message with bit 0 as first transmitted bit
+// a field separated by other bits (e.g. parity of GPS LNAV) has MSB part at Pos and LSB part at Pos2
+#define NAV_FIELD_DOUBLE		0		// destination is double, value multiplied by Factor
+#define NAV_FIELD_INT			1		// destination is int/unsigned int, value shift left by -Scale
+#define NAV_FIELD_SHORT			2		// destination is short/unsigned short
+#define NAV_FIELD_CHAR			3		// destination is char/unsigned char
+#define NAV_FIELD_TYPE_MASK		0x3
+#define NAV_FIELD_SIGNED		0x4		// field is two's complement
+#define NAV_FIELD_SEMI_CIRCLE	0x8		// double value multiplied by PI
+
+typedef struct
+{
+	unsigned short Pos;		// start bit of field (or MSB part of field)
+	unsigned short Pos2;	// start bit of LSB part of field
+	unsigned char Length;	// bit length of field (or MSB part of field)
+	unsigned char Length2;	// bit length of LSB part of field, 0 if field is continuous
+	signed char Scale;		// scale factor as power of 2 in same manner as ScaleDouble()
+	unsigned char Flag;		// destination type and attribute
+	unsigned short Offset;	// offset of destination variable within structure
+	double Factor;			// 2^(-Scale) (times PI for semi-circle) for double destination, generated by NAV_FIELD macro
+} NAV_FIELD_DESC, *PNAV_FIELD_DESC;
+
+// navigation message word layout, each word has WordBits valid bits with first transmitted bit as MSB
+// LastWord is index of first word for words stored in reverse order (GPS LNAV subframe), -1 for increasing order
+typedef struct
+{
+	const unsigned int *Data;
+	int WordBits;
+	int LastWord;
+} NAV_MESSAGE, *PNAV_MESSAGE;
+
+// constant 2^(-scale) for scale within -63~126, power of 2 split in two shifts to allow scale over 63
+#define NAV_SCALE_POS(scale) ((scale) > 0 ? (scale) : 0)
+#define NAV_SCALE_NEG(scale) ((scale) < 0 ? -(scale) : 0)
+#define NAV_FIELD_FACTOR(scale, flag) \
+	((double)(1ULL << NAV_SCALE_NEG(scale)) / ((double)(1ULL << (NAV_SCALE_POS(scale) / 2)) * (double)(1ULL << (NAV_SCALE_POS(scale) - NAV_SCALE_POS(scale) / 2))) \
+	* (((flag) & NAV_FIELD_SEMI_CIRCLE) ? PI : 1.0))
+#define NAV_FIELD(type, member, pos, len, scale, flag) \
+	{ pos, 0, len, 0, scale, flag, (unsigned short)offsetof(type, member), NAV_FIELD_FACTOR(scale, flag) }
+#define NAV_FIELD2(type, member, pos, len, pos2, len2, scale, flag) \
+	{ pos, pos2, len, len2, scale, flag, (unsigned short)offsetof(type, member), NAV_FIELD_FACTOR(scale, flag) }
+#define NAV_FIELD_NUMBER(table) ((int)(sizeof(table) / sizeof(NAV_FIELD_DESC)))
+
 // basic functions
 double ScaleDouble(int value, int scale);
 double ScaleDoubleU(unsigned int value, int scale);
 double ScaleDoubleLong(long long value, int scale);
 double ScaleDoubleULong(unsigned long long value, int scale);
 BOOL GpsParityCheck(unsigned int word);
+unsigned long long GetNavBits(const NAV_MESSAGE *Message, int Pos, int Length);
+void DecodeNavFields(const NAV_MESSAGE *Message, const NAV_FIELD_DESC *FieldTable, int FieldNumber, void *Dest);
 
 // conversion functions
 void EcefToLlh(const KINEMATIC_INFO *ecef_pos, LLH *llh_pos);
@@ -44,14 +91,20 @@ void UtcToGlonassTime(PSYSTEM_TIME pUtcTime, int *LeapYears, int *DayNumber, int
 void CalcConvMatrix(KINEMATIC_INFO *pReceiverPos, PCONVERT_MATRIX pConvertMatrix);
 
 // satellite coordinate related functions
-double ClockCorrection(PGNSS_EPHEMERIS pEph, double TransmitTime);
-int SatPosSpeedEph(double TransmitTime, PGNSS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel);
-void SatPosSpeedAlm(int WeekNumber, int TransmitTime, PMIDI_ALMANAC pAlm, PKINEMATIC_INFO pPosVel);
+double ClockCorrection(const GNSS_EPHEMERIS *pEph, double TransmitTime);
+int SatPosSpeedEph(double TransmitTime, const GNSS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel);
+void SatPosSpeedEphBatch(int Number, const double *TransmitTime, const GNSS_EPHEMERIS *const *EphList, PKINEMATIC_INFO *PosVelList, int *EphOK);
+void GpsSatPosSpeedAlm(int WeekNumber, int TransmitTime, PMIDI_ALMANAC pAlm, PKINEMATIC_INFO pPosVel);
 double GeometryDistanceXYZ(const double *ReceiverPos, const double *SatellitePos);
 double GeometryDistance(const PKINEMATIC_INFO pReceiver, const PKINEMATIC_INFO pSatellite);
 double SatRelativeSpeed(PKINEMATIC_INFO pReceiver, PKINEMATIC_INFO pSatellite);
 double SatRelativeSpeedXYZ(double *ReceiverState, double *SatPosVel);
 void SatElAz(PKINEMATIC_INFO pReceiver, PSATELLITE_INFO pSatellite);
+void UpdateEpochGeometry(PEPOCH_GEOMETRY Geometry, const double *ReceiverPos);
+void EpochGeometryElAz(PEPOCH_GEOMETRY Geometry, const double *ReceiverPos);
+
+// ephemeris store functions
+int PublishEphemeris(PGNSS_EPHEMERIS Current, PGNSS_EPHEMERIS Staged);
 
 // matrix related functions
 void ComposeDelta(double *Delta, PHMATRIX H, double *MsrDelta, int dim);
@@ -61,9 +114,12 @@ void SymMatrixMultiply(double *DeltaPos, double *Inv, double *Delta, int dim);
 
 // position fix functions
 int PvtLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount);
-void InitPMatrix(double *PMatrix, const double *PMatrixInit, unsigned int PosFlag);
-void KFPrediction(double *PMatrix, double DeltaT);
-void KFAddQMatrix(double *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT);
+int PvtFlexibleTime(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount, double *TimeError);
+int PvtDopplerLsq(PCHANNEL_STATUS ObservationList[], int ObsCount, int LoopCount);
+void InitPMatrix(KF_COV_TYPE *PMatrix, const double *PMatrixInit, unsigned int PosFlag);
+void KFPrediction(KF_COV_TYPE *PMatrix, double DeltaT);
+void KFAddQMatrix(KF_COV_TYPE *PMatrix, const double *QConfig, PCONVERT_MATRIX pConvertMatrix, double DeltaT);
+double KFStateVariance(const KF_COV_TYPE *PMatrix, int StateIndex);
 int KFPosition(PCHANNEL_STATUS ObservationList[], int ObsCount, int PosUseSatCount[PVT_MAX_SYSTEM_ID]);
 
 #endif //__SUPPORT_PKG_H__
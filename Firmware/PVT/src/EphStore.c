@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------
+// EphStore.c:
+//   Ephemeris validation and publish shared by all frame decoders
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <string.h>
+#include <math.h>
+
+#include "DataTypes.h"
+#include "GlobalVar.h"
+#include "SupportPackage.h"
+
+#define EPH_AXIS_MIN 2.0e7				// semi-major axis range of MEO/IGSO/GEO satellites
+#define EPH_AXIS_MAX 4.5e7
+#define EPH_ECC_MAX 0.1					// eccentricity upper limit of navigation satellites
+#define EPH_CROSS_CHECK_SPAN 14400		// cross check with current ephemeris if toe within this number of seconds
+#define EPH_CROSS_CHECK_DISTANCE 1000.0	// maximum satellite position difference of two ephemeris sets in meter
+
+#define TOTAL_EPH_NUMBER (TOTAL_GPS_SAT_NUMBER + TOTAL_BDS_SAT_NUMBER + TOTAL_GAL_SAT_NUMBER)
+
+// toe+1 of latest staged ephemeris failing cross check (0 for none), same toe decoded again means current ephemeris is wrong
+static int RejectedToe[TOTAL_EPH_NUMBER];
+
+static int GetStoreIndex(const GNSS_EPHEMERIS *Current);
+static int ValidateEphemeris(const GNSS_EPHEMERIS *pEph);
+static int CrossCheckEphemeris(const GNSS_EPHEMERIS *Current, const GNSS_EPHEMERIS *Staged);
+static void CalcEphemerisDerived(PGNSS_EPHEMERIS pEph);
+
+//*************** Publish staged ephemeris to current ephemeris ****************
+//* decoders fill staged ephemeris with decoded fields (sqrtA, not axis), this function
+//* validates it, calculates derived variables and copies to current slot with version increased
+//* staged ephemeris with flag 0 (unhealthy) is published without check to invalidate current one
+// Parameters:
+//   Current: pointer to current ephemeris in g_GpsEphemeris/g_BdsEphemeris/g_GalileoEphemeris
+//   Staged: pointer to staged ephemeris, derived variables and version are filled in
+// Return value:
+//   1 if published, 0 if rejected
+int PublishEphemeris(PGNSS_EPHEMERIS Current, PGNSS_EPHEMERIS Staged)
+{
+	int Index = GetStoreIndex(Current);
+
+	if (Staged->flag & 1)
+	{
+		CalcEphemerisDerived(Staged);
+		if (!ValidateEphemeris(Staged))
+			return 0;
+		if (!CrossCheckEphemeris(Current, Staged))
+		{
+			if (Index < 0 || RejectedToe[Index] != Staged->toe + 1)
+			{
+				if (Index >= 0)
+					RejectedToe[Index] = Staged->toe + 1;
+				return 0;
+			}
+		}
+	}
+	if (Index >= 0)
+		RejectedToe[Index] = 0;
+	Staged->version = Current->version + 1;
+	memcpy(Current, Staged, sizeof(GNSS_EPHEMERIS));
+	return 1;
+}
+
+//*************** Get index of ephemeris slot in rejected toe array ****************
+// Parameters:
+//   Current: pointer to current ephemeris
+// Return value:
+//   index of slot, -1 if not a global ephemeris slot
+int GetStoreIndex(const GNSS_EPHEMERIS *Current)
+{
+	if (Current >= g_GpsEphemeris && Current < g_GpsEphemeris + TOTAL_GPS_SAT_NUMBER)
+		return (int)(Current - g_GpsEphemeris);
+	if (Current >= g_BdsEphemeris && Current < g_BdsEphemeris + TOTAL_BDS_SAT_NUMBER)
+		return TOTAL_GPS_SAT_NUMBER + (int)(Current - g_BdsEphemeris);
+	if (Current >= g_GalileoEphemeris && Current < g_GalileoEphemeris + TOTAL_GAL_SAT_NUMBER)
+		return TOTAL_GPS_SAT_NUMBER + TOTAL_BDS_SAT_NUMBER + (int)(Current - g_GalileoEphemeris);
+	return -1;
+}
+
+//*************** Check whether ephemeris parameters within valid range ****************
+// Parameters:
+//   pEph: pointer to ephemeris with derived variables calculated
+// Return value:
+//   1 if valid, otherwise 0
+int ValidateEphemeris(const GNSS_EPHEMERIS *pEph)
+{
+	if (pEph->axis < EPH_AXIS_MIN || pEph->axis > EPH_AXIS_MAX)
+		return 0;
+	if (pEph->ecc < 0.0 || pEph->ecc >= EPH_ECC_MAX)
+		return 0;
+	if (pEph->toe < 0 || pEph->toe >= 604800 || pEph->toc < 0 || pEph->toc >= 604800)
+		return 0;
+	if (fabs(pEph->i0) > PI)
+		return 0;
+	return 1;
+}
+
+//*************** Cross check staged ephemeris with current ephemeris ****************
+//* satellite positions of both sets at staged toe should match if toe close enough
+// Parameters:
+//   Current: pointer to current ephemeris
+//   Staged: pointer to staged ephemeris with derived variables calculated
+// Return value:
+//   1 if consistent or not comparable, 0 if two sets do not match
+int CrossCheckEphemeris(const GNSS_EPHEMERIS *Current, const GNSS_EPHEMERIS *Staged)
+{
+	KINEMATIC_INFO CurrentPos, StagedPos;
+	double dx, dy, dz;
+	int TimeDiff;
+
+	if (!(Current->flag & 1))
+		return 1;
+	TimeDiff = Staged->toe - Current->toe;
+	if (TimeDiff > 302400)
+		TimeDiff -= 604800;
+	else if (TimeDiff < -302400)
+		TimeDiff += 604800;
+	if (TimeDiff > EPH_CROSS_CHECK_SPAN || TimeDiff < -EPH_CROSS_CHECK_SPAN)
+		return 1;
+
+	SatPosSpeedEph((double)Staged->toe, Current, &CurrentPos);
+	SatPosSpeedEph((double)Staged->toe, Staged, &StagedPos);
+	dx = CurrentPos.x - StagedPos.x;
+	dy = CurrentPos.y - StagedPos.y;
+	dz = CurrentPos.z - StagedPos.z;
+	return ((dx * dx + dy * dy + dz * dz) < EPH_CROSS_CHECK_DISTANCE * EPH_CROSS_CHECK_DISTANCE) ? 1 : 0;
+}
+
+//*************** Calculate derived variables of ephemeris ****************
+//* done once on publish so that satellite position calculation only uses precomputed values
+// Parameters:
+//   pEph: pointer to ephemeris
+// Return value:
+//   none
+void CalcEphemerisDerived(PGNSS_EPHEMERIS pEph)
+{
+	pEph->axis = pEph->sqrtA * pEph->sqrtA;
+	pEph->n = WGS_SQRT_GM / (pEph->sqrtA * pEph->axis) + pEph->delta_n;
+	pEph->root_ecc = sqrt(1.0 - pEph->ecc * pEph->ecc);
+	pEph->omega_t = pEph->omega0 - WGS_OMEGDOTE * pEph->toe;
+	pEph->omega_delta = pEph->omega_dot - WGS_OMEGDOTE;
+}
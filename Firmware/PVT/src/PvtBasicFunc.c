@@ -8,8 +8,9 @@
 
 #include <math.h>
 #include "DataTypes.h"
+#include "SupportPackage.h"
 
-static unsigned int GetParity(unsigned int word);
+unsigned int GetParity(unsigned int word);
 
 // play a trick here for ScaleDouble, ScaleDoubleU
 // ScaleFloat and ScaleFloatU
@@ -148,3 +149,89 @@ BOOL GpsParityCheck(unsigned int word)
 {
 	return (GetParity(word) == (word & 0x3f));
 }
+
+//*************** Get bits from navigation message ****************
+//* bits are taken word by word instead of bit by bit
+// Parameters:
+//   Message: pointer to navigation message word layout
+//   Pos: start bit position, 0 for first transmitted bit of message
+//   Length: number of bits to get, not exceed 64
+// Return value:
+//   bits got with last bit as LSB
+unsigned long long GetNavBits(const NAV_MESSAGE *Message, int Pos, int Length)
+{
+	unsigned long long Bits = 0;
+	unsigned int Word;
+	int WordIndex, BitIndex, BitNumber;
+
+	WordIndex = Pos / Message->WordBits;
+	BitIndex = Pos - WordIndex * Message->WordBits;
+	BitNumber = Message->WordBits - BitIndex;	// remaining bits in current word
+	if (BitNumber >= Length)	// most fields within one word
+	{
+		Word = Message->Data[(Message->LastWord >= 0) ? (Message->LastWord - WordIndex) : WordIndex];
+		return (Word >> (BitNumber - Length)) & (0xffffffff >> (32 - Length));
+	}
+	while (Length > 0)
+	{
+		Word = Message->Data[(Message->LastWord >= 0) ? (Message->LastWord - WordIndex) : WordIndex];
+		BitNumber = Message->WordBits - BitIndex;	// remaining bits in current word
+		if (BitNumber > Length)
+		{
+			Word >>= (BitNumber - Length);
+			BitNumber = Length;
+		}
+		Bits = (Bits << BitNumber) | (Word & (0xffffffff >> (32 - BitNumber)));
+		Length -= BitNumber;
+		WordIndex ++;
+		BitIndex = 0;
+	}
+
+	return Bits;
+}
+
+//*************** Decode navigation message fields according to descriptor table ****************
+// Parameters:
+//   Message: pointer to navigation message word layout
+//   FieldTable: array of field descriptors
+//   FieldNumber: number of field descriptors
+//   Dest: pointer to structure to hold decoded values
+// Return value:
+//   none
+void DecodeNavFields(const NAV_MESSAGE *Message, const NAV_FIELD_DESC *FieldTable, int FieldNumber, void *Dest)
+{
+	unsigned long long Bits;
+	int Length;
+	void *Target;
+
+	for (; FieldNumber > 0; FieldNumber --, FieldTable ++)
+	{
+		Bits = GetNavBits(Message, FieldTable->Pos, FieldTable->Length);
+		Length = FieldTable->Length;
+		if (FieldTable->Length2)
+		{
+			Bits = (Bits << FieldTable->Length2) | GetNavBits(Message, FieldTable->Pos2, FieldTable->Length2);
+			Length += FieldTable->Length2;
+		}
+		// sign extension
+		if ((FieldTable->Flag & NAV_FIELD_SIGNED) && (Bits & (1ULL << (Length - 1))))
+			Bits |= ~0ULL << Length;
+
+		Target = (unsigned char *)Dest + FieldTable->Offset;
+		switch (FieldTable->Flag & NAV_FIELD_TYPE_MASK)
+		{
+		case NAV_FIELD_DOUBLE:
+			*(double *)Target = (double)(long long)Bits * FieldTable->Factor;
+			break;
+		case NAV_FIELD_INT:
+			*(int *)Target = (int)(Bits << (-FieldTable->Scale));
+			break;
+		case NAV_FIELD_SHORT:
+			*(short *)Target = (short)(Bits << (-FieldTable->Scale));
+			break;
+		case NAV_FIELD_CHAR:
+			*(unsigned char *)Target = (unsigned char)(Bits << (-FieldTable->Scale));
+			break;
+		}
+	}
+}
@@ -55,6 +55,8 @@ do \
 // baseband configurations
 //==========================
 #define TOTAL_CHANNEL_NUMBER 32
+// define DUAL_FREQ_L5 to track GPS L5 from second RF input, L5 channel is handed over from L1C/A channel
+//#define DUAL_FREQ_L5
 
 //==========================
 // frequency ID definitions
@@ -63,12 +65,17 @@ do \
 #define FREQ_E1   1
 #define FREQ_B1C  2
 #define FREQ_L1C  3
+#define FREQ_L5   4	// GPS L5 pilot (Q5), tracked on second RF input only
 // frequency ID compare
 #define FREQ_ID_IS_L1CA(FreqID) ((FreqID) == FREQ_L1CA)
 #define FREQ_ID_IS_E1(FreqID) ((FreqID) == FREQ_E1)
 #define FREQ_ID_IS_B1C(FreqID) ((FreqID) == FREQ_B1C)
 #define FREQ_ID_IS_L1C(FreqID) ((FreqID) == FREQ_L1C)
+#define FREQ_ID_IS_L5(FreqID) ((FreqID) == FREQ_L5)
 #define FREQ_ID_IS_B1C_L1C(FreqID) ((FreqID) & 2)
+// SBAS PRN120~138 share L1C/A frequency ID with SVID 33~51
+#define MIN_SBAS_SVID 33
+#define SVID_IS_SBAS(FreqID, Svid) (FREQ_ID_IS_L1CA(FreqID) && (Svid) >= MIN_SBAS_SVID)
 // 2MSB mark as data/pilot
 #define FREQ_DATA_CHANNEL 0x80
 #define FREQ_PILOT_CHANNEL 0x40
@@ -121,6 +128,9 @@ do \
 // bit 12 for NH update required
 #define NH_SEGMENT_UPDATE 0x1000	// NH code longer than 25bit
 
+// bit 13 for vector tracking
+#define STATE_VECTOR_AIDED 0x2000	// carrier and code frequency aided by PVT Kalman filter prediction
+
 // bit16~18 for tracking loop update
 #define TRACKING_UPDATE_PLL 0x10000
 #define TRACKING_UPDATE_FLL 0x20000
@@ -154,10 +164,26 @@ do \
 #define SAMPLES_1MS (SAMPLE_FREQ / 1000)
 #define GPS_L1_WAVELENGTH 0.19029367279836488
 
+// second RF input for L5 band
+#if !defined IF_FREQ_L5
+#define IF_FREQ_L5 141000
+#endif
+#if !defined SAMPLE_FREQ_L5
+#define SAMPLE_FREQ_L5 24000000
+#endif
+#if (SAMPLE_FREQ_L5 % 1000) != 0
+#error L5 sample frequency should be multiple of 1000
+#endif
+#define RF_FREQ_L5 1176450000
+#define SAMPLES_1MS_L5 (SAMPLE_FREQ_L5 / 1000)
+#define GPS_L5_WAVELENGTH 0.25482804879085386
+
 #define DIVIDE_ROUND(divident, divisor) (S32)(((divident) + divisor/2) / divisor)
 #define CARRIER_FREQ(doppler) DIVIDE_ROUND(((S64)(IF_FREQ + (doppler))) << 32, SAMPLE_FREQ)	// multiply 2^32/fs
 #define CARRIER_FREQ_BOC(doppler) DIVIDE_ROUND(((S64)(IF_FREQ_BOC + (doppler))) << 32, SAMPLE_FREQ)	// multiply 2^32/fs
 #define CODE_FREQ(doppler) DIVIDE_ROUND((((S64)(RF_FREQ + (doppler))) << 32) / 770, SAMPLE_FREQ)	// (RF + Doppler)/770 multiply 2^32/fs
+#define CARRIER_FREQ_L5(doppler) DIVIDE_ROUND(((S64)(IF_FREQ_L5 + (doppler))) << 32, SAMPLE_FREQ_L5)	// multiply 2^32/fs_L5
+#define CODE_FREQ_L5(doppler) DIVIDE_ROUND((((S64)(RF_FREQ_L5 + (doppler))) << 32) / 115 * 2, SAMPLE_FREQ_L5)	// (RF + Doppler)/115*2 multiply 2^32/fs_L5
 #define AE_STRIDE_INTERVAL(freq) DIVIDE_ROUND((S64)(freq) << 32, 2046000)	// multiply 2^32/2046000
 #define AE_CENTER_FREQ(freq) DIVIDE_ROUND((S64)(freq) << 20, 2046000)	// multiply 2^20/2046000
 
@@ -187,6 +213,7 @@ typedef struct
 	S32 FrameIndex;		// position of first data in frame
 	U32 LockIndicator;	// carrier lock indicator
 	U32 *DataStreamAddr;	// address of data in data stream buffer
+	U32 BitCount;		// total number of data symbols decoded since channel start (index of next symbol)
 } BB_MEASUREMENT, *PBB_MEASUREMENT;
 
 typedef struct
@@ -210,9 +237,23 @@ typedef struct
 	int DataCount;			// number of decoded symbols
 	int StartIndex;			// index of the first data symbol within a frame
 	int PrevSymbol;			// previous symbol (determine data toggle)
+	U32 BitCount;			// total number of symbols since channel start (not cleared on measurement)
+	int SymbolAmp;			// smoothed symbol amplitude to scale 8bit soft symbols
 	U32 DataBuffer[128/4];	// maximum 128 bytes to hold decoded symbols
 } DATA_STREAM, *PDATA_STREAM;
 
+//==========================
+// navigation bit prediction for data wipe-off
+//==========================
+typedef struct
+{
+	U8 FreqID;	// system and frequency
+	U8 Svid;	// SVID start from 1
+	U16 BitNumber;	// number of predicted bits in BitStream
+	U32 StartBit;	// index of first predicted bit (compare with BitCount in DATA_STREAM)
+	U32 BitStream[2];	// predicted bits, first bit at MSB of BitStream[0]
+} NAV_BIT_PREDICT, *PNAV_BIT_PREDICT;
+
 //==========================
 // satellite prediction and aiding
 //==========================
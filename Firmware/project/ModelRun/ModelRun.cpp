@@ -12,6 +12,9 @@ extern "C" {
 void main()
 {
 	SetInputFile("..\\..\\..\\data\\sim_signal_L1CA.bin");
+#if defined DUAL_FREQ_L5
+	SetInputFile2("..\\..\\..\\data\\sim_signal_L5.bin");
+#endif
 
 	FirmwareInitialize();
 	EnableRF();
@@ -8,12 +8,15 @@ extern "C" {
 #include "GlobalVar.h"
 }
 
+#include "RtsSmoother.h"
+
 #define PARAM_OFFSET_CONFIG		1024*0
 #define PARAM_OFFSET_RCVRINFO	1024*1
 #define PARAM_OFFSET_IONOUTC	1024*2
 #define PARAM_OFFSET_GPSALM		1024*4
 #define PARAM_OFFSET_BDSALM		1024*8
 #define PARAM_OFFSET_GALALM		1024*16
+#define PARAM_OFFSET_EPHLAYOUT	1024*23
 #define PARAM_OFFSET_GPSEPH		1024*24
 #define PARAM_OFFSET_BDSEPH		1024*32
 #define PARAM_OFFSET_GALEPH		1024*48
@@ -27,19 +30,25 @@ BB_MEAS_PARAM MeasurementParam;
 void main()
 {
 	FILE *fp;
-	int i;
+	int i, j, k;
+	S8 SbasSymbols[128], GalSymbols[256], L1cSymbols[128];
 	char InputLine[256], *p;
 	U32 *BufferPointer, *DataStreamAddr;
 	BB_MEASUREMENT Meas, *CurrentMeas = 0;
 	int LogicChannel, Svid, FreqID;
 	int DataNumber, FrameIndex;
 	DATA_STREAM DataStream;
+	CRtsSmoother Smoother;
+	int SmoothEnable = 1;	// record KF epochs and output forward-backward smoothed result
 
 	if ((fp = fopen("test_obs2.bbo", "r")) == NULL)
 		return;
 
 	GpsDecodeInit();
 	BdsDecodeInit();
+	SbasDecodeInit();
+	GalDecodeInit();
+	L1cDecodeInit();
 	MsrProcInit();
 	PvtProcInit((PRECEIVER_INFO)0);
 
@@ -51,6 +60,8 @@ void main()
 		g_ReceiverInfo.PosVel.vx = g_ReceiverInfo.PosVel.vy = g_ReceiverInfo.PosVel.vz = 0.0;
 	}
 	g_PvtConfig.PvtConfigFlags |= PVT_CONFIG_USE_KF;
+	if (SmoothEnable && !Smoother.Open())
+		SmoothEnable = 0;
 
 	MeasurementParam.Measurements = BasebandMeasurement;
 	BufferPointer = DataStreamBuffer;
@@ -112,6 +123,27 @@ void main()
 						memcpy(DataStream.DataBuffer, CurrentMeas->DataStreamAddr, 128);
 						BdsDecodeTask((void *)(&DataStream));
 					}
+					else if (SVID_IS_SBAS(CurrentMeas->FreqID, CurrentMeas->Svid) && CurrentMeas->DataNumber <= 128)
+					{
+						for (j = 0; j < CurrentMeas->DataNumber; j ++)
+							SbasSymbols[j] = (S8)(CurrentMeas->DataStreamAddr[j/4] >> (24 - (j & 3) * 8));
+						SbasSymbolDecode(i, CurrentMeas->Svid, SbasSymbols, CurrentMeas->DataNumber);
+					}
+					else if (FREQ_ID_IS_E1(CurrentMeas->FreqID) && CurrentMeas->FrameIndex >= 0 && CurrentMeas->DataNumber <= 256)
+					{
+						for (j = 0; j < CurrentMeas->DataNumber; j ++)
+						{
+							k = (CurrentMeas->DataStreamAddr[j/8] >> (28 - (j & 7) * 4)) & 0xf;
+							GalSymbols[j] = (S8)(((k - ((k & 0x8) << 1)) * 2 + 1) * 8);	// 4bit soft symbol to 8bit
+						}
+						GalSymbolDecode(i, CurrentMeas->Svid, GalSymbols, CurrentMeas->DataNumber);
+					}
+					else if (FREQ_ID_IS_L1C(CurrentMeas->FreqID) && CurrentMeas->FrameIndex >= 0 && CurrentMeas->DataNumber <= 128)
+					{
+						for (j = 0; j < CurrentMeas->DataNumber; j ++)
+							L1cSymbols[j] = (S8)(CurrentMeas->DataStreamAddr[j/4] >> (24 - (j & 3) * 8));
+						L1cSymbolDecode(i, CurrentMeas->Svid, CurrentMeas->FrameIndex, L1cSymbols, CurrentMeas->DataNumber);
+					}
 				}
 			}
 			// calculate raw measurement and do PVT
@@ -119,17 +151,23 @@ void main()
 				MeasurementParam.RunTimeAcc = 1153000;
 			MsrProc(BasebandMeasurement, MeasurementParam.MeasMask, MeasurementParam.MeasInterval, MeasurementParam.MeasInterval);
 			PvtProc(MeasurementParam.MeasInterval);
+			if (SmoothEnable)
+				Smoother.AddEpoch(MeasurementParam.MeasInterval);
 			// reset current measurement set
 			BufferPointer = DataStreamBuffer;
 			MeasurementParam.MeasMask = 0;
 		}
 	}
+	if (SmoothEnable)
+		Smoother.Smooth("smoothed_pos.txt");
 //	SaveAllParameters();
 }
 
 void LoadAllParameters()
 {
 	FILE *fp;
+	unsigned int EphLayout = 0;
+
 	if ((fp = fopen("ParamFile.bin", "rb")) == NULL)
 		return;
 	fseek(fp, PARAM_OFFSET_CONFIG, SEEK_SET); fread(&g_PvtConfig, 1, sizeof(g_PvtConfig), fp);
@@ -141,8 +179,12 @@ void LoadAllParameters()
 	fseek(fp, PARAM_OFFSET_GPSALM, SEEK_SET); fread(&g_GpsAlmanac, 1, sizeof(g_GpsAlmanac), fp);
 	fseek(fp, PARAM_OFFSET_BDSALM, SEEK_SET); fread(&g_BdsAlmanac, 1, sizeof(g_BdsAlmanac), fp);
 	fseek(fp, PARAM_OFFSET_GALALM, SEEK_SET); fread(&g_GalileoAlmanac, 1, sizeof(g_GalileoAlmanac), fp);
-	fseek(fp, PARAM_OFFSET_GPSEPH, SEEK_SET); fread(&g_GpsEphemeris, 1, sizeof(g_GpsEphemeris), fp);
-	fseek(fp, PARAM_OFFSET_BDSEPH, SEEK_SET); fread(&g_BdsEphemeris, 1, sizeof(g_BdsEphemeris), fp);
-	fseek(fp, PARAM_OFFSET_GALEPH, SEEK_SET); fread(&g_GalileoEphemeris, 1, sizeof(g_GalileoEphemeris), fp);
+	fseek(fp, PARAM_OFFSET_EPHLAYOUT, SEEK_SET); fread(&EphLayout, 1, sizeof(EphLayout), fp);
+	if (EphLayout == EPH_LAYOUT_TAG)	// discard ephemeris saved with different structure layout
+	{
+		fseek(fp, PARAM_OFFSET_GPSEPH, SEEK_SET); fread(&g_GpsEphemeris, 1, sizeof(g_GpsEphemeris), fp);
+		fseek(fp, PARAM_OFFSET_BDSEPH, SEEK_SET); fread(&g_BdsEphemeris, 1, sizeof(g_BdsEphemeris), fp);
+		fseek(fp, PARAM_OFFSET_GALEPH, SEEK_SET); fread(&g_GalileoEphemeris, 1, sizeof(g_GalileoEphemeris), fp);
+	}
 	fclose(fp);
 }
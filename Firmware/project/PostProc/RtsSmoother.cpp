@@ -0,0 +1,268 @@
+//----------------------------------------------------------------------
+// RtsSmoother.cpp:
+//   Rauch-Tung-Striebel smoother class implementation for post processing
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#include "RtsSmoother.h"
+
+extern "C" {
+#include "GlobalVar.h"
+#include "SupportPackage.h"
+}
+
+static void UnpackMatrix(const double *Packed, double Full[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE]);
+static void PackMatrix(double Full[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE], double *Packed);
+
+CRtsSmoother::CRtsSmoother()
+{
+	fpStore = fpSmooth = (FILE *)0;
+	EpochCount = 0;
+	PrevKFEpoch = 0;
+	Chunk = new KF_EPOCH_RECORD[SMOOTH_CHUNK_SIZE];
+}
+
+CRtsSmoother::~CRtsSmoother()
+{
+	if (fpStore)
+		fclose(fpStore);
+	if (fpSmooth)
+		fclose(fpSmooth);
+	delete[] Chunk;
+}
+
+//*************** Open temporary files to store filtered and smoothed epochs ****************
+// Parameters:
+//   none
+// Return value:
+//   1 if success, 0 if fail to open files
+int CRtsSmoother::Open()
+{
+	fpStore = tmpfile();
+	fpSmooth = tmpfile();
+	EpochCount = 0;
+	PrevKFEpoch = 0;
+	return (fpStore && fpSmooth) ? 1 : 0;
+}
+
+//*************** Record KF state after one PvtProc call in forward pass ****************
+//* only epochs with KF initialized (PosTypeToKF) or updated (PosTypeKFPos) are recorded
+//* an epoch starts a new segment if KF is re-initialized or previous epoch is not recorded
+// Parameters:
+//   MsInterval: time interval used by PvtProc
+// Return value:
+//   none
+void CRtsSmoother::AddEpoch(int MsInterval)
+{
+	KF_EPOCH_RECORD Record;
+
+	if (g_ReceiverInfo.CurrentPosType != PosTypeKFPos && g_ReceiverInfo.CurrentPosType != PosTypeToKF)
+	{
+		PrevKFEpoch = 0;
+		return;
+	}
+
+	Record.Start = (g_ReceiverInfo.CurrentPosType == PosTypeToKF || !PrevKFEpoch) ? 1 : 0;
+	Record.WeekNumber = g_ReceiverInfo.WeekNumber;
+	Record.GpsMsCount = g_ReceiverInfo.GpsMsCount;
+	Record.DeltaT = MsInterval / 1000.0;
+	Record.ConvertMatrix = g_ReceiverInfo.ConvertMatrix;	// calculated at beginning of PvtFix and used by KFAddQMatrix
+	memcpy(Record.StateVector, g_PvtCoreData.StateVector, sizeof(Record.StateVector));
+	memcpy(Record.PMatrix, g_PvtCoreData.PMatrix, sizeof(Record.PMatrix));
+	fwrite(&Record, sizeof(KF_EPOCH_RECORD), 1, fpStore);
+	EpochCount ++;
+	PrevKFEpoch = 1;
+}
+
+//*************** Do backward pass and output smoothed result ****************
+//* stored epochs are loaded from last to first by chunks of SMOOTH_CHUNK_SIZE
+//* only the smoothed epoch next to current chunk is kept between chunks, so memory is bounded for long logs
+//* smoothed epochs are written back to the same position of another file and output in forward order at the end
+// Parameters:
+//   OutputFileName: name of text file to output smoothed result
+// Return value:
+//   number of smoothed epochs
+int CRtsSmoother::Smooth(const char *OutputFileName)
+{
+	int i, Count, Remaining = EpochCount;
+	KF_EPOCH_RECORD Next;
+	int HaveNext = 0;
+	FILE *fp;
+
+	if (!fpStore || !fpSmooth || EpochCount == 0)
+		return 0;
+
+	while (Remaining > 0)
+	{
+		Count = (Remaining > SMOOTH_CHUNK_SIZE) ? SMOOTH_CHUNK_SIZE : Remaining;
+		Remaining -= Count;
+		fseek(fpStore, (long)Remaining * sizeof(KF_EPOCH_RECORD), SEEK_SET);
+		if (fread(Chunk, sizeof(KF_EPOCH_RECORD), Count, fpStore) != (size_t)Count)
+			return 0;
+		for (i = Count - 1; i >= 0; i --)
+		{
+			// last epoch of each segment keeps filtered result
+			if (HaveNext && !Next.Start)
+				SmoothStep(&Chunk[i], &Next);
+			Next = Chunk[i];
+			HaveNext = 1;
+		}
+		fseek(fpSmooth, (long)Remaining * sizeof(KF_EPOCH_RECORD), SEEK_SET);
+		fwrite(Chunk, sizeof(KF_EPOCH_RECORD), Count, fpSmooth);
+	}
+
+	if ((fp = fopen(OutputFileName, "w")) == NULL)
+		return 0;
+	OutputResult(fp);
+	fclose(fp);
+
+	return EpochCount;
+}
+
+//*************** Smooth one epoch with smoothed result of next epoch ****************
+//* Ppred = A*P*A'+Q and Xpred = A*X are calculated again with the same functions as forward pass
+//* C = P*A'*Inv(Ppred)
+//* Xs = X + C*(Xs_next - Xpred)
+//* Ps = P + C*(Ps_next - Ppred)*C'
+// Parameters:
+//   Epoch: filtered epoch, replaced by smoothed result
+//   Next: smoothed result of next epoch with its prediction parameters
+// Return value:
+//   none
+void CRtsSmoother::SmoothStep(PKF_EPOCH_RECORD Epoch, const KF_EPOCH_RECORD *Next)
+{
+	int i, j, k, Src;
+	const double Q[3] = { KF_QH, KF_QV, KF_QF };
+	double DeltaT = Next->DeltaT;
+	double PredictP[P_MATRIX_SIZE], InvP[P_MATRIX_SIZE], WorkSpace[P_MATRIX_SIZE];
+	double P[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE], PAt[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE];
+	double C[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE], Temp[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE];
+	double DeltaP[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE];
+	double DeltaX[STATE_VECTOR_SIZE];
+	CONVERT_MATRIX ConvertMatrix = Next->ConvertMatrix;
+
+	// prediction to next epoch
+	memcpy(PredictP, Epoch->PMatrix, sizeof(PredictP));
+	KFPrediction(PredictP, DeltaT);
+	KFAddQMatrix(PredictP, Q, &ConvertMatrix, DeltaT);
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+	{
+		// transition of X/Y/Z from VX/VY/VZ, clock error from TDOT
+		Src = (i < 4) ? -1 : (i < 7) ? (i - 4) : 3;
+		DeltaX[i] = Next->StateVector[i] - Epoch->StateVector[i] - ((Src >= 0) ? Epoch->StateVector[Src] * DeltaT : 0.0);
+	}
+
+	// gain C = P*A'*Inv(Ppred)
+	memcpy(InvP, PredictP, sizeof(InvP));
+	SymMatrixInv(InvP, WorkSpace, STATE_VECTOR_SIZE);
+	UnpackMatrix(Epoch->PMatrix, P);
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+		{
+			Src = (j < 4) ? -1 : (j < 7) ? (j - 4) : 3;
+			PAt[i][j] = P[i][j] + ((Src >= 0) ? P[i][Src] * DeltaT : 0.0);
+		}
+	UnpackMatrix(InvP, Temp);
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+		{
+			C[i][j] = 0.0;
+			for (k = 0; k < STATE_VECTOR_SIZE; k ++)
+				C[i][j] += PAt[i][k] * Temp[k][j];
+		}
+
+	// smoothed state
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+			Epoch->StateVector[i] += C[i][j] * DeltaX[j];
+
+	// smoothed P matrix
+	for (i = 0; i < P_MATRIX_SIZE; i ++)
+		PredictP[i] = Next->PMatrix[i] - PredictP[i];
+	UnpackMatrix(PredictP, DeltaP);
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j < STATE_VECTOR_SIZE; j ++)
+		{
+			Temp[i][j] = 0.0;
+			for (k = 0; k < STATE_VECTOR_SIZE; k ++)
+				Temp[i][j] += C[i][k] * DeltaP[k][j];
+		}
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j <= i; j ++)
+			for (k = 0; k < STATE_VECTOR_SIZE; k ++)
+				P[i][j] += Temp[i][k] * C[j][k];
+	PackMatrix(P, Epoch->PMatrix);
+}
+
+//*************** Output smoothed epochs in forward order ****************
+//* each line has UTC time, latitude/longitude/height, ECEF velocity and STD of ECEF position
+// Parameters:
+//   fp: output file
+// Return value:
+//   none
+void CRtsSmoother::OutputResult(FILE *fp)
+{
+	int i, Count, Remaining = EpochCount;
+	KINEMATIC_INFO PosVel;
+	LLH PosLLH;
+	SYSTEM_TIME UtcTime;
+	PKF_EPOCH_RECORD Epoch;
+
+	fseek(fpSmooth, 0, SEEK_SET);
+	while (Remaining > 0)
+	{
+		Count = (Remaining > SMOOTH_CHUNK_SIZE) ? SMOOTH_CHUNK_SIZE : Remaining;
+		Remaining -= Count;
+		if (fread(Chunk, sizeof(KF_EPOCH_RECORD), Count, fpSmooth) != (size_t)Count)
+			return;
+		for (i = 0, Epoch = Chunk; i < Count; i ++, Epoch ++)
+		{
+			PosVel.x = Epoch->StateVector[4];
+			PosVel.y = Epoch->StateVector[5];
+			PosVel.z = Epoch->StateVector[6];
+			EcefToLlh(&PosVel, &PosLLH);
+			GpsTimeToUtc(Epoch->WeekNumber, Epoch->GpsMsCount, &UtcTime, (PUTC_PARAM)0);
+			fprintf(fp, "%04d/%02d/%02d %02d:%02d:%02d.%03d %14.9f %14.9f %10.4f %8.3f %8.3f %8.3f %7.3f %7.3f %7.3f\n",
+				UtcTime.Year, UtcTime.Month, UtcTime.Day, UtcTime.Hour, UtcTime.Minute, UtcTime.Second, UtcTime.Millisecond,
+				PosLLH.lat * 180 / PI, PosLLH.lon * 180 / PI, PosLLH.hae,
+				Epoch->StateVector[0], Epoch->StateVector[1], Epoch->StateVector[2],
+				sqrt(Epoch->PMatrix[14]), sqrt(Epoch->PMatrix[20]), sqrt(Epoch->PMatrix[27]));
+		}
+	}
+}
+
+//*************** Expand packed lower triangle symmetric matrix to full matrix ****************
+// Parameters:
+//   Packed: pointer to packed matrix with same order as P matrix
+//   Full: full matrix
+// Return value:
+//   none
+void UnpackMatrix(const double *Packed, double Full[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE])
+{
+	int i, j;
+
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j <= i; j ++)
+			Full[i][j] = Full[j][i] = *Packed ++;
+}
+
+//*************** Pack lower triangle of symmetric matrix ****************
+// Parameters:
+//   Full: full matrix
+//   Packed: pointer to packed matrix with same order as P matrix
+// Return value:
+//   none
+void PackMatrix(double Full[STATE_VECTOR_SIZE][STATE_VECTOR_SIZE], double *Packed)
+{
+	int i, j;
+
+	for (i = 0; i < STATE_VECTOR_SIZE; i ++)
+		for (j = 0; j <= i; j ++)
+			*Packed ++ = Full[i][j];
+}
@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------
+// RtsSmoother.h:
+//   Rauch-Tung-Striebel smoother class declaration for post processing
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __RTS_SMOOTHER_H__
+#define __RTS_SMOOTHER_H__
+
+#include <stdio.h>
+
+extern "C" {
+#include "CommonDefines.h"
+#include "PvtConst.h"
+#include "DataTypes.h"
+}
+
+#if defined PVT_KF_UD_FLOAT
+#error "RTS smoother works on double precision P matrix, build PostProc without PVT_KF_UD_FLOAT"
+#endif
+
+#define SMOOTH_CHUNK_SIZE 1024	// number of epochs loaded into memory in one step of backward pass
+
+// KF epoch stored in forward pass and replaced by smoothed result in backward pass
+typedef struct
+{
+	int Start;				// first epoch of a continuous KF segment
+	int WeekNumber;
+	int GpsMsCount;
+	double DeltaT;			// time interval of KF prediction from previous epoch
+	CONVERT_MATRIX ConvertMatrix;	// conversion matrix used to calculate Q matrix of KF prediction
+	double StateVector[STATE_VECTOR_SIZE];
+	double PMatrix[P_MATRIX_SIZE];
+} KF_EPOCH_RECORD, *PKF_EPOCH_RECORD;
+
+class CRtsSmoother
+{
+public:
+	CRtsSmoother();
+	~CRtsSmoother();
+
+	int Open();
+	void AddEpoch(int MsInterval);
+	int Smooth(const char *OutputFileName);
+
+private:
+	FILE *fpStore;			// filtered epochs from forward pass
+	FILE *fpSmooth;			// smoothed epochs from backward pass
+	int EpochCount;
+	int PrevKFEpoch;		// whether previous epoch is recorded as KF epoch
+	KF_EPOCH_RECORD *Chunk;
+
+	void SmoothStep(PKF_EPOCH_RECORD Epoch, const KF_EPOCH_RECORD *Next);
+	void OutputResult(FILE *fp);
+};
+
+#endif //__RTS_SMOOTHER_H__
@@ -9,6 +9,7 @@
 #if !defined __ACQ_ENGINE_H__
 #define __ACQ_ENGINE_H__
 
+#include <thread>
 #include "CommonOps.h"
 #include "RegAddress.h"
 #include "GeneralPrn.h"
@@ -36,7 +37,7 @@
 #define CHANNEL_CONFIG_LEN 8
 #define MF_CORE_DEPTH (FULL_LENGTH ? 2046 : 682)
 #define ADDER_TREE_WIDTH (MF_CORE_DEPTH/2)
-#define DFT_NUMBER 8
+#define MAX_DFT_NUMBER 32	// DFT bin number within one stride selectable as 8/16/32
 
 struct complex_exp10 {
 	int real;	// 10bit
@@ -52,6 +53,16 @@ struct complex_exp10 {
 	void operator -= (complex_int data);
 };
 
+// search state of one channel kept between strides while channels sharing the same sample stream are searched stride by stride
+struct ChannelSearchState {
+	CPeakSorter PeakSorter;
+	unsigned int NoiseFloor;
+	unsigned int NoncohExp;
+	unsigned int ExpIncPos;
+	int Success;
+	int Finished;		// early terminated
+};
+
 class CAcqEngine
 {
 public:
@@ -72,6 +83,7 @@ public:
 	reg_uint ReadAddress;		// 5bit
 	reg_uint DftFreq;			// 11bit
 	reg_uint StrideInterval;	// 22bit
+	reg_uint DftSize;			// 2bit, DFT bin number is 8 << DftSize
 
 	CAcqEngine(unsigned int *MemCodeAddress);
 	~CAcqEngine();
@@ -81,6 +93,8 @@ public:
 	void SetRegValue(int Address, U32 Value);
 	U32 GetRegValue(int Address);
 	void DoAcquisition();
+	void StartAcquisition();
+	void FinishAcquisition();
 	// interface functions for AE buffer
 	void StartFill() { WritePointer = 0; Filling = 1; }
 	int WriteSample(int Length, unsigned char Sample[]);
@@ -91,14 +105,18 @@ public:
 	complex_int ReadSampleToBuffer();
 	void PreloadSample();
 	void LoadSample();
+	void LoadSegment(complex_int Samples[]);
+	int CompareStreamKey(unsigned int Channel1, unsigned int Channel2);
+	void LoadChannelConfig(unsigned int Channel);
+	void SearchChannelGroup(unsigned int Channels[], int GroupSize);
 	void LoadCode();
 	void MatchFilterCore(int PhaseCount, complex_int CorResult[]);
-	void GetDftFactor(complex_int DftFactor[DFT_NUMBER/2], int sign_cos[DFT_NUMBER/2], int sign_sin[DFT_NUMBER/2]);
+	void GetDftFactor(complex_int DftFactor[MAX_DFT_NUMBER/2], int sign_cos[MAX_DFT_NUMBER/2], int sign_sin[MAX_DFT_NUMBER/2]);
 	void NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount);
 	void DoNonCoherentSum();
 	void InsertPeak(int Amp, int Exp, int PartialCorPos, int PartialFreq);
 	int PeakFound();
-	void SearchOneChannel();
+	void SearchCodeRound(ChannelSearchState *State);
 	unsigned int Amplitude(complex_exp10 data);
 	void InitPrnGen();
 	void SetStartAddr(int Addr) { ReadPointer = Addr; }
@@ -126,17 +144,34 @@ public:
 	int StrideOffset;			// 6bit signed
 	unsigned int NoncohExp;		// 4bit unsigned
 	unsigned int ExpIncPos;		// 10bit unsigned
+	int DftNumber;				// number of DFT bins, derived from DftSize
 
 	int ReadPointer;
 	int WritePointer;
 	int Filling;
 
 	// internal RAM
-	complex_exp10 CoherentBuffer[MF_CORE_DEPTH][DFT_NUMBER];
-	unsigned long long NonCoherentBuffer[MF_CORE_DEPTH+2];
+	complex_exp10 CoherentBuffer[MF_CORE_DEPTH][MAX_DFT_NUMBER];
+	unsigned long long NonCoherentBuffer[(MF_CORE_DEPTH+2)*MAX_DFT_NUMBER/8];	// 8bit per DFT bin, DftNumber bins packed for each correlator
 	unsigned int ChannelConfig[MAX_CHANNEL][CHANNEL_CONFIG_LEN];
 	unsigned char AEBuffer[AE_BUFFER_SIZE];
 
+	// acquisition runs in background thread on snapshot of channel config and AE buffer
+	// result is copied back to ChannelConfig when AE processing time expires
+	std::thread AcqThread;
+	unsigned int SearchChannelNumber;
+	unsigned int SearchConfig[MAX_CHANNEL][CHANNEL_CONFIG_LEN];
+	unsigned char SearchBuffer[AE_BUFFER_SIZE];
+
+	// carrier wiped sample segments of current stride and code round, shared by channels with the same
+	// read address, center frequency and stride interval, segments are wiped on first use
+	complex_int *SegmentSet;
+	int SegmentSetSize;			// number of segments allocated
+	int SegmentSetLength;		// number of segments wiped in current stride and code round
+	int SegmentIndex;			// next segment to load into AcqSamples
+	unsigned int SegmentLoadCount;	// statistics of segments loaded and segments wiped within one DoAcquisition
+	unsigned int SegmentWipeCount;
+
 	CPrnGen *PrnGen[4];
 	CPeakSorter PeakSorter;
 	CRateAdaptor RateAdaptor;
@@ -34,6 +34,7 @@ public:
 	reg_uint CodeFreq;				// 32bit RO
 	reg_uint PreShiftBits;			// 2bit RO
 	reg_uint PostShiftBits;			// 2bit RO
+	reg_uint InputSelect;			// 1bit RO, 0 for TE FIFO, 1 for TE FIFO2
 	reg_uint DataInQBranch;			// 1bit RO
 	reg_uint EnableSecondPrn;		// 1bit RO
 	reg_uint EnableBOC;				// 1bit RO
@@ -44,15 +44,20 @@ public:
 
 	unsigned int MemCodeBuffer[128*100];
 	CIfFile IfFile;
+	CIfFile IfFile2;		// second RF input stream (L5 band)
 	CTeFifoMem TeFifo;
+	CTeFifoMem TeFifo2;
 	CTrackingEngine TrackingEngine;
 	CAcqEngine AcqEngine;
 	complex_int *FileData;
+	complex_int *FileData2;
 	unsigned char *SampleQuant;
 	int AeProcessCount;		// simulate AE acquisition process delay
+	int ReadBlockSize2;		// samples of second RF input read on each block
 
 	int Process(int ReadBlockSize);
 	void SetInputFile(char *FileName) { IfFile.OpenIfFile(FileName); }
+	void SetInputFile2(char *FileName, int BlockSize) { if (IfFile2.OpenIfFile(FileName)) ReadBlockSize2 = BlockSize; }
 	int GetAeProcessTime();
 
 	InterruptFunction InterruptService;
@@ -16,7 +16,7 @@ struct PeakData
 	unsigned int Amp;
 	unsigned int Exp;
 	int PhasePos;
-	int FreqPos;
+	int FreqPos;	// StrideOffset * DFT bin number + DFT bin index
 
 	bool operator > (const PeakData &data);
 	bool operator >= (const PeakData &data);
@@ -23,7 +23,7 @@ class CTeFifoMem;
 class CTrackingEngine
 {
 public:
-	CTrackingEngine(CTeFifoMem *pTeFifo, unsigned int *MemCodeBuffer);
+	CTrackingEngine(CTeFifoMem *pTeFifo, CTeFifoMem *pTeFifo2, unsigned int *MemCodeBuffer);
 	~CTrackingEngine();
 	void Reset();
 	void SetRegValue(int Address, U32 Value);
@@ -41,9 +41,11 @@ public:
 
 	unsigned int *TEBuffer;
 	CTeFifoMem *pTeFifo;
+	CTeFifoMem *pTeFifo2;	// second input (L5 band), selected by InputSelect of each channel
 	CCorrelator *Correlator[PHYSICAL_CHANNEL_NUMBER];
 	CNoiseCalc NoiseCalc;
 	complex_int *FifoData;
+	complex_int *FifoData2;
 };
 
 #endif //__TRACKING_ENGINE_H__
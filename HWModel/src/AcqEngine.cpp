@@ -360,15 +360,19 @@ CAcqEngine::CAcqEngine(unsigned int *MemCodeAddress)
 	PrnGen[0] = new CGeneralPrn(PrnPolySettings);
 	PrnGen[1] = new CMemoryPrn(MemCodeAddress);
 	PrnGen[2] = PrnGen[3] = new CWeilPrn;
+	SegmentSet = NULL;
+	SegmentSetSize = 0;
 	Reset();
 	memset(ChannelConfig, 0, sizeof(ChannelConfig));
 }
 
 CAcqEngine::~CAcqEngine()
 {
+	FinishAcquisition();
 	delete PrnGen[0];
 	delete PrnGen[1];
 	delete PrnGen[2];
+	delete[] SegmentSet;
 }
 
 void CAcqEngine::Reset()
@@ -381,6 +385,8 @@ void CAcqEngine::Reset()
 	LastInput = complex_int(0, 0);
 	EarlyTerminate = 0;
 	PeakRatioTh = 3;
+	DftSize = 0;
+	DftNumber = 8;
 }
 
 void CAcqEngine::SetRegValue(int Address, U32 Value)
@@ -392,7 +398,7 @@ void CAcqEngine::SetRegValue(int Address, U32 Value)
 	case ADDR_OFFSET_AE_CONTROL:
 		ChannelNumber = EXTRACT_UINT(Value, 0, 6);
 		if (Value & 0x100)
-			DoAcquisition();
+			StartAcquisition();
 		break;
 	case ADDR_OFFSET_AE_BUFFER_CONTROL:
 		BufferThreshold = EXTRACT_UINT(Value, 0, 7);
@@ -469,21 +475,43 @@ complex_int CAcqEngine::ReadSampleToBuffer()
 
 void CAcqEngine::PreloadSample()
 {
-	int i;
-	int StartAddr = ReadAddress * 682 + CodeRoundCount * MF_CORE_DEPTH;
-
-	SetStartAddr(StartAddr);
-	LastInput = ReadSampleFromFifo();
-	for (i = 0; i < MF_CORE_DEPTH * 2; i ++)
-		AcqSamples[i] = ReadSampleToBuffer();
+	SegmentIndex = 0;
+	if (SegmentSetLength == 0)	// first channel searching this stride and code round, start sample stream
+	{
+		SetStartAddr(ReadAddress * 682 + CodeRoundCount * MF_CORE_DEPTH);
+		CarrierNco = 0;
+		LastInput = ReadSampleFromFifo();
+	}
+	LoadSegment(AcqSamples);
+	LoadSegment(AcqSamples + MF_CORE_DEPTH);
 }
 
 void CAcqEngine::LoadSample()
+{
+	LoadSegment(AcqSamples + MF_CORE_DEPTH);
+}
+
+// load one segment of carrier wiped samples, the segment is wiped only by the first channel reaching it
+// within current stride and code round, CarrierNco, ReadPointer and LastInput keep the stream position
+// after last wiped segment because only sample loading changes them
+void CAcqEngine::LoadSegment(complex_int Samples[])
 {
 	int i;
+	complex_int *Segment = SegmentSet + SegmentIndex * MF_CORE_DEPTH;
 
-	for (i = MF_CORE_DEPTH; i < MF_CORE_DEPTH * 2; i ++)
-		AcqSamples[i] = ReadSampleToBuffer();
+	SegmentLoadCount ++;
+	if (SegmentIndex == SegmentSetLength)
+	{
+		for (i = 0; i < MF_CORE_DEPTH; i ++)
+			Segment[i] = ReadSampleToBuffer();
+		SegmentSetLength ++;
+		SegmentWipeCount ++;
+	}
+	else if (fp_out[INTERMEDIATE_RESULT_SAMPLE2BUFFER])
+		for (i = 0; i < MF_CORE_DEPTH; i ++)
+			fprintf(fp_out[INTERMEDIATE_RESULT_SAMPLE2BUFFER], "%3d %3d\n", Segment[i].real, Segment[i].imag);
+	memcpy(Samples, Segment, sizeof(complex_int) * MF_CORE_DEPTH);
+	SegmentIndex ++;
 }
 
 void CAcqEngine::LoadCode()
@@ -537,13 +565,13 @@ void CAcqEngine::MatchFilterCore(int PhaseCount, complex_int CorResult[])
 	}
 }
 
-void CAcqEngine::GetDftFactor(complex_int DftFactor[DFT_NUMBER/2], int sign_cos[DFT_NUMBER/2], int sign_sin[DFT_NUMBER/2])
+void CAcqEngine::GetDftFactor(complex_int DftFactor[MAX_DFT_NUMBER/2], int sign_cos[MAX_DFT_NUMBER/2], int sign_sin[MAX_DFT_NUMBER/2])
 {
 	int i;
 	unsigned int NCO;
 	int index;
 
-	for (i = 0; i < DFT_NUMBER/2; i ++)
+	for (i = 0; i < DftNumber/2; i ++)
 	{
 		NCO = (i*2+1) * DftNco;
 		NCO &= 0x3fff;	// 14bit
@@ -559,7 +587,7 @@ void CAcqEngine::GetDftFactor(complex_int DftFactor[DFT_NUMBER/2], int sign_cos[
 void CAcqEngine::NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount)
 {
 	int CorCount, FreqCount, MaxFreq;
-	unsigned int AmpCoh, AmpNoncoh[DFT_NUMBER], MaxAmp;
+	unsigned int AmpCoh, AmpNoncoh[MAX_DFT_NUMBER], MaxAmp;
 	int ExpIncCor;
 	unsigned char *NonCoherentData = (unsigned char *)(NonCoherentBuffer);
 	int ShiftCoh, ShiftNoncoh, ShiftBit;
@@ -593,7 +621,7 @@ void CAcqEngine::NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount)
 		Exceed = 0;
 		MaxAmp = 0;
 		MaxFreq = 0;
-		for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+		for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 		{
 			// calculate shifted coherent acc amplitude
 			AmpCoh = Amplitude(CoherentBuffer[CorCount][FreqCount]);	// Amp is 10bit unsigned, largest possible value is 704
@@ -601,7 +629,7 @@ void CAcqEngine::NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount)
 			AmpCoh = (AmpCoh + 1) >> 1;	// round shift one extra bit to reduce Amp to maximum 9bit, maximum value is 352
 
 			// get non coherent acc and shift to appreciate exp
-			AmpNoncoh[FreqCount] = (NoncohCount == 0) ? 0 : NonCoherentData[CorCount * 8 + FreqCount];
+			AmpNoncoh[FreqCount] = (NoncohCount == 0) ? 0 : NonCoherentData[CorCount * DftNumber + FreqCount];
 			ShiftBit = (CorCount < (int)ExpIncPos) ? (ShiftNoncoh + 1) : ShiftNoncoh;
 			if (ShiftBit)
 				AmpNoncoh[FreqCount] = ROUND_SHIFT_RAW(AmpNoncoh[FreqCount], ShiftBit);
@@ -626,23 +654,23 @@ void CAcqEngine::NonCoherentAcc(unsigned int MaxCohExp, int NoncohCount)
 			ExtraShift = 1;
 			NoncohExp ++;
 			ExpIncCor = CorCount;
-			for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+			for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 				AmpNoncoh[FreqCount] = (AmpNoncoh[FreqCount] + 1) >> 1;	// round shift
 			NoiseFloor >>= 1;	// compensate existing noise floor
 			MaxAmp = (MaxAmp + 1) >> 1;
 		}
 		// write back noncoh acc result
-		for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
-			AmpSumCor += (NonCoherentData[CorCount * 8 + FreqCount] = AmpNoncoh[FreqCount]);
+		for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
+			AmpSumCor += (NonCoherentData[CorCount * DftNumber + FreqCount] = AmpNoncoh[FreqCount]);
 
 		if (fp_out[INTERMEDIATE_RESULT_NONCOH_ACC])
 		{
-			for (FreqCount = DFT_NUMBER-1; FreqCount >= 0; FreqCount --)
-				fprintf(fp_out[INTERMEDIATE_RESULT_NONCOH_ACC], "%02x", NonCoherentData[CorCount*8+FreqCount]);
+			for (FreqCount = DftNumber-1; FreqCount >= 0; FreqCount --)
+				fprintf(fp_out[INTERMEDIATE_RESULT_NONCOH_ACC], "%02x", NonCoherentData[CorCount*DftNumber+FreqCount]);
 			fprintf(fp_out[INTERMEDIATE_RESULT_NONCOH_ACC], "\n");
 		}
 
-		AmpSumCor >>= 3;	// to simplify, use truncate instead of round shift, this will introduce less than 3% loss for strong peak and less than 0.5% for weak peak
+		AmpSumCor >>= (3 + DftSize);	// average over DFT bins, to simplify, use truncate instead of round shift, this will introduce less than 3% loss for strong peak and less than 0.5% for weak peak
 		if (NoncohCount == (NonCoherentNumber - 1) && CodeRoundCount == (CodeSpan / (FULL_LENGTH ? 3 : 1) - 1) && (StrideCount == StrideNumber))		// last round
 			NoiseFloor += AmpSumCor;
 
@@ -660,13 +688,12 @@ void CAcqEngine::DoNonCoherentSum()
 	complex_int InputSample;
 	complex_int CorResult[MF_CORE_DEPTH];
 	complex_int CorOutput;
-	complex_int DftFactorMag[DFT_NUMBER/2], MulCos, MulSin, MulAdd, MulSub;
-	int sign_cos[DFT_NUMBER/2], sign_sin[DFT_NUMBER/2];
+	complex_int DftFactorMag[MAX_DFT_NUMBER/2], MulCos, MulSin, MulAdd, MulSub;
+	int sign_cos[MAX_DFT_NUMBER/2], sign_sin[MAX_DFT_NUMBER/2];
 	complex_exp10 CorData;
 	unsigned int MaxExp;
 	unsigned int CoherentBufferData;
 
-	CarrierNco = 0;
 	PreloadSample();
 
 	for (NoncohCount = 0; NoncohCount < NonCoherentNumber; NoncohCount ++)
@@ -699,7 +726,7 @@ void CAcqEngine::DoNonCoherentSum()
 							CorData = CoherentBuffer[CorCount][0] + CorOutput;
 						else
 							CorData = CorOutput;
-						for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+						for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 							CoherentBuffer[CorCount][FreqCount] = CorData;	// write in coherent buffer with same value
 
 						if (CoherentBuffer[CorCount][0].exp > (int)MaxExp)
@@ -708,7 +735,7 @@ void CAcqEngine::DoNonCoherentSum()
 					}
 					else	// for other round of coherent sum
 					{
-						for (FreqCount = 0; FreqCount < DFT_NUMBER/2; FreqCount ++)
+						for (FreqCount = 0; FreqCount < DftNumber/2; FreqCount ++)
 						{
 							CorOutput = CorResult[CorCount];
 							// multiply the four products
@@ -729,14 +756,14 @@ void CAcqEngine::DoNonCoherentSum()
 							MulSub.real = (sign_cos[FreqCount] ? (-MulCos.real) : MulCos.real) + (sign_sin[FreqCount] ? (-MulSin.imag) : MulSin.imag);
 							MulSub.imag = (sign_cos[FreqCount] ? (-MulCos.imag) : MulCos.imag) + (sign_sin[FreqCount] ? MulSin.real : (-MulSin.real));
 
-							// accumulate cosine part
-							CoherentBuffer[CorCount][4+FreqCount] += MulAdd;
-							CoherentBuffer[CorCount][3-FreqCount] += MulSub;
+							// accumulate cosine part, positive frequency in upper half bins and negative frequency in lower half bins
+							CoherentBuffer[CorCount][DftNumber/2+FreqCount] += MulAdd;
+							CoherentBuffer[CorCount][DftNumber/2-1-FreqCount] += MulSub;
 							// calculate maximum exp
-							if (CoherentBuffer[CorCount][4+FreqCount].exp > (int)MaxExp)
-								MaxExp = CoherentBuffer[CorCount][4+FreqCount].exp;
-							if (CoherentBuffer[CorCount][3-FreqCount].exp > (int)MaxExp)
-								MaxExp = CoherentBuffer[CorCount][3-FreqCount].exp;
+							if (CoherentBuffer[CorCount][DftNumber/2+FreqCount].exp > (int)MaxExp)
+								MaxExp = CoherentBuffer[CorCount][DftNumber/2+FreqCount].exp;
+							if (CoherentBuffer[CorCount][DftNumber/2-1-FreqCount].exp > (int)MaxExp)
+								MaxExp = CoherentBuffer[CorCount][DftNumber/2-1-FreqCount].exp;
 						}
 					}
 				}
@@ -744,7 +771,7 @@ void CAcqEngine::DoNonCoherentSum()
 				if (fp_out[INTERMEDIATE_RESULT_COH_ACC])
 					for (CorCount = 0; CorCount < MF_CORE_DEPTH; CorCount ++)
 					{
-						for (FreqCount = DFT_NUMBER-1; FreqCount >= 0; FreqCount --)
+						for (FreqCount = DftNumber-1; FreqCount >= 0; FreqCount --)
 						{
 							CoherentBufferData = ((CoherentBuffer[CorCount][FreqCount].real & 0x3ff) << 14) + ((CoherentBuffer[CorCount][FreqCount].imag & 0x3ff) << 4) + (CoherentBuffer[CorCount][FreqCount].exp & 0xf);
 							fprintf(fp_out[INTERMEDIATE_RESULT_COH_ACC], "%06x", CoherentBufferData);
@@ -763,7 +790,7 @@ void CAcqEngine::DoNonCoherentSum()
 		if (fp_out[INTERMEDIATE_RESULT_LAST_COH_ACC])
 			for (CorCount = 0; CorCount < MF_CORE_DEPTH; CorCount ++)
 			{
-				for (FreqCount = DFT_NUMBER-1; FreqCount >= 0; FreqCount --)
+				for (FreqCount = DftNumber-1; FreqCount >= 0; FreqCount --)
 				{
 					CoherentBufferData = ((CoherentBuffer[CorCount][FreqCount].real & 0x3ff) << 14) + ((CoherentBuffer[CorCount][FreqCount].imag & 0x3ff) << 4) + (CoherentBuffer[CorCount][FreqCount].exp & 0xf);
 					fprintf(fp_out[INTERMEDIATE_RESULT_LAST_COH_ACC], "%06x", CoherentBufferData);
@@ -784,7 +811,7 @@ void CAcqEngine::InsertPeak(int Amp, int Exp, int PartialCorPos, int PartialFreq
 	Peak.Amp = Amp;
 	Peak.Exp = Exp;
 	Peak.PhasePos = CodeRoundCount * MF_CORE_DEPTH + PartialCorPos;
-	Peak.FreqPos = (StrideOffset << 3) + PartialFreq;
+	Peak.FreqPos = (StrideOffset << (3 + DftSize)) + PartialFreq;
 
 	PeakSorter.InsertValue(Peak);
 	if (fp_out[INTERMEDIATE_RESULT_INSERT_PEAK])
@@ -810,75 +837,191 @@ int CAcqEngine::PeakFound()
 	return Success;
 }
 
-void CAcqEngine::SearchOneChannel()
+// search current stride and code round of one channel, peak sorter and exp of the channel are kept in State
+void CAcqEngine::SearchCodeRound(ChannelSearchState *State)
 {
-	int CodeRoundNumber = CodeSpan / (FULL_LENGTH ? 3 : 1);
 	int i, k;
 	unsigned char *NonCoherentData = (unsigned char *)(NonCoherentBuffer);
 
-	Success = 0;
+	PeakSorter = State->PeakSorter;
+	NoiseFloor = State->NoiseFloor;
+	NoncohExp = State->NoncohExp;
+	ExpIncPos = State->ExpIncPos;
+
+	InitPrnGen();
+	LoadCode();
+	DoNonCoherentSum();
+
+	if (fp_out[INTERMEDIATE_RESULT_LAST_NONCOH_ACC])
+	{
+		for (i = 0; i < MF_CORE_DEPTH; i ++)
+			for (k = 0; k < DftNumber; k ++)
+				fprintf(fp_out[INTERMEDIATE_RESULT_LAST_NONCOH_ACC], "%d\n", NonCoherentData[i*DftNumber+k] << ((i < (int)ExpIncPos) ? (NoncohExp) : (NoncohExp + 1)));
+	}
+
+	State->PeakSorter = PeakSorter;
+	State->NoiseFloor = NoiseFloor;
+	State->NoncohExp = NoncohExp;
+	State->ExpIncPos = ExpIncPos;
+	State->Success = Success;
+	if (Success && EarlyTerminate)
+		State->Finished = 1;
+}
+
+// search channels having the same read address, center frequency and stride interval
+// stride and code round in outer loop so that carrier wiped samples are shared by all channels
+// each channel still goes through its strides and code rounds in the same order as searched alone
+void CAcqEngine::SearchChannelGroup(unsigned int Channels[], int GroupSize)
+{
+	int i, CodeRoundNumber, MaxCodeRound = 0, MaxSegment = 0;
+	unsigned int MaxStride = 0;
+	ChannelSearchState State[MAX_CHANNEL];
 
-	PeakSorter.Clear();
+	for (i = 0; i < GroupSize; i ++)
+	{
+		LoadChannelConfig(Channels[i]);
+		State[i].PeakSorter.Clear();
+		State[i].NoiseFloor = State[i].NoncohExp = State[i].ExpIncPos = 0;
+		State[i].Success = State[i].Finished = 0;
+		CodeRoundNumber = CodeSpan / (FULL_LENGTH ? 3 : 1);
+		if (MaxStride < StrideNumber)
+			MaxStride = StrideNumber;
+		if (MaxCodeRound < CodeRoundNumber)
+			MaxCodeRound = CodeRoundNumber;
+		if (MaxSegment < (int)(CoherentNumber * NonCoherentNumber))
+			MaxSegment = CoherentNumber * NonCoherentNumber;
+	}
+	MaxSegment = MaxSegment * (FULL_LENGTH ? 1 : 3) + 2;	// two segments preloaded, one more loaded after each match filter round
+	if (SegmentSetSize < MaxSegment)
+	{
+		delete[] SegmentSet;
+		SegmentSet = new complex_int[MaxSegment * MF_CORE_DEPTH];
+		SegmentSetSize = MaxSegment;
+	}
 
-	for (StrideCount = 1; StrideCount <= StrideNumber; StrideCount ++)
+	for (StrideCount = 1; StrideCount <= MaxStride; StrideCount ++)
 	{
 		StrideOffset = (StrideCount >> 1);
 		if (StrideCount & 1)
 			StrideOffset = ~StrideOffset;
 		StrideOffset += (StrideCount & 1);
-		CarrierFreq = CenterFreq + StrideInterval * StrideOffset;
-
-		for (CodeRoundCount = 0; CodeRoundCount < CodeRoundNumber; CodeRoundCount ++)
+		for (CodeRoundCount = 0; CodeRoundCount < MaxCodeRound; CodeRoundCount ++)
 		{
-			InitPrnGen();
-			LoadCode();
-			DoNonCoherentSum();
-
-			if (fp_out[INTERMEDIATE_RESULT_LAST_NONCOH_ACC])
+			SegmentSetLength = 0;	// new sample stream
+			for (i = 0; i < GroupSize; i ++)
 			{
-				for (i = 0; i < MF_CORE_DEPTH; i ++)
-					for (k = 0; k < 8; k ++)
-						fprintf(fp_out[INTERMEDIATE_RESULT_LAST_NONCOH_ACC], "%d\n", NonCoherentData[i*8+k] << ((i < (int)ExpIncPos) ? (NoncohExp) : (NoncohExp + 1)));
+				if (State[i].Finished)
+					continue;
+				LoadChannelConfig(Channels[i]);
+				if (StrideCount > StrideNumber || CodeRoundCount >= (int)(CodeSpan / (FULL_LENGTH ? 3 : 1)))
+					continue;
+				CarrierFreq = CenterFreq + StrideInterval * StrideOffset;
+				SearchCodeRound(&State[i]);
 			}
-
-			if (Success && EarlyTerminate)
-				return;
 		}
 	}
+
+	// write back result
+	for (i = 0; i < GroupSize; i ++)
+	{
+		PeakSorter = State[i].PeakSorter;
+		NoiseFloor = State[i].NoiseFloor >> (PeakSorter.Peaks[0].Exp - State[i].NoncohExp);	// adjust noise floor exp to be same as peaks
+		SearchConfig[Channels[i]][4] = (State[i].Success << 31) | (PeakSorter.Peaks[0].Exp << 24) | (NoiseFloor & 0x7ffff);
+		SearchConfig[Channels[i]][5] = (PeakSorter.Peaks[0].Amp << 24) | ((PeakSorter.Peaks[0].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[0].PhasePos;
+		SearchConfig[Channels[i]][6] = (PeakSorter.Peaks[1].Amp << 24) | ((PeakSorter.Peaks[1].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[1].PhasePos;
+		SearchConfig[Channels[i]][7] = (PeakSorter.Peaks[2].Amp << 24) | ((PeakSorter.Peaks[2].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[2].PhasePos;
+	}
 }
 
-void CAcqEngine::DoAcquisition()
+// take snapshot of channel config and AE buffer then start acquisition in background
+// so that it overlaps with tracking as the hardware does
+void CAcqEngine::StartAcquisition()
+{
+	FinishAcquisition();	// previous search not finished yet
+	SearchChannelNumber = ChannelNumber;
+	memcpy(SearchConfig, ChannelConfig, sizeof(SearchConfig));
+	memcpy(SearchBuffer, AEBuffer, sizeof(SearchBuffer));
+	AcqThread = std::thread(&CAcqEngine::DoAcquisition, this);
+}
+
+// wait background acquisition and make search result visible in ChannelConfig
+void CAcqEngine::FinishAcquisition()
 {
 	unsigned int i;
 
-	for (i = 0; i < ChannelNumber; i ++)
+	if (!AcqThread.joinable())
+		return;
+	AcqThread.join();
+	for (i = 0; i < SearchChannelNumber; i ++)
+		memcpy(&ChannelConfig[i][4], &SearchConfig[i][4], sizeof(unsigned int) * 4);
+}
+
+void CAcqEngine::DoAcquisition()
+{
+	unsigned int j, n, GroupStart;
+	unsigned int Order[MAX_CHANNEL];
+
+	// sort channels by read address, center frequency and stride interval (stable insertion sort on search order)
+	// channels with same key use the same carrier wiped sample stream on each stride and code round
+	for (n = 0; n < SearchChannelNumber; n ++)
+	{
+		for (j = n; j > 0 && CompareStreamKey(Order[j-1], n) > 0; j --)
+			Order[j] = Order[j-1];
+		Order[j] = n;
+	}
+	SegmentLoadCount = SegmentWipeCount = 0;
+
+	for (GroupStart = 0; GroupStart < SearchChannelNumber; GroupStart = n)
 	{
-		// fill in config registers
-		StrideNumber = EXTRACT_UINT(ChannelConfig[i][0], 0, 6);
-		CoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 8, 6);
-		NonCoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
-		PeakRatioTh = EXTRACT_UINT(ChannelConfig[i][0], 24, 3);
-		EarlyTerminate = EXTRACT_UINT(ChannelConfig[i][0], 27, 1);
-		CenterFreq = EXTRACT_INT(ChannelConfig[i][1], 0, 20) << 12;
-		Svid = EXTRACT_UINT(ChannelConfig[i][1], 24, 6);
-		PrnSelect = EXTRACT_UINT(ChannelConfig[i][1], 30, 2);
-		CodeSpan = EXTRACT_UINT(ChannelConfig[i][2], 0, 5);
-		ReadAddress = EXTRACT_UINT(ChannelConfig[i][2], 8, 5);
-		DftFreq = EXTRACT_UINT(ChannelConfig[i][2], 20, 11);
-		StrideInterval = EXTRACT_UINT(ChannelConfig[i][3], 0, 22);
-
-		// Do searching
-		SearchOneChannel();
-
-		// write back result
-		NoiseFloor >>= (PeakSorter.Peaks[0].Exp - NoncohExp);	// adjust noise floor exp to be same as peaks
-		ChannelConfig[i][4] = (Success << 31) | (PeakSorter.Peaks[0].Exp << 24) | (NoiseFloor & 0x7ffff);
-		ChannelConfig[i][5] = (PeakSorter.Peaks[0].Amp << 24) | ((PeakSorter.Peaks[0].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[0].PhasePos;
-		ChannelConfig[i][6] = (PeakSorter.Peaks[1].Amp << 24) | ((PeakSorter.Peaks[1].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[1].PhasePos;
-		ChannelConfig[i][7] = (PeakSorter.Peaks[2].Amp << 24) | ((PeakSorter.Peaks[2].FreqPos & 0x1ff) << 15) | PeakSorter.Peaks[2].PhasePos;
+		for (n = GroupStart + 1; n < SearchChannelNumber && CompareStreamKey(Order[GroupStart], Order[n]) == 0; n ++)
+			;
+		SearchChannelGroup(Order + GroupStart, n - GroupStart);
 	}
 }
 
+// fill in config registers of one channel from SearchConfig
+void CAcqEngine::LoadChannelConfig(unsigned int Channel)
+{
+	StrideNumber = EXTRACT_UINT(SearchConfig[Channel][0], 0, 6);
+	CoherentNumber = EXTRACT_UINT(SearchConfig[Channel][0], 8, 6);
+	NonCoherentNumber = EXTRACT_UINT(SearchConfig[Channel][0], 16, 7);
+	PeakRatioTh = EXTRACT_UINT(SearchConfig[Channel][0], 24, 3);
+	EarlyTerminate = EXTRACT_UINT(SearchConfig[Channel][0], 27, 1);
+	DftSize = EXTRACT_UINT(SearchConfig[Channel][0], 28, 2);
+	if (DftSize > 2)	// 2'b11 reserved, treat as 32 bins
+		DftSize = 2;
+	DftNumber = 8 << DftSize;
+	if (StrideNumber > (unsigned int)(512 / DftNumber - 1))	// peak frequency index is 9bit signed in result, limit all bins within -256~255
+		StrideNumber = 512 / DftNumber - 1;
+	CenterFreq = EXTRACT_INT(SearchConfig[Channel][1], 0, 20) << 12;
+	Svid = EXTRACT_UINT(SearchConfig[Channel][1], 24, 6);
+	PrnSelect = EXTRACT_UINT(SearchConfig[Channel][1], 30, 2);
+	CodeSpan = EXTRACT_UINT(SearchConfig[Channel][2], 0, 5);
+	ReadAddress = EXTRACT_UINT(SearchConfig[Channel][2], 8, 5);
+	DftFreq = EXTRACT_UINT(SearchConfig[Channel][2], 20, 11);
+	StrideInterval = EXTRACT_UINT(SearchConfig[Channel][3], 0, 22);
+}
+
+// compare read address, center frequency and stride interval of two channels in SearchConfig
+int CAcqEngine::CompareStreamKey(unsigned int Channel1, unsigned int Channel2)
+{
+	unsigned int Key1, Key2;
+
+	Key1 = EXTRACT_UINT(SearchConfig[Channel1][2], 8, 5);
+	Key2 = EXTRACT_UINT(SearchConfig[Channel2][2], 8, 5);
+	if (Key1 != Key2)
+		return (Key1 > Key2) ? 1 : -1;
+	Key1 = EXTRACT_UINT(SearchConfig[Channel1][1], 0, 20);
+	Key2 = EXTRACT_UINT(SearchConfig[Channel2][1], 0, 20);
+	if (Key1 != Key2)
+		return (Key1 > Key2) ? 1 : -1;
+	Key1 = EXTRACT_UINT(SearchConfig[Channel1][3], 0, 22);
+	Key2 = EXTRACT_UINT(SearchConfig[Channel2][3], 0, 22);
+	if (Key1 != Key2)
+		return (Key1 > Key2) ? 1 : -1;
+	return 0;
+}
+
 unsigned int CAcqEngine::Amplitude(complex_exp10 data)
 {
 	unsigned int max, min, amp;
@@ -925,7 +1068,7 @@ unsigned int CAcqEngine::ReadSample()
 {
 	if (ReadPointer >= AE_BUFFER_SIZE)
 		ReadPointer = 0;
-	return (unsigned int)AEBuffer[ReadPointer++];
+	return (unsigned int)SearchBuffer[ReadPointer++];
 }
 
 int CAcqEngine::WriteSample(int Length, unsigned char Sample[])
@@ -81,6 +81,7 @@ void CCorrelator::FillState(unsigned int *StateBuffer)
 	CodeFreq = StateBuffer[1];
 	PreShiftBits = EXTRACT_UINT(StateBuffer[2], 0, 2);
 	PostShiftBits = EXTRACT_UINT(StateBuffer[2], 2, 2);
+	InputSelect = EXTRACT_UINT(StateBuffer[2], 4, 1);
 	DataInQBranch = EXTRACT_UINT(StateBuffer[2], 5, 1);
 	EnableSecondPrn = EXTRACT_UINT(StateBuffer[2], 6, 1);
 	EnableBOC = EXTRACT_UINT(StateBuffer[2], 7, 1);
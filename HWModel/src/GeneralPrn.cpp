@@ -43,7 +43,7 @@ void CGeneralPrn::FillState(unsigned int *StateBuffer)
 {
 	int PrnSel = EXTRACT_UINT(StateBuffer[0], 30, 2);
 
-	PrnPolySettings = PrnPolyRegs + PrnSel * 4;
+	PrnPolySettings = PrnPolyRegs + PrnSel * 2;	// each polynomial set occupies 2 registers
 	G1InitState = EXTRACT_UINT(StateBuffer[0], 0, 14);
 	G2InitState = EXTRACT_UINT(StateBuffer[0], 14, 14);
 	G1CurState = EXTRACT_UINT(StateBuffer[1], 0, 14);
@@ -14,16 +14,18 @@
 #include "GnssTop.h"
 #include "E1_code.h"
 
-CGnssTop::CGnssTop() : TeFifo(0, 10240), TrackingEngine(&TeFifo, MemCodeBuffer), AcqEngine(MemCodeBuffer)
+CGnssTop::CGnssTop() : TeFifo(0, 10240), TeFifo2(1, 49152), TrackingEngine(&TeFifo, &TeFifo2, MemCodeBuffer), AcqEngine(MemCodeBuffer)
 {
 	TrackingEngineEnable = 0;
 	MeasurementNumber = 0;
 	MeasurementCount = 0;
 	ReqCount = 0;
 	InterruptFlag = 0;
+	ReadBlockSize2 = 0;
 
 	memcpy(MemCodeBuffer, GalE1Code, sizeof(GalE1Code));	// memory code put in MemCodeBuffer as ROM
 	FileData = (complex_int *)malloc(MAX_BLOCK_SIZE * sizeof(complex_int));
+	FileData2 = (complex_int *)malloc(MAX_BLOCK_SIZE * sizeof(complex_int));
 	SampleQuant = (unsigned char *)malloc(MAX_BLOCK_SIZE * sizeof(unsigned char));
 
 	InterruptService = NULL;
@@ -32,6 +34,7 @@ CGnssTop::CGnssTop() : TeFifo(0, 10240), TrackingEngine(&TeFifo, MemCodeBuffer),
 CGnssTop::~CGnssTop()
 {
 	free(FileData);
+	free(FileData2);
 	free(SampleQuant);
 }
 
@@ -41,12 +44,16 @@ void CGnssTop::Reset(U32 ResetMask)
 		TrackingEngine.Reset();
 	if (ResetMask & 0x100)
 		TeFifo.Reset();
+	if (ResetMask & 0x200)
+		TeFifo2.Reset();
 }
 
 void CGnssTop::Clear(U32 ClearMask)
 {
 	if (ClearMask & 0x100)
 		TeFifo.Clear();
+	if (ClearMask & 0x200)
+		TeFifo2.Clear();
 }
 
 void CGnssTop::SetRegValue(int Address, U32 Value)
@@ -62,7 +69,8 @@ void CGnssTop::SetRegValue(int Address, U32 Value)
 			if (Value & 0x100)
 			{
 				TrackingEngineEnable = 1;
-				TeFifo.SetFifoEnable(Value >> 8);
+				TeFifo.SetFifoEnable(Value & 0x100);
+				TeFifo2.SetFifoEnable(Value & 0x200);
 			}
 			break;
 		case ADDR_OFFSET_BB_RESET:
@@ -108,7 +116,10 @@ void CGnssTop::SetRegValue(int Address, U32 Value)
 			AeProcessCount = GetAeProcessTime();
 		break;
 	case ADDR_BASE_TE_FIFO:
-		TeFifo.SetRegValue(AddressOffset, Value);
+		if (AddressOffset & ADDR_OFFSET_TE_FIFO2)
+			TeFifo2.SetRegValue(AddressOffset & ~ADDR_OFFSET_TE_FIFO2, Value);
+		else
+			TeFifo.SetRegValue(AddressOffset, Value);
 		break;
 	case ADDR_BASE_TRACKING_ENGINE:
 		TrackingEngine.SetRegValue(AddressOffset & 0xff, Value);
@@ -161,7 +172,7 @@ U32 CGnssTop::GetRegValue(int Address)
 	case ADDR_BASE_ACQUIRE_ENGINE:
 		return AcqEngine.GetRegValue(AddressOffset);
 	case ADDR_BASE_TE_FIFO:
-		return TeFifo.GetRegValue(AddressOffset);
+		return (AddressOffset & ADDR_OFFSET_TE_FIFO2) ? TeFifo2.GetRegValue(AddressOffset & ~ADDR_OFFSET_TE_FIFO2) : TeFifo.GetRegValue(AddressOffset);
 	case ADDR_BASE_TRACKING_ENGINE:
 		return TrackingEngine.GetRegValue(AddressOffset & 0xff);
 	case ADDR_BASE_PERIPHERIAL:
@@ -190,6 +201,12 @@ int CGnssTop::Process(int ReadBlockSize)
 	}
 	for (i = 0; i < ReadBlockSize; i ++)
 		ReachThreshold |= TeFifo.WriteData(FileData[i]);
+	// second RF input covers same time span with its own sample rate
+	if (ReadBlockSize2 > 0 && IfFile2.ReadFile(ReadBlockSize2, FileData2))
+	{
+		for (i = 0; i < ReadBlockSize2; i ++)
+			TeFifo2.WriteData(FileData2[i]);
+	}
 
 	if (TrackingEngineEnable)
 	{
@@ -209,7 +226,10 @@ int CGnssTop::Process(int ReadBlockSize)
 	if (AeProcessCount)
 	{
 		if (--AeProcessCount == 0)
+		{
+			AcqEngine.FinishAcquisition();	// AE result visible only after modeled process time
 			InterruptFlag |= (1 << 11);
+		}
 	}
 
 	if ((InterruptFlag & IntMask) && InterruptService != NULL )
@@ -230,12 +250,14 @@ int CGnssTop::Process(int ReadBlockSize)
 //   N is non-coherent number
 //   R is code span
 // one last step of force output needs about 1364 clock cycles
+// with D DFT bins (D = 16/32) the non-coherent acc reads D/8 words of coherent buffer
+// for each correlator, so each non-coherent round adds 682*(D/8-1) clock cycles
 int CGnssTop::GetAeProcessTime()
 {
 	int i;
 	int TotalCycles = 2;
 	unsigned int (*ChannelConfig)[CHANNEL_CONFIG_LEN] = AcqEngine.ChannelConfig;
-	int StrideNumber, CoherentNumber, NonCoherentNumber, CodeSpan;
+	int StrideNumber, CoherentNumber, NonCoherentNumber, CodeSpan, DftSize;
 	double ProcessTime;
 
 	for (i = 0; i < (int)AcqEngine.ChannelNumber; i ++)
@@ -244,8 +266,11 @@ int CGnssTop::GetAeProcessTime()
 		StrideNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 0, 6);
 		CoherentNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 8, 6);
 		NonCoherentNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
+		DftSize = (int)EXTRACT_UINT(ChannelConfig[i][0], 28, 2);
 		CodeSpan = (int)EXTRACT_UINT(ChannelConfig[i][2], 0, 5);
-		TotalCycles += StrideNumber * CodeSpan * (1 + 6 * CoherentNumber * NonCoherentNumber);
+		if (DftSize > 2)
+			DftSize = 2;
+		TotalCycles += StrideNumber * CodeSpan * (1 + (6 * CoherentNumber + (1 << DftSize) - 1) * NonCoherentNumber);
 	}
 
 	ProcessTime = 682. * TotalCycles / CLK_NUMBER_IN_BLOCK;
@@ -15,7 +15,7 @@
 
 #define COH_OFFSET(ch_index, cor_index) ((ch_index << 5) + 24 + (cor_index >> 2))
 
-CTrackingEngine::CTrackingEngine(CTeFifoMem *pTeFifo, unsigned int *MemCodeBuffer) : pTeFifo(pTeFifo), NoiseCalc(10)
+CTrackingEngine::CTrackingEngine(CTeFifoMem *pTeFifo, CTeFifoMem *pTeFifo2, unsigned int *MemCodeBuffer) : pTeFifo(pTeFifo), pTeFifo2(pTeFifo2), NoiseCalc(10)
 {
 	int i;
 
@@ -26,6 +26,7 @@ CTrackingEngine::CTrackingEngine(CTeFifoMem *pTeFifo, unsigned int *MemCodeBuffe
 	memset(TEBuffer, 0, TE_BUFFER_SIZE);
 
 	FifoData = (complex_int *)malloc(65536 * sizeof(complex_int));
+	FifoData2 = (complex_int *)malloc(65536 * sizeof(complex_int));
 }
 
 CTrackingEngine::~CTrackingEngine()
@@ -33,6 +34,7 @@ CTrackingEngine::~CTrackingEngine()
 	int i;
 	free(TEBuffer);
 	free(FifoData);
+	free(FifoData2);
 	for (i = 0; i < PHYSICAL_CHANNEL_NUMBER; i ++)
 		delete Correlator[i];
 }
@@ -137,7 +139,8 @@ int CTrackingEngine::ProcessData()
 	S16 DumpDataI[16], DumpDataQ[16];
 	int CorIndex[16];
 	int DumpCount;
-	int ReadNumber;
+	int ReadNumber, ReadNumber2;
+	int InputUsed;
 	unsigned int CohData, DataAcc;
 	S16 CohDataI, CohDataQ;
 	int FirstRound = 1;
@@ -150,6 +153,7 @@ int CTrackingEngine::ProcessData()
 	if (ChannelEnable == 0)
 	{
 		pTeFifo->SkipBlock();
+		pTeFifo2->SkipBlock();
 		return 0;
 	}
 
@@ -157,8 +161,6 @@ int CTrackingEngine::ProcessData()
 	EnableMask = ChannelEnable;
 	while (EnableMask)
 	{
-		if (FirstRound)
-			Correlator[0]->NoiseCalc = &NoiseCalc;
 		// find at most 4 active channel
 		TrackingChannelCount = 0;
 		while (EnableMask && TrackingChannelCount < PHYSICAL_CHANNEL_NUMBER)
@@ -167,18 +169,36 @@ int CTrackingEngine::ProcessData()
 			EnableMask &= ~(1 << TrackingChannelIndex[TrackingChannelCount]);
 			TrackingChannelCount ++;
 		}
+		// load state of physical channels to determine which input each channel uses
+		InputUsed = 0;
+		for (i = 0; i < TrackingChannelCount; i ++)
+		{
+			Correlator[i]->FillState(&TEBuffer[TrackingChannelIndex[i] << 5]);
+			InputUsed |= 1 << Correlator[i]->InputSelect;
+		}
+		// noise calculation attached to first channel using first input
+		if (FirstRound)
+		{
+			for (i = 0; i < TrackingChannelCount; i ++)
+				if (Correlator[i]->InputSelect == 0)
+				{
+					Correlator[i]->NoiseCalc = &NoiseCalc;
+					break;
+				}
+		}
 		
-		// read data from TE FIFO
-		pTeFifo->ReadData(ReadNumber, FifoData);
-//		for (i = 0; i < ReadNumber; i ++)
-//			if (SetIndex == 1)
-//				printf("%x\n", FifoData[i]);
+		// read data from TE FIFO, FIFO not used by any physical channel is not read
+		ReadNumber = ReadNumber2 = 0;
+		if (InputUsed & 1)
+			pTeFifo->ReadData(ReadNumber, FifoData);
+		if (InputUsed & 2)
+			pTeFifo2->ReadData(ReadNumber2, FifoData2);
 		// process all physical channels
 		for (i = 0; i < TrackingChannelCount; i ++)
 		{
-			Correlator[i]->FillState(&TEBuffer[TrackingChannelIndex[i] << 5]);
 			// if any correlator reaches coherent value, set data ready flag
-			if (Correlator[i]->Correlation(ReadNumber, FifoData, DumpDataI, DumpDataQ, CorIndex, DumpCount))
+			if (Correlator[i]->InputSelect ? Correlator[i]->Correlation(ReadNumber2, FifoData2, DumpDataI, DumpDataQ, CorIndex, DumpCount) :
+				Correlator[i]->Correlation(ReadNumber, FifoData, DumpDataI, DumpDataQ, CorIndex, DumpCount))
 				CohDataReady |= 1 << TrackingChannelIndex[i];
 			for (j = 0; j < DumpCount; j ++)
 			{
@@ -211,11 +231,16 @@ int CTrackingEngine::ProcessData()
 			Correlator[i]->DumpState(&TEBuffer[TrackingChannelIndex[i] << 5]);
 		}
 		// rewind FIFO read pointer
-		pTeFifo->RewindPointer();
+		if (InputUsed & 1)
+			pTeFifo->RewindPointer();
+		if (InputUsed & 2)
+			pTeFifo2->RewindPointer();
 		FirstRound = 0;
-		Correlator[0]->NoiseCalc = NULL;
+		for (i = 0; i < TrackingChannelCount; i ++)
+			Correlator[i]->NoiseCalc = NULL;
 	}
 	pTeFifo->SkipBlock();
+	pTeFifo2->SkipBlock();
 
 	return (CohDataReady != 0);
 }
@@ -15,7 +15,7 @@
 #define MF_DEPTH 682
 #define MAX_CHANNEL 32
 #define CHANNEL_CONFIG_LEN 8
-#define DFT_NUMBER 8
+#define MAX_DFT_NUMBER 32	// DFT bin number within one stride selectable as 8/16/32
 #define NOISE_AMP_SQRT2 120.	// noise amplitude of 1ms correlation
 
 struct AeBufferSatParam
@@ -52,6 +52,8 @@ public:
 	double CenterFreq;
 	double DftTwiddlePhase;
 	double StrideInterval;
+	int DftSize;			// 2bit, DFT bin number is 8 << DftSize
+	int DftNumber;
 
 
 	// rate adaptor registers, only for register read/write
@@ -85,8 +87,8 @@ public:
 	AeBufferSatParam SatParam[32];
 	int SatNumber;	// number of valid satellites in SatParam
 	complex_number CohResult[MF_DEPTH];
-	complex_number DftResult[MF_DEPTH][DFT_NUMBER];
-	double NoncohResult[MF_DEPTH][DFT_NUMBER];
+	complex_number DftResult[MF_DEPTH][MAX_DFT_NUMBER];
+	double NoncohResult[MF_DEPTH][MAX_DFT_NUMBER];
 
 	void NonCoherentAcc(int NoncohCount);
 	void DoNonCoherentSum(AeBufferSatParam *pSatParam);
@@ -15,7 +15,7 @@
 #define MF_DEPTH 682
 #define MAX_CHANNEL 32
 #define CHANNEL_CONFIG_LEN 8
-#define DFT_NUMBER 8
+#define MAX_DFT_NUMBER 32	// DFT bin number within one stride selectable as 8/16/32
 #define SIGMA0 156
 #define LAMBDA_PARAM1 0.055422
 #define LAMBDA_PARAM2 0.051488
@@ -55,6 +55,8 @@ public:
 	double CenterFreq;
 	double DftTwiddlePhase;
 	double StrideInterval;
+	int DftSize;			// 2bit, DFT bin number is 8 << DftSize
+	int DftNumber;
 
 	// rate adaptor registers, only for register read/write
 	unsigned int RateCarrierFreq;	// 32bit
@@ -13,6 +13,7 @@
 #include "TeFifoSim.h"
 #include "AcqEngineFast.h"
 #include "TrackingEngine.h"
+#include "NavBitCache.h"
 
 typedef void (*InterruptFunction)();
 typedef int S32;
@@ -21,6 +22,29 @@ typedef unsigned int U32;
 #define TOTAL_GPS_SAT 32
 #define TOTAL_BDS_SAT 63
 #define TOTAL_GAL_SAT 50
+#define TOTAL_EPH_NUMBER (TOTAL_GPS_SAT+TOTAL_BDS_SAT+TOTAL_GAL_SAT)
+#define MAX_NAV_FILE 8	// maximum number of <Ephemeris> navigation files in scenario
+
+// compiled scenario cache, saved beside scenario file with extension .bin appended
+#define SCENARIO_CACHE_MAGIC 0x43535347	// "GSSC"
+#define SCENARIO_CACHE_VERSION 1
+
+// header of scenario cache file, sections follow the header in order:
+//   ephemeris valid flag array (int x TOTAL_EPH_NUMBER)
+//   ephemeris array (GPS_EPHEMERIS x TOTAL_EPH_NUMBER, GPS/BDS/Galileo order)
+//   GPS iono, GPS UTC, Galileo iono, Galileo UTC parameters
+//   visible satellite index array (int x TOTAL_EPH_NUMBER, GPS/BDS/Galileo order)
+typedef struct
+{
+	U32 Magic;
+	U32 Version;
+	U32 EphSize;			// size of GPS_EPHEMERIS to reject cache built with different SignalSim
+	U32 IonoUtcSize[4];		// size of GPS iono, GPS UTC, Galileo iono and Galileo UTC parameters
+	U32 Reserved;
+	U64 ScenarioHash;		// hash of scenario file and all navigation files
+	int VisibleNumber[3];	// initial visible satellite number of GPS/BDS/Galileo
+	int Reserved2;
+} SCENARIO_CACHE_HEADER;
 
 class CGnssTop
 {
@@ -53,11 +77,13 @@ public:
 	LNavBit GpsBits;
 	BCNav1Bit BdsBits;
 	INavBit GalBits;
+	CNavBitCache GpsBitCache, BdsBitCache, GalBitCache;	// frames shared by all channels and AE
 	NavBit *NavBitArray[4];
 
 	PGPS_EPHEMERIS GpsEph[TOTAL_GPS_SAT], GpsEphVisible[TOTAL_GPS_SAT];
 	PGPS_EPHEMERIS BdsEph[TOTAL_BDS_SAT], BdsEphVisible[TOTAL_BDS_SAT];
 	PGPS_EPHEMERIS GalEph[TOTAL_GAL_SAT], GalEphVisible[TOTAL_GAL_SAT];
+	GPS_EPHEMERIS EphStore[TOTAL_EPH_NUMBER];	// ephemeris used in scenario, GpsEph/BdsEph/GalEph point to here
 	SATELLITE_PARAM GpsSatParam[TOTAL_GPS_SAT], BdsSatParam[TOTAL_BDS_SAT], GalSatParam[TOTAL_GAL_SAT];	// satellite parameter array at CurTime
 	PSATELLITE_PARAM SatParamList[TOTAL_GPS_SAT+TOTAL_BDS_SAT+TOTAL_GAL_SAT];
 	int GpsSatNumber, BdsSatNumber, GalSatNumber;	// number of visible GPS satellite
@@ -70,6 +96,11 @@ public:
 
 	int Process(int BlockSize);
 	void SetInputFile(char *FileName);
+	void SetInputFile2(char *FileName, int BlockSize) {}	// L5 band input not simulated
+	void SetEphPointers();
+	U64 HashFile(const char *FileName, U64 Hash);
+	int LoadScenarioCache(const char *CacheFile, U64 ScenarioHash);
+	int SaveScenarioCache(const char *CacheFile, U64 ScenarioHash);
 	int StepToNextTime();
 	void UpdateSatParamList();
 	int GetAeProcessTime();
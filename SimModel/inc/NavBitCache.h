@@ -0,0 +1,50 @@
+//----------------------------------------------------------------------
+// NavBitCache.h:
+//   Navigation bit frame cache shared by all channels declaration
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined __NAV_BIT_CACHE_H__
+#define __NAV_BIT_CACHE_H__
+
+#include "CommonDefines.h"
+#include "SignalSim.h"
+
+#define NAV_CACHE_MAX_SVID 63
+#define NAV_CACHE_MAX_SYMBOL 1800	// B-CNAV1 frame has 1800 symbols
+#define NAV_CACHE_SLOT_NUMBER 2		// current and previous block for each satellite
+// cache block length in millisecond, it is common divisor of LNAV subframe (6s), I/NAV page (2s),
+// B-CNAV1 frame (18s) and BDS to GPS time difference (14s), so one block always within one frame
+#define NAV_CACHE_BLOCK 2000
+
+typedef struct
+{
+	S64 BlockIndex;		// index of NAV_CACHE_BLOCK since week 0, -1 for empty slot
+	int Param;
+	int ReturnValue;
+	int *Symbols;
+} NAV_CACHE_SLOT;
+
+// wrap a NavBit object and generate each frame only once for all tracking channels and AE
+class CNavBitCache : public NavBit
+{
+public:
+	CNavBitCache();
+	~CNavBitCache();
+	void SetSource(NavBit *Source, int FrameLength, int SymbolLength);
+	void Invalidate(int svid);
+
+	int GetFrameData(GNSS_TIME StartTime, int svid, int Param, int *NavBits);
+	int SetEphemeris(int svid, PGPS_EPHEMERIS Eph);
+	int SetAlmanac(GPS_ALMANAC Alm[]);
+	int SetIonoUtc(PIONO_PARAM IonoParam, PUTC_PARAM UtcParam);
+
+	NavBit *NavBitSource;
+	int SymbolNumber;	// number of symbols output by source for one frame
+	int *SymbolBuffer;
+	NAV_CACHE_SLOT CacheSlot[NAV_CACHE_MAX_SVID][NAV_CACHE_SLOT_NUMBER];
+};
+
+#endif //__NAV_BIT_CACHE_H__
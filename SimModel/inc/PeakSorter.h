@@ -15,7 +15,7 @@ struct PeakData
 {
 	double Amp;
 	int PhasePos;
-	int FreqPos;
+	int FreqPos;	// StrideOffset * DFT bin number + DFT bin index
 };
 
 class CPeakSorter
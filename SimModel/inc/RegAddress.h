@@ -81,6 +81,8 @@
 #define ADDR_OFFSET_TE_FIFO_LWADDR_EM	0x44
 #define ADDR_OFFSET_TE_FIFO_LWADDR_PPS	0x48
 #define ADDR_OFFSET_TE_FIFO_LWADDR_AE	0x4c
+// second TE FIFO for L5 band input has same register layout at offset 0x100
+#define ADDR_OFFSET_TE_FIFO2			0x100
 
 // for Tracking Engine
 #define ADDR_OFFSET_TE_CHANNEL_ENABLE	0x0
@@ -174,6 +176,10 @@
 #define ADDR_TE_FIFO_LWADDR_EM		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO_LWADDR_EM)
 #define ADDR_TE_FIFO_LWADDR_PPS		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO_LWADDR_PPS)
 #define ADDR_TE_FIFO_LWADDR_AE		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO_LWADDR_AE)
+#define ADDR_TE_FIFO2_CONFIG		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO2+ADDR_OFFSET_TE_FIFO_CONFIG)
+#define ADDR_TE_FIFO2_STATUS		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO2+ADDR_OFFSET_TE_FIFO_STATUS)
+#define ADDR_TE_FIFO2_BLOCK_SIZE	(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO2+ADDR_OFFSET_TE_FIFO_BLOCK_SIZE)
+#define ADDR_TE_FIFO2_BLOCK_ADJ		(ADDR_BASE_TE_FIFO+ADDR_OFFSET_TE_FIFO2+ADDR_OFFSET_TE_FIFO_BLOCK_ADJ)
 
 #define ADDR_TE_CHANNEL_ENABLE		(ADDR_BASE_TRACKING_ENGINE+ADDR_OFFSET_TE_CHANNEL_ENABLE)
 #define ADDR_TE_COH_DATA_READY		(ADDR_BASE_TRACKING_ENGINE+ADDR_OFFSET_TE_COH_DATA_READY)
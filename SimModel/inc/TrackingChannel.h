@@ -41,6 +41,12 @@ public:
 	U32 GetChannelStates(unsigned int AddressOffset);
 	int FindSvid(unsigned int ConfigArray[], int ArraySize, U32 PrnConfig);
 	void GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength);
+	void GetIntervalCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength);
+	void UpdateCarrierDiff(SATELLITE_PARAM *pSatParam, int CorPos0);
+	void EpochCorrelation(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, complex_number CorResult[], int CorIndex[], int CorPos[], int NHCode[], int DataLength);
+	void SynthesizeInterval(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int CorBase, int NHShift);
+	complex_number RunPhasor(int StartMs, int EndMs);
+	double PeakAmplitude(const double *PeakValues, double CodeDiff, int CodeLength);
 	int CalculateCounter(int BlockSize, int CorIndex[], int CorPos[], int NHCode[], int &DataLength);
 	void DecodeDataAcc(int DataValue);
 	double NarrowCompensation(int CorIndex, int NarrowFactor);
@@ -91,6 +97,12 @@ public:
 	complex_number DataSignal, PilotSignal;
 	// for carrier difference calculation
 	CarrierState CarrierParam;
+	double CurFreqDiff, CurPhaseDiff;	// carrier difference of latest dump, FreqDiff has unit of PI/1000 of Hz, PhaseDiff has unit of cycle
+	// for coherent interval synthesis
+	U64 NHHistory;					// NH bit of latest 64 rounds of correlator 0, bit0 is the latest
+	int IntervalCount[COR_NUMBER];	// epochs accumulated within current coherent interval, 0 for not started
+	unsigned int IntervalPending;	// bit mask of correlators with synthesized result not yet output
+	complex_number IntervalResult[COR_NUMBER];
 
 	// co-variance matrix to generate relative Gauss noise
 	static double CovarMatrix[4][SUM_N(COR_NUMBER)];
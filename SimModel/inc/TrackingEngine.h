@@ -17,6 +17,9 @@
 #define TE_BUFFER_SIZE (LOGICAL_CHANNEL_NUMBER * 128)
 #define COR_NUMBER 8
 #define NOISE_AMP 625.
+// set to 1 to synthesize one correlation result for each coherent interval instead of accumulating 1ms results
+// channels with CoherentNumber of 1 and correlators doing data decode always use 1ms results
+#define TE_INTERVAL_SYNTHESIS 0
 
 class CTrackingEngine
 {
@@ -44,6 +47,7 @@ public:
 	CTrackingChannel LogicChannel[LOGICAL_CHANNEL_NUMBER];
 	int SmoothScale;
 	double NoiseFloor;
+	int IntervalSynthesis;
 };
 
 #endif //__TRACKING_ENGINE_SIM_H__
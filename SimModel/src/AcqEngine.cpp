@@ -73,6 +73,8 @@ void CAcqEngine::Reset()
 {
 	EarlyTerminate = 0;
 	PeakRatioTh = 3;
+	DftSize = 0;
+	DftNumber = 8;
 }
 
 void CAcqEngine::SetRegValue(int Address, U32 Value)
@@ -137,7 +139,7 @@ void CAcqEngine::NonCoherentAcc(int NoncohCount)
 	{
 		MaxAmp = AmplitudeAcc = 0.;
 		MaxFreq = 0;
-		for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+		for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 		{
 			AmplitudeAcc += (Amplitude = DftResult[CorCount][FreqCount].abs());
 			NoncohResult[CorCount][FreqCount] += Amplitude;
@@ -147,7 +149,7 @@ void CAcqEngine::NonCoherentAcc(int NoncohCount)
 				MaxFreq = FreqCount;
 			}
 		}
-		AmplitudeAcc /= 8;	// get average
+		AmplitudeAcc /= DftNumber;	// get average
 		if (NoncohCount == (NonCoherentNumber - 1))		// last round
 			NoiseFloor += (int)AmplitudeAcc;
 
@@ -245,19 +247,19 @@ void CAcqEngine::DoNonCoherentSum(AeBufferSatParam *pSatParam)
 			for (CorCount = 0; CorCount < MF_DEPTH; CorCount ++)
 			{
 				if (CohCount == 0)	// for the first round of coherent sum, do not apply DFT twiddle factor
-					for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+					for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 						DftResult[CorCount][FreqCount] = CohResult[CorCount];
 				else	// for other round of coherent sum
 				{
-					for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+					for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 					{
-						DftPhase = (FreqCount * 2 - 7) * DftTwiddleFactor;
+						DftPhase = (FreqCount * 2 - (DftNumber - 1)) * DftTwiddleFactor;
 						Value = complex_number(cos(DftPhase), sin(DftPhase));
 						DftResult[CorCount][FreqCount] += CohResult[CorCount] * Value;
 					}
 				}
 			}
-//			for (FreqCount = 0; FreqCount < DFT_NUMBER && EndIndex >= 0; FreqCount ++)
+//			for (FreqCount = 0; FreqCount < DftNumber && EndIndex >= 0; FreqCount ++)
 //				printf("DFT=%f %f\n", DftResult[StartIndex+2][FreqCount].real, DftResult[StartIndex+2][FreqCount].imag);
 			DopplerPhase += 2 * PI * (CarrierFreq - pSatParam->Doppler) / 1000;
 			DftTwiddleFactor += DftTwiddlePhase;
@@ -281,7 +283,7 @@ void CAcqEngine::InsertPeak(double Amp, int PartialCorPos, int PartialFreq)
 
 	Peak.Amp = Amp;
 	Peak.PhasePos = CodeRoundCount * MF_DEPTH + PartialCorPos;
-	Peak.FreqPos = (StrideOffset << 3) + PartialFreq;
+	Peak.FreqPos = (StrideOffset << (3 + DftSize)) + PartialFreq;
 	PeakSorter.InsertValue(Peak);
 }
 
@@ -353,6 +355,12 @@ void CAcqEngine::DoAcquisition()
 		NonCoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
 		PeakRatioTh = EXTRACT_UINT(ChannelConfig[i][0], 24, 3);
 		EarlyTerminate = EXTRACT_UINT(ChannelConfig[i][0], 27, 1);
+		DftSize = EXTRACT_UINT(ChannelConfig[i][0], 28, 2);
+		if (DftSize > 2)	// 2'b11 reserved, treat as 32 bins
+			DftSize = 2;
+		DftNumber = 8 << DftSize;
+		if (StrideNumber > 512 / DftNumber - 1)	// peak frequency index is 9bit signed in result, limit all bins within -256~255
+			StrideNumber = 512 / DftNumber - 1;
 		Freq = EXTRACT_INT(ChannelConfig[i][1], 0, 20);
 		CenterFreq = Freq * 2.046e6 / 1048576.;
 		Svid = EXTRACT_UINT(ChannelConfig[i][1], 24, 6);
@@ -383,7 +391,7 @@ void CAcqEngine::DoAcquisition()
 
 		// Do searching
 		SearchOneChannel(pSatParam);
-		printf("Svid%2d Amp=%f Cor=%4d Freq=%f\n", Svid, PeakSorter.Peaks[0].Amp, PeakSorter.Peaks[0].PhasePos, (PeakSorter.Peaks[0].FreqPos - 3.5) * 62.5 + CenterFreq);
+		printf("Svid%2d Amp=%f Cor=%4d Freq=%f\n", Svid, PeakSorter.Peaks[0].Amp, PeakSorter.Peaks[0].PhasePos, (PeakSorter.Peaks[0].FreqPos - (DftNumber - 1) / 2.) * StrideInterval / DftNumber + CenterFreq);
 
 		// determine global exp
 		GlobalExp = int(log10(PeakSorter.Peaks[0].Amp) / 0.3010 + 1) - 8;	// this is number of shift to have max amplitude fit in 8bit
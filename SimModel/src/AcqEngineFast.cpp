@@ -160,6 +160,8 @@ void CAcqEngine::Reset()
 {
 	EarlyTerminate = 0;
 	PeakRatioTh = 3;
+	DftSize = 0;
+	DftNumber = 8;
 }
 
 void CAcqEngine::SetRegValue(int Address, U32 Value)
@@ -219,7 +221,7 @@ void CAcqEngine::GetNoisePeaks(double NoisePeaks[3])
 	int RandomValue, Segment;
 	double SegmentWidth, k, RamdomBasic;
 	double Sigma = SIGMA0 * sqrt((double)CoherentNumber);
-	int SampleFactor = ((CoherentNumber <= DFT_NUMBER) ? CoherentNumber : DFT_NUMBER) * StrideNumber * CodeSpan;
+	int SampleFactor = ((CoherentNumber <= DftNumber) ? CoherentNumber : DftNumber) * StrideNumber * CodeSpan;
 	double logn = log((double)SampleFactor);
 	double xn, sn2, kxn, ksn, xnn, snn2;
 	double lambda2;
@@ -269,9 +271,9 @@ double CAcqEngine::GetSignalPeak(AeBufferSatParam *pSatParam, int &FreqBin, int
 	double DopplerPhase;
 	double FreqFade, Amplitude;
 	const double *PeakValues;
-	complex_number Value, DftResult[DFT_NUMBER];
+	complex_number Value, DftResult[MAX_DFT_NUMBER];
 	int CurBit = 0;
-	double AmplitudeAcc[DFT_NUMBER], AmplitudeMax = 0.0;
+	double AmplitudeAcc[MAX_DFT_NUMBER], AmplitudeMax = 0.0;
 
 	if (pSatParam == NULL)
 		return 0.0;
@@ -335,13 +337,13 @@ double CAcqEngine::GetSignalPeak(AeBufferSatParam *pSatParam, int &FreqBin, int
 			Value += GenerateNoise(SIGMA0);
 			// add to DFT result
 			if (CohCount == 0)	// for the first round of coherent sum, do not apply DFT twiddle factor
-				for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+				for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 					DftResult[FreqCount] = Value;
 			else	// for other round of coherent sum
 			{
-				for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+				for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 				{
-					DftPhase = (FreqCount * 2 - 7) * DftTwiddleFactor;
+					DftPhase = (FreqCount * 2 - (DftNumber - 1)) * DftTwiddleFactor;
 					DftResult[FreqCount] += Value * complex_number(cos(DftPhase), sin(DftPhase));
 				}
 			}
@@ -355,18 +357,18 @@ double CAcqEngine::GetSignalPeak(AeBufferSatParam *pSatParam, int &FreqBin, int
 				CurBitIndex ++;
 			}
 		}
-		for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+		for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 			AmplitudeAcc[FreqCount] += DftResult[FreqCount].abs();
 	}
 
-	for (FreqCount = 0; FreqCount < DFT_NUMBER; FreqCount ++)
+	for (FreqCount = 0; FreqCount < DftNumber; FreqCount ++)
 		if (AmplitudeMax < AmplitudeAcc[FreqCount])
 		{
 			AmplitudeMax = AmplitudeAcc[FreqCount];
 			DftBinMin = FreqCount;
 		}
 	// assign FreqBin field of signal
-	FreqBin = (StrideOffsetMin << 3) + DftBinMin;
+	FreqBin = (StrideOffsetMin << (3 + DftSize)) + DftBinMin;
 	return AmplitudeMax;
 }
 
@@ -444,15 +446,15 @@ void CAcqEngine::SearchOneChannel(AeBufferSatParam *pSatParam, int Channel)
 		{
 			PeakAmp = ((int)NoisePeaks[i]) >> GlobalExp;
 			// random FreqBin
-			PeakFreqBin = (rand() % (8 * StrideNumber)) - (StrideNumber - 1) / 2 * 8;
+			PeakFreqBin = (rand() % (DftNumber * StrideNumber)) - (StrideNumber - 1) / 2 * DftNumber;
 			if (CoherentNumber == 1)
-				PeakFreqBin &= ~7;	// no DFT, DFT bin field always 0
+				PeakFreqBin &= ~(DftNumber - 1);	// no DFT, DFT bin field always 0
 			PeakCor = rand() % MaxCor;
 		}
 		ChannelConfig[Channel][5+i] = (PeakAmp << 24) | ((PeakFreqBin & 0x1ff) << 15) | PeakCor;
 	}
 //	printf("Ch%02d %08x %08x %08x %08x ", Channel, ChannelConfig[Channel][4], ChannelConfig[Channel][5], ChannelConfig[Channel][6], ChannelConfig[Channel][7]);
-//	printf("Svid%2d Amp=%f Cor=%4d Freq=%f\n", Svid, SignalPeak, Cor, (FreqBin - 3.5) * 62.5 + CenterFreq);
+//	printf("Svid%2d Amp=%f Cor=%4d Freq=%f\n", Svid, SignalPeak, Cor, (FreqBin - (DftNumber - 1) / 2.) * StrideInterval / DftNumber + CenterFreq);
 }
 
 void CAcqEngine::DoAcquisition()
@@ -469,6 +471,12 @@ void CAcqEngine::DoAcquisition()
 		NonCoherentNumber = EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
 		PeakRatioTh = EXTRACT_UINT(ChannelConfig[i][0], 24, 3);
 		EarlyTerminate = EXTRACT_UINT(ChannelConfig[i][0], 27, 1);
+		DftSize = EXTRACT_UINT(ChannelConfig[i][0], 28, 2);
+		if (DftSize > 2)	// 2'b11 reserved, treat as 32 bins
+			DftSize = 2;
+		DftNumber = 8 << DftSize;
+		if (StrideNumber > 512 / DftNumber - 1)	// peak frequency index is 9bit signed in result, limit all bins within -256~255
+			StrideNumber = 512 / DftNumber - 1;
 		Freq = EXTRACT_INT(ChannelConfig[i][1], 0, 20);
 		CenterFreq = Freq * 2.046e6 / 1048576.;
 		Svid = EXTRACT_UINT(ChannelConfig[i][1], 24, 6);
@@ -21,10 +21,13 @@ double CTrackingChannel::CovarMatrix[4][SUM_N(COR_NUMBER)];
 CGnssTop::CGnssTop()
 {
 	InterruptService = (InterruptFunction)0;
-	NavBitArray[0] = &GpsBits;	// for GPS L1C/A
-	NavBitArray[1] = &GalBits;	// for Galileo E1
-	NavBitArray[2] = &BdsBits;	// for BDS B1C
-	NavBitArray[3] = &GpsBits;	// for GPS L1C
+	GpsBitCache.SetSource(&GpsBits, 6000, 20);	// LNAV subframe
+	BdsBitCache.SetSource(&BdsBits, 18000, 10);	// B-CNAV1 frame
+	GalBitCache.SetSource(&GalBits, 2000, 4);	// I/NAV page pair
+	NavBitArray[0] = &GpsBitCache;	// for GPS L1C/A
+	NavBitArray[1] = &GalBitCache;	// for Galileo E1
+	NavBitArray[2] = &BdsBitCache;	// for BDS B1C
+	NavBitArray[3] = &GpsBitCache;	// for GPS L1C
 	// calculate relative matrix for noise generation
 	CalculateCovar(COR_NUMBER, 2, CTrackingChannel::CovarMatrix[0]);
 	CalculateCovar(COR_NUMBER, 4, CTrackingChannel::CovarMatrix[1]);
@@ -98,7 +101,8 @@ void CGnssTop::SetRegValue(int Address, U32 Value)
 			AeProcessCount = GetAeProcessTime();
 		break;
 	case ADDR_BASE_TE_FIFO:
-		TeFifo.SetRegValue(AddressOffset, Value);
+		if ((AddressOffset & ADDR_OFFSET_TE_FIFO2) == 0)	// L5 band input not simulated, ignore second TE FIFO
+			TeFifo.SetRegValue(AddressOffset, Value);
 		break;
 	case ADDR_BASE_TRACKING_ENGINE:
 		TrackingEngine.SetRegValue(AddressOffset & 0xff, Value);
@@ -151,7 +155,7 @@ U32 CGnssTop::GetRegValue(int Address)
 	case ADDR_BASE_ACQUIRE_ENGINE:
 		return AcqEngine.GetRegValue(AddressOffset);
 	case ADDR_BASE_TE_FIFO:
-		return TeFifo.GetRegValue(AddressOffset);
+		return (AddressOffset & ADDR_OFFSET_TE_FIFO2) ? 0 : TeFifo.GetRegValue(AddressOffset);
 	case ADDR_BASE_TRACKING_ENGINE:
 		return TrackingEngine.GetRegValue(AddressOffset & 0xff);
 	case ADDR_BASE_PERIPHERIAL:
@@ -171,6 +175,12 @@ void CGnssTop::SetInputFile(char *FileName)
 	CXmlElementTree XmlTree;
 	CXmlElement *RootElement, *Element;
 	GNSS_TIME BdsTime;
+	const char *NavFile[MAX_NAV_FILE];	// file names point to text of XmlTree
+	int NavFileNumber = 0;
+	const char *CachePath = NULL;	// scenario cache is used only if Cache element exists
+	char CacheFile[256+4];
+	PGPS_EPHEMERIS Eph;
+	U64 ScenarioHash = 0;
 
 	XmlTree.parse(FileName);
 	RootElement = XmlTree.getroot();
@@ -181,12 +191,14 @@ void CGnssTop::SetInputFile(char *FileName)
 			AssignStartTime(Element, UtcTime);
 		else if (strcmp(Element->GetTag(), "Trajectory") == 0)
 			SetTrajectory(Element, StartPos, StartVel, Trajectory);
-		else if (strcmp(Element->GetTag(), "Ephemeris") == 0)
-			NavData.ReadNavFile(Element->GetText());
+		else if (strcmp(Element->GetTag(), "Ephemeris") == 0 && NavFileNumber < MAX_NAV_FILE)	// navigation files are read only if scenario cache not match
+			NavFile[NavFileNumber ++] = Element->GetText();
 		else if (strcmp(Element->GetTag(), "Output") == 0)
 			SetOutputParam(Element, OutputParam);
 		else if (strcmp(Element->GetTag(), "PowerControl") == 0)
 			SetPowerControl(Element, PowerControl);
+		else if (strcmp(Element->GetTag(), "Cache") == 0)	// <Cache>path</Cache>, empty path for scenario file name appended with .bin
+			CachePath = (Element->GetText() != NULL) ? Element->GetText() : "";
 	}
 	Trajectory.ResetTrajectoryTime();
 	CurTime = UtcToGpsTime(UtcTime);
@@ -201,29 +213,190 @@ void CGnssTop::SetInputFile(char *FileName)
 	for (i = 0; i < TOTAL_GAL_SAT; i ++)
 		GalSatParam[i].CN0 = (int)(PowerControl.InitCN0 * 100 + 0.5);
 
-	// Find ephemeris match current time and fill in data to generate bit stream
-	for (i = 1; i <= TOTAL_GPS_SAT; i ++)
+	// load ephemeris, iono/UTC and initial visible satellites from compiled cache if both scenario and navigation file not changed
+	if (CachePath)
 	{
-		GpsEph[i-1] = NavData.FindEphemeris(GpsSystem, CurTime, i);
-		GpsBits.SetEphemeris(i, GpsEph[i-1]);
+		ScenarioHash = HashFile(FileName, 0xcbf29ce484222325ULL);
+		for (i = 0; i < NavFileNumber; i ++)
+			ScenarioHash = HashFile(NavFile[i], ScenarioHash);
+		if (CachePath[0])
+			sprintf(CacheFile, "%.259s", CachePath);
+		else
+			sprintf(CacheFile, "%.255s.bin", FileName);
 	}
-	for (i = 1; i <= TOTAL_BDS_SAT; i ++)
+	if (!CachePath || !LoadScenarioCache(CacheFile, ScenarioHash))
 	{
-		BdsEph[i-1] = NavData.FindEphemeris(BdsSystem, BdsTime, i);
-		BdsBits.SetEphemeris(i, BdsEph[i-1]);
+		for (i = 0; i < NavFileNumber; i ++)
+			NavData.ReadNavFile(NavFile[i]);
+		// Find ephemeris match current time and keep a copy in EphStore
+		for (i = 0; i < TOTAL_EPH_NUMBER; i ++)
+		{
+			if (i < TOTAL_GPS_SAT)
+				Eph = NavData.FindEphemeris(GpsSystem, CurTime, i + 1);
+			else if (i < TOTAL_GPS_SAT + TOTAL_BDS_SAT)
+				Eph = NavData.FindEphemeris(BdsSystem, BdsTime, i - TOTAL_GPS_SAT + 1);
+			else
+				Eph = NavData.FindEphemeris(GalileoSystem, CurTime, i - TOTAL_GPS_SAT - TOTAL_BDS_SAT + 1);
+			if (Eph)
+				EphStore[i] = *Eph;
+			else
+				memset(&EphStore[i], 0, sizeof(GPS_EPHEMERIS));
+		}
+		SetEphPointers();
+		// calculate visible satellite at start time
+		GpsSatNumber = (OutputParam.FreqSelect[GpsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GpsSystem, GpsEph, 32, GpsEphVisible) : 0;
+		BdsSatNumber = (OutputParam.FreqSelect[BdsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, BdsSystem, BdsEph, TOTAL_BDS_SAT, BdsEphVisible) : 0;
+		GalSatNumber = (OutputParam.FreqSelect[GalileoSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GalileoSystem, GalEph, TOTAL_GAL_SAT, GalEphVisible) : 0;
+		if (CachePath && !SaveScenarioCache(CacheFile, ScenarioHash))
+			printf("Warning: fail to write scenario cache %s\n", CacheFile);
 	}
+
+	// fill in data to generate bit stream, go through cache to drop frames generated with old data
+	for (i = 1; i <= TOTAL_GPS_SAT; i ++)
+		GpsBitCache.SetEphemeris(i, GpsEph[i-1]);
+	for (i = 1; i <= TOTAL_BDS_SAT; i ++)
+		BdsBitCache.SetEphemeris(i, BdsEph[i-1]);
 	for (i = 1; i <= TOTAL_GAL_SAT; i ++)
+		GalBitCache.SetEphemeris(i, GalEph[i-1]);
+	GpsBitCache.SetIonoUtc(NavData.GetGpsIono(), NavData.GetGpsUtcParam());
+	GalBitCache.SetIonoUtc(NavData.GetGalileoIono(), NavData.GetGalileoUtcParam());
+	// calculate satellite parameters
+	UpdateSatParamList();
+}
+
+//*************** Point ephemeris arrays to EphStore ****************
+//* satellite without ephemeris (svid is 0) has NULL pointer
+void CGnssTop::SetEphPointers()
+{
+	int i;
+
+	for (i = 0; i < TOTAL_GPS_SAT; i ++)
+		GpsEph[i] = EphStore[i].svid ? &EphStore[i] : NULL;
+	for (i = 0; i < TOTAL_BDS_SAT; i ++)
+		BdsEph[i] = EphStore[TOTAL_GPS_SAT + i].svid ? &EphStore[TOTAL_GPS_SAT + i] : NULL;
+	for (i = 0; i < TOTAL_GAL_SAT; i ++)
+		GalEph[i] = EphStore[TOTAL_GPS_SAT + TOTAL_BDS_SAT + i].svid ? &EphStore[TOTAL_GPS_SAT + TOTAL_BDS_SAT + i] : NULL;
+}
+
+//*************** Accumulate FNV-1a hash of file contents ****************
+// Parameters:
+//   FileName: file to hash, file not exist has no effect on hash
+//   Hash: initial hash value
+// Return value:
+//   accumulated hash value
+U64 CGnssTop::HashFile(const char *FileName, U64 Hash)
+{
+	FILE *fp;
+	unsigned char Buffer[4096];
+	int i, Length;
+
+	if (FileName[0] == '\0' || (fp = fopen(FileName, "rb")) == NULL)
+		return Hash;
+	while ((Length = (int)fread(Buffer, 1, sizeof(Buffer), fp)) > 0)
 	{
-		GalEph[i-1] = NavData.FindEphemeris(GalileoSystem, CurTime, i);
-		GalBits.SetEphemeris(i, GalEph[i-1]);
+		for (i = 0; i < Length; i ++)
+		{
+			Hash ^= Buffer[i];
+			Hash *= 0x100000001b3ULL;
+		}
 	}
-	GpsBits.SetIonoUtc(NavData.GetGpsIono(), NavData.GetGpsUtcParam());
-	GalBits.SetIonoUtc(NavData.GetGalileoIono(), NavData.GetGalileoUtcParam());
-	// calculate visible satellite at start time and calculate satellite parameters
-	GpsSatNumber = (OutputParam.FreqSelect[GpsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GpsSystem, GpsEph, 32, GpsEphVisible) : 0;
-	BdsSatNumber = (OutputParam.FreqSelect[BdsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, BdsSystem, BdsEph, TOTAL_BDS_SAT, BdsEphVisible) : 0;
-	GalSatNumber = (OutputParam.FreqSelect[GalileoSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GalileoSystem, GalEph, TOTAL_GAL_SAT, GalEphVisible) : 0;
-	UpdateSatParamList();
+	fclose(fp);
+	return Hash;
+}
+
+//*************** Load compiled scenario cache ****************
+// Parameters:
+//   CacheFile: cache file name
+//   ScenarioHash: hash of scenario file and all navigation files
+// Return value:
+//   1 if cache matches and loaded, 0 if cache not exist or not match
+int CGnssTop::LoadScenarioCache(const char *CacheFile, U64 ScenarioHash)
+{
+	FILE *fp;
+	SCENARIO_CACHE_HEADER Header;
+	int EphValid[TOTAL_EPH_NUMBER], VisibleIndex[TOTAL_EPH_NUMBER];
+	void *IonoUtc[4] = { NavData.GetGpsIono(), NavData.GetGpsUtcParam(), NavData.GetGalileoIono(), NavData.GetGalileoUtcParam() };
+	U32 IonoUtcSize[4] = { sizeof(*NavData.GetGpsIono()), sizeof(*NavData.GetGpsUtcParam()), sizeof(*NavData.GetGalileoIono()), sizeof(*NavData.GetGalileoUtcParam()) };
+	int i, Valid;
+
+	if ((fp = fopen(CacheFile, "rb")) == NULL)
+		return 0;
+	Valid = (fread(&Header, sizeof(Header), 1, fp) == 1);
+	Valid = Valid && Header.Magic == SCENARIO_CACHE_MAGIC && Header.Version == SCENARIO_CACHE_VERSION && Header.ScenarioHash == ScenarioHash;
+	Valid = Valid && Header.EphSize == sizeof(GPS_EPHEMERIS) && memcmp(Header.IonoUtcSize, IonoUtcSize, sizeof(IonoUtcSize)) == 0;
+	Valid = Valid && (unsigned int)Header.VisibleNumber[0] <= TOTAL_GPS_SAT && (unsigned int)Header.VisibleNumber[1] <= TOTAL_BDS_SAT && (unsigned int)Header.VisibleNumber[2] <= TOTAL_GAL_SAT;
+	Valid = Valid && fread(EphValid, sizeof(EphValid), 1, fp) == 1 && fread(EphStore, sizeof(EphStore), 1, fp) == 1;
+	for (i = 0; Valid && i < 4; i ++)
+		Valid = (fread(IonoUtc[i], IonoUtcSize[i], 1, fp) == 1);
+	Valid = Valid && fread(VisibleIndex, sizeof(VisibleIndex), 1, fp) == 1;
+	fclose(fp);
+	if (!Valid)
+		return 0;
+
+	for (i = 0; i < TOTAL_EPH_NUMBER; i ++)
+		if (!EphValid[i])
+			memset(&EphStore[i], 0, sizeof(GPS_EPHEMERIS));
+	SetEphPointers();
+	GpsSatNumber = Header.VisibleNumber[0];
+	BdsSatNumber = Header.VisibleNumber[1];
+	GalSatNumber = Header.VisibleNumber[2];
+	for (i = 0; i < GpsSatNumber; i ++)
+		GpsEphVisible[i] = &EphStore[VisibleIndex[i] % TOTAL_GPS_SAT];
+	for (i = 0; i < BdsSatNumber; i ++)
+		BdsEphVisible[i] = &EphStore[TOTAL_GPS_SAT + VisibleIndex[TOTAL_GPS_SAT + i] % TOTAL_BDS_SAT];
+	for (i = 0; i < GalSatNumber; i ++)
+		GalEphVisible[i] = &EphStore[TOTAL_GPS_SAT + TOTAL_BDS_SAT + VisibleIndex[TOTAL_GPS_SAT + TOTAL_BDS_SAT + i] % TOTAL_GAL_SAT];
+	return 1;
+}
+
+//*************** Save compiled scenario cache ****************
+//* sections have fixed size so the file can also be mapped to memory directly
+// Parameters:
+//   CacheFile: cache file name
+//   ScenarioHash: hash of scenario file and all navigation files
+// Return value:
+//   1 if cache written, 0 if fail to write (incomplete file is removed)
+int CGnssTop::SaveScenarioCache(const char *CacheFile, U64 ScenarioHash)
+{
+	FILE *fp;
+	SCENARIO_CACHE_HEADER Header;
+	int EphValid[TOTAL_EPH_NUMBER], VisibleIndex[TOTAL_EPH_NUMBER];
+	void *IonoUtc[4] = { NavData.GetGpsIono(), NavData.GetGpsUtcParam(), NavData.GetGalileoIono(), NavData.GetGalileoUtcParam() };
+	int i, Valid;
+
+	memset(&Header, 0, sizeof(Header));
+	Header.Magic = SCENARIO_CACHE_MAGIC;
+	Header.Version = SCENARIO_CACHE_VERSION;
+	Header.EphSize = sizeof(GPS_EPHEMERIS);
+	Header.IonoUtcSize[0] = sizeof(*NavData.GetGpsIono());
+	Header.IonoUtcSize[1] = sizeof(*NavData.GetGpsUtcParam());
+	Header.IonoUtcSize[2] = sizeof(*NavData.GetGalileoIono());
+	Header.IonoUtcSize[3] = sizeof(*NavData.GetGalileoUtcParam());
+	Header.ScenarioHash = ScenarioHash;
+	Header.VisibleNumber[0] = GpsSatNumber;
+	Header.VisibleNumber[1] = BdsSatNumber;
+	Header.VisibleNumber[2] = GalSatNumber;
+	for (i = 0; i < TOTAL_EPH_NUMBER; i ++)
+		EphValid[i] = (EphStore[i].svid != 0);
+	memset(VisibleIndex, 0, sizeof(VisibleIndex));
+	for (i = 0; i < GpsSatNumber; i ++)
+		VisibleIndex[i] = (int)(GpsEphVisible[i] - EphStore);
+	for (i = 0; i < BdsSatNumber; i ++)
+		VisibleIndex[TOTAL_GPS_SAT + i] = (int)(BdsEphVisible[i] - EphStore) - TOTAL_GPS_SAT;
+	for (i = 0; i < GalSatNumber; i ++)
+		VisibleIndex[TOTAL_GPS_SAT + TOTAL_BDS_SAT + i] = (int)(GalEphVisible[i] - EphStore) - TOTAL_GPS_SAT - TOTAL_BDS_SAT;
+
+	if ((fp = fopen(CacheFile, "wb")) == NULL)
+		return 0;
+	Valid = (fwrite(&Header, sizeof(Header), 1, fp) == 1);
+	Valid = Valid && fwrite(EphValid, sizeof(EphValid), 1, fp) == 1 && fwrite(EphStore, sizeof(EphStore), 1, fp) == 1;
+	for (i = 0; Valid && i < 4; i ++)
+		Valid = (fwrite(IonoUtc[i], Header.IonoUtcSize[i], 1, fp) == 1);
+	Valid = Valid && fwrite(VisibleIndex, sizeof(VisibleIndex), 1, fp) == 1;
+	Valid = (fclose(fp) == 0) && Valid;
+	if (!Valid)
+		remove(CacheFile);
+	return Valid;
 }
 
 int CGnssTop::Process(int BlockSize)
@@ -324,12 +497,14 @@ void CGnssTop::UpdateSatParamList()
 //   N is non-coherent number
 //   R is code span
 // one last step of force output needs about 1364 clock cycles
+// with D DFT bins (D = 16/32) the non-coherent acc reads D/8 words of coherent buffer
+// for each correlator, so each non-coherent round adds 682*(D/8-1) clock cycles
 int CGnssTop::GetAeProcessTime()
 {
 	int i;
 	int TotalCycles = 2;
 	unsigned int (*ChannelConfig)[CHANNEL_CONFIG_LEN] = AcqEngine.ChannelConfig;
-	int StrideNumber, CoherentNumber, NonCoherentNumber, CodeSpan;
+	int StrideNumber, CoherentNumber, NonCoherentNumber, CodeSpan, DftSize;
 	double ProcessTime;
 
 	for (i = 0; i < (int)AcqEngine.ChannelNumber; i ++)
@@ -338,8 +513,11 @@ int CGnssTop::GetAeProcessTime()
 		StrideNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 0, 6);
 		CoherentNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 8, 6);
 		NonCoherentNumber = (int)EXTRACT_UINT(ChannelConfig[i][0], 16, 7);
+		DftSize = (int)EXTRACT_UINT(ChannelConfig[i][0], 28, 2);
 		CodeSpan = (int)EXTRACT_UINT(ChannelConfig[i][2], 0, 5);
-		TotalCycles += StrideNumber * CodeSpan * (1 + 6 * CoherentNumber * NonCoherentNumber);
+		if (DftSize > 2)
+			DftSize = 2;
+		TotalCycles += StrideNumber * CodeSpan * (1 + (6 * CoherentNumber + (1 << DftSize) - 1) * NonCoherentNumber);
 	}
 
 	ProcessTime = 682. * TotalCycles / CLK_NUMBER_IN_BLOCK;
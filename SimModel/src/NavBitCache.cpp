@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------
+// NavBitCache.cpp:
+//   Navigation bit frame cache shared by all channels implementation
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include "NavBitCache.h"
+
+CNavBitCache::CNavBitCache()
+{
+	NavBitSource = (NavBit *)0;
+	SymbolNumber = 0;
+	SymbolBuffer = (int *)0;
+	memset(CacheSlot, 0, sizeof(CacheSlot));
+}
+
+CNavBitCache::~CNavBitCache()
+{
+	if (SymbolBuffer)
+		free(SymbolBuffer);
+}
+
+// set NavBit object to generate frames, frame length and symbol length in millisecond
+// determine number of symbols it outputs for each frame
+void CNavBitCache::SetSource(NavBit *Source, int FrameLength, int SymbolLength)
+{
+	int i, j;
+
+	NavBitSource = Source;
+	SymbolNumber = FrameLength / SymbolLength;
+	if (SymbolNumber > NAV_CACHE_MAX_SYMBOL)
+		SymbolNumber = NAV_CACHE_MAX_SYMBOL;
+	if (SymbolBuffer == NULL)
+		SymbolBuffer = (int *)malloc(NAV_CACHE_MAX_SVID * NAV_CACHE_SLOT_NUMBER * NAV_CACHE_MAX_SYMBOL * sizeof(int));
+	for (i = 0; i < NAV_CACHE_MAX_SVID; i ++)
+		for (j = 0; j < NAV_CACHE_SLOT_NUMBER; j ++)
+			CacheSlot[i][j].Symbols = SymbolBuffer ? SymbolBuffer + (i * NAV_CACHE_SLOT_NUMBER + j) * NAV_CACHE_MAX_SYMBOL : (int *)0;
+	Invalidate(0);
+}
+
+// clear cached frames of svid, svid 0 to clear all satellites
+void CNavBitCache::Invalidate(int svid)
+{
+	int i, j;
+
+	for (i = 0; i < NAV_CACHE_MAX_SVID; i ++)
+	{
+		if (svid != 0 && svid != i + 1)
+			continue;
+		for (j = 0; j < NAV_CACHE_SLOT_NUMBER; j ++)
+			CacheSlot[i][j].BlockIndex = -1;
+	}
+}
+
+// return frame from cache, generate by source and replace the oldest slot if not found
+int CNavBitCache::GetFrameData(GNSS_TIME StartTime, int svid, int Param, int *NavBits)
+{
+	int i, Oldest;
+	S64 BlockIndex;
+	NAV_CACHE_SLOT *Slot;
+
+	if (!NavBitSource)
+		return 0;
+	if (svid < 1 || svid > NAV_CACHE_MAX_SVID || !SymbolBuffer)
+		return NavBitSource->GetFrameData(StartTime, svid, Param, NavBits);
+
+	BlockIndex = ((S64)StartTime.Week * 604800000 + StartTime.MilliSeconds) / NAV_CACHE_BLOCK;
+	Slot = CacheSlot[svid-1];
+	for (i = 0, Oldest = 0; i < NAV_CACHE_SLOT_NUMBER; i ++)
+	{
+		if (Slot[i].BlockIndex == BlockIndex && Slot[i].Param == Param)
+			break;
+		if (Slot[i].BlockIndex < Slot[Oldest].BlockIndex)
+			Oldest = i;
+	}
+	if (i == NAV_CACHE_SLOT_NUMBER)	// not found, evict the oldest block
+	{
+		i = Oldest;
+		Slot[i].ReturnValue = NavBitSource->GetFrameData(StartTime, svid, Param, Slot[i].Symbols);
+		Slot[i].BlockIndex = BlockIndex;
+		Slot[i].Param = Param;
+	}
+	memcpy(NavBits, Slot[i].Symbols, SymbolNumber * sizeof(int));
+	return Slot[i].ReturnValue;
+}
+
+int CNavBitCache::SetEphemeris(int svid, PGPS_EPHEMERIS Eph)
+{
+	Invalidate((svid >= 1 && svid <= NAV_CACHE_MAX_SVID) ? svid : 0);
+	return NavBitSource ? NavBitSource->SetEphemeris(svid, Eph) : 0;
+}
+
+int CNavBitCache::SetAlmanac(GPS_ALMANAC Alm[])
+{
+	Invalidate(0);
+	return NavBitSource ? NavBitSource->SetAlmanac(Alm) : 0;
+}
+
+int CNavBitCache::SetIonoUtc(PIONO_PARAM IonoParam, PUTC_PARAM UtcParam)
+{
+	Invalidate(0);
+	return NavBitSource ? NavBitSource->SetIonoUtc(IonoParam, UtcParam) : 0;
+}
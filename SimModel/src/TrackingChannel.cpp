@@ -15,6 +15,7 @@
 #include "ComplexNumber.h"
 #include "GaussNoise.h"
 #include "TrackingChannel.h"
+#include "NavBitCache.h"
 
 const double CTrackingChannel::Bpsk4PeakValues[160] = {
   0.937500,  0.937256,  0.936523,  0.935303,  0.933594,  0.931396,  0.928711,  0.925537,  0.921875,  0.917725,
@@ -84,6 +85,7 @@ CTrackingChannel::~CTrackingChannel()
 void CTrackingChannel::Initial(GNSS_TIME CurTime, PSATELLITE_PARAM pSatParam, NavBit *pNavData)
 {
 	GNSS_TIME TransmitTime;
+	CNavBitCache *NavBitCache = dynamic_cast<CNavBitCache *>(pNavData);
 	int FrameLength = (SystemSel == SignalL1CA) ? 6000 : ((SystemSel == SignalE1) ? 2000 : 18000);
 
 	if (SystemSel == SignalB1C)
@@ -95,9 +97,16 @@ void CTrackingChannel::Initial(GNSS_TIME CurTime, PSATELLITE_PARAM pSatParam, Na
 	// initial modulation bit and counter
 	TransmitTime = GetTransmitTime(CurTime, GetTravelTime(pSatParam, 0));
 	TransmitTime.MilliSeconds ++;	// correlation result will be calculated from next millisecond
-	if (!SatelliteSignal.SetSignalAttribute(pSatParam->system, 0, pNavData, pSatParam->svid))
+	// signal attribute is matched against concrete NavBit type, so use source of the cache to match and get frames through cache after that
+	if (!SatelliteSignal.SetSignalAttribute(pSatParam->system, 0, NavBitCache ? NavBitCache->NavBitSource : pNavData, pSatParam->svid))
 		SatelliteSignal.NavData = (NavBit *)0;	// if system/frequency and navigation data not match, set pointer to NULL
+	else if (NavBitCache)
+		SatelliteSignal.NavData = pNavData;
 	DataSignal = PilotSignal = complex_number(0, 0);
+	// reset coherent interval synthesis
+	NHHistory = 0;
+	memset(IntervalCount, 0, sizeof(IntervalCount));
+	IntervalPending = 0;
 }
 
 // on set value of channel state buffer, interprete channel configuration parameters
@@ -240,24 +249,122 @@ int CTrackingChannel::FindSvid(unsigned int ConfigArray[], int ArraySize, U32 Pr
 void CTrackingChannel::GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength)
 {
 	int i;
-	double Alpha;
 	complex_number CorResult[16];
-	complex_number Signal, Rotate;
-	double CodeDiff[16];
-	int CorCount = 0, StartIndex = 0;
+
+	if (pSatParam)
+		UpdateCarrierDiff(pSatParam, CorPos[0]);
+	EpochCorrelation(CurTime, pSatParam, CorResult, CorIndex, CorPos, NHCode, DataLength);
+	for (i = 0; i < DataLength; i ++)
+	{
+		DumpDataI[i] = ((int)CorResult[i].real) >> (PreShiftBits + PostShiftBits);
+		DumpDataQ[i] = ((int)CorResult[i].imag) >> (PreShiftBits + PostShiftBits);
+	}
+}
+
+// output correlation result of whole coherent interval at last epoch of each correlator
+// the result is synthesized once from signal statistics of the interval instead of accumulating 1ms results
+// epochs other than the last one output 0, so the accumulated value in TE buffer is only valid on coherent done
+// correlator 0 doing data decode still uses 1ms result because decode needs each bit sum
+void CTrackingChannel::GetIntervalCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int DumpDataI[], int DumpDataQ[], int CorIndex[], int CorPos[], int NHCode[], int DataLength)
+{
+	int i, j, Cor, NHShift;
+	int EpochIndex[16], EpochCorIndex[16], EpochCorPos[16], EpochNHCode[16], EpochLength = 0;
+	complex_number CorResult[16], EpochResult[16];
+
+	if (DataLength == 0)
+		return;
+	// carrier difference history still updates every millisecond
+	if (pSatParam)
+		UpdateCarrierDiff(pSatParam, CorPos[0]);
+
+	for (i = 0; i < DataLength; i ++)
+	{
+		Cor = CorIndex[i] >> 2;
+		CorResult[i] = complex_number(0, 0);
+		if (BitLength && EnableSecondPrn && Cor == 0)	// data decode correlator, put to 1ms result list
+		{
+			EpochIndex[EpochLength] = i;
+			EpochCorIndex[EpochLength] = CorIndex[i];
+			EpochCorPos[EpochLength] = CorPos[i];
+			EpochNHCode[EpochLength] = NHCode[i];
+			EpochLength ++;
+			continue;
+		}
+		if (CorIndex[i] & 1)	// first epoch of coherent interval
+		{
+			IntervalCount[Cor] = 1;
+			IntervalPending &= ~(1 << Cor);
+		}
+		else if (IntervalCount[Cor] > 0)
+			IntervalCount[Cor] ++;
+		if (IntervalCount[Cor] < CoherentNumber)	// interval not finished or first epoch not seen yet
+			continue;
+		if ((IntervalPending & (1 << Cor)) == 0)	// first correlator finishing the interval, synthesize all correlators
+		{
+			// correlator 0 dumped later within this block has already pushed NH bit of next round
+			for (j = i + 1, NHShift = 0; j < DataLength; j ++)
+				if ((CorIndex[j] >> 2) == 0)
+					NHShift ++;
+			SynthesizeInterval(CurTime, pSatParam, CorPos[i] + (((Cor == 0) && EnableSecondPrn) ? 4 : Cor), NHShift);
+			IntervalPending = (1 << COR_NUMBER) - 1;
+		}
+		CorResult[i] = IntervalResult[Cor];
+		IntervalPending &= ~(1 << Cor);
+		IntervalCount[Cor] = 0;
+	}
+
+	if (EpochLength)
+	{
+		EpochCorrelation(CurTime, pSatParam, EpochResult, EpochCorIndex, EpochCorPos, EpochNHCode, EpochLength);
+		for (i = 0; i < EpochLength; i ++)
+			CorResult[EpochIndex[i]] = EpochResult[i];
+	}
+	for (i = 0; i < DataLength; i ++)
+	{
+		DumpDataI[i] = ((int)CorResult[i].real) >> (PreShiftBits + PostShiftBits);
+		DumpDataQ[i] = ((int)CorResult[i].imag) >> (PreShiftBits + PostShiftBits);
+	}
+}
+
+// update frequency and phase difference between source signal and local carrier at latest dump
+void CTrackingChannel::UpdateCarrierDiff(SATELLITE_PARAM *pSatParam, int CorPos0)
+{
+	double Alpha;
 	int NominalIF;
-	double FreqDiff, PhaseDiff;
 	double SourceCarrierPhase;
+
+	Alpha = ((double)CorPos0 / DumpLength / 2);	// CorPos has unit of 1/2 chip
+	Alpha -= (int)Alpha;	// modulo to 1ms
+	Alpha = 1 - Alpha;
+
+	// calculate frequency difference
+	NominalIF = ((SystemSel == SignalL1CA) || EnableBOC) ? IF_FREQ : (IF_FREQ + 1023000);
+	CurFreqDiff = CarrierParam.GetFreqDiff(GetDoppler(pSatParam, 0), CarrierFreq - NominalIF, Alpha) / 1000. * PI;
+
+	// calculate carrier phase of source signal
+	SourceCarrierPhase = GetCarrierPhase(pSatParam, 0);
+	SourceCarrierPhase -= (int)SourceCarrierPhase;
+	SourceCarrierPhase = 1 - SourceCarrierPhase;	// carrier is fractional part of negative of travel time, equvalent to 1 minus positive fractional part
+	// calculate phase difference
+	CurPhaseDiff = CarrierParam.GetPhaseDiff(SourceCarrierPhase - CarrierPhase / 4294967296., Alpha);
+//	printf(" %.5f\n", CurPhaseDiff);
+}
+
+// calculate 1ms correlation result with noise for each dumped correlator
+void CTrackingChannel::EpochCorrelation(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, complex_number CorResult[], int CorIndex[], int CorPos[], int NHCode[], int DataLength)
+{
+	int i;
+	complex_number Signal, Rotate;
+	int CorCount = 0;
 	double Amplitude, PeakPosition, NcoPhase, CorPosition, AmpRatio;
 	GNSS_TIME TransmitTime;
-	int CodeDiffIndex, CodeLength, FrameLength, BitLength;
+	int CodeLength, BitLength;
 	int Milliseconds;
 	const double *PeakValues;
 
 	// calculate half of 128x code length
 	CodeLength = (SystemSel == SignalL1CA) ? 1023 : ((SystemSel == SignalE1) ? 4092 : 10230);
 	CodeLength *= 64;
-	FrameLength = (SystemSel == SignalL1CA) ? 6000 : ((SystemSel == SignalE1) ? 2000 : 18000);
 	BitLength = (SystemSel == SignalL1CA) ? 20 : ((SystemSel == SignalE1) ? 4 : 10);
 
 	// first generate relative noise
@@ -271,72 +378,151 @@ void CTrackingChannel::GetCorrelationResult(GNSS_TIME CurTime, SATELLITE_PARAM *
 	if (pSatParam)
 	{
 		PeakValues = (SystemSel == SignalL1CA) ? Bpsk4PeakValues : (EnableBOC ? Boc4PeakValues : Boc2PeakValues);
-		Alpha = ((double)CorPos[0] / DumpLength / 2);	// CorPos has unit of 1/2 chip
-		Alpha -= (int)Alpha;	// modulo to 1ms
-		Alpha = 1 - Alpha;
-
-		// calculate frequency difference
-		NominalIF = ((SystemSel == SignalL1CA) || EnableBOC) ? IF_FREQ : (IF_FREQ + 1023000);
-		FreqDiff = CarrierParam.GetFreqDiff(GetDoppler(pSatParam, 0), CarrierFreq - NominalIF, Alpha) / 1000. * PI;
-
-		// calculate carrier phase of source signal
-		SourceCarrierPhase = GetCarrierPhase(pSatParam, 0);
-		SourceCarrierPhase -= (int)SourceCarrierPhase;
-		SourceCarrierPhase = 1 - SourceCarrierPhase;	// carrier is fractional part of negative of travel time, equvalent to 1 minus positive fractional part
-		// calculate phase difference
-		PhaseDiff = CarrierParam.GetPhaseDiff(SourceCarrierPhase - CarrierPhase / 4294967296., Alpha);
-		Rotate = complex_number(cos(PhaseDiff * PI2), sin(PhaseDiff * PI2));
-//		printf(" %.5f\n", PhaseDiff);
+		Rotate = complex_number(cos(CurPhaseDiff * PI2), sin(CurPhaseDiff * PI2));
 
 		// calculate signal amplitude
 		Amplitude = 1.4142135 * pow(10, (pSatParam->CN0 - 3000) / 2000.) * NOISE_AMP;
-		Amplitude *= (fabs(FreqDiff) > 1e-3) ? (sin(FreqDiff) / FreqDiff) : 1.0;
+		Amplitude *= (fabs(CurFreqDiff) > 1e-3) ? (sin(CurFreqDiff) / CurFreqDiff) : 1.0;
 		TransmitTime = GetTransmitTime(CurTime, GetTravelTime(pSatParam, 0) + 0.001);	// add one extra millisecond to get previous finished millisecond
 		Milliseconds = TransmitTime.MilliSeconds % BitLength;
 		PeakPosition = (((SystemSel == SignalL1CA) ? 0 : Milliseconds) + TransmitTime.SubMilliSeconds) * 2046;
 		NcoPhase = (double)CodePhase / 4294967296.;
-		// calculate code difference for each correlator and add narrow correlator compensation (with unit of 1/64 correlator interval or 1/128 chip)
+
+		// calculate 1ms correlation value
 		for (i = 0; i < DataLength; i ++)
 		{
+			if ((CorIndex[i] >> 2) == 0)	// new correlator dump, recalculate data/pilot signal
+				SatelliteSignal.GetSatelliteSignal(TransmitTime, DataSignal, PilotSignal);
+
+			// calculate code difference and add narrow correlator compensation (with unit of 1/64 correlator interval or 1/128 chip)
 			CorPosition = CorPos[i] + NcoPhase;
 			if (NarrowFactor)
 				CorPosition += NarrowCompensation(CorIndex[i] >> 2, NarrowFactor);
-			CodeDiff[i] = fabs(CorPosition - PeakPosition) * 64;
+			AmpRatio = PeakAmplitude(PeakValues, (CorPosition - PeakPosition) * 64, CodeLength);
+			AmpRatio *= Amplitude;
+			if ((((CorIndex[i] >> 2) == 0) && EnableSecondPrn) || (SystemSel == SignalL1CA))
+				Signal = DataSignal * AmpRatio;
+			else
+				Signal = PilotSignal * (NHCode[i] ? -AmpRatio : AmpRatio);
+			CorResult[i] += Signal * Rotate;
+//			if ((CorIndex[i] >> 2) == 4)
+//				printf("Cor=%f %f %f\n", AmpRatio, CorResult[i].real, CorResult[i].imag);
 		}
+	}
+}
 
-		// calculate 1ms correlation value
-		for (i = 0; i < DataLength; i ++)
-		{
-			if ((CorIndex[i] >> 2) == 0)	// new correlator dump, recalculate data/pilot signal
-				SatelliteSignal.GetSatelliteSignal(TransmitTime, DataSignal, PilotSignal);
+// synthesize correlation result of all correlators over the whole coherent interval ending at latest epoch
+// CorBase is the code position of correlator 0 without secondary PRN delay, NHShift is NH history bits pushed after the interval
+void CTrackingChannel::SynthesizeInterval(GNSS_TIME CurTime, SATELLITE_PARAM *pSatParam, int CorBase, int NHShift)
+{
+	int i, k;
+	int CodeLength, SymbolLength, Milliseconds;
+	int Segment, CurSegment, NHBit, CurNHBit, DataStart, PilotStart;
+	double Amplitude, TravelTime, PeakPosition, NcoPhase, CorPosition, CodeDiff, CodeDrift, AmpRatio;
+	complex_number SegmentData, SegmentPilot, DataSum, PilotSum;
+	GNSS_TIME TransmitTime;
+	const double *PeakValues;
 
-			if (CodeDiff[i] > CodeLength)	// CodeDiff may be one whole code round difference
-				CodeDiff[i] = fabs(CodeDiff[i] - (CodeLength * 2));
-			CodeDiffIndex = (int)CodeDiff[i];	// integer part of code difference
-			CodeDiff[i] -= CodeDiffIndex;	// factional part of code difference
-			if (CodeDiffIndex < 159)
-			{
-				// interpolation on peak value shape
-				AmpRatio = PeakValues[CodeDiffIndex];
-				AmpRatio += (PeakValues[CodeDiffIndex+1] - PeakValues[CodeDiffIndex]) * CodeDiff[i];
-				AmpRatio *= Amplitude;
-				if ((((CorIndex[i] >> 2) == 0) && EnableSecondPrn) || (SystemSel == SignalL1CA))
-					Signal = DataSignal * AmpRatio;
-				else
-					Signal = PilotSignal * (NHCode[i] ? -AmpRatio : AmpRatio);
-				CorResult[i] += Signal * Rotate;
-//				if ((CorIndex[i] >> 2) == 4)
-//					printf("Cor=%f %f %f\n", AmpRatio, CorResult[i].real, CorResult[i].imag);
-			}
+	// noise power increases linearly with number of accumulated epochs
+	GenerateRelativeNoise(8, (2 << NarrowFactor), CovarMatrix[NarrowFactor], NOISE_AMP * sqrt((double)CoherentNumber), IntervalResult);
+	if (!pSatParam)
+		return;
+
+	CodeLength = (SystemSel == SignalL1CA) ? 1023 : ((SystemSel == SignalE1) ? 4092 : 10230);
+	CodeLength *= 64;
+	SymbolLength = (SystemSel == SignalL1CA) ? 20 : ((SystemSel == SignalE1) ? 4 : 10);
+	PeakValues = (SystemSel == SignalL1CA) ? Bpsk4PeakValues : (EnableBOC ? Boc4PeakValues : Boc2PeakValues);
+	Amplitude = 1.4142135 * pow(10, (pSatParam->CN0 - 3000) / 2000.) * NOISE_AMP;
+
+	// count epochs back from the latest one and split the interval into runs with constant modulation
+	// data changes on symbol boundary, pilot after NH wipe-off changes on symbol boundary or local NH bit
+	// only one data/pilot signal is calculated for each symbol the interval straddles
+	TravelTime = GetTravelTime(pSatParam, 0) + 0.001;	// add one extra millisecond to get previous finished millisecond
+	TransmitTime = GetTransmitTime(CurTime, TravelTime);
+	Milliseconds = TransmitTime.MilliSeconds % SymbolLength;
+	DataSum = PilotSum = complex_number(0, 0);
+	CurSegment = -1;
+	CurNHBit = DataStart = PilotStart = 0;
+	for (k = 0; k <= CoherentNumber; k ++)
+	{
+		if (k < CoherentNumber)
+		{
+			Segment = (k > Milliseconds) ? (k - Milliseconds - 1) / SymbolLength + 1 : 0;
+			NHBit = (NHLength && (k + NHShift) < 64) ? (int)((NHHistory >> (k + NHShift)) & 1) : 0;
 		}
+		else	// force to close last run
+			Segment = NHBit = -1;
+		if (k > 0 && Segment != CurSegment)
+		{
+			DataSum += SegmentData * RunPhasor(DataStart, k - 1);
+			DataStart = k;
+		}
+		if (k > 0 && (Segment != CurSegment || NHBit != CurNHBit))
+		{
+			PilotSum += SegmentPilot * RunPhasor(PilotStart, k - 1) * (CurNHBit ? -1.0 : 1.0);
+			PilotStart = k;
+		}
+		if (k < CoherentNumber && Segment != CurSegment)
+		{
+			SatelliteSignal.GetSatelliteSignal(GetTransmitTime(CurTime, TravelTime + k * 0.001), SegmentData, SegmentPilot);
+			CurSegment = Segment;
+		}
+		CurNHBit = NHBit;
 	}
-	for (i = 0; i < DataLength; i ++)
+
+	// code drift per epoch is local code rate minus code rate of source signal (with unit of 1/64 correlator interval)
+	CodeDrift = (CodeFreq - 2046000. * (1 + GetDoppler(pSatParam, 0) / RF_FREQ)) / 1000. * 64;
+	PeakPosition = (((SystemSel == SignalL1CA) ? 0 : Milliseconds) + TransmitTime.SubMilliSeconds) * 2046;
+	NcoPhase = (double)CodePhase / 4294967296.;
+	for (i = 0; i < COR_NUMBER; i ++)
 	{
-		DumpDataI[i] = ((int)CorResult[i].real) >> (PreShiftBits + PostShiftBits);
-		DumpDataQ[i] = ((int)CorResult[i].imag) >> (PreShiftBits + PostShiftBits);
+		CorPosition = (((i == 0) && EnableSecondPrn) ? CorBase - 4 : CorBase - i) + NcoPhase;
+		if (NarrowFactor)
+			CorPosition += NarrowCompensation(i, NarrowFactor);
+		CodeDiff = (CorPosition - PeakPosition) * 64;
+		// k epochs back code difference is CodeDiff - k * CodeDrift, average peak shape over the interval using Simpson rule
+		AmpRatio = PeakAmplitude(PeakValues, CodeDiff, CodeLength);
+		if (fabs(CodeDrift * (CoherentNumber - 1)) > 1e-3)
+		{
+			AmpRatio += PeakAmplitude(PeakValues, CodeDiff - CodeDrift * (CoherentNumber - 1) / 2, CodeLength) * 4;
+			AmpRatio += PeakAmplitude(PeakValues, CodeDiff - CodeDrift * (CoherentNumber - 1), CodeLength);
+			AmpRatio /= 6;
+		}
+		AmpRatio *= Amplitude;
+		if (((i == 0) && EnableSecondPrn) || (SystemSel == SignalL1CA))
+			IntervalResult[i] += DataSum * AmpRatio;
+		else
+			IntervalResult[i] += PilotSum * AmpRatio;
 	}
 }
 
+// sum of carrier phasor over epochs StartMs~EndMs counted back from the latest epoch
+// each epoch has sinc loss of frequency difference, so the sum has closed form sin(L*x)/x
+complex_number CTrackingChannel::RunPhasor(int StartMs, int EndMs)
+{
+	int Length = EndMs - StartMs + 1;
+	double Phase = CurPhaseDiff - (StartMs + EndMs) / 2. * CurFreqDiff / PI;	// phase at middle of the run
+	double Amplitude = (fabs(CurFreqDiff) > 1e-6) ? (sin(Length * CurFreqDiff) / CurFreqDiff) : Length;
+
+	return complex_number(cos(Phase * PI2), sin(Phase * PI2)) * Amplitude;
+}
+
+// get interpolated peak shape value, CodeDiff has unit of 1/64 correlator interval
+double CTrackingChannel::PeakAmplitude(const double *PeakValues, double CodeDiff, int CodeLength)
+{
+	int CodeDiffIndex;
+
+	CodeDiff = fabs(CodeDiff);
+	if (CodeDiff > CodeLength)	// CodeDiff may be one whole code round difference
+		CodeDiff = fabs(CodeDiff - (CodeLength * 2));
+	CodeDiffIndex = (int)CodeDiff;	// integer part of code difference
+	if (CodeDiffIndex >= 159)
+		return 0.0;
+	CodeDiff -= CodeDiffIndex;	// factional part of code difference
+	// interpolation on peak value shape
+	return PeakValues[CodeDiffIndex] + (PeakValues[CodeDiffIndex+1] - PeakValues[CodeDiffIndex]) * CodeDiff;
+}
+
 int CTrackingChannel::CalculateCounter(int BlockSize, int CorIndex[], int CorPos[], int NHBit[], int &DataLength)
 {
 	int i;
@@ -426,6 +612,8 @@ int CTrackingChannel::CalculateCounter(int BlockSize, int CorIndex[], int CorPos
 				CorIndex[DataLength] |= (CoherentCount == 0 ? 1 : 0);
 			// first correlator uses NH code at NHCount position, others uses the same as previous correlator
 			NHBit[DataLength] = (i == 0) ? (NHLength ? ((NHCode & (1 << NHCount)) ? 1 : 0) : 0) : NHBit[DataLength-1];
+			if (i == 0)
+				NHHistory = (NHHistory << 1) | NHBit[DataLength];
 			DataLength ++;
 			CoherentDone |= (CoherentCount == CoherentNumber - 1) ? 1 : 0;
 			if (NHLength && (i == 0) && DumpRound == CodeRound)	// NHCount increase with firse correlator
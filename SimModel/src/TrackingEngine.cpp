@@ -23,6 +23,7 @@ CTrackingEngine::CTrackingEngine()
 	Reset();
 	memset(TEBuffer, 0, TE_BUFFER_SIZE);
 	memset(LogicChannel, 0, sizeof(LogicChannel));
+	IntervalSynthesis = TE_INTERVAL_SYNTHESIS;
 }
 
 CTrackingEngine::~CTrackingEngine()
@@ -171,8 +172,11 @@ int CTrackingEngine::ProcessData(int BlockSize, GNSS_TIME CurTime, PSATELLITE_PA
 		// recalculate corresponding counter of channel
 		if (LogicChannel[i].CalculateCounter(BlockSize, CorIndex, CorPos, NHCode, DataLength))
 			CohDataReady |= EnableMask;
-		// calculate 1ms correlation result
-		LogicChannel[i].GetCorrelationResult(CurTime, pSatParam, DumpDataI, DumpDataQ, CorIndex, CorPos, NHCode, DataLength);
+		// calculate 1ms correlation result or output result of whole coherent interval on its last epoch
+		if (IntervalSynthesis && LogicChannel[i].CoherentNumber > 1)
+			LogicChannel[i].GetIntervalCorrelationResult(CurTime, pSatParam, DumpDataI, DumpDataQ, CorIndex, CorPos, NHCode, DataLength);
+		else
+			LogicChannel[i].GetCorrelationResult(CurTime, pSatParam, DumpDataI, DumpDataQ, CorIndex, CorPos, NHCode, DataLength);
 		// do coherent sum
 		for (j = 0; j < DataLength; j ++)
 		{